@@ -578,6 +578,23 @@ ups_get_version(uint32_t *major, uint32_t *minor,
  *      Environment.
  *     <li>@ref UPS_ENABLE_CRC32</li> Stores (and verifies) CRC32
  *      checksums. Not allowed in combination with @ref UPS_IN_MEMORY.
+ *     <li>@ref UPS_ENABLE_CONCURRENT_READS</li> Read-only operations
+ *      (@ref ups_db_find, @ref ups_cursor_find, @ref ups_cursor_move,
+ *      @ref ups_db_count and the uqi_* functions) share the Environment
+ *      lock and can run in parallel; pages are latched in shared mode.
+ *      Writers remain exclusive. Ignored for Databases with Transactions,
+ *      duplicate keys, variable length keys or key/record compression.
+ *      Cursors must not be shared between threads.
+ *     <li>@ref UPS_ENABLE_IO_URING</li> Performs the file I/O with
+ *      io_uring; pages are read and written without holding the lock of
+ *      the device. Only available on Linux if upscaledb was built with
+ *      liburing; otherwise (or if the kernel does not support io_uring)
+ *      the regular file I/O is used.
+ *     <li>@ref UPS_ENABLE_DIRECT_IO</li> Opens the file with O_DIRECT and
+ *      transfers the data through registered buffers, bypassing the
+ *      page cache of the operating system. Requires
+ *      @ref UPS_ENABLE_IO_URING and implies @ref UPS_DISABLE_MMAP. Ignored
+ *      if the page size is not a multiple of 4096.
  *    </ul>
  *
  * @param mode File access rights for the new file. This is the @a mode
@@ -593,6 +610,45 @@ ups_get_version(uint32_t *major, uint32_t *minor,
  *      posix_fadvise(). Only on supported platforms. Allowed values are
  *      @ref UPS_POSIX_FADVICE_NORMAL (which is the default) or
  *      @ref UPS_POSIX_FADVICE_RANDOM.
+ *    <li>@ref UPS_PARAM_CACHE_POLICY</li> Sets the replacement policy
+ *      of the cache. Allowed values are @ref UPS_CACHE_POLICY_LRU (which
+ *      is the default) or @ref UPS_CACHE_POLICY_2Q. 2Q protects frequently
+ *      used pages from being purged by full scans. Not persisted.
+ *    <li>@ref UPS_PARAM_FLUSH_THREADS</li> The number of threads which
+ *      write dirty pages to disk. Adjacent pages are always coalesced into
+ *      a single write; with more than one thread, these writes are issued
+ *      in parallel. Default is 1. Not persisted.
+ *    <li>@ref UPS_PARAM_PREFETCH_PAGES</li> The number of Btree leaf pages
+ *      which are read ahead in the background when a cursor or a UQI
+ *      query scans the Database sequentially. Default is 0 (disabled).
+ *      Ignored for In-Memory Environments. Not persisted.
+ *    <li>@ref UPS_PARAM_GROUP_COMMIT_WINDOW</li> Only with
+ *      @ref UPS_ENABLE_TRANSACTIONS and @ref UPS_ENABLE_FSYNC: the time
+ *      (in microseconds) a committing Transaction waits for concurrent
+ *      commits, which are then synced to disk with a single fsync.
+ *      Default is 0 (only commits which are already waiting share the
+ *      fsync). Maximum is 1000000. Not persisted.
+ *    <li>@ref UPS_PARAM_GROUP_COMMIT_BYTES</li> Only with
+ *      @ref UPS_ENABLE_TRANSACTIONS and @ref UPS_ENABLE_FSYNC: stops
+ *      waiting for the @ref UPS_PARAM_GROUP_COMMIT_WINDOW as soon as
+ *      this many bytes were written to the journal. Default is 0
+ *      (disabled). Not persisted.
+ *    <li>@ref UPS_PARAM_JANITOR_INTERVAL</li> Enables the background
+ *      compaction of the Btree: underfull leaves which remain after
+ *      @ref ups_db_erase are merged with their siblings, the freed pages
+ *      are moved to the freelist and unused space at the end of the file
+ *      is truncated (unless @ref UPS_DISABLE_RECLAIM_INTERNAL is set).
+ *      The value is the minimum time (in milliseconds) between two
+ *      compaction steps; each step only modifies a few pages, and is
+ *      skipped if the Environment is in use. Default is 0 (disabled).
+ *      Ignored for In-Memory Environments. Not persisted.
+ *    <li>@ref UPS_PARAM_SCAN_THREADS</li> The number of threads which
+ *      scan the Btree leaves in parallel in the UQI functions (i.e.
+ *      @ref uqi_sum). Only used for Databases with fixed-length keys
+ *      without duplicates and key compression; then the predicate
+ *      functions of the @a *_if functions are called from several threads
+ *      at the same time. Default is 1 (disabled). Maximum is 64.
+ *      Not persisted.
  *    <li>@ref UPS_PARAM_PAGE_SIZE</li> The size of a file page, in
  *      bytes. It is recommended not to change the default size. The
  *      default size depends on hardware and operating system.
@@ -697,6 +753,23 @@ ups_env_create(ups_env_t **env, const char *filename,
  *      if necessary.
  *     <li>@ref UPS_ENABLE_CRC32</li> Stores (and verifies) CRC32
  *      checksums.
+ *     <li>@ref UPS_ENABLE_CONCURRENT_READS</li> Read-only operations
+ *      (@ref ups_db_find, @ref ups_cursor_find, @ref ups_cursor_move,
+ *      @ref ups_db_count and the uqi_* functions) share the Environment
+ *      lock and can run in parallel; pages are latched in shared mode.
+ *      Writers remain exclusive. Ignored for Databases with Transactions,
+ *      duplicate keys, variable length keys or key/record compression.
+ *      Cursors must not be shared between threads.
+ *     <li>@ref UPS_ENABLE_IO_URING</li> Performs the file I/O with
+ *      io_uring; pages are read and written without holding the lock of
+ *      the device. Only available on Linux if upscaledb was built with
+ *      liburing; otherwise (or if the kernel does not support io_uring)
+ *      the regular file I/O is used.
+ *     <li>@ref UPS_ENABLE_DIRECT_IO</li> Opens the file with O_DIRECT and
+ *      transfers the data through registered buffers, bypassing the
+ *      page cache of the operating system. Requires
+ *      @ref UPS_ENABLE_IO_URING and implies @ref UPS_DISABLE_MMAP. Ignored
+ *      if the page size is not a multiple of 4096.
  *    </ul>
  * @param param An array of ups_parameter_t structures. The following
  *      parameters are available:
@@ -708,6 +781,45 @@ ups_env_create(ups_env_t **env, const char *filename,
  *      posix_fadvise(). Only on supported platforms. Allowed values are
  *      @ref UPS_POSIX_FADVICE_NORMAL (which is the default) or
  *      @ref UPS_POSIX_FADVICE_RANDOM.
+ *    <li>@ref UPS_PARAM_CACHE_POLICY</li> Sets the replacement policy
+ *      of the cache. Allowed values are @ref UPS_CACHE_POLICY_LRU (which
+ *      is the default) or @ref UPS_CACHE_POLICY_2Q. 2Q protects frequently
+ *      used pages from being purged by full scans. Not persisted.
+ *    <li>@ref UPS_PARAM_FLUSH_THREADS</li> The number of threads which
+ *      write dirty pages to disk. Adjacent pages are always coalesced into
+ *      a single write; with more than one thread, these writes are issued
+ *      in parallel. Default is 1. Not persisted.
+ *    <li>@ref UPS_PARAM_PREFETCH_PAGES</li> The number of Btree leaf pages
+ *      which are read ahead in the background when a cursor or a UQI
+ *      query scans the Database sequentially. Default is 0 (disabled).
+ *      Ignored for In-Memory Environments. Not persisted.
+ *    <li>@ref UPS_PARAM_GROUP_COMMIT_WINDOW</li> Only with
+ *      @ref UPS_ENABLE_TRANSACTIONS and @ref UPS_ENABLE_FSYNC: the time
+ *      (in microseconds) a committing Transaction waits for concurrent
+ *      commits, which are then synced to disk with a single fsync.
+ *      Default is 0 (only commits which are already waiting share the
+ *      fsync). Maximum is 1000000. Not persisted.
+ *    <li>@ref UPS_PARAM_GROUP_COMMIT_BYTES</li> Only with
+ *      @ref UPS_ENABLE_TRANSACTIONS and @ref UPS_ENABLE_FSYNC: stops
+ *      waiting for the @ref UPS_PARAM_GROUP_COMMIT_WINDOW as soon as
+ *      this many bytes were written to the journal. Default is 0
+ *      (disabled). Not persisted.
+ *    <li>@ref UPS_PARAM_JANITOR_INTERVAL</li> Enables the background
+ *      compaction of the Btree: underfull leaves which remain after
+ *      @ref ups_db_erase are merged with their siblings, the freed pages
+ *      are moved to the freelist and unused space at the end of the file
+ *      is truncated (unless @ref UPS_DISABLE_RECLAIM_INTERNAL is set).
+ *      The value is the minimum time (in milliseconds) between two
+ *      compaction steps; each step only modifies a few pages, and is
+ *      skipped if the Environment is in use. Default is 0 (disabled).
+ *      Ignored for In-Memory Environments. Not persisted.
+ *    <li>@ref UPS_PARAM_SCAN_THREADS</li> The number of threads which
+ *      scan the Btree leaves in parallel in the UQI functions (i.e.
+ *      @ref uqi_sum). Only used for Databases with fixed-length keys
+ *      without duplicates and key compression; then the predicate
+ *      functions of the @a *_if functions are called from several threads
+ *      at the same time. Default is 1 (disabled). Maximum is 64.
+ *      Not persisted.
  *    <li>@ref UPS_PARAM_FILE_SIZE_LIMIT</li> Sets a file size limit (in bytes).
  *      Disabled by default. If the limit is exceeded, API functions
  *      return @ref UPS_LIMITS_REACHED.
@@ -1168,7 +1280,13 @@ typedef struct ups_txn_t ups_txn_t;
  *    bitwise OR. Possible flags are:
  *    <ul>
  *     <li>@ref UPS_TXN_READ_ONLY </li> This Transaction is read-only and
- *      will not modify the Database.
+ *      will not modify the Database. It reads from a snapshot: it only
+ *      sees Transactions which were committed before it was started, and
+ *      therefore never fails with @ref UPS_TXN_CONFLICT. Committed
+ *      Transactions which are not visible for an active read-only
+ *      Transaction are not flushed to disk till the read-only Transaction
+ *      is committed or aborted. Inserting or erasing keys fails with
+ *      @ref UPS_WRITE_PROTECTED.
  *    </ul>
  *
  * @return @ref UPS_SUCCESS upon success
@@ -1254,13 +1372,19 @@ ups_txn_abort(ups_txn_t *txn, uint32_t flags);
  * This flag is non persistent. */
 #define UPS_READ_ONLY                               0x00000004
 
-/* unused                                           0x00000008 */
+/** Flag for @ref ups_env_open, @ref ups_env_create.
+ * This flag is non persistent. */
+#define UPS_ENABLE_IO_URING                         0x00000008
 
-/* unused                                           0x00000010 */
+/** Flag for @ref ups_env_open, @ref ups_env_create.
+ * This flag is non persistent. */
+#define UPS_ENABLE_DIRECT_IO                        0x00000010
 
 /* reserved                                         0x00000020 */
 
-/* unused                                           0x00000040 */
+/** Flag for @ref ups_env_open, @ref ups_env_create.
+ * This flag is non persistent. */
+#define UPS_ENABLE_CONCURRENT_READS                 0x00000040
 
 /** Flag for @ref ups_env_create.
  * This flag is non persistent. */
@@ -1674,6 +1798,306 @@ ups_db_insert(ups_db_t *db, ups_txn_t *txn, ups_key_t *key,
 UPS_EXPORT ups_status_t UPS_CALLCONV
 ups_db_erase(ups_db_t *db, ups_txn_t *txn, ups_key_t *key, uint32_t flags);
 
+/**
+ * Inserts many Database items
+ *
+ * This function inserts @a count key/record pairs with a single call.
+ * It is equivalent to calling @ref ups_db_insert for each pair, but the
+ * Environment is locked only once and the parameters are verified
+ * up front. If the keys are sorted then each key is directly inserted
+ * into the Btree leaf which received the previous key, without
+ * traversing the tree from the root.
+ *
+ * The status of each insert operation is stored in @a results. A failed
+ * operation (i.e. @ref UPS_DUPLICATE_KEY) does not stop the batch.
+ *
+ * For Record Number Databases, the generated record numbers are returned
+ * in @a keys, just like in @ref ups_db_insert. Their memory is valid till
+ * the next call to upscaledb.
+ *
+ * @param db A valid Database handle
+ * @param txn A Transaction handle, or NULL
+ * @param keys An array of @a count keys
+ * @param records An array of @a count records
+ * @param count The number of key/record pairs
+ * @param results An array of @a count status codes; receives the
+ *        result of each insert operation
+ * @param flags Optional flags; see @ref ups_db_insert. The flags are
+ *        applied to all operations
+ *
+ * @return @ref UPS_SUCCESS if the batch was processed; check @a results
+ *        for the status of each operation
+ * @return @ref UPS_INV_PARAMETER if @a db, @a keys, @a records or
+ *        @a results is NULL, or if a key or record is invalid
+ *        (see @ref ups_db_insert)
+ * @return @ref UPS_WRITE_PROTECTED if you tried to insert a key in a
+ *        read-only Database
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_insert_many(ups_db_t *db, ups_txn_t *txn, ups_key_t *keys,
+            ups_record_t *records, uint32_t count, ups_status_t *results,
+            uint32_t flags);
+
+/**
+ * Searches many Database items
+ *
+ * This function looks up @a count keys with a single call. It is
+ * equivalent to calling @ref ups_db_find for each key, but the
+ * Environment is locked only once. The keys are sorted internally before
+ * they are looked up; a key which falls into the Btree leaf of the
+ * previous key is directly searched in that leaf.
+ *
+ * The status of each lookup is stored in @a results (i.e.
+ * @ref UPS_KEY_NOT_FOUND). The record data is valid till the next call
+ * to upscaledb, unless @ref UPS_RECORD_USER_ALLOC is set.
+ *
+ * Approximate matching (@ref UPS_FIND_LT_MATCH etc) is not supported.
+ *
+ * @param db A valid Database handle
+ * @param txn A Transaction handle, or NULL
+ * @param keys An array of @a count keys
+ * @param records An array of @a count records; receives the records
+ * @param count The number of keys
+ * @param results An array of @a count status codes; receives the
+ *        result of each lookup
+ * @param flags Optional flags; see @ref ups_db_find
+ *
+ * @return @ref UPS_SUCCESS if the batch was processed; check @a results
+ *        for the status of each operation
+ * @return @ref UPS_INV_PARAMETER if @a db, @a keys, @a records or
+ *        @a results is NULL, if a key or record is invalid, or if
+ *        approximate matching was requested
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_find_many(ups_db_t *db, ups_txn_t *txn, ups_key_t *keys,
+            ups_record_t *records, uint32_t count, ups_status_t *results,
+            uint32_t flags);
+
+/**
+ * Erases many Database items
+ *
+ * This function erases @a count keys with a single call. It is
+ * equivalent to calling @ref ups_db_erase for each key, but the
+ * Environment is locked only once.
+ *
+ * The status of each erase operation is stored in @a results (i.e.
+ * @ref UPS_KEY_NOT_FOUND). A failed operation does not stop the batch.
+ *
+ * @param db A valid Database handle
+ * @param txn A Transaction handle, or NULL
+ * @param keys An array of @a count keys
+ * @param count The number of keys
+ * @param results An array of @a count status codes; receives the
+ *        result of each erase operation
+ * @param flags Optional flags for erasing; unused, set to 0
+ *
+ * @return @ref UPS_SUCCESS if the batch was processed; check @a results
+ *        for the status of each operation
+ * @return @ref UPS_INV_PARAMETER if @a db, @a keys or @a results is NULL
+ * @return @ref UPS_WRITE_PROTECTED if you tried to erase a key from a
+ *        read-only Database
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_erase_many(ups_db_t *db, ups_txn_t *txn, ups_key_t *keys,
+            uint32_t count, ups_status_t *results, uint32_t flags);
+
+/**
+ * A callback function which is invoked when an asynchronous operation
+ * (@ref ups_db_insert_async, @ref ups_db_find_async,
+ * @ref ups_db_erase_async) was completed
+ *
+ * @a status is the result of the operation. @a key is the key of the
+ * operation; for Record Number Databases it is the generated record number,
+ * and for approximate matching the key which was found. @a record is the
+ * record which was found by @ref ups_db_find_async, otherwise NULL.
+ * Both are only valid while the callback is executed. @a context is the
+ * pointer which was passed to the asynchronous function.
+ *
+ * The callback must not call upscaledb functions of the same Environment.
+ */
+typedef void UPS_CALLCONV (*ups_async_callback_t)(ups_db_t *db,
+            ups_status_t status, ups_key_t *key, ups_record_t *record,
+            void *context);
+
+/**
+ * Inserts a Database item asynchronously
+ *
+ * For remote Environments, the request is sent to the server, but this
+ * function does not wait for the reply. Many requests can therefore be
+ * in flight at the same time, and the throughput is no longer limited by
+ * the network latency. The key and record data are copied; the buffers
+ * can be reused as soon as this function returns.
+ *
+ * The server replies in the order of the requests. The replies are
+ * received (and @a callback is invoked) when too many requests are in
+ * flight, when @ref ups_env_wait_async is called or before any other
+ * operation of the same Environment is executed.
+ *
+ * For local Environments, the operation is executed immediately and
+ * @a callback is invoked before this function returns.
+ *
+ * @param db A valid Database handle
+ * @param txn A Transaction handle, or NULL
+ * @param key The key of the new item
+ * @param record The record of the new item
+ * @param flags Optional flags; see @ref ups_db_insert
+ * @param callback The callback function; must not be NULL
+ * @param context A user-defined pointer which is passed to @a callback
+ *
+ * @return @ref UPS_SUCCESS if the request was sent (or executed); the
+ *        result of the operation is passed to @a callback
+ * @return @ref UPS_INV_PARAMETER if @a db, @a key, @a record or
+ *        @a callback is NULL, or if the key or record is invalid
+ *        (see @ref ups_db_insert)
+ * @return @ref UPS_NETWORK_ERROR if the request could not be sent
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_insert_async(ups_db_t *db, ups_txn_t *txn, ups_key_t *key,
+            ups_record_t *record, uint32_t flags,
+            ups_async_callback_t callback, void *context);
+
+/**
+ * Searches an item in the Database asynchronously
+ *
+ * Works like @ref ups_db_insert_async. The record is passed to
+ * @a callback.
+ *
+ * @param db A valid Database handle
+ * @param txn A Transaction handle, or NULL
+ * @param key The key of the item
+ * @param flags Optional flags; see @ref ups_db_find
+ * @param callback The callback function; must not be NULL
+ * @param context A user-defined pointer which is passed to @a callback
+ *
+ * @return @ref UPS_SUCCESS if the request was sent (or executed); the
+ *        result of the operation is passed to @a callback
+ * @return @ref UPS_INV_PARAMETER if @a db, @a key or @a callback is NULL
+ * @return @ref UPS_NETWORK_ERROR if the request could not be sent
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_find_async(ups_db_t *db, ups_txn_t *txn, ups_key_t *key,
+            uint32_t flags, ups_async_callback_t callback, void *context);
+
+/**
+ * Erases a Database item asynchronously
+ *
+ * Works like @ref ups_db_insert_async.
+ *
+ * @param db A valid Database handle
+ * @param txn A Transaction handle, or NULL
+ * @param key The key of the item
+ * @param flags Optional flags for erasing; unused, set to 0
+ * @param callback The callback function; must not be NULL
+ * @param context A user-defined pointer which is passed to @a callback
+ *
+ * @return @ref UPS_SUCCESS if the request was sent (or executed); the
+ *        result of the operation is passed to @a callback
+ * @return @ref UPS_INV_PARAMETER if @a db, @a key or @a callback is NULL
+ * @return @ref UPS_NETWORK_ERROR if the request could not be sent
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_erase_async(ups_db_t *db, ups_txn_t *txn, ups_key_t *key,
+            uint32_t flags, ups_async_callback_t callback, void *context);
+
+/**
+ * Waits till all asynchronous operations of an Environment were completed
+ *
+ * Receives the replies of all requests which were sent with
+ * @ref ups_db_insert_async, @ref ups_db_find_async or
+ * @ref ups_db_erase_async, and invokes their callbacks. Does nothing
+ * for local Environments.
+ *
+ * @param env A valid Environment handle
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if @a env is NULL
+ * @return @ref UPS_NETWORK_ERROR if the replies could not be received
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_env_wait_async(ups_env_t *env);
+
+/**
+ * Starts a bulk load of an empty Database
+ *
+ * A bulk load builds the Btree bottom-up from keys which are inserted
+ * in sorted order with @ref ups_db_bulk_insert. The Btree leaves are
+ * filled up to the @a fill_factor, and the pages are allocated (and
+ * written) sequentially. This is much faster than inserting the keys
+ * with @ref ups_db_insert, and the resulting Btree is smaller.
+ *
+ * The bulk load is not journalled and not part of a Transaction. Its
+ * pages are written to disk by @ref ups_db_bulk_end; if the application
+ * crashes before, then the Database has to be re-created.
+ *
+ * While the bulk load is active, the Database must not be modified
+ * with other functions, and Cursors must not be used.
+ *
+ * @param db A valid Database handle; the Database must be empty
+ * @param fill_factor The percentage (1 - 100) of the leaf capacity which
+ *        is filled. 0 is the same as 100. Use a lower value if the
+ *        Database will receive random inserts after loading
+ * @param flags Optional flags for this operation; unused, set to 0
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if @a db is NULL, if @a fill_factor is
+ *        invalid, if the Database is not empty or if a bulk load is
+ *        already active
+ * @return @ref UPS_WRITE_PROTECTED if the Database is read-only
+ * @return @ref UPS_CURSOR_STILL_OPEN if the Database has open Cursors
+ * @return @ref UPS_TXN_STILL_OPEN if the Database is modified by an
+ *        active Transaction
+ * @return @ref UPS_NOT_IMPLEMENTED if the Database is remote
+ *
+ * @sa ups_db_bulk_insert
+ * @sa ups_db_bulk_end
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_bulk_begin(ups_db_t *db, uint32_t fill_factor, uint32_t flags);
+
+/**
+ * Appends a key/record pair to a bulk load
+ *
+ * The keys have to be inserted in ascending order (according to the
+ * Database's sort order). If the Database was created with
+ * @ref UPS_ENABLE_DUPLICATE_KEYS then a key can be inserted several times;
+ * each record is then appended as a duplicate.
+ *
+ * For Record Number Databases the @a key can be empty (size 0, data NULL);
+ * it is then assigned the next record number. Otherwise it must be larger
+ * than the previous record number.
+ *
+ * @param db A valid Database handle
+ * @param key The key of the new item
+ * @param record The record of the new item
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if @a db, @a key or @a record is NULL,
+ *        if no bulk load is active or if @a key is smaller than the
+ *        previous key
+ * @return @ref UPS_DUPLICATE_KEY if @a key is equal to the previous key
+ *        and the Database does not support duplicate keys
+ * @return @ref UPS_INV_KEY_SIZE if the key size is invalid
+ * @return @ref UPS_INV_RECORD_SIZE if the record size is invalid
+ *
+ * @sa ups_db_bulk_begin
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_bulk_insert(ups_db_t *db, ups_key_t *key, ups_record_t *record);
+
+/**
+ * Finishes a bulk load and writes the modified pages to disk
+ *
+ * @param db A valid Database handle
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if @a db is NULL or if no bulk load
+ *        is active
+ *
+ * @sa ups_db_bulk_begin
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_bulk_end(ups_db_t *db);
+
 /* internal flag for ups_db_erase() - do not use */
 #define UPS_ERASE_ALL_DUPLICATES                1
 
@@ -1794,12 +2218,46 @@ ups_db_get_parameters(ups_db_t *db, ups_parameter_t *param);
 /** Parameter name for @ref ups_env_create_db */
 #define UPS_PARAM_CUSTOM_COMPARE_NAME   0x00000111
 
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * replacement policy of the cache */
+#define UPS_PARAM_CACHE_POLICY          0x00000112
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * number of threads which flush dirty pages */
+#define UPS_PARAM_FLUSH_THREADS         0x00000113
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * number of leaf pages which are read ahead during scans */
+#define UPS_PARAM_PREFETCH_PAGES        0x00000114
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * time (in microseconds) a commit waits for others to share the fsync */
+#define UPS_PARAM_GROUP_COMMIT_WINDOW   0x00000115
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * number of journal bytes which trigger the group commit fsync */
+#define UPS_PARAM_GROUP_COMMIT_BYTES    0x00000116
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * interval (in milliseconds) of the background Btree compaction */
+#define UPS_PARAM_JANITOR_INTERVAL      0x00000117
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * number of threads which scan the Btree in the UQI functions */
+#define UPS_PARAM_SCAN_THREADS          0x00000118
+
 /** Value for @ref UPS_PARAM_POSIX_FADVISE */
 #define UPS_POSIX_FADVICE_NORMAL                 0
 
 /** Value for @ref UPS_PARAM_POSIX_FADVISE */
 #define UPS_POSIX_FADVICE_RANDOM                 1
 
+/** Value for @ref UPS_PARAM_CACHE_POLICY: least recently used */
+#define UPS_CACHE_POLICY_LRU                     0
+
+/** Value for @ref UPS_PARAM_CACHE_POLICY: scan-resistant 2Q */
+#define UPS_CACHE_POLICY_2Q                      1
+
 /** Value for unlimited record sizes */
 #define UPS_RECORD_SIZE_UNLIMITED       ((uint32_t)-1)
 
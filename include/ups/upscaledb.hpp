@@ -388,6 +388,90 @@ class db {
         throw error(st);
     }
 
+    /** Inserts a batch of key/record pairs; see ups_db_insert_many. */
+    void insert_many(txn *t, ups_key_t *keys, ups_record_t *records,
+                uint32_t count, ups_status_t *results, uint32_t flags = 0) {
+      ups_status_t st = ups_db_insert_many(m_db,
+                t ? t->get_handle() : 0,
+                keys, records, count, results, flags);
+      if (st)
+        throw error(st);
+    }
+
+    /** Looks up a batch of keys; see ups_db_find_many. */
+    void find_many(txn *t, ups_key_t *keys, ups_record_t *records,
+                uint32_t count, ups_status_t *results, uint32_t flags = 0) {
+      ups_status_t st = ups_db_find_many(m_db,
+                t ? t->get_handle() : 0,
+                keys, records, count, results, flags);
+      if (st)
+        throw error(st);
+    }
+
+    /** Erases a batch of keys; see ups_db_erase_many. */
+    void erase_many(txn *t, ups_key_t *keys, uint32_t count,
+                ups_status_t *results, uint32_t flags = 0) {
+      ups_status_t st = ups_db_erase_many(m_db,
+                t ? t->get_handle() : 0,
+                keys, count, results, flags);
+      if (st)
+        throw error(st);
+    }
+
+    /** Inserts a key/record pair asynchronously; see ups_db_insert_async. */
+    void insert_async(txn *t, key *k, record *r, uint32_t flags,
+                ups_async_callback_t callback, void *context = 0) {
+      ups_status_t st = ups_db_insert_async(m_db,
+                t ? t->get_handle() : 0,
+                k ? k->get_handle() : 0,
+                r ? r->get_handle() : 0, flags, callback, context);
+      if (st)
+        throw error(st);
+    }
+
+    /** Looks up a key asynchronously; see ups_db_find_async. */
+    void find_async(txn *t, key *k, uint32_t flags,
+                ups_async_callback_t callback, void *context = 0) {
+      ups_status_t st = ups_db_find_async(m_db,
+                t ? t->get_handle() : 0,
+                k ? k->get_handle() : 0, flags, callback, context);
+      if (st)
+        throw error(st);
+    }
+
+    /** Erases a key asynchronously; see ups_db_erase_async. */
+    void erase_async(txn *t, key *k, uint32_t flags,
+                ups_async_callback_t callback, void *context = 0) {
+      ups_status_t st = ups_db_erase_async(m_db,
+                t ? t->get_handle() : 0,
+                k ? k->get_handle() : 0, flags, callback, context);
+      if (st)
+        throw error(st);
+    }
+
+    /** Starts a bulk load; see ups_db_bulk_begin. */
+    void bulk_begin(uint32_t fill_factor = 100, uint32_t flags = 0) {
+      ups_status_t st = ups_db_bulk_begin(m_db, fill_factor, flags);
+      if (st)
+        throw error(st);
+    }
+
+    /** Appends a sorted key/record pair; see ups_db_bulk_insert. */
+    void bulk_insert(key *k, record *r) {
+      ups_status_t st = ups_db_bulk_insert(m_db,
+                k ? k->get_handle() : 0,
+                r ? r->get_handle() : 0);
+      if (st)
+        throw error(st);
+    }
+
+    /** Finishes a bulk load; see ups_db_bulk_end. */
+    void bulk_end() {
+      ups_status_t st = ups_db_bulk_end(m_db);
+      if (st)
+        throw error(st);
+    }
+
     /** Returns number of items in the Database. */
     uint64_t count(ups_txn_t *txn = 0, uint32_t flags = 0) {
       uint64_t count = 0;
@@ -646,6 +730,13 @@ class env {
         throw error(st);
     }
 
+    /** Waits till all asynchronous operations were completed. */
+    void wait_async() {
+      ups_status_t st = ups_env_wait_async(m_env);
+      if (st)
+        throw error(st);
+    }
+
     /** Creates a new Database in the Environment. */
     db create_db(uint16_t name, uint32_t flags = 0,
                 const ups_parameter_t *param = 0) {
@@ -207,7 +207,12 @@ typedef struct btree_metrics_t {
  * Metrics marked "global" are stored globally and shared between multiple
  * Environments.
  */
-#define UPS_METRICS_VERSION         9
+#define UPS_METRICS_VERSION         11
+
+/**
+ * The number of shards of the page cache
+ */
+#define UPS_CACHE_SHARDS            8
 
 typedef struct ups_env_metrics_t {
   /* the version indicator - must be UPS_METRICS_VERSION */
@@ -308,6 +313,18 @@ typedef struct ups_env_metrics_t {
   // PRO: set to true if AVX is enabled
   ups_bool_t is_avx_enabled;
 
+  /* number of cache hits, per cache shard */
+  uint64_t cache_shard_hits[UPS_CACHE_SHARDS];
+
+  /* number of cache misses, per cache shard */
+  uint64_t cache_shard_misses[UPS_CACHE_SHARDS];
+
+  /* number of leaf pages which were read ahead during scans */
+  uint64_t page_count_prefetched;
+
+  /* number of read-ahead pages which were fetched afterwards */
+  uint64_t prefetch_hits;
+
 } ups_env_metrics_t;
 
 /**
@@ -54,6 +54,20 @@ typedef struct {
    * - currently NOT USED! */
   const char *error_log_path;
 
+  /** The number of threads. If 0 or 1 then a single thread accepts the
+   * connections and executes all requests. Otherwise the requests are
+   * executed by a pool of @a num_threads threads, and (if the OS supports
+   * SO_REUSEPORT) @a num_threads event loops accept the connections.
+   *
+   * The requests of a connection are always executed and answered in the
+   * order in which they were received, but the requests of different
+   * connections run in parallel. If several connections use the same
+   * Database then the Environment should be created with
+   * @ref UPS_ENABLE_CONCURRENT_READS, which gives each thread its own
+   * buffers for the returned keys and records; otherwise these can be
+   * overwritten by a concurrent request. */
+  uint32_t num_threads;
+
 } ups_srv_config_t;
 
 /**
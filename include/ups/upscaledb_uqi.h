@@ -49,6 +49,25 @@ typedef struct {
 
 } uqi_bool_predicate_t;
 
+/**
+ * A predicate function which is applied to a whole array of keys.
+ *
+ * This avoids the overhead of a function call per key, and allows the
+ * predicate itself to be vectorized. The function receives @a key_count
+ * keys of @a key_size bytes each, stored back-to-back in @a key_array.
+ * It sets @a selected[i] to a non-zero value if the i-th key is selected,
+ * otherwise to 0.
+ */
+typedef struct {
+  /** A function pointer; receives an array of keys, fills @a selected */
+  void (*predicate_func)(const void *key_array, size_t key_count,
+                  uint16_t key_size, uint8_t *selected, void *context);
+
+  /** User-supplied context data */
+  void *context;
+
+} uqi_batch_predicate_t;
+
 
 /**
  * A structure which returns the result of an operation.
@@ -72,6 +91,48 @@ typedef struct {
 } uqi_result_t;
 
 
+/**
+ * Describes a numeric value in a record.
+ *
+ * The records of the Database must have a fixed length (see
+ * @ref UPS_PARAM_RECORD_SIZE). The value is stored @a offset bytes after
+ * the beginning of each record; its @a type is one of @a UPS_TYPE_UINT8,
+ * @a UPS_TYPE_UINT16, @a UPS_TYPE_UINT32, @a UPS_TYPE_UINT64,
+ * @a UPS_TYPE_REAL32 or @a UPS_TYPE_REAL64. The value does not have to
+ * be aligned.
+ */
+typedef struct {
+  /** The type of the value - one of the @a UPS_TYPE_* macros */
+  int type;
+
+  /** The offset of the value in the record, in bytes */
+  uint32_t offset;
+
+} uqi_record_field_t;
+
+/**
+ * A callback function for @ref uqi_record_group_by.
+ *
+ * Receives a distinct key and the aggregated value of its records.
+ */
+typedef void (*uqi_group_func_t)(const void *key_data, uint16_t key_size,
+                const uqi_result_t *result, void *context);
+
+/** Aggregate function for @ref uqi_record_group_by: counts the records */
+#define UQI_AGGREGATE_COUNT         1
+
+/** Aggregate function for @ref uqi_record_group_by: sums up the values */
+#define UQI_AGGREGATE_SUM           2
+
+/** Aggregate function for @ref uqi_record_group_by: the average value */
+#define UQI_AGGREGATE_AVERAGE       3
+
+/** Aggregate function for @ref uqi_record_group_by: the smallest value */
+#define UQI_AGGREGATE_MIN           4
+
+/** Aggregate function for @ref uqi_record_group_by: the largest value */
+#define UQI_AGGREGATE_MAX           5
+
 /**
  * Counts the keys in a Database
  *
@@ -105,6 +166,39 @@ UPS_EXPORT ups_status_t UPS_CALLCONV
 uqi_count_if(ups_db_t *db, ups_txn_t *txn, uqi_bool_predicate_t *pred,
                 uqi_result_t *result);
 
+/**
+ * Selectively counts the keys in a Database
+ *
+ * Same as @ref uqi_count_if, but the predicate is applied to arrays
+ * of keys.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_count_if_batch(ups_db_t *db, ups_txn_t *txn, uqi_batch_predicate_t *pred,
+                uqi_result_t *result);
+
+/**
+ * Counts the keys in the range [@a low, @a high]
+ *
+ * This is a non-distinct count. If the Database has duplicate keys then
+ * they are included in the count. Both bounds are included in the range.
+ * The keys in the database (@a db) have to be numeric, and the size of
+ * @a low and @a high must match the key size.
+ *
+ * The actual count is returned in @a result->u.result_u64. @a result->type
+ * is set to @a UPS_TYPE_U64.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ * @return @ref UPS_INV_PARAMETER if the database is not numeric
+ * @return @ref UPS_INV_PARAMETER if the size of @a low or @a high is invalid
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_count_range(ups_db_t *db, ups_txn_t *txn, ups_key_t *low,
+                ups_key_t *high, uqi_result_t *result);
+
 /**
  * Counts the distinct keys in a Database
  *
@@ -186,6 +280,17 @@ UPS_EXPORT ups_status_t UPS_CALLCONV
 uqi_average_if(ups_db_t *db, ups_txn_t *txn, uqi_bool_predicate_t *pred,
                 uqi_result_t *result);
 
+/**
+ * Same as @ref uqi_average_if, but the predicate is applied to arrays of keys.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ * @return @ref UPS_INV_PARAMETER if the database is not numeric
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_average_if_batch(ups_db_t *db, ups_txn_t *txn, uqi_batch_predicate_t *pred,
+                uqi_result_t *result);
+
 /**
  * Calculates the sum of all keys.
  *
@@ -234,6 +339,174 @@ UPS_EXPORT ups_status_t UPS_CALLCONV
 uqi_sum_if(ups_db_t *db, ups_txn_t *txn, uqi_bool_predicate_t *pred,
                 uqi_result_t *result);
 
+/**
+ * Same as @ref uqi_sum_if, but the predicate is applied to arrays of keys.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ * @return @ref UPS_INV_PARAMETER if the database is not numeric
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_sum_if_batch(ups_db_t *db, ups_txn_t *txn, uqi_batch_predicate_t *pred,
+                uqi_result_t *result);
+
+/**
+ * Returns the smallest key of a Database.
+ *
+ * The keys in the database (@a db) have to be numeric, which means that
+ * the Database's type must be one of @a UPS_TYPE_UINT8, @a UPS_TYPE_UINT16,
+ * UPS_TYPE_UINT32, @a UPS_TYPE_UINT64, @a UPS_TYPE_REAL32 or
+ * @a UPS_TYPE_REAL64.
+ *
+ * The actual result is returned in @a result->u.result_u64 or
+ * @a result->u.result_double, depending on the Database's configuration.
+ * If the Database is empty then the result is 0.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ * @return @ref UPS_INV_PARAMETER if the database is not numeric
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_min(ups_db_t *db, ups_txn_t *txn, uqi_result_t *result);
+
+/**
+ * Returns the largest key of a Database.
+ *
+ * The keys in the database (@a db) have to be numeric, which means that
+ * the Database's type must be one of @a UPS_TYPE_UINT8, @a UPS_TYPE_UINT16,
+ * UPS_TYPE_UINT32, @a UPS_TYPE_UINT64, @a UPS_TYPE_REAL32 or
+ * @a UPS_TYPE_REAL64.
+ *
+ * The actual result is returned in @a result->u.result_u64 or
+ * @a result->u.result_double, depending on the Database's configuration.
+ * If the Database is empty then the result is 0.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ * @return @ref UPS_INV_PARAMETER if the database is not numeric
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_max(ups_db_t *db, ups_txn_t *txn, uqi_result_t *result);
+
+/**
+ * Returns the @a k largest keys of a Database.
+ *
+ * The keys in the database (@a db) have to be numeric (see @ref uqi_min).
+ * Each key is returned only once, even if it has duplicates.
+ *
+ * The keys are copied to @a keys, which must have space for @a k keys,
+ * starting with the largest key. The number of keys which were copied
+ * is returned in @a count; it is smaller than @a k if the Database has
+ * fewer keys.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ * @return @ref UPS_INV_PARAMETER if the database is not numeric
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_top_keys(ups_db_t *db, ups_txn_t *txn, uint32_t k, void *keys,
+                uint32_t *count);
+
+/**
+ * Returns the @a k key/record pairs with the largest values in a record
+ * field.
+ *
+ * The keys and the records must have a fixed length. If several records
+ * have the same value then the smaller keys are returned first.
+ *
+ * The keys are copied to @a keys, the records to @a records, starting with
+ * the largest value. Each of them must have space for @a k keys (or
+ * records); either can be NULL if it is not required. The number of
+ * returned pairs is stored in @a count.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if @a db, @a field or @a count is NULL
+ * @return @ref UPS_INV_PARAMETER if the keys or records do not have a
+ *      fixed length, or if @a field is invalid
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_top_records(ups_db_t *db, ups_txn_t *txn, uqi_record_field_t *field,
+                uint32_t k, void *keys, void *records, uint32_t *count);
+
+/**
+ * Sums up a numeric value of all records.
+ *
+ * Duplicate keys are included; each of their records is added.
+ * The result is returned in @a result->u.result_u64 or
+ * @a result->u.result_double, depending on the type of the @a field.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ * @return @ref UPS_INV_PARAMETER if the records do not have a fixed
+ *      length, or if @a field is invalid
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_record_sum(ups_db_t *db, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result);
+
+/**
+ * Calculates the average of a numeric value of all records.
+ *
+ * Same as @ref uqi_record_sum, but returns the average. As in
+ * @ref uqi_average, the average of integer values is an integer.
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_record_average(ups_db_t *db, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result);
+
+/**
+ * Returns the smallest value of a numeric field of all records.
+ *
+ * Same as @ref uqi_record_sum, but returns the minimum. If the
+ * Database is empty then the result is 0.
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_record_min(ups_db_t *db, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result);
+
+/**
+ * Returns the largest value of a numeric field of all records.
+ *
+ * Same as @ref uqi_record_sum, but returns the maximum. If the
+ * Database is empty then the result is 0.
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_record_max(ups_db_t *db, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result);
+
+/**
+ * Counts the records for which a predicate is true.
+ *
+ * The predicate function receives the data and the size of each record
+ * (instead of a key). The records do not need to have a fixed length.
+ * The result is returned in @a result->u.result_u64.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if one of the parameters is NULL
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_record_count_if(ups_db_t *db, ups_txn_t *txn, uqi_bool_predicate_t *pred,
+                uqi_result_t *result);
+
+/**
+ * Aggregates the records of each distinct key.
+ *
+ * For each key, the records of all its duplicates are aggregated with
+ * the @a aggregate function (one of the @a UQI_AGGREGATE_* macros), and
+ * @a func is called with the key and the result. The keys are visited in
+ * sorted order. @a field is ignored (and can be NULL) if @a aggregate is
+ * @ref UQI_AGGREGATE_COUNT.
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if @a db or @a func is NULL
+ * @return @ref UPS_INV_PARAMETER if @a aggregate is unknown
+ * @return @ref UPS_INV_PARAMETER if the records do not have a fixed
+ *      length, or if @a field is invalid
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+uqi_record_group_by(ups_db_t *db, ups_txn_t *txn, uqi_record_field_t *field,
+                int aggregate, uqi_group_func_t func, void *context);
+
 /**
  * @}
  */
@@ -31,6 +31,7 @@
 #include <boost/version.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/tss.hpp>
 #include <boost/thread/condition.hpp>
@@ -47,6 +48,9 @@ typedef boost::mutex::scoped_lock ScopedLock;
 typedef boost::thread Thread;
 typedef boost::condition Condition;
 typedef boost::recursive_mutex RecursiveMutex;
+typedef boost::shared_mutex SharedMutex;
+typedef boost::unique_lock<SharedMutex> ScopedExclusiveLock;
+typedef boost::shared_lock<SharedMutex> ScopedSharedLock;
 
 class Mutex : public boost::mutex 
 {
@@ -60,6 +64,48 @@ class Mutex : public boost::mutex
     }
 };
 
+// A scoped lock for a SharedMutex. The mutex is either acquired in shared
+// mode (for concurrent readers) or exclusively.
+class ScopedReadWriteLock
+{
+  public:
+    ScopedReadWriteLock()
+      : m_mutex(0), m_shared(false) {
+    }
+
+    ScopedReadWriteLock(SharedMutex &mutex, bool shared)
+      : m_mutex(0), m_shared(false) {
+      lock(mutex, shared);
+    }
+
+    ~ScopedReadWriteLock() {
+      if (m_mutex) {
+        if (m_shared)
+          m_mutex->unlock_shared();
+        else
+          m_mutex->unlock();
+      }
+    }
+
+    // Acquires the |mutex|; must not be called twice
+    void lock(SharedMutex &mutex, bool shared) {
+      if (shared)
+        mutex.lock_shared();
+      else
+        mutex.lock();
+      m_mutex = &mutex;
+      m_shared = shared;
+    }
+
+  private:
+    // not copyable
+    ScopedReadWriteLock(const ScopedReadWriteLock &other);
+    ScopedReadWriteLock &operator=(const ScopedReadWriteLock &other);
+
+    SharedMutex *m_mutex;
+    bool m_shared;
+};
+
 } // namespace upscaledb
 
 #endif /* UPS_MUTEX_H */
@@ -141,6 +141,117 @@ class Spinlock {
 };
 #endif // UPS_ENABLE_HELGRIND
 
+#ifdef UPS_ENABLE_HELGRIND
+class ReadWriteSpinlock : public boost::shared_mutex
+{
+  public:
+    void acquire_ownership() {
+    }
+
+    void safe_unlock() {
+      try_lock();
+      unlock();
+    }
+};
+#else
+
+// A spinlock which can either be locked exclusively by a single thread
+// (lock/try_lock/unlock) or shared by several readers (lock_shared/
+// try_lock_shared/unlock_shared). The exclusive interface is identical to
+// the one of the Spinlock.
+class ReadWriteSpinlock {
+    enum {
+      kUnlocked      =  0,
+      kLocked        = -1
+    };
+
+  public:
+    ReadWriteSpinlock()
+      : m_state(kUnlocked) {
+    }
+
+    // Need user-defined copy constructor because boost::atomic<> is not
+    // copyable. Initializes an *unlocked* ReadWriteSpinlock.
+    ReadWriteSpinlock(const ReadWriteSpinlock &other)
+      : m_state(kUnlocked) {
+    }
+
+    ~ReadWriteSpinlock() {
+      ups_assert(m_state == kUnlocked);
+    }
+
+    // Only for test verification: lets the current thread acquire ownership
+    // of an exclusively locked mutex
+    void acquire_ownership() {
+#ifdef UPS_DEBUG
+      ups_assert(m_state != kUnlocked);
+      m_owner = boost::this_thread::get_id();
+#endif
+    }
+
+    // For debugging and verification; unlocks the mutex, even if it was
+    // locked by a different thread
+    void safe_unlock() {
+#ifdef UPS_DEBUG
+      m_owner = boost::this_thread::get_id();
+#endif
+      m_state.store(kUnlocked, boost::memory_order_release);
+    }
+
+    bool try_lock() {
+      int expected = kUnlocked;
+      if (m_state.compare_exchange_strong(expected, kLocked,
+                              boost::memory_order_acquire)) {
+#ifdef UPS_DEBUG
+        m_owner = boost::this_thread::get_id();
+#endif
+        return (true);
+      }
+      return (false);
+    }
+
+    void lock() {
+      int k = 0;
+      while (!try_lock())
+        Spinlock::spin(k++);
+    }
+
+    void unlock() {
+      ups_assert(m_state == kLocked);
+      ups_assert(m_owner == boost::this_thread::get_id());
+      m_state.store(kUnlocked, boost::memory_order_release);
+    }
+
+    bool try_lock_shared() {
+      int state = m_state.load(boost::memory_order_relaxed);
+      while (state != kLocked) {
+        if (m_state.compare_exchange_weak(state, state + 1,
+                              boost::memory_order_acquire))
+          return (true);
+      }
+      return (false);
+    }
+
+    void lock_shared() {
+      int k = 0;
+      while (!try_lock_shared())
+        Spinlock::spin(k++);
+    }
+
+    void unlock_shared() {
+      ups_assert(m_state > 0);
+      m_state.fetch_sub(1, boost::memory_order_release);
+    }
+
+  private:
+    // kUnlocked, kLocked or the number of readers
+    boost::atomic<int> m_state;
+#ifdef UPS_DEBUG
+    boost::thread::id m_owner;
+#endif
+};
+#endif // UPS_ENABLE_HELGRIND
+
 class ScopedSpinlock {
   public:
     ScopedSpinlock(Spinlock &lock)
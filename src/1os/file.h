@@ -96,6 +96,11 @@ class File
       return (m_fd != UPS_INVALID_FD);
     }
 
+    // Returns the file handle
+    ups_fd_t get_handle() const {
+      return (m_fd);
+    }
+
     // Flushes a file
     void flush();
 
@@ -119,6 +124,11 @@ class File
     // Positional write to a file
     void pwrite(uint64_t addr, const void *buffer, size_t len);
 
+    // Positional write of |count| buffers to consecutive file offsets,
+    // starting at |addr|; uses pwritev() if available
+    void pwritev(uint64_t addr, void *buffers[], size_t lengths[],
+                    size_t count);
+
     // Write data to a file; uses the current file position
     void write(const void *buffer, size_t len);
 
@@ -30,6 +30,7 @@ namespace upscaledb {
 //  Windows
 #  include <intrin.h>
 #  define cpuid    __cpuid
+#  define cpuidex  __cpuidex
 #else
 //  GCC Inline Assembly
 static void
@@ -43,6 +44,19 @@ cpuid(int cpuinfo[4], int infotype){
       "a" (infotype)
   );
 }
+
+static void
+cpuidex(int cpuinfo[4], int infotype, int subtype){
+  __asm__ __volatile__ (
+      "cpuid":
+      "=a" (cpuinfo[0]),
+      "=b" (cpuinfo[1]),
+      "=c" (cpuinfo[2]),
+      "=d" (cpuinfo[3]) :
+      "a" (infotype),
+      "c" (subtype)
+  );
+}
 #endif
 
 bool
@@ -69,6 +83,28 @@ os_has_avx()
   return (available);
 }
 
+bool
+os_has_avx2()
+{
+  static bool available = false;
+  static bool initialized = false;
+  if (!initialized) {
+    initialized = true;
+
+    int info[4];
+    cpuid(info, 0);
+    int num_ids = info[0];
+
+    // the AVX2 flag is in the "extended features" (leaf 7, subleaf 0)
+    if (num_ids >= 7 && os_has_avx()) {
+      cpuidex(info, 0x00000007, 0);
+      available = (info[1] & ((int)1 << 5)) != 0;
+    }
+  }
+
+  return (available);
+}
+
 int
 os_get_simd_lane_width()
 {
@@ -83,6 +119,12 @@ os_has_avx()
   return false;
 }
 
+bool
+os_has_avx2()
+{
+  return false;
+}
+
 int
 os_get_simd_lane_width()
 {
@@ -69,6 +69,10 @@ typedef SOCKET             ups_socket_t;
 extern bool
 os_has_avx();
 
+// Returns true if the CPU supports AVX2
+extern bool
+os_has_avx2();
+
 // Returns the number of 32bit integers that the CPU can process in
 // parallel (the SIMD lane width) 
 extern int
@@ -259,7 +259,8 @@ File::pwrite(uint64_t addr, const void *buffer, size_t len)
   size_t total = 0;
 
   while (total < len) {
-    s = ::pwrite(m_fd, buffer, len, addr + total);
+    s = ::pwrite(m_fd, (const uint8_t *)buffer + total, len - total,
+                    addr + total);
     if (s < 0) {
       ups_log(("pwrite() failed with status %u (%s)", errno, strerror(errno)));
       throw Exception(UPS_IO_ERROR);
@@ -279,6 +280,59 @@ File::pwrite(uint64_t addr, const void *buffer, size_t len)
 #endif
 }
 
+void
+File::pwritev(uint64_t addr, void *buffers[], size_t lengths[], size_t count)
+{
+  os_log(("File::pwritev: fd=%d, address=%lld, count=%lld", m_fd, addr,
+                          count));
+
+#if HAVE_PWRITEV
+  enum { kMaxVectors = 64 };
+  struct iovec vec[kMaxVectors];
+
+  size_t i = 0;
+  while (i < count) {
+    int n = 0;
+    size_t total = 0;
+    for (; n < kMaxVectors && i + n < count; n++) {
+      vec[n].iov_base = buffers[i + n];
+      vec[n].iov_len = lengths[i + n];
+      total += lengths[i + n];
+    }
+
+    ssize_t s = ::pwritev(m_fd, &vec[0], n, addr);
+    if (s < 0) {
+      ups_log(("pwritev() failed with status %u (%s)", errno,
+                              strerror(errno)));
+      throw Exception(UPS_IO_ERROR);
+    }
+
+    // a short write: write the remaining data of each buffer separately
+    size_t written = (size_t)s;
+    for (int j = 0; j < n && written < total; j++) {
+      if (written >= vec[j].iov_len) {
+        written -= vec[j].iov_len;
+      }
+      else {
+        pwrite(addr + written, (uint8_t *)vec[j].iov_base + written,
+                        vec[j].iov_len - written);
+        written = 0;
+      }
+      addr += vec[j].iov_len;
+      total -= vec[j].iov_len;
+    }
+
+    addr += total;
+    i += n;
+  }
+#else
+  for (size_t i = 0; i < count; i++) {
+    pwrite(addr, buffers[i], lengths[i]);
+    addr += lengths[i];
+  }
+#endif
+}
+
 void
 File::write(const void *buffer, size_t len)
 {
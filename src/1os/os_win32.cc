@@ -230,6 +230,15 @@ File::pwrite(uint64_t addr, const void *buffer, size_t len)
     throw Exception(UPS_IO_ERROR);
 }
 
+void
+File::pwritev(uint64_t addr, void *buffers[], size_t lengths[], size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    pwrite(addr, buffers[i], lengths[i]);
+    addr += lengths[i];
+  }
+}
+
 void
 File::write(const void *buffer, size_t len)
 {
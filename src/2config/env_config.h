@@ -52,7 +52,10 @@ struct EnvironmentConfiguration
       file_size_limit_bytes(std::numeric_limits<size_t>::max()), 
       remote_timeout_sec(0), journal_compressor(0),
       is_encryption_enabled(false), journal_switch_threshold(0),
-      posix_advice(UPS_POSIX_FADVICE_NORMAL) {
+      posix_advice(UPS_POSIX_FADVICE_NORMAL),
+      cache_policy(UPS_CACHE_POLICY_LRU), flush_threads(1),
+      prefetch_pages(0), group_commit_usec(0), group_commit_bytes(0),
+      janitor_interval_msec(0), scan_threads(1) {
   }
 
   // the environment's flags
@@ -96,6 +99,28 @@ struct EnvironmentConfiguration
 
   // parameter for posix_fadvise()
   int posix_advice;
+
+  // the replacement policy of the cache
+  int cache_policy;
+
+  // the number of threads which flush dirty pages
+  int flush_threads;
+
+  // the number of btree leaves which are read ahead during scans
+  int prefetch_pages;
+
+  // the time (in usec) a committing thread waits for others before
+  // syncing the journal
+  uint64_t group_commit_usec;
+
+  // the journal is synced when this many bytes were written
+  uint64_t group_commit_bytes;
+
+  // the interval (in msec) of the background compaction; 0 if disabled
+  uint32_t janitor_interval_msec;
+
+  // the number of threads which scan the btree in the UQI functions
+  int scan_threads;
 };
 
 } // namespace upscaledb
@@ -95,6 +95,11 @@ class Device {
     // Writes to the device; this function does not use mmap
     virtual void write(uint64_t offset, void *buffer, size_t len) = 0;
 
+    // Writes |count| buffers to consecutive offsets, starting at |offset|.
+    // Can be called by several threads in parallel.
+    virtual void writev(uint64_t offset, void *buffers[], size_t lengths[],
+                    size_t count) = 0;
+
     // Allocate storage from this device; this function
     // will *NOT* use mmap. returns the offset of the allocated storage.
     virtual uint64_t alloc(size_t len) = 0;
@@ -50,6 +50,7 @@ namespace upscaledb {
  * a File-based device
  */
 class DiskDevice : public Device {
+  protected:
     struct State {
       // the database file
       File file;
@@ -208,6 +209,24 @@ class DiskDevice : public Device {
       m_state.file.pwrite(offset, buffer, len);
     }
 
+    // writes multiple buffers to consecutive offsets. The device lock is
+    // not held during the I/O, therefore several threads can write in
+    // parallel. This is safe because positional writes do not modify the
+    // file handle, and the file is not closed while pages are flushed.
+    virtual void writev(uint64_t offset, void *buffers[], size_t lengths[],
+                    size_t count) {
+#ifdef UPS_ENABLE_ENCRYPTION
+      if (m_config.is_encryption_enabled) {
+        for (size_t i = 0; i < count; i++) {
+          write(offset, buffers[i], lengths[i]);
+          offset += lengths[i];
+        }
+        return;
+      }
+#endif
+      m_state.file.pwritev(offset, buffers, lengths, count);
+    }
+
     // allocate storage from this device; this function
     // will *NOT* return mmapped memory
     virtual uint64_t alloc(size_t requested_length) {
@@ -323,7 +342,7 @@ class DiskDevice : public Device {
       return (&m_state.mmapptr[address]);
     }
 
-  private:
+  protected:
     // truncate/resize the device, sans locking
     void truncate_nolock(uint64_t new_file_size) {
       if (new_file_size > m_config.file_size_limit_bytes)
@@ -31,6 +31,7 @@
 #include "2config/env_config.h"
 #include "2device/device_disk.h"
 #include "2device/device_inmem.h"
+#include "2device/device_uring.h"
 
 #ifndef UPS_ROOT_H
 #  error "root.h was not included"
@@ -43,8 +44,11 @@ struct DeviceFactory {
   static Device *create(const EnvironmentConfiguration &config) {
     if (config.flags & UPS_IN_MEMORY)
       return (new InMemoryDevice(config));
-    else
-      return (new DiskDevice(config));
+#ifdef HAVE_LIBURING_H
+    if (config.flags & UPS_ENABLE_IO_URING)
+      return (new UringDevice(config));
+#endif
+    return (new DiskDevice(config));
   }
 };
 
@@ -0,0 +1,527 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * A file-based device which performs its I/O through io_uring (Linux only,
+ * requires liburing).
+ *
+ * Reads and writes are submitted to a shared ring; afterwards the calling
+ * thread waits for its own completion. Whichever thread waits for the
+ * completion queue also reaps the completions of the other threads.
+ * The lock of the DiskDevice is not held during the I/O, therefore several
+ * threads can read and write in parallel.
+ *
+ * With UPS_ENABLE_DIRECT_IO the file is accessed with O_DIRECT, bypassing
+ * the page cache of the operating system. The data is then transferred
+ * through a pool of aligned buffers which are registered with the kernel.
+ *
+ * Memory mapping, encryption and file size management are inherited from
+ * the DiskDevice.
+ *
+ * @exception_safe: strong
+ * @thread_safe: yes
+ */
+
+#ifndef UPS_DEVICE_URING_H
+#define UPS_DEVICE_URING_H
+
+#include "0root/root.h"
+
+#ifdef HAVE_LIBURING_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <liburing.h>
+
+#include <vector>
+#include <algorithm>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/spinlock.h"
+#include "2device/device_disk.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+class UringDevice : public DiskDevice {
+    enum {
+      // the number of entries in the submission queue
+      kQueueDepth = 64,
+
+      // alignment of offsets, lengths and memory for O_DIRECT
+      kDirectIoAlignment = 4096,
+
+      // the number of registered buffers (O_DIRECT only)
+      kNumBuffers = 16,
+
+      // the size of each registered buffer
+      kBufferSize = 256 * 1024,
+
+      // the maximum number of vectors of a single IORING_OP_WRITEV
+      kMaxVectors = 64
+    };
+
+    // A single I/O request. The thread which reaps the completion stores
+    // the result and sets |done|.
+    struct Request {
+      Request()
+        : result(0), done(false) {
+      }
+
+      int result;
+      boost::atomic<bool> done;
+    };
+
+  public:
+    UringDevice(const EnvironmentConfiguration &config)
+      : DiskDevice(config), m_is_active(false), m_direct_io(false) {
+    }
+
+    virtual ~UringDevice() {
+      shutdown();
+    }
+
+    // Creates a new device
+    virtual void create() {
+      DiskDevice::create();
+      initialize();
+    }
+
+    // Opens an existing device
+    virtual void open() {
+      DiskDevice::open();
+      initialize();
+    }
+
+    // Closes the device
+    virtual void close() {
+      shutdown();
+      DiskDevice::close();
+    }
+
+    // Reads from the device
+    virtual void read(uint64_t offset, void *buffer, size_t len) {
+      if (!m_is_active) {
+        DiskDevice::read(offset, buffer, len);
+        return;
+      }
+      if (m_direct_io)
+        transfer_direct(false, offset, (uint8_t *)buffer, len);
+      else
+        transfer(false, offset, (uint8_t *)buffer, len);
+    }
+
+    // Writes to the device
+    virtual void write(uint64_t offset, void *buffer, size_t len) {
+      if (!m_is_active) {
+        DiskDevice::write(offset, buffer, len);
+        return;
+      }
+      if (m_direct_io)
+        transfer_direct(true, offset, (uint8_t *)buffer, len);
+      else
+        transfer(true, offset, (uint8_t *)buffer, len);
+    }
+
+    // Writes multiple buffers to consecutive offsets; without O_DIRECT the
+    // buffers are submitted with a single IORING_OP_WRITEV
+    virtual void writev(uint64_t offset, void *buffers[], size_t lengths[],
+                    size_t count) {
+      if (!m_is_active) {
+        DiskDevice::writev(offset, buffers, lengths, count);
+        return;
+      }
+
+      if (m_direct_io) {
+        for (size_t i = 0; i < count; i++) {
+          transfer_direct(true, offset, (uint8_t *)buffers[i], lengths[i]);
+          offset += lengths[i];
+        }
+        return;
+      }
+
+      struct iovec vec[kMaxVectors];
+      size_t i = 0;
+      while (i < count) {
+        int n = 0;
+        size_t total = 0;
+        for (; n < kMaxVectors && i + n < count; n++) {
+          vec[n].iov_base = buffers[i + n];
+          vec[n].iov_len = lengths[i + n];
+          total += lengths[i + n];
+        }
+
+        Request request;
+        {
+          ScopedSpinlock lock(m_sq_mutex);
+          struct io_uring_sqe *sqe = get_sqe();
+          io_uring_prep_writev(sqe, m_fd, &vec[0], n, offset);
+          io_uring_sqe_set_data(sqe, &request);
+          submit();
+        }
+        wait(request);
+
+        // a short write: write the remaining data of each buffer separately
+        size_t written = (size_t)request.result;
+        for (int j = 0; j < n && written < total; j++) {
+          if (written >= vec[j].iov_len) {
+            written -= vec[j].iov_len;
+          }
+          else {
+            transfer(true, offset + written,
+                        (uint8_t *)vec[j].iov_base + written,
+                        vec[j].iov_len - written);
+            written = 0;
+          }
+          offset += vec[j].iov_len;
+          total -= vec[j].iov_len;
+        }
+
+        offset += total;
+        i += n;
+      }
+    }
+
+    // Reads a page from the device. Mapped pages are served by the
+    // DiskDevice; all others are read through the ring, without holding
+    // the device lock.
+    virtual void read_page(Page *page, uint64_t address) {
+      if (!m_is_active || is_mapped(address, m_config.page_size_bytes)) {
+        DiskDevice::read_page(page, address);
+        return;
+      }
+
+      if (page->get_data() == 0) {
+        uint8_t *p = Memory::allocate<uint8_t>(m_config.page_size_bytes);
+        page->assign_allocated_buffer(p, address);
+      }
+
+      read(address, page->get_data(), m_config.page_size_bytes);
+    }
+
+    // Returns true if the device uses io_uring; false if it fell back to
+    // the synchronous I/O of the DiskDevice
+    bool is_active() const {
+      return (m_is_active);
+    }
+
+    // Returns true if the file was opened with O_DIRECT
+    bool is_direct_io() const {
+      return (m_direct_io);
+    }
+
+  private:
+    // Sets up the ring (and the registered buffers for O_DIRECT). If
+    // io_uring is not supported by the kernel then the device falls back
+    // to the DiskDevice's I/O.
+    void initialize() {
+      // encryption is implemented by the DiskDevice
+      if (m_config.is_encryption_enabled)
+        return;
+
+      m_fd = m_state.file.get_handle();
+
+      int ret = io_uring_queue_init(kQueueDepth, &m_ring, 0);
+      if (ret < 0) {
+        ups_log(("io_uring_queue_init failed with status %d (%s); "
+                 "falling back to synchronous I/O", -ret, strerror(-ret)));
+        return;
+      }
+      m_is_active = true;
+
+      if ((m_config.flags & UPS_ENABLE_DIRECT_IO)
+            && m_config.page_size_bytes % kDirectIoAlignment == 0)
+        initialize_direct_io();
+    }
+
+    // Switches the file descriptor to O_DIRECT and registers the buffers
+    void initialize_direct_io() {
+      std::vector<struct iovec> vec(kNumBuffers);
+      for (int i = 0; i < kNumBuffers; i++) {
+        void *p = 0;
+        if (::posix_memalign(&p, kDirectIoAlignment, kBufferSize) != 0)
+          break;
+        m_buffers.push_back((uint8_t *)p);
+        vec[i].iov_base = p;
+        vec[i].iov_len = kBufferSize;
+      }
+
+      int flags = ::fcntl(m_fd, F_GETFL);
+      if (m_buffers.size() != kNumBuffers
+            || flags < 0
+            || ::fcntl(m_fd, F_SETFL, flags | O_DIRECT) < 0
+            || io_uring_register_buffers(&m_ring, &vec[0], kNumBuffers) < 0) {
+        ups_log(("failed to enable O_DIRECT; using buffered I/O"));
+        if (flags >= 0)
+          ::fcntl(m_fd, F_SETFL, flags);
+        release_buffers();
+        return;
+      }
+
+      for (int i = 0; i < kNumBuffers; i++)
+        m_free_buffers.push_back(i);
+      m_direct_io = true;
+    }
+
+    // Releases the ring and the registered buffers
+    void shutdown() {
+      if (!m_is_active)
+        return;
+
+      if (m_direct_io) {
+        io_uring_unregister_buffers(&m_ring);
+        int flags = ::fcntl(m_fd, F_GETFL);
+        if (flags >= 0)
+          ::fcntl(m_fd, F_SETFL, flags & ~O_DIRECT);
+        m_direct_io = false;
+      }
+      release_buffers();
+
+      io_uring_queue_exit(&m_ring);
+      m_is_active = false;
+    }
+
+    // Frees the memory of the registered buffers
+    void release_buffers() {
+      for (size_t i = 0; i < m_buffers.size(); i++)
+        ::free(m_buffers[i]);
+      m_buffers.clear();
+      m_free_buffers.clear();
+    }
+
+    // Returns a free submission queue entry; the caller holds |m_sq_mutex|
+    struct io_uring_sqe *get_sqe() {
+      struct io_uring_sqe *sqe;
+      while ((sqe = io_uring_get_sqe(&m_ring)) == 0)
+        submit();
+      return (sqe);
+    }
+
+    // Submits all queued entries; the caller holds |m_sq_mutex|
+    void submit() {
+      int ret;
+      while ((ret = io_uring_submit(&m_ring)) == -EINTR || ret == -EAGAIN)
+        ;
+      if (ret < 0) {
+        ups_log(("io_uring_submit failed with status %d (%s)", -ret,
+                                strerror(-ret)));
+        throw Exception(UPS_IO_ERROR);
+      }
+    }
+
+    // Waits till |request| is completed. The thread which holds
+    // |m_cq_mutex| reaps the completions of all threads.
+    void wait(Request &request) {
+      int k = 0;
+      while (!request.done.load(boost::memory_order_acquire)) {
+        if (!m_cq_mutex.try_lock()) {
+          Spinlock::spin(k++);
+          continue;
+        }
+
+        int ret = 0;
+        if (!request.done.load(boost::memory_order_acquire)) {
+          struct io_uring_cqe *cqe;
+          ret = io_uring_wait_cqe(&m_ring, &cqe);
+          if (ret == 0) {
+            Request *r = (Request *)io_uring_cqe_get_data(cqe);
+            r->result = cqe->res;
+            io_uring_cqe_seen(&m_ring, cqe);
+            r->done.store(true, boost::memory_order_release);
+          }
+        }
+        m_cq_mutex.unlock();
+
+        if (ret < 0 && ret != -EINTR) {
+          ups_log(("io_uring_wait_cqe failed with status %d (%s)", -ret,
+                                  strerror(-ret)));
+          throw Exception(UPS_IO_ERROR);
+        }
+      }
+
+      if (request.result < 0) {
+        ups_log(("io_uring I/O failed with status %d (%s)", -request.result,
+                                strerror(-request.result)));
+        throw Exception(UPS_IO_ERROR);
+      }
+    }
+
+    // Reads or writes |len| bytes through the ring; resumes short transfers.
+    // If |buffer_index| is >= 0 then |buffer| is a registered buffer. If
+    // |allow_eof| is true then a read can stop at the end of the file.
+    // Returns the number of transferred bytes.
+    size_t transfer(bool is_write, uint64_t offset, uint8_t *buffer,
+                    size_t len, int buffer_index = -1,
+                    bool allow_eof = false) {
+      size_t total = 0;
+      while (len > 0) {
+        Request request;
+        {
+          ScopedSpinlock lock(m_sq_mutex);
+          struct io_uring_sqe *sqe = get_sqe();
+          if (buffer_index >= 0) {
+            if (is_write)
+              io_uring_prep_write_fixed(sqe, m_fd, buffer, (unsigned)len,
+                              offset, buffer_index);
+            else
+              io_uring_prep_read_fixed(sqe, m_fd, buffer, (unsigned)len,
+                              offset, buffer_index);
+          }
+          else {
+            if (is_write)
+              io_uring_prep_write(sqe, m_fd, buffer, (unsigned)len, offset);
+            else
+              io_uring_prep_read(sqe, m_fd, buffer, (unsigned)len, offset);
+          }
+          io_uring_sqe_set_data(sqe, &request);
+          submit();
+        }
+        wait(request);
+
+        if (request.result == 0) {
+          if (allow_eof && !is_write)
+            break;
+          ups_log(("io_uring I/O failed with short %s",
+                                  is_write ? "write" : "read"));
+          throw Exception(UPS_IO_ERROR);
+        }
+
+        offset += request.result;
+        buffer += request.result;
+        len -= request.result;
+        total += request.result;
+      }
+      return (total);
+    }
+
+    // Reads or writes through the registered (aligned) buffers. Unaligned
+    // ranges are extended to the alignment; for writes, the extended range
+    // is read first.
+    void transfer_direct(bool is_write, uint64_t offset, uint8_t *buffer,
+                    size_t len) {
+      while (len > 0) {
+        uint64_t aligned_offset = offset & ~(uint64_t)(kDirectIoAlignment - 1);
+        size_t head = (size_t)(offset - aligned_offset);
+        size_t chunk = std::min(len, (size_t)kBufferSize - head);
+        size_t aligned_len = (head + chunk + kDirectIoAlignment - 1)
+                                & ~(size_t)(kDirectIoAlignment - 1);
+
+        int index = acquire_buffer();
+        uint8_t *bounce = m_buffers[index];
+        try {
+          if (!is_write) {
+            read_aligned(aligned_offset, bounce, aligned_len, index);
+            ::memcpy(buffer, bounce + head, chunk);
+          }
+          else if (head != 0 || aligned_len != chunk) {
+            // read-modify-write the partially overwritten blocks
+            ScopedSpinlock lock(m_rmw_mutex);
+            read_aligned(aligned_offset, bounce, aligned_len, index);
+            ::memcpy(bounce + head, buffer, chunk);
+            transfer(true, aligned_offset, bounce, aligned_len, index);
+          }
+          else {
+            ::memcpy(bounce, buffer, chunk);
+            transfer(true, aligned_offset, bounce, aligned_len, index);
+          }
+        }
+        catch (Exception &) {
+          release_buffer(index);
+          throw;
+        }
+        release_buffer(index);
+
+        offset += chunk;
+        buffer += chunk;
+        len -= chunk;
+      }
+    }
+
+    // Reads an aligned range into a registered buffer; the part beyond
+    // the end of the file is filled with zeroes
+    void read_aligned(uint64_t offset, uint8_t *buffer, size_t len,
+                    int index) {
+      size_t available = transfer(false, offset, buffer, len, index, true);
+      if (available < len)
+        ::memset(buffer + available, 0, len - available);
+    }
+
+    // Returns the index of a free registered buffer; blocks if all buffers
+    // are in use
+    int acquire_buffer() {
+      int k = 0;
+      while (true) {
+        {
+          ScopedSpinlock lock(m_buffer_mutex);
+          if (!m_free_buffers.empty()) {
+            int index = m_free_buffers.back();
+            m_free_buffers.pop_back();
+            return (index);
+          }
+        }
+        Spinlock::spin(k++);
+      }
+    }
+
+    // Returns a registered buffer to the pool
+    void release_buffer(int index) {
+      ScopedSpinlock lock(m_buffer_mutex);
+      m_free_buffers.push_back(index);
+    }
+
+    // true if the ring was initialized
+    bool m_is_active;
+
+    // true if the file was opened with O_DIRECT
+    bool m_direct_io;
+
+    // the file descriptor
+    int m_fd;
+
+    // the ring
+    struct io_uring m_ring;
+
+    // protects the submission queue
+    Spinlock m_sq_mutex;
+
+    // protects the completion queue
+    Spinlock m_cq_mutex;
+
+    // serializes read-modify-write cycles of unaligned writes
+    Spinlock m_rmw_mutex;
+
+    // the registered buffers (O_DIRECT only)
+    std::vector<uint8_t *> m_buffers;
+
+    // indices of the unused registered buffers
+    std::vector<int> m_free_buffers;
+
+    // protects |m_free_buffers|
+    Spinlock m_buffer_mutex;
+};
+
+} // namespace upscaledb
+
+#endif // HAVE_LIBURING_H
+
+#endif /* UPS_DEVICE_URING_H */
@@ -28,11 +28,12 @@
 
 namespace upscaledb {
 
-uint64_t Page::ms_page_count_flushed = 0;
+boost::atomic<uint64_t> Page::ms_page_count_flushed(0);
 
 Page::Page(Device *device, LocalDatabase *db)
-  : m_device(device), m_db(db), m_cursor_list(0),
-    m_node_proxy(0), m_datap(&m_data_inline)
+  : m_device(device), m_db(db), m_cursor_list(0), m_cache_queue(kCacheQueueNone),
+    m_node_proxy(0), m_prefetched(false), m_prefetch_next(0),
+    m_datap(&m_data_inline)
 {
   ::memset(&m_prev[0], 0, sizeof(m_prev));
   ::memset(&m_next[0], 0, sizeof(m_next));
@@ -90,6 +91,41 @@ Page::flush(Device *device, PersistedData *page_data)
   }
 }
 
+void
+Page::flush(Device *device, PersistedData **page_data, size_t count)
+{
+  if (count == 1) {
+    flush(device, page_data[0]);
+    return;
+  }
+
+  void **buffers = (void **)::alloca(count * sizeof(void *));
+  size_t *lengths = (size_t *)::alloca(count * sizeof(size_t));
+
+  for (size_t i = 0; i < count; i++) {
+    PersistedData *pd = page_data[i];
+    ups_assert(pd->is_dirty);
+    ups_assert(i == 0 || page_data[i - 1]->address
+                            + page_data[i - 1]->size == pd->address);
+    // Pro: update crc32
+    if ((device->config().flags & UPS_ENABLE_CRC32)
+        && likely(!pd->is_without_header)) {
+      MurmurHash3_x86_32(pd->raw_data->header.payload,
+                         pd->size - (sizeof(PPageHeader) - 1),
+                         (uint32_t)pd->address,
+                         &pd->raw_data->header.crc32);
+    }
+    buffers[i] = pd->raw_data;
+    lengths[i] = pd->size;
+  }
+
+  device->writev(page_data[0]->address, buffers, lengths, count);
+
+  for (size_t i = 0; i < count; i++)
+    page_data[i]->is_dirty = false;
+  ms_page_count_flushed += count;
+}
+
 Page::PersistedData *
 Page::deep_copy_data()
 {
@@ -114,8 +114,9 @@ class Page {
         raw_data = 0;
       }
 
-      // The spinlock is locked if the page is in use or written to disk
-      Spinlock mutex;
+      // The spinlock is locked if the page is in use or written to disk.
+      // Concurrent readers share the lock (see Changeset::set_shared)
+      ReadWriteSpinlock mutex;
 
       // address of this page - the absolute offset in the file
       uint64_t address;
@@ -161,6 +162,18 @@ class Page {
       kListMax                = 3
     };
 
+    // The queues of the cache (see Cache)
+    enum {
+      // the page is not cached
+      kCacheQueueNone         = 0,
+
+      // the LRU list
+      kCacheQueueHot          = 1,
+
+      // the FIFO queue for new pages (2Q policy only)
+      kCacheQueueIn           = 2
+    };
+
     // non-persistent page flags
     enum {
       // page->m_data was allocated with malloc, not mmap
@@ -222,7 +235,7 @@ class Page {
     }
 
     // Returns the spinlock
-    Spinlock &mutex() {
+    ReadWriteSpinlock &mutex() {
       return (m_datap->mutex);
     }
 
@@ -364,6 +377,11 @@ class Page {
     // Writes a page to the device
     static void flush(Device *device, PersistedData *page_data);
 
+    // Writes |count| pages with consecutive addresses to the device, using
+    // a single call to Device::writev(). All pages must be dirty.
+    static void flush(Device *device, PersistedData **page_data,
+                    size_t count);
+
     // Creates a deep copy of the persisted data; returns the old pointer
     // IF the old pointer was allocated and needs to be released
     PersistedData *deep_copy_data();
@@ -430,6 +448,33 @@ class Page {
       return (m_prev[list]);
     }
 
+    // Returns the cache queue which stores this page
+    int get_cache_queue() const {
+      return (m_cache_queue);
+    }
+
+    // Sets the cache queue which stores this page
+    void set_cache_queue(int queue) {
+      m_cache_queue = queue;
+    }
+
+    // Marks this page as "read ahead" by the PageManager. |next| is the
+    // address where the next read-ahead window starts (or 0)
+    void set_prefetched(uint64_t next) {
+      m_prefetch_next = next;
+      m_prefetched = true;
+    }
+
+    // Clears the "read ahead" flag. Returns true if the flag was set; in
+    // this case |*next| receives the address set in |set_prefetched()|
+    bool clear_prefetched(uint64_t *next) {
+      if (!m_prefetched.load(boost::memory_order_relaxed)
+              || !m_prefetched.exchange(false))
+        return (false);
+      *next = m_prefetch_next;
+      return (true);
+    }
+
     // Returns the cached BtreeNodeProxy
     BtreeNodeProxy *get_node_proxy() {
       return (m_node_proxy);
@@ -441,7 +486,7 @@ class Page {
     }
 
     // tracks number of flushed pages
-    static uint64_t ms_page_count_flushed;
+    static boost::atomic<uint64_t> ms_page_count_flushed;
 
   private:
     friend class PageCollection;
@@ -469,9 +514,19 @@ class Page {
     Page *m_prev[Page::kListMax];
     Page *m_next[Page::kListMax];
 
+    // the cache queue which stores this page (kListCache is used by all
+    // queues)
+    int m_cache_queue;
+
     // the cached BtreeNodeProxy object
     BtreeNodeProxy *m_node_proxy;
 
+    // true if the page was read ahead and was not yet fetched
+    boost::atomic<bool> m_prefetched;
+
+    // the start of the next read-ahead window (see |set_prefetched()|)
+    uint64_t m_prefetch_next;
+
     // the persistent data of this page
     PersistedData *m_datap;
     PersistedData m_data_inline;
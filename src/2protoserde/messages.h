@@ -1487,6 +1487,7 @@ struct SerializedWrapper {
   SerializedUint32 magic;
   SerializedUint32 size;
   SerializedUint32 id;
+  SerializedUint32 request_id;
   SerializedTxnBeginRequest txn_begin_request;
   SerializedTxnBeginReply txn_begin_reply;
   SerializedTxnCommitRequest txn_commit_request;
@@ -1533,10 +1534,12 @@ struct SerializedWrapper {
     magic = 0;
     size = 0;
     id = 0;
+    request_id = 0;
   }
 
   size_t get_size() const {
-    size_t s = magic.get_size() + size.get_size() + id.get_size();
+    size_t s = magic.get_size() + size.get_size() + id.get_size()
+                + request_id.get_size();
     switch (id.value) {
       case kTxnBeginRequest: 
         return (s + txn_begin_request.get_size());
@@ -1616,6 +1619,7 @@ struct SerializedWrapper {
     magic.serialize(pptr, psize);
     size.serialize(pptr, psize);
     id.serialize(pptr, psize);
+    request_id.serialize(pptr, psize);
 
     switch (id.value) {
       case kTxnBeginRequest: 
@@ -1729,6 +1733,7 @@ struct SerializedWrapper {
     magic.deserialize(pptr, psize);
     size.deserialize(pptr, psize);
     id.deserialize(pptr, psize);
+    request_id.deserialize(pptr, psize);
 
     switch (id.value) {
       case kTxnBeginRequest: 
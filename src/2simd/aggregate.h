@@ -0,0 +1,509 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * SIMD aggregation functions (sum, min, max, range counts) over arrays
+ * of POD keys. They are used by the UQI scan visitors.
+ *
+ * The AVX2 kernels are compiled with a function-specific target and
+ * selected at run-time, because the CPU might be older than the compiler.
+ * Otherwise the portable functions are used.
+ *
+ * @exception_safe: nothrow
+ * @thread_safe: yes
+ */
+
+#ifndef UPS_SIMD_AGGREGATE_H
+#define UPS_SIMD_AGGREGATE_H
+
+#include "0root/root.h"
+
+#include <string.h>
+
+#if defined(HAVE_SSE2) && defined(__GNUC__) \
+        && (defined(__x86_64__) || defined(__i386__))
+#  define UPS_ENABLE_AVX2_KERNELS 1
+#  define UPS_TARGET_AVX2 __attribute__((target("avx2")))
+#  include <immintrin.h>
+#endif
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "1os/os.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+//
+// The portable implementations
+//
+
+template<typename T, typename R>
+inline R
+sum_portable(const T *p, size_t count)
+{
+  const T *end = &p[count];
+  const int kMax = 8;
+  R sums[kMax] = {0};
+  for (; p + kMax <= end; p += kMax) {
+    sums[0] += p[0];
+    sums[1] += p[1];
+    sums[2] += p[2];
+    sums[3] += p[3];
+    sums[4] += p[4];
+    sums[5] += p[5];
+    sums[6] += p[6];
+    sums[7] += p[7];
+  }
+  R sum = 0;
+  for (; p < end; p++)
+    sum += *p;
+  for (int i = 0; i < kMax; i++)
+    sum += sums[i];
+  return (sum);
+}
+
+template<typename T>
+inline T
+min_portable(const T *p, size_t count)
+{
+  ups_assert(count > 0);
+  T m = p[0];
+  for (size_t i = 1; i < count; i++)
+    if (p[i] < m)
+      m = p[i];
+  return (m);
+}
+
+template<typename T>
+inline T
+max_portable(const T *p, size_t count)
+{
+  ups_assert(count > 0);
+  T m = p[0];
+  for (size_t i = 1; i < count; i++)
+    if (p[i] > m)
+      m = p[i];
+  return (m);
+}
+
+// Counts the values in the range [low, high]
+template<typename T>
+inline size_t
+count_range_portable(const T *p, size_t count, T low, T high)
+{
+  size_t c = 0;
+  for (size_t i = 0; i < count; i++)
+    c += (p[i] >= low) & (p[i] <= high);
+  return (c);
+}
+
+// Sums up the values where |selected| is not zero
+template<typename T, typename R>
+inline R
+sum_selected(const T *p, size_t count, const uint8_t *selected)
+{
+  R sum = 0;
+  for (size_t i = 0; i < count; i++)
+    sum += selected[i] ? (R)p[i] : (R)0;
+  return (sum);
+}
+
+#ifdef UPS_ENABLE_AVX2_KERNELS
+
+//
+// The type-specific AVX2 operations. |Vector| is a register with |kLanes|
+// values of type T; |Accumulator| stores the (wider) partial sums.
+//
+template<typename T>
+struct Avx2Ops;
+
+UPS_TARGET_AVX2 inline uint64_t
+avx2_reduce_epi64(__m256i v)
+{
+  uint64_t t[4];
+  _mm256_storeu_si256((__m256i *)&t[0], v);
+  return (t[0] + t[1] + t[2] + t[3]);
+}
+
+UPS_TARGET_AVX2 inline double
+avx2_reduce_pd(__m256d v)
+{
+  double t[4];
+  _mm256_storeu_pd(&t[0], v);
+  return (t[0] + t[1] + t[2] + t[3]);
+}
+
+// Adds the eight 32bit lanes of |v| to the four 64bit lanes of |acc|
+UPS_TARGET_AVX2 inline __m256i
+avx2_add_epu32(__m256i acc, __m256i v)
+{
+  __m256i zero = _mm256_setzero_si256();
+  acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(v, zero));
+  return (_mm256_add_epi64(acc, _mm256_unpackhi_epi32(v, zero)));
+}
+
+// Number of lanes where |mask| (the result of a comparison) is set
+UPS_TARGET_AVX2 inline int
+avx2_count_mask(__m256i mask, int bytes_per_lane)
+{
+  return (__builtin_popcount(_mm256_movemask_epi8(mask)) / bytes_per_lane);
+}
+
+template<>
+struct Avx2Ops<uint8_t> {
+  enum { kLanes = 32 };
+  typedef __m256i Vector;
+  typedef __m256i Accumulator;
+
+  UPS_TARGET_AVX2 static Vector load(const uint8_t *p) {
+    return (_mm256_loadu_si256((const __m256i *)p));
+  }
+  UPS_TARGET_AVX2 static Vector broadcast(uint8_t v) {
+    return (_mm256_set1_epi8((char)v));
+  }
+  UPS_TARGET_AVX2 static Vector min(Vector a, Vector b) {
+    return (_mm256_min_epu8(a, b));
+  }
+  UPS_TARGET_AVX2 static Vector max(Vector a, Vector b) {
+    return (_mm256_max_epu8(a, b));
+  }
+  UPS_TARGET_AVX2 static Accumulator accumulate(Accumulator acc, Vector v) {
+    return (_mm256_add_epi64(acc, _mm256_sad_epu8(v, _mm256_setzero_si256())));
+  }
+  UPS_TARGET_AVX2 static uint64_t reduce(Accumulator acc) {
+    return (avx2_reduce_epi64(acc));
+  }
+  // (v - low) <= (high - low), compared as unsigned values
+  UPS_TARGET_AVX2 static int count_range(Vector v, Vector low, Vector high) {
+    __m256i t = _mm256_sub_epi8(v, low);
+    __m256i d = _mm256_sub_epi8(high, low);
+    return (avx2_count_mask(_mm256_cmpeq_epi8(_mm256_min_epu8(t, d), t), 1));
+  }
+};
+
+template<>
+struct Avx2Ops<uint16_t> {
+  enum { kLanes = 16 };
+  typedef __m256i Vector;
+  typedef __m256i Accumulator;
+
+  UPS_TARGET_AVX2 static Vector load(const uint16_t *p) {
+    return (_mm256_loadu_si256((const __m256i *)p));
+  }
+  UPS_TARGET_AVX2 static Vector broadcast(uint16_t v) {
+    return (_mm256_set1_epi16((short)v));
+  }
+  UPS_TARGET_AVX2 static Vector min(Vector a, Vector b) {
+    return (_mm256_min_epu16(a, b));
+  }
+  UPS_TARGET_AVX2 static Vector max(Vector a, Vector b) {
+    return (_mm256_max_epu16(a, b));
+  }
+  // adds the even and odd lanes as 32bit values, then widens to 64bit
+  UPS_TARGET_AVX2 static Accumulator accumulate(Accumulator acc, Vector v) {
+    __m256i lo = _mm256_and_si256(v, _mm256_set1_epi32(0xffff));
+    __m256i hi = _mm256_srli_epi32(v, 16);
+    return (avx2_add_epu32(acc, _mm256_add_epi32(lo, hi)));
+  }
+  UPS_TARGET_AVX2 static uint64_t reduce(Accumulator acc) {
+    return (avx2_reduce_epi64(acc));
+  }
+  UPS_TARGET_AVX2 static int count_range(Vector v, Vector low, Vector high) {
+    __m256i t = _mm256_sub_epi16(v, low);
+    __m256i d = _mm256_sub_epi16(high, low);
+    return (avx2_count_mask(_mm256_cmpeq_epi16(_mm256_min_epu16(t, d), t), 2));
+  }
+};
+
+template<>
+struct Avx2Ops<uint32_t> {
+  enum { kLanes = 8 };
+  typedef __m256i Vector;
+  typedef __m256i Accumulator;
+
+  UPS_TARGET_AVX2 static Vector load(const uint32_t *p) {
+    return (_mm256_loadu_si256((const __m256i *)p));
+  }
+  UPS_TARGET_AVX2 static Vector broadcast(uint32_t v) {
+    return (_mm256_set1_epi32((int)v));
+  }
+  UPS_TARGET_AVX2 static Vector min(Vector a, Vector b) {
+    return (_mm256_min_epu32(a, b));
+  }
+  UPS_TARGET_AVX2 static Vector max(Vector a, Vector b) {
+    return (_mm256_max_epu32(a, b));
+  }
+  UPS_TARGET_AVX2 static Accumulator accumulate(Accumulator acc, Vector v) {
+    return (avx2_add_epu32(acc, v));
+  }
+  UPS_TARGET_AVX2 static uint64_t reduce(Accumulator acc) {
+    return (avx2_reduce_epi64(acc));
+  }
+  UPS_TARGET_AVX2 static int count_range(Vector v, Vector low, Vector high) {
+    __m256i t = _mm256_sub_epi32(v, low);
+    __m256i d = _mm256_sub_epi32(high, low);
+    return (avx2_count_mask(_mm256_cmpeq_epi32(_mm256_min_epu32(t, d), t), 4));
+  }
+};
+
+template<>
+struct Avx2Ops<uint64_t> {
+  enum { kLanes = 4 };
+  typedef __m256i Vector;
+  typedef __m256i Accumulator;
+
+  UPS_TARGET_AVX2 static Vector load(const uint64_t *p) {
+    return (_mm256_loadu_si256((const __m256i *)p));
+  }
+  UPS_TARGET_AVX2 static Vector broadcast(uint64_t v) {
+    return (_mm256_set1_epi64x((long long)v));
+  }
+  // AVX2 only has a signed 64bit comparison; flipping the sign bit
+  // makes it work for unsigned values
+  UPS_TARGET_AVX2 static Vector greater(Vector a, Vector b) {
+    __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ull);
+    return (_mm256_cmpgt_epi64(_mm256_xor_si256(a, sign),
+                            _mm256_xor_si256(b, sign)));
+  }
+  UPS_TARGET_AVX2 static Vector min(Vector a, Vector b) {
+    return (_mm256_blendv_epi8(a, b, greater(a, b)));
+  }
+  UPS_TARGET_AVX2 static Vector max(Vector a, Vector b) {
+    return (_mm256_blendv_epi8(b, a, greater(a, b)));
+  }
+  UPS_TARGET_AVX2 static Accumulator accumulate(Accumulator acc, Vector v) {
+    return (_mm256_add_epi64(acc, v));
+  }
+  UPS_TARGET_AVX2 static uint64_t reduce(Accumulator acc) {
+    return (avx2_reduce_epi64(acc));
+  }
+  UPS_TARGET_AVX2 static int count_range(Vector v, Vector low, Vector high) {
+    __m256i t = _mm256_sub_epi64(v, low);
+    __m256i d = _mm256_sub_epi64(high, low);
+    return (kLanes - avx2_count_mask(greater(t, d), 8));
+  }
+};
+
+template<>
+struct Avx2Ops<float> {
+  enum { kLanes = 8 };
+  typedef __m256 Vector;
+  typedef __m256d Accumulator;
+
+  UPS_TARGET_AVX2 static Vector load(const float *p) {
+    return (_mm256_loadu_ps(p));
+  }
+  UPS_TARGET_AVX2 static Vector broadcast(float v) {
+    return (_mm256_set1_ps(v));
+  }
+  UPS_TARGET_AVX2 static Vector min(Vector a, Vector b) {
+    return (_mm256_min_ps(a, b));
+  }
+  UPS_TARGET_AVX2 static Vector max(Vector a, Vector b) {
+    return (_mm256_max_ps(a, b));
+  }
+  // the sum is calculated with double precision
+  UPS_TARGET_AVX2 static Accumulator accumulate(Accumulator acc, Vector v) {
+    acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+    return (_mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1))));
+  }
+  UPS_TARGET_AVX2 static double reduce(Accumulator acc) {
+    return (avx2_reduce_pd(acc));
+  }
+  UPS_TARGET_AVX2 static int count_range(Vector v, Vector low, Vector high) {
+    __m256 mask = _mm256_and_ps(_mm256_cmp_ps(v, low, _CMP_GE_OQ),
+                            _mm256_cmp_ps(v, high, _CMP_LE_OQ));
+    return (__builtin_popcount(_mm256_movemask_ps(mask)));
+  }
+};
+
+template<>
+struct Avx2Ops<double> {
+  enum { kLanes = 4 };
+  typedef __m256d Vector;
+  typedef __m256d Accumulator;
+
+  UPS_TARGET_AVX2 static Vector load(const double *p) {
+    return (_mm256_loadu_pd(p));
+  }
+  UPS_TARGET_AVX2 static Vector broadcast(double v) {
+    return (_mm256_set1_pd(v));
+  }
+  UPS_TARGET_AVX2 static Vector min(Vector a, Vector b) {
+    return (_mm256_min_pd(a, b));
+  }
+  UPS_TARGET_AVX2 static Vector max(Vector a, Vector b) {
+    return (_mm256_max_pd(a, b));
+  }
+  UPS_TARGET_AVX2 static Accumulator accumulate(Accumulator acc, Vector v) {
+    return (_mm256_add_pd(acc, v));
+  }
+  UPS_TARGET_AVX2 static double reduce(Accumulator acc) {
+    return (avx2_reduce_pd(acc));
+  }
+  UPS_TARGET_AVX2 static int count_range(Vector v, Vector low, Vector high) {
+    __m256d mask = _mm256_and_pd(_mm256_cmp_pd(v, low, _CMP_GE_OQ),
+                            _mm256_cmp_pd(v, high, _CMP_LE_OQ));
+    return (__builtin_popcount(_mm256_movemask_pd(mask)));
+  }
+};
+
+//
+// The AVX2 kernels. Two registers are processed per iteration to hide
+// the latency of the additions; the remaining values are processed
+// one by one.
+//
+template<typename T, typename R>
+UPS_TARGET_AVX2 R
+sum_avx2(const T *p, size_t count)
+{
+  typedef Avx2Ops<T> Ops;
+  const T *end = &p[count];
+  typename Ops::Accumulator acc1 = typename Ops::Accumulator();
+  typename Ops::Accumulator acc2 = typename Ops::Accumulator();
+  for (; p + 2 * Ops::kLanes <= end; p += 2 * Ops::kLanes) {
+    acc1 = Ops::accumulate(acc1, Ops::load(p));
+    acc2 = Ops::accumulate(acc2, Ops::load(p + Ops::kLanes));
+  }
+  R sum = (R)Ops::reduce(acc1) + (R)Ops::reduce(acc2);
+  for (; p < end; p++)
+    sum += *p;
+  return (sum);
+}
+
+template<typename T>
+UPS_TARGET_AVX2 T
+min_avx2(const T *p, size_t count)
+{
+  typedef Avx2Ops<T> Ops;
+  if (count < Ops::kLanes)
+    return (min_portable(p, count));
+
+  const T *end = &p[count];
+  typename Ops::Vector v = Ops::load(p);
+  for (p += Ops::kLanes; p + Ops::kLanes <= end; p += Ops::kLanes)
+    v = Ops::min(v, Ops::load(p));
+
+  T lanes[Ops::kLanes];
+  ::memcpy(&lanes[0], &v, sizeof(v));
+  T m = min_portable(&lanes[0], Ops::kLanes);
+  for (; p < end; p++)
+    if (*p < m)
+      m = *p;
+  return (m);
+}
+
+template<typename T>
+UPS_TARGET_AVX2 T
+max_avx2(const T *p, size_t count)
+{
+  typedef Avx2Ops<T> Ops;
+  if (count < Ops::kLanes)
+    return (max_portable(p, count));
+
+  const T *end = &p[count];
+  typename Ops::Vector v = Ops::load(p);
+  for (p += Ops::kLanes; p + Ops::kLanes <= end; p += Ops::kLanes)
+    v = Ops::max(v, Ops::load(p));
+
+  T lanes[Ops::kLanes];
+  ::memcpy(&lanes[0], &v, sizeof(v));
+  T m = max_portable(&lanes[0], Ops::kLanes);
+  for (; p < end; p++)
+    if (*p > m)
+      m = *p;
+  return (m);
+}
+
+template<typename T>
+UPS_TARGET_AVX2 size_t
+count_range_avx2(const T *p, size_t count, T low, T high)
+{
+  typedef Avx2Ops<T> Ops;
+  const T *end = &p[count];
+  typename Ops::Vector vlow = Ops::broadcast(low);
+  typename Ops::Vector vhigh = Ops::broadcast(high);
+  size_t c = 0;
+  for (; p + Ops::kLanes <= end; p += Ops::kLanes)
+    c += Ops::count_range(Ops::load(p), vlow, vhigh);
+  return (c + count_range_portable(p, end - p, low, high));
+}
+
+#endif // UPS_ENABLE_AVX2_KERNELS
+
+//
+// The public interface; chooses the best implementation for this CPU
+//
+
+// Returns the sum of all values
+template<typename T, typename R>
+inline R
+simd_sum(const T *p, size_t count)
+{
+#ifdef UPS_ENABLE_AVX2_KERNELS
+  if (os_has_avx2())
+    return (sum_avx2<T, R>(p, count));
+#endif
+  return (sum_portable<T, R>(p, count));
+}
+
+// Returns the smallest value; |count| must not be 0
+template<typename T>
+inline T
+simd_min(const T *p, size_t count)
+{
+#ifdef UPS_ENABLE_AVX2_KERNELS
+  if (os_has_avx2())
+    return (min_avx2(p, count));
+#endif
+  return (min_portable(p, count));
+}
+
+// Returns the largest value; |count| must not be 0
+template<typename T>
+inline T
+simd_max(const T *p, size_t count)
+{
+#ifdef UPS_ENABLE_AVX2_KERNELS
+  if (os_has_avx2())
+    return (max_avx2(p, count));
+#endif
+  return (max_portable(p, count));
+}
+
+// Counts the values in the range [low, high]
+template<typename T>
+inline size_t
+simd_count_range(const T *p, size_t count, T low, T high)
+{
+  // the integer kernels rely on low <= high
+  if (!(low <= high))
+    return (0);
+#ifdef UPS_ENABLE_AVX2_KERNELS
+  if (os_has_avx2())
+    return (count_range_avx2(p, count, low, high));
+#endif
+  return (count_range_portable(p, count, low, high));
+}
+
+} // namespace upscaledb
+
+#endif /* UPS_SIMD_AGGREGATE_H */
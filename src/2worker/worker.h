@@ -28,6 +28,8 @@
 #include <boost/thread/thread.hpp>
 
 // Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "1base/mutex.h"
 #include "2worker/workitem.h"
 
 #ifndef UPS_ROOT_H
@@ -37,6 +39,57 @@
 namespace upscaledb {
 
 struct WorkerPool;
+
+// Waits till all tasks of a batch (see WorkerPool::run_parallel) were
+// executed; collects the first error
+struct ParallelBatch {
+  ParallelBatch(size_t pending_)
+    : pending(pending_), status(0) {
+  }
+
+  // Called by a task when it was executed
+  void done(ups_status_t st) {
+    ScopedLock lock(mutex);
+    if (st && !status)
+      status = st;
+    if (--pending == 0)
+      cond.notify_all();
+  }
+
+  // Blocks till all tasks were executed
+  void wait() {
+    ScopedLock lock(mutex);
+    while (pending > 0)
+      cond.wait(lock);
+  }
+
+  Mutex mutex;
+  Condition cond;
+  size_t pending;
+  ups_status_t status;
+};
+
+// Executes a single task of a batch
+template<typename F>
+struct ParallelTask {
+  ParallelTask(F f_, ParallelBatch *batch_)
+    : f(f_), batch(batch_) {
+  }
+
+  void operator()() {
+    ups_status_t st = 0;
+    try {
+      f();
+    }
+    catch (Exception &ex) {
+      st = ex.code;
+    }
+    batch->done(st);
+  }
+
+  F f;
+  ParallelBatch *batch;
+};
  
 // our worker thread objects
 struct WorkerThread {
@@ -58,12 +111,51 @@ struct WorkerPool {
       workers.push_back(new boost::thread(WorkerThread(*this)));
   }
 
-  // Add a new work item to the pool
+  // Add a new work item to the pool. Work items are executed in the
+  // order in which they were added, one at a time.
   template<typename F>
   void enqueue(F &f) {
     strand.post(f);
   }
 
+  // Executes |tasks| in parallel on all threads of the pool and blocks till
+  // all of them were executed. Only called by a work item (see
+  // |enqueue()|) - since work items do not overlap, the other threads are
+  // idle. With a single thread the tasks are executed sequentially.
+  // The first error of a task is re-thrown.
+  template<typename F>
+  void run_parallel(std::vector<F> &tasks) {
+    if (workers.size() <= 1 || tasks.size() <= 1) {
+      for (size_t i = 0; i < tasks.size(); i++)
+        tasks[i]();
+      return;
+    }
+
+    ParallelBatch batch(tasks.size() - 1);
+    for (size_t i = 1; i < tasks.size(); i++)
+      service.post(ParallelTask<F>(tasks[i], &batch));
+
+    // the calling thread executes the first task
+    ups_status_t st = 0;
+    try {
+      tasks[0]();
+    }
+    catch (Exception &ex) {
+      st = ex.code;
+    }
+
+    batch.wait();
+    if (!st)
+      st = batch.status;
+    if (st)
+      throw Exception(st);
+  }
+
+  // Returns the number of threads
+  size_t num_threads() const {
+    return (workers.size());
+  }
+
   // the destructor joins all threads
   ~WorkerPool() {
     service.stop();
@@ -80,7 +172,7 @@ struct WorkerPool {
   // the io_service we are wrapping
   boost::asio::io_service service;
   boost::asio::io_service::work working;
-  boost::asio::strand strand;
+  boost::asio::io_service::strand strand;
 };
 
 inline void
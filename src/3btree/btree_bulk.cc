@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+#include "0root/root.h"
+
+#include <string.h>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "3page_manager/page_manager.h"
+#include "3btree/btree_stats.h"
+#include "3btree/btree_index.h"
+#include "3btree/btree_bulk.h"
+#include "3btree/btree_node_proxy.h"
+#include "4db/db_local.h"
+#include "4env/env_local.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+BtreeBulkLoader::BtreeBulkLoader(Context *context, BtreeIndex *btree,
+                uint32_t fill_factor)
+  : m_btree(btree), m_fill_factor(fill_factor), m_max_leaf_keys(0),
+    m_first_leaf_full(false), m_has_last_key(false)
+{
+  ::memset(&m_last_key, 0, sizeof(m_last_key));
+
+  // the (empty) root page is the first leaf
+  m_levels.push_back(m_btree->root_address());
+
+  LocalEnvironment *env = m_btree->get_db()->lenv();
+  Page *root = env->page_manager()->fetch(context, m_btree->root_address());
+  m_btree->get_statistics()->reset_page(root);
+}
+
+ups_status_t
+BtreeBulkLoader::append(Context *context, ups_key_t *key,
+                ups_record_t *record)
+{
+  LocalDatabase *db = m_btree->get_db();
+  Page *page = db->lenv()->page_manager()->fetch(context, m_levels[0]);
+
+  if (m_has_last_key) {
+    int cmp = m_btree->compare_keys(key, &m_last_key);
+    if (cmp < 0) {
+      ups_trace(("keys are not sorted"));
+      return (UPS_INV_PARAMETER);
+    }
+    if (cmp == 0) {
+      if ((db->get_flags() & UPS_ENABLE_DUPLICATE_KEYS) == 0)
+        return (UPS_DUPLICATE_KEY);
+      append_duplicate(context, page, key, record);
+      return (0);
+    }
+  }
+
+  BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+
+  // the leaf reached the fill factor? then continue with a new leaf
+  if (m_max_leaf_keys > 0 && node->get_count() >= m_max_leaf_keys) {
+    page = split_leaf(context, page, node->get_count(), key);
+    node = m_btree->get_node_from_page(page);
+  }
+
+  PBtreeNode::InsertResult result = node->insert(context, key,
+                  PBtreeNode::kInsertAppend);
+
+  if (result.status == UPS_LIMITS_REACHED) {
+    // the first leaf is full: now the capacity of the leaves is known.
+    // If the leaves are not filled completely then move the surplus keys
+    // to new leaves
+    if (!m_first_leaf_full) {
+      m_first_leaf_full = true;
+      if (m_fill_factor < 100) {
+        m_max_leaf_keys = node->get_count() * m_fill_factor / 100;
+        if (m_max_leaf_keys == 0)
+          m_max_leaf_keys = 1;
+        while (node->get_count() > m_max_leaf_keys) {
+          page = split_leaf(context, page, (int)m_max_leaf_keys);
+          node = m_btree->get_node_from_page(page);
+        }
+      }
+    }
+
+    page = split_leaf(context, page, node->get_count(), key);
+    node = m_btree->get_node_from_page(page);
+    result = node->insert(context, key, PBtreeNode::kInsertAppend);
+  }
+
+  if (result.status)
+    return (result.status);
+
+  try {
+    node->set_record(context, result.slot, record, 0, 0, 0);
+  }
+  catch (Exception &ex) {
+    node->erase(context, result.slot);
+    throw ex;
+  }
+
+  page->set_dirty(true);
+  set_last_key(key);
+  return (0);
+}
+
+void
+BtreeBulkLoader::append_duplicate(Context *context, Page *page,
+                ups_key_t *key, ups_record_t *record)
+{
+  BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+  int slot = node->get_count() - 1;
+
+  // same as in BtreeUpdateAction: if the node is full then split it
+  // before the duplicate table grows
+  if (slot > 0 && node->requires_split(context, key)) {
+    page = split_leaf(context, page, slot);
+    node = m_btree->get_node_from_page(page);
+    slot = 0;
+  }
+
+  node->set_record(context, slot, record, 0,
+                  UPS_DUPLICATE | UPS_DUPLICATE_INSERT_LAST, 0);
+  page->set_dirty(true);
+}
+
+Page *
+BtreeBulkLoader::append_node(Context *context, size_t level, Page *page)
+{
+  LocalEnvironment *env = m_btree->get_db()->lenv();
+
+  Page *new_page = env->page_manager()->alloc(context, Page::kTypeBindex);
+  {
+    PBtreeNode *node = PBtreeNode::from_page(new_page);
+    node->set_flags(level == 0 ? PBtreeNode::kLeafNode : 0);
+    node->set_left(page->get_address());
+  }
+
+  BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+  node->set_right(new_page->get_address());
+  page->set_dirty(true);
+  new_page->set_dirty(true);
+
+  m_levels[level] = new_page->get_address();
+  return (new_page);
+}
+
+void
+BtreeBulkLoader::append_separator(Context *context, size_t level,
+                ups_key_t *key, uint64_t left, uint64_t child)
+{
+  LocalEnvironment *env = m_btree->get_db()->lenv();
+  Page *page;
+
+  // the root was split? then allocate a new root page
+  if (level == m_levels.size()) {
+    page = env->page_manager()->alloc(context, Page::kTypeBroot);
+    BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+    node->set_ptr_down(left);
+    page->set_dirty(true);
+
+    Page *old_root = env->page_manager()->fetch(context, left);
+    old_root->set_type(Page::kTypeBindex);
+    old_root->set_dirty(true);
+
+    m_levels.push_back(page->get_address());
+    m_btree->set_root_address(context, page->get_address());
+    Page *header = env->page_manager()->fetch(context, 0);
+    header->set_dirty(true);
+  }
+  else
+    page = env->page_manager()->fetch(context, m_levels[level]);
+
+  BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+  PBtreeNode::InsertResult result = node->insert(context, key,
+                  PBtreeNode::kInsertAppend);
+
+  // the node is full: the |child| becomes the ptr_down of a new node,
+  // and |key| moves up to the parent
+  if (result.status == UPS_LIMITS_REACHED) {
+    Page *new_page = append_node(context, level, page);
+    BtreeNodeProxy *new_node = m_btree->get_node_from_page(new_page);
+    new_node->set_ptr_down(child);
+    append_separator(context, level + 1, key, page->get_address(),
+                    new_page->get_address());
+    return;
+  }
+
+  if (result.status)
+    throw Exception(result.status);
+
+  node->set_record_id(context, result.slot, child);
+  page->set_dirty(true);
+}
+
+Page *
+BtreeBulkLoader::split_leaf(Context *context, Page *page, int pivot,
+                ups_key_t *key)
+{
+  BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+  ByteArray pivot_key_arena;
+  ups_key_t pivot_key = {0};
+
+  // |key| is the first key of the new leaf if nothing is moved
+  if (pivot < (int)node->get_count())
+    node->get_key(context, pivot, &pivot_key_arena, &pivot_key);
+  else
+    pivot_key = *key;
+
+  Page *new_page = append_node(context, 0, page);
+  if (pivot < (int)node->get_count()) {
+    BtreeNodeProxy *new_node = m_btree->get_node_from_page(new_page);
+    node->split(context, new_node, pivot);
+  }
+
+  append_separator(context, 1, &pivot_key, page->get_address(),
+                  new_page->get_address());
+  return (new_page);
+}
+
+void
+BtreeBulkLoader::set_last_key(ups_key_t *key)
+{
+  m_last_key_arena.copy((uint8_t *)key->data, key->size);
+  m_last_key.data = m_last_key_arena.get_ptr();
+  m_last_key.size = key->size;
+  m_has_last_key = true;
+}
+
+} // namespace upscaledb
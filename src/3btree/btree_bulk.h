@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Builds a btree bottom-up from sorted keys (ups_db_bulk_begin etc).
+ *
+ * The keys are appended to the right-most leaf. If the leaf is full (or
+ * reached the fill factor) then a new leaf is allocated, and its first key
+ * is appended to the right-most node of the parent level. Full internal
+ * nodes are handled the same way; if the top level overflows then a new
+ * root is allocated. The btree is therefore valid after each append, and
+ * the pages are allocated (and later written) in ascending order.
+ *
+ * Only the right-most path of the tree is modified. Since the nodes are
+ * filled with the same insert()/set_record() functions which are used for
+ * regular inserts, all KeyList/RecordList layouts are supported.
+ *
+ * @exception_safe: basic
+ * @thread_safe: no
+ */
+
+#ifndef UPS_BTREE_BULK_H
+#define UPS_BTREE_BULK_H
+
+#include "0root/root.h"
+
+#include <vector>
+
+#include "ups/upscaledb.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/dynamic_array.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+struct Context;
+class Page;
+class BtreeIndex;
+
+class BtreeBulkLoader
+{
+  public:
+    // Constructor; the |btree| must be empty. |fill_factor| is the
+    // percentage (1 - 100) of the leaf capacity which is filled
+    BtreeBulkLoader(Context *context, BtreeIndex *btree,
+                    uint32_t fill_factor);
+
+    // Appends a key/record pair. The key must be greater than the previous
+    // key. If duplicate keys are enabled then it can also be equal; the
+    // record is then appended as a duplicate.
+    ups_status_t append(Context *context, ups_key_t *key,
+                    ups_record_t *record);
+
+  private:
+    // Appends a duplicate record to the last key (|key|) of the leaf |page|
+    void append_duplicate(Context *context, Page *page, ups_key_t *key,
+                    ups_record_t *record);
+
+    // Allocates a new node right of |page| and makes it the right-most
+    // node of |level|
+    Page *append_node(Context *context, size_t level, Page *page);
+
+    // Appends the first key of a new node (|key|, |child|) to the parent
+    // |level|. |left| is the left sibling of |child|; it becomes the
+    // ptr_down of a new root page.
+    void append_separator(Context *context, size_t level, ups_key_t *key,
+                    uint64_t left, uint64_t child);
+
+    // Moves the keys at |pivot| and above from the right-most leaf |page|
+    // to a new leaf; returns the new leaf. If |pivot| is the number of keys
+    // then the new leaf is empty, and |key| will be its first key
+    Page *split_leaf(Context *context, Page *page, int pivot,
+                    ups_key_t *key = 0);
+
+    // Stores a copy of the last key (for the sort order check)
+    void set_last_key(ups_key_t *key);
+
+    // the btree which is built
+    BtreeIndex *m_btree;
+
+    // the fill factor of the leaves, in percent
+    uint32_t m_fill_factor;
+
+    // the maximum number of keys per leaf; calculated when the first
+    // leaf is full. 0 if unknown or if leaves are filled completely
+    size_t m_max_leaf_keys;
+
+    // true if the first leaf was already full
+    bool m_first_leaf_full;
+
+    // the addresses of the right-most nodes; |m_levels[0]| is the leaf
+    // level, |m_levels.back()| is the root
+    std::vector<uint64_t> m_levels;
+
+    // a copy of the last key which was appended
+    ups_key_t m_last_key;
+
+    // the memory of |m_last_key|
+    ByteArray m_last_key_arena;
+
+    // true if |m_last_key| is valid
+    bool m_has_last_key;
+};
+
+} // namespace upscaledb
+
+#endif /* UPS_BTREE_BULK_H */
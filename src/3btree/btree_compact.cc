@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+#include "0root/root.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "1base/dynamic_array.h"
+#include "2page/page.h"
+#include "3page_manager/page_manager.h"
+#include "3btree/btree_stats.h"
+#include "3btree/btree_index.h"
+#include "3btree/btree_update.h"
+#include "3btree/btree_node_proxy.h"
+#include "3btree/btree_cursor.h"
+#include "4db/db_local.h"
+#include "4env/env_local.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+/*
+ * Merges underfull leaves in the background. Leaves are only merged with
+ * their right sibling if both have the same parent; the same rules apply
+ * as for the merges in BtreeUpdateAction::traverse_tree().
+ */
+class BtreeCompactAction : public BtreeUpdateAction
+{
+  public:
+    BtreeCompactAction(BtreeIndex *btree, Context *context,
+                    ByteArray *resume_key, size_t max_visits,
+                    size_t max_merges)
+      : BtreeUpdateAction(btree, context, 0, 0),
+        m_resume_key(resume_key), m_max_visits(max_visits),
+        m_max_merges(max_merges) {
+    }
+
+    // This is the entry point for the compaction
+    bool run() {
+      PageManager *page_manager = m_btree->get_db()->lenv()->page_manager();
+
+      Page *page = page_manager->fetch(m_context, m_btree->root_address());
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+
+      // if the root page is empty with children then collapse it
+      while (node->get_count() == 0 && !node->is_leaf()) {
+        page = collapse_root(page);
+        node = m_btree->get_node_from_page(page);
+      }
+
+      // a single leaf cannot be merged
+      if (node->is_leaf()) {
+        m_resume_key->clear();
+        return (true);
+      }
+
+      // descend to the parent of the leaf where the previous call stopped
+      ups_key_t key = {0};
+      key.data = m_resume_key->get_ptr();
+      key.size = (uint16_t)m_resume_key->get_size();
+
+      int slot;
+      while (true) {
+        Page *child;
+        if (key.size > 0)
+          child = m_btree->find_lower_bound(m_context, page, &key, 0, &slot);
+        else {
+          child = page_manager->fetch(m_context, node->get_ptr_down());
+          slot = -1;
+        }
+
+        if (m_btree->get_node_from_page(child)->is_leaf())
+          break;
+        page = child;
+        node = m_btree->get_node_from_page(page);
+      }
+
+      // now walk through the children of this node (and its right
+      // siblings), move each leaf to a lower free page and merge adjacent
+      // leaves. Each node has at least one child checked before the limits
+      // are applied; otherwise the position of its left-most child could
+      // not be stored
+      size_t visits = 0;
+      size_t merges = 0;
+      while (true) {
+        if (slot >= 0 && (visits >= m_max_visits || merges >= m_max_merges))
+          break;
+
+        Page *child = page_manager->fetch(m_context, child_address(node, slot));
+        child = relocate(page, slot, child);
+        visits++;
+
+        if (slot + 1 >= (int)node->get_count()) {
+          if (node->get_right() == 0) {
+            m_resume_key->clear();
+            return (true);
+          }
+          page = page_manager->fetch(m_context, node->get_right());
+          node = m_btree->get_node_from_page(page);
+          slot = -1;
+          continue;
+        }
+
+        Page *sibling = page_manager->fetch(m_context,
+                        child_address(node, slot + 1));
+
+        if (requires_merge(child, sibling)) {
+          merge_page(child, sibling);
+          // also remove the link to the sibling from the parent
+          node->erase(m_context, slot + 1);
+          page->set_dirty(true);
+          merges++;
+        }
+        else
+          slot++;
+      }
+
+      // the separator key of the current child is the position for
+      // the next call
+      ByteArray arena;
+      ups_key_t separator = {0};
+      node->get_key(m_context, slot, &arena, &separator);
+      m_resume_key->copy((uint8_t *)separator.data, separator.size);
+      return (false);
+    }
+
+  private:
+    // Returns the address of the child at |slot| (-1 for the left-most child)
+    uint64_t child_address(BtreeNodeProxy *node, int slot) {
+      return (slot < 0
+                ? node->get_ptr_down()
+                : node->get_record_id(m_context, slot));
+    }
+
+    // Moves the leaf |page| (the child of |parent| at |slot|) to the
+    // lowest free page of the file, if that page has a lower address.
+    // The freed pages then accumulate at the end of the file, where
+    // PageManager::reclaim_space() can truncate them. Returns the page
+    // which now stores the leaf.
+    Page *relocate(Page *parent, int slot, Page *page) {
+      PageManager *page_manager = m_btree->get_db()->lenv()->page_manager();
+
+      uint64_t free_page = page_manager->first_free_page();
+      if (free_page == 0 || free_page >= page->get_address())
+        return (page);
+
+      BtreeCursor::uncouple_all_cursors(m_context, page, 0);
+
+      Page *new_page = page_manager->alloc(m_context, Page::kTypeBindex);
+      uint32_t page_size = m_btree->get_db()->lenv()->config().page_size_bytes;
+      ::memcpy(new_page->get_payload(), page->get_payload(),
+                Page::usable_page_size(page_size));
+      new_page->set_dirty(true);
+      BtreeNodeProxy *node = m_btree->get_node_from_page(new_page);
+
+      // fix the parent
+      BtreeNodeProxy *parent_node = m_btree->get_node_from_page(parent);
+      if (slot < 0)
+        parent_node->set_ptr_down(new_page->get_address());
+      else
+        parent_node->set_record_id(m_context, slot, new_page->get_address());
+      parent->set_dirty(true);
+
+      // and the linked list of the leaves
+      if (node->get_left()) {
+        Page *left = page_manager->fetch(m_context, node->get_left());
+        m_btree->get_node_from_page(left)->set_right(new_page->get_address());
+        left->set_dirty(true);
+      }
+      if (node->get_right()) {
+        Page *right = page_manager->fetch(m_context, node->get_right());
+        m_btree->get_node_from_page(right)->set_left(new_page->get_address());
+        right->set_dirty(true);
+      }
+
+      m_btree->get_statistics()->reset_page(page);
+      page_manager->del(m_context, page);
+      return (new_page);
+    }
+
+    // Returns true if the |sibling| can be merged into |page|
+    bool requires_merge(Page *page, Page *sibling) {
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+      BtreeNodeProxy *sib_node = m_btree->get_node_from_page(sibling);
+
+      // an empty sibling can always be merged; otherwise both nodes must be
+      // underfull, or the merged node might not have enough space
+      if (sib_node->get_count() == 0)
+        return (true);
+      return (node->requires_merge() && sib_node->requires_merge());
+    }
+
+    // the position of the previous call
+    ByteArray *m_resume_key;
+
+    // the maximum number of leaves which are checked
+    size_t m_max_visits;
+
+    // the maximum number of leaves which are merged
+    size_t m_max_merges;
+};
+
+bool
+BtreeIndex::compact(Context *context, ByteArray *resume_key,
+                size_t max_visits, size_t max_merges)
+{
+  context->db = get_db();
+
+  BtreeCompactAction bca(this, context, resume_key, max_visits, max_merges);
+  return (bca.run());
+}
+
+} // namespace upscaledb
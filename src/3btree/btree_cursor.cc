@@ -221,7 +221,7 @@ BtreeCursor::move_to_next_page(Context *context)
   }
 
   Page *page = env->page_manager()->fetch(context, node->get_right(),
-                        PageManager::kReadOnly);
+                        PageManager::kReadOnly | PageManager::kReadAhead);
   couple_to_page(page, 0, 0);
   return (0);
 }
@@ -350,7 +350,7 @@ BtreeCursor::move_next(Context *context, uint32_t flags)
     return (UPS_KEY_NOT_FOUND);
 
   Page *page = env->page_manager()->fetch(context, node->get_right(),
-                    PageManager::kReadOnly);
+                    PageManager::kReadOnly | PageManager::kReadAhead);
   node = m_btree->get_node_from_page(page);
 
   // if the right node is empty then continue searching for the next
@@ -359,7 +359,7 @@ BtreeCursor::move_next(Context *context, uint32_t flags)
     if (!node->get_right())
       return (UPS_KEY_NOT_FOUND);
     page = env->page_manager()->fetch(context, node->get_right(),
-                    PageManager::kReadOnly);
+                    PageManager::kReadOnly | PageManager::kReadAhead);
     node = m_btree->get_node_from_page(page);
   }
 
@@ -489,6 +489,7 @@ BtreeCursor::couple_to_page(Page *page, uint32_t index)
   m_coupled_page = page;
 
   // add the cursor to the page
+  ScopedSpinlock lock(m_btree->m_mutex);
   if (page->cursor_list()) {
     m_next_in_page = page->cursor_list();
     m_previous_in_page = 0;
@@ -502,6 +503,7 @@ BtreeCursor::remove_cursor_from_page(Page *page)
 {
   BtreeCursor *n, *p;
 
+  ScopedSpinlock lock(m_btree->m_mutex);
   if (this == page->cursor_list()) {
     n = m_next_in_page;
     if (n)
@@ -31,6 +31,8 @@
 #include "3btree/btree_update.h"
 #include "3btree/btree_node_proxy.h"
 #include "4db/db.h"
+#include "4env/env_local.h"
+#include "4env/janitor.h"
 #include "4cursor/cursor_local.h"
 
 #ifndef UPS_ROOT_H
@@ -78,7 +80,6 @@ class BtreeEraseAction : public BtreeUpdateAction
               throw ex;
             goto fall_through;
           }
-          // TODO if the page is empty then ask the janitor to clean it up
           return (0);
 
 fall_through:
@@ -212,6 +213,13 @@ fall_through:
         return (erase());
       }
 
+      // underfull leaves are merged in the background
+      if (node->requires_merge()) {
+        Janitor *janitor = db->lenv()->janitor();
+        if (janitor)
+          janitor->schedule(db);
+      }
+
       return (0);
     }
 
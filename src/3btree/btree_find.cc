@@ -47,10 +47,10 @@ class BtreeFindAction
     BtreeFindAction(BtreeIndex *btree, Context *context, LocalCursor *cursor,
                     ups_key_t *key, ByteArray *key_arena,
                     ups_record_t *record, ByteArray *record_arena,
-                    uint32_t flags)
+                    uint32_t flags, uint64_t *leaf_hint)
       : m_btree(btree), m_context(context), m_cursor(0), m_key(key),
         m_record(record), m_flags(flags), m_key_arena(key_arena),
-        m_record_arena(record_arena) {
+        m_record_arena(record_arena), m_leaf_hint(leaf_hint) {
       if (cursor && cursor->get_btree_cursor()->get_parent())
         m_cursor = cursor->get_btree_cursor();
     }
@@ -99,6 +99,20 @@ class BtreeFindAction
 
       uint32_t approx_match = 0;
 
+      /* batch lookup: check the leaf of the previous key first */
+      if (slot == -1 && m_leaf_hint && *m_leaf_hint
+              && (m_flags & (UPS_FIND_LT_MATCH | UPS_FIND_GT_MATCH)) == 0) {
+        page = find_in_hinted_leaf(&slot);
+        if (page) {
+          if (slot == -1) {
+            stats->find_failed();
+            return (UPS_KEY_NOT_FOUND);
+          }
+          node = m_btree->get_node_from_page(page);
+          goto return_result;
+        }
+      }
+
       if (slot == -1) {
         /* load the root page */
         page = env->page_manager()->fetch(m_context,
@@ -117,6 +131,9 @@ class BtreeFindAction
           node = m_btree->get_node_from_page(page);
         }
 
+        if (m_leaf_hint)
+          *m_leaf_hint = page->get_address();
+
         /* check the leaf page for the key (shortcut w/o approx. matching) */
         if (m_flags == 0) {
           slot = node->find(m_context, m_key);
@@ -188,6 +205,36 @@ return_result:
     }
 
   private:
+    // Returns the leaf of the previous lookup of a batch if |m_key| falls
+    // into its range, and stores the slot of the key (or -1) in |pslot|.
+    // Returns null if the leaf cannot be used.
+    Page *find_in_hinted_leaf(int *pslot) {
+      LocalDatabase *db = m_btree->get_db();
+      Page *page = db->lenv()->page_manager()->fetch(m_context, *m_leaf_hint,
+                                            PageManager::kOnlyFromCache
+                                            | PageManager::kReadOnly);
+      if (!page
+              || page->get_db() != db
+              || (page->get_type() != Page::kTypeBroot
+                  && page->get_type() != Page::kTypeBindex))
+        return (0);
+
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+      if (!node->is_leaf() || node->get_count() == 0)
+        return (0);
+
+      /* keys which are smaller than the first key (or larger than the
+       * last key) can belong to a sibling */
+      if (node->get_left() != 0 && node->compare(m_context, m_key, 0) < 0)
+        return (0);
+      if (node->get_right() != 0
+              && node->compare(m_context, m_key, node->get_count() - 1) > 0)
+        return (0);
+
+      *pslot = node->find(m_context, m_key);
+      return (page);
+    }
+
     // Searches a leaf node for a key.
     //
     // !!!
@@ -260,15 +307,18 @@ return_result:
 
     // allocator for the record data
     ByteArray *m_record_arena;
+
+    // the leaf of the previous lookup of a batch; can be null
+    uint64_t *m_leaf_hint;
 };
 
 ups_status_t
 BtreeIndex::find(Context *context, LocalCursor *cursor, ups_key_t *key,
                 ByteArray *key_arena, ups_record_t *record,
-                ByteArray *record_arena, uint32_t flags)
+                ByteArray *record_arena, uint32_t flags, uint64_t *leaf_hint)
 {
   BtreeFindAction bfa(this, context, cursor, key, key_arena, record,
-                  record_arena, flags);
+                  record_arena, flags, leaf_hint);
   return (bfa.run());
 }
 
@@ -36,6 +36,7 @@
 #include "2page/page.h"
 #include "3btree/btree_node.h"
 #include "3btree/btree_keys_base.h"
+#include "3btree/btree_visitor.h"
 
 #ifndef UPS_ROOT_H
 #  error "root.h was not included"
@@ -45,6 +46,45 @@ namespace upscaledb {
 
 struct Context;
 
+//
+// Forwards the keys of KeyList::scan() to a ScanVisitor, together with
+// the records which are stored at the same positions in the array of
+// fixed-length records
+//
+struct RecordArrayScanVisitor : public ScanVisitor {
+  RecordArrayScanVisitor(ScanVisitor *visitor, const uint8_t *record_array,
+                  size_t record_size)
+    : m_visitor(visitor), m_record_array(record_array),
+      m_record_size(record_size) {
+  }
+
+  // Operates on a single key
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  size_t duplicate_count) {
+    (*m_visitor)(key_data, key_size, m_record_array, (uint32_t)m_record_size);
+    m_record_array += m_record_size;
+  }
+
+  // Operates on an array of keys
+  virtual void operator()(const void *key_array, size_t key_count) {
+    (*m_visitor)(key_array, m_record_array, key_count);
+    m_record_array += key_count * m_record_size;
+  }
+
+  // Not required
+  virtual void assign_result(uqi_result_t *result) {
+  }
+
+  // The visitor which receives the keys and records
+  ScanVisitor *m_visitor;
+
+  // The record of the next key
+  const uint8_t *m_record_array;
+
+  // The size of each record
+  size_t m_record_size;
+};
+
 template<typename KeyList, typename RecordList>
 class BaseNodeImpl
 {
@@ -90,6 +130,37 @@ class BaseNodeImpl
                       flags, duplicate_index);
     }
 
+    // Iterates all keys and their records (including duplicates), calls
+    // the |visitor| on each. If the records are stored in an array then
+    // the KeyList scans the keys, and the records are passed without
+    // copying them
+    void scan_records(Context *context, ScanVisitor *visitor,
+                    uint32_t start) {
+      size_t node_count = m_node->get_count();
+      const uint8_t *record_array = m_records.get_record_array();
+      if (KeyList::kSupportsBlockScans && record_array) {
+        size_t record_size = m_records.get_full_record_size();
+        RecordArrayScanVisitor rasv(visitor, &record_array[start * record_size],
+                        record_size);
+        m_keys.scan(context, &rasv, start, node_count - start);
+        return;
+      }
+
+      ups_key_t key = {0};
+      ups_record_t record = {0};
+      ByteArray key_arena;
+      ByteArray record_arena;
+      for (size_t i = start; i < node_count; i++) {
+        m_keys.get_key(context, i, &key_arena, &key, false);
+        int record_count = m_records.get_record_count(context, i);
+        for (int d = 0; d < record_count; d++) {
+          m_records.get_record(context, i, &record_arena, &record,
+                          UPS_DIRECT_ACCESS, d);
+          (*visitor)(key.data, key.size, record.data, (uint32_t)record.size);
+        }
+      }
+    }
+
     // Updates the record of a key
     void set_record(Context *context, int slot, ups_record_t *record,
                     int duplicate_index, uint32_t flags,
@@ -145,6 +145,11 @@ class DefaultNodeImpl : public BaseNodeImpl<KeyList, RecordList>
       check_index_integrity(context, P::m_node->get_count());
 #endif
 
+      if (visitor->requires_records()) {
+        P::scan_records(context, visitor, start);
+        return;
+      }
+
       // a distinct scan over fixed-length keys can be moved to the KeyList
       if (KeyList::kSupportsBlockScans && distinct) {
         P::m_keys.scan(context, visitor, start, P::m_node->get_count() - start);
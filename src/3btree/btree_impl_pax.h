@@ -102,7 +102,11 @@ class PaxNodeImpl : public BaseNodeImpl<KeyList, RecordList>
     // Iterates all keys, calls the |visitor| on each
     void scan(Context *context, ScanVisitor *visitor, uint32_t start,
                     bool distinct) {
-      P::m_keys.scan(context, visitor, start, P::m_node->get_count() - start);
+      if (visitor->requires_records())
+        P::scan_records(context, visitor, start);
+      else
+        P::m_keys.scan(context, visitor, start,
+                        P::m_node->get_count() - start);
     }
 
     // Returns true if |key| cannot be inserted because a split is required
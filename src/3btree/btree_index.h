@@ -26,11 +26,13 @@
 #include "0root/root.h"
 
 #include <algorithm>
+#include <vector>
 
 // Always verify that a file of level N does not include headers > N!
 #include "1globals/globals.h"
 #include "1base/abi.h"
 #include "1base/dynamic_array.h"
+#include "1base/spinlock.h"
 #include "3btree/btree_cursor.h"
 #include "3btree/btree_stats.h"
 #include "3btree/btree_node.h"
@@ -183,6 +185,51 @@ class LocalDatabase;
 class BtreeNodeProxy;
 struct PDupeEntry;
 struct BtreeVisitor;
+struct ScanVisitor;
+
+//
+// One end of a key range of a parallel scan. If |is_set| is false then
+// the range is unbounded.
+//
+struct BtreeScanBound
+{
+  BtreeScanBound()
+    : is_set(false), inclusive(false) {
+  }
+
+  // the key data
+  std::vector<uint8_t> key;
+
+  // true if the bound is set
+  bool is_set;
+
+  // true if the key itself is part of the range
+  bool inclusive;
+};
+
+//
+// A range of adjacent leaves which is scanned by a single thread. It
+// starts at |leaf| and ends before the first leaf of the next chunk. All
+// keys of the chunk are >= |pivot|.
+//
+struct BtreeScanChunk
+{
+  // the address of the first leaf
+  uint64_t leaf;
+
+  // the separator key of the parent node
+  BtreeScanBound pivot;
+};
+
+//
+// A key range which was not scanned because it is modified by
+// Transactions
+//
+struct BtreeScanRange
+{
+  BtreeScanBound low;
+  BtreeScanBound high;
+};
 
 //
 // Abstract base class, overwritten by a templated version
@@ -298,14 +345,21 @@ class BtreeIndex
     // Returns the key compression algorithm
     int key_compression();
 
-    // Lookup a key in the index (ups_db_find)
+    // Lookup a key in the index (ups_db_find).
+    // If |leaf_hint| is not null then it's the address of the leaf of the
+    // previous lookup of a batch (ups_db_find_many), or 0. If the key falls
+    // into the range of this leaf then the leaf is searched directly.
+    // Returns the address of the searched leaf in |leaf_hint|.
     ups_status_t find(Context *context, LocalCursor *cursor, ups_key_t *key,
                     ByteArray *key_arena, ups_record_t *record,
-                    ByteArray *record_arena, uint32_t flags);
+                    ByteArray *record_arena, uint32_t flags,
+                    uint64_t *leaf_hint = 0);
 
-    // Inserts (or updates) a key/record in the index (ups_db_insert)
+    // Inserts (or updates) a key/record in the index (ups_db_insert).
+    // |leaf_hint| is used like in find() (ups_db_insert_many)
     ups_status_t insert(Context *context, LocalCursor *cursor, ups_key_t *key,
-                    ups_record_t *record, uint32_t flags);
+                    ups_record_t *record, uint32_t flags,
+                    uint64_t *leaf_hint = 0);
 
     // Erases a key/record from the index (ups_db_erase).
     // If |duplicate_index| is 0 then all duplicates are erased, otherwise only
@@ -313,6 +367,31 @@ class BtreeIndex
     ups_status_t erase(Context *context, LocalCursor *cursor, ups_key_t *key,
                     int duplicate_index, uint32_t flags);
 
+    // Merges underfull leaves with their right siblings (see Janitor).
+    // Starts at the leaf which covers |resume_key| (or at the left-most
+    // leaf if |resume_key| is empty), and stops after |max_visits| leaves
+    // were checked or |max_merges| leaves were merged. Then stores the
+    // position for the next call in |resume_key|.
+    // Returns true if the right-most leaf was reached.
+    bool compact(Context *context, ByteArray *resume_key, size_t max_visits,
+                    size_t max_merges);
+
+    // Splits the leaves into at least |min_chunks| ranges (if the tree is
+    // large enough) by using the separator keys of the internal nodes.
+    // Returns false if the root node is a leaf.
+    bool partition(Context *context, size_t min_chunks,
+                    std::vector<BtreeScanChunk> *chunks);
+
+    // Scans the leaves of |chunks[index]| with |visitor|. Can be called from
+    // several threads at the same time. Leaves which overlap with any of the
+    // (sorted) |txn_keys| are skipped; their key range is appended to
+    // |skipped|, and has to be scanned with a regular Cursor.
+    void scan_chunk(Context *context,
+                    const std::vector<BtreeScanChunk> &chunks, size_t index,
+                    ScanVisitor *visitor, bool distinct,
+                    const std::vector<ups_key_t *> &txn_keys,
+                    std::vector<BtreeScanRange> *skipped);
+
     // Iterates over the whole index and calls |visitor| on every node
     void visit_nodes(Context *context, BtreeVisitor &visitor,
                     bool visit_internal_nodes);
@@ -341,6 +420,12 @@ class BtreeIndex
       if (page->get_node_proxy())
         return (page->get_node_proxy());
 
+      // concurrent readers can share the same page; make sure that the
+      // proxy is created only once
+      ScopedSpinlock lock(m_mutex);
+      if (page->get_node_proxy())
+        return (page->get_node_proxy());
+
       BtreeNodeProxy *proxy;
       PBtreeNode *node = PBtreeNode::from_page(page);
       if (node->is_leaf())
@@ -375,8 +460,10 @@ class BtreeIndex
     }
 
   private:
+    friend class BtreeBulkLoader;
     friend class BtreeUpdateAction;
     friend class BtreeCheckAction;
+    friend class BtreeCompactAction;
     friend class BtreeEnumAction;
     friend class BtreeEraseAction;
     friend class BtreeFindAction;
@@ -452,6 +539,10 @@ class BtreeIndex
     // the btree statistics
     BtreeStatistics m_statistics;
 
+    // protects the creation of node proxies and the cursor lists of the
+    // pages against concurrent readers
+    Spinlock m_mutex;
+
     // usage metrics - number of page splits
     static uint64_t ms_btree_smo_split;
 
@@ -52,11 +52,12 @@ class BtreeInsertAction : public BtreeUpdateAction
 {
   public:
     BtreeInsertAction(BtreeIndex *btree, Context *context, LocalCursor *cursor,
-                    ups_key_t *key, ups_record_t *record, uint32_t flags)
+                    ups_key_t *key, ups_record_t *record, uint32_t flags,
+                    uint64_t *leaf_hint)
       : BtreeUpdateAction(btree, context, cursor
                                             ? cursor->get_btree_cursor()
                                             : 0, 0),
-        m_key(key), m_record(record), m_flags(flags) {
+        m_key(key), m_record(record), m_flags(flags), m_leaf_hint(leaf_hint) {
       if (m_cursor)
         m_duplicate_index = m_cursor->get_duplicate_index();
     }
@@ -82,7 +83,9 @@ class BtreeInsertAction : public BtreeUpdateAction
        * flag and call insert()
        */
       ups_status_t st;
-      if (m_hints.leaf_page_addr
+      if (m_leaf_hint && *m_leaf_hint)
+        st = insert_in_hinted_leaf();
+      else if (m_hints.leaf_page_addr
           && (m_hints.flags & UPS_HINT_APPEND
               || m_hints.flags & UPS_HINT_PREPEND))
         st = append_or_prepend_key();
@@ -102,10 +105,47 @@ class BtreeInsertAction : public BtreeUpdateAction
                   m_hints.processed_slot);
       }
 
+      if (m_leaf_hint)
+        *m_leaf_hint = (st == 0 && m_hints.processed_leaf_page)
+                          ? m_hints.processed_leaf_page->get_address()
+                          : 0;
+
       return (st);
     }
 
   private:
+    // Inserts the key in the leaf which received the previous key of a
+    // batch, if the key belongs to this leaf. Otherwise performs a
+    // regular insert.
+    ups_status_t insert_in_hinted_leaf() {
+      LocalDatabase *db = m_btree->get_db();
+      LocalEnvironment *env = db->lenv();
+
+      Page *page = env->page_manager()->fetch(m_context, *m_leaf_hint,
+                      PageManager::kOnlyFromCache);
+      if (!page
+              || page->get_db() != db
+              || (page->get_type() != Page::kTypeBroot
+                  && page->get_type() != Page::kTypeBindex))
+        return (insert());
+
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+      if (!node->is_leaf()
+              || node->get_count() == 0
+              || node->requires_split(m_context, m_key))
+        return (insert());
+
+      /* keys which are smaller than the first key (or larger than the
+       * last key) can belong to a sibling */
+      if (node->get_left() != 0 && node->compare(m_context, m_key, 0) < 0)
+        return (insert());
+      if (node->get_right() != 0
+              && node->compare(m_context, m_key, node->get_count() - 1) > 0)
+        return (insert());
+
+      return (insert_in_page(page, m_key, m_record, m_hints));
+    }
+
     // Appends a key at the "end" of the btree, or prepends it at the
     // "beginning"
     ups_status_t append_or_prepend_key() {
@@ -202,11 +242,14 @@ class BtreeInsertAction : public BtreeUpdateAction
 
     // statistical hints for this operation
     BtreeStatistics::InsertHints m_hints;
+
+    // the leaf of the previous insert operation of a batch; can be null
+    uint64_t *m_leaf_hint;
 };
 
 ups_status_t
 BtreeIndex::insert(Context *context, LocalCursor *cursor, ups_key_t *key,
-                ups_record_t *record, uint32_t flags)
+                ups_record_t *record, uint32_t flags, uint64_t *leaf_hint)
 {
   context->db = get_db();
 
@@ -215,7 +258,8 @@ BtreeIndex::insert(Context *context, LocalCursor *cursor, ups_key_t *key,
               key ? EventLog::escape(key->data, key->size) : "",
               record->size, flags));
 
-  BtreeInsertAction bia(this, context, cursor, key, record, flags);
+  BtreeInsertAction bia(this, context, cursor, key, record, flags,
+                  leaf_hint);
   return (bia.run());
 }
 
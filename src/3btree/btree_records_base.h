@@ -56,6 +56,12 @@ struct BaseRecordList
                         m_range_size);
   }
 
+  // Returns a pointer to the records if they are stored in an array of
+  // fixed-length records (see ScanVisitor); otherwise returns NULL
+  const uint8_t *get_record_array() const {
+    return (0);
+  }
+
   // The size of the range (in bytes)
   size_t m_range_size;
 };
@@ -173,6 +173,11 @@ class InlineRecordList : public BaseRecordList
                       m_record_size * (node_count - sstart));
     }
 
+    // Returns a pointer to the array of records
+    const uint8_t *get_record_array() const {
+      return (m_data);
+    }
+
     // Returns the record id. Not required for fixed length leaf nodes
     uint64_t get_record_id(int slot, int duplicate_index = 0)
                     const {
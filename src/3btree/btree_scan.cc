@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Parallel scans; splits the leaves into chunks and scans them
+ */
+
+#include "0root/root.h"
+
+#include <algorithm>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/dynamic_array.h"
+#include "3page_manager/page_manager.h"
+#include "3btree/btree_index.h"
+#include "3btree/btree_node_proxy.h"
+#include "3btree/btree_visitor.h"
+#include "4context/context.h"
+#include "4db/db_local.h"
+#include "4env/env_local.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+// Orders ups_key_t pointers with the compare function of the btree
+struct ScanKeyCompare
+{
+  ScanKeyCompare(BtreeIndex *btree_)
+    : btree(btree_) {
+  }
+
+  bool operator()(ups_key_t *lhs, ups_key_t *rhs) const {
+    return (btree->compare_keys(lhs, rhs) < 0);
+  }
+
+  BtreeIndex *btree;
+};
+
+class BtreeScanAction
+{
+  public:
+    BtreeScanAction(BtreeIndex *btree, Context *context)
+      : m_btree(btree), m_context(context) {
+    }
+
+    bool partition(size_t min_chunks, std::vector<BtreeScanChunk> *chunks) {
+      Page *page = fetch(m_btree->root_address());
+      if (m_btree->get_node_from_page(page)->is_leaf())
+        return (false);
+
+      // walk down level by level and collect the children of each level;
+      // the left-most child inherits the separator of its parent. Stop as
+      // soon as there are enough chunks, or if the leaves are reached
+      std::vector<BtreeScanChunk> level(1);
+      level[0].leaf = m_btree->root_address();
+
+      while (true) {
+        std::vector<BtreeScanChunk> children;
+        for (size_t i = 0; i < level.size(); i++) {
+          BtreeNodeProxy *node = m_btree->get_node_from_page(
+                          fetch(level[i].leaf));
+
+          children.push_back(level[i]);
+          children.back().leaf = node->get_ptr_down();
+
+          for (size_t slot = 0; slot < node->get_count(); slot++) {
+            children.push_back(BtreeScanChunk());
+            BtreeScanChunk &chunk = children.back();
+            chunk.leaf = node->get_record_id(m_context, (int)slot);
+            copy_key(node, (int)slot, &chunk.pivot);
+            chunk.pivot.inclusive = true;
+          }
+        }
+        level.swap(children);
+
+        if (level.size() >= min_chunks
+              || m_btree->get_node_from_page(fetch(level[0].leaf))->is_leaf())
+          break;
+      }
+
+      // then move to the left-most leaf of each chunk
+      for (size_t i = 0; i < level.size(); i++) {
+        BtreeNodeProxy *node = m_btree->get_node_from_page(
+                        fetch(level[i].leaf));
+        while (!node->is_leaf()) {
+          level[i].leaf = node->get_ptr_down();
+          node = m_btree->get_node_from_page(fetch(level[i].leaf));
+        }
+      }
+
+      chunks->swap(level);
+      return (true);
+    }
+
+    void scan_chunk(const std::vector<BtreeScanChunk> &chunks, size_t index,
+                    ScanVisitor *visitor, bool distinct,
+                    const std::vector<ups_key_t *> &txn_keys,
+                    std::vector<BtreeScanRange> *skipped) {
+      PageManager *page_manager = m_btree->get_db()->lenv()->page_manager();
+      uint64_t end = index + 1 < chunks.size() ? chunks[index + 1].leaf : 0;
+
+      // the key range of a leaf starts after the last key of its left
+      // sibling (or at the pivot of the chunk), and ends with its own last
+      // key (or before the pivot of the next chunk). Therefore the ranges
+      // of all leaves cover the whole key space without gaps
+      BtreeScanBound low = chunks[index].pivot;
+      uint64_t address = chunks[index].leaf;
+      bool was_skipped = false;
+
+      while (address != 0 && address != end) {
+        BtreeNodeProxy *node = m_btree->get_node_from_page(fetch(address,
+                                PageManager::kReadAhead));
+        address = node->get_right();
+        bool is_last = (address == 0 || address == end);
+
+        // an empty leaf is merged with the range of its right sibling
+        if (node->get_count() == 0 && !is_last) {
+          m_context->changeset.clear();
+          continue;
+        }
+
+        BtreeScanBound high;
+        if (!is_last) {
+          copy_key(node, (int)node->get_count() - 1, &high);
+          high.inclusive = true;
+        }
+        else if (index + 1 < chunks.size()) {
+          high = chunks[index + 1].pivot;
+          high.inclusive = false;
+        }
+
+        // leaves which are modified by Transactions are scanned later
+        bool skip = overlaps(txn_keys, low, high);
+        if (skip && was_skipped)
+          skipped->back().high = high;
+        else if (skip) {
+          skipped->push_back(BtreeScanRange());
+          skipped->back().low = low;
+          skipped->back().high = high;
+        }
+        else
+          node->scan(m_context, visitor, 0, distinct);
+        was_skipped = skip;
+
+        low = high;
+        low.inclusive = !high.inclusive;
+
+        // release the page, otherwise the changeset grows with each leaf
+        m_context->changeset.clear();
+        page_manager->purge_cache(m_context);
+      }
+    }
+
+  private:
+    // Fetches a page for reading
+    Page *fetch(uint64_t address, uint32_t flags = 0) {
+      PageManager *page_manager = m_btree->get_db()->lenv()->page_manager();
+      return (page_manager->fetch(m_context, address,
+                              PageManager::kReadOnly | flags));
+    }
+
+    // Copies the key at |slot| to |bound|
+    void copy_key(BtreeNodeProxy *node, int slot, BtreeScanBound *bound) {
+      ups_key_t key = {0};
+      node->get_key(m_context, slot, &m_arena, &key);
+      const uint8_t *p = (const uint8_t *)key.data;
+      bound->key.assign(p, p + key.size);
+      bound->is_set = true;
+    }
+
+    // Returns true if any of the (sorted) |keys| is in the range
+    // between |low| and |high|
+    bool overlaps(const std::vector<ups_key_t *> &keys,
+                    const BtreeScanBound &low, const BtreeScanBound &high) {
+      if (keys.empty())
+        return (false);
+
+      ScanKeyCompare cmp(m_btree);
+      std::vector<ups_key_t *>::const_iterator it = keys.begin();
+      if (low.is_set) {
+        ups_key_t key = make_key(low);
+        it = low.inclusive
+                ? std::lower_bound(keys.begin(), keys.end(), &key, cmp)
+                : std::upper_bound(keys.begin(), keys.end(), &key, cmp);
+      }
+      if (it == keys.end())
+        return (false);
+      if (!high.is_set)
+        return (true);
+
+      ups_key_t key = make_key(high);
+      int c = m_btree->compare_keys(*it, &key);
+      return (high.inclusive ? c <= 0 : c < 0);
+    }
+
+    // Returns a key structure which points to the data of |bound|
+    static ups_key_t make_key(const BtreeScanBound &bound) {
+      ups_key_t key = {0};
+      key.data = bound.key.empty() ? 0 : (void *)&bound.key[0];
+      key.size = (uint16_t)bound.key.size();
+      return (key);
+    }
+
+    BtreeIndex *m_btree;
+    Context *m_context;
+    ByteArray m_arena;
+};
+
+bool
+BtreeIndex::partition(Context *context, size_t min_chunks,
+                std::vector<BtreeScanChunk> *chunks)
+{
+  BtreeScanAction bsa(this, context);
+  return (bsa.partition(min_chunks, chunks));
+}
+
+void
+BtreeIndex::scan_chunk(Context *context,
+                const std::vector<BtreeScanChunk> &chunks, size_t index,
+                ScanVisitor *visitor, bool distinct,
+                const std::vector<ups_key_t *> &txn_keys,
+                std::vector<BtreeScanRange> *skipped)
+{
+  BtreeScanAction bsa(this, context);
+  bsa.scan_chunk(chunks, index, visitor, distinct, txn_keys, skipped);
+}
+
+} // namespace upscaledb
@@ -100,7 +100,6 @@ class BtreeUpdateAction
     // 1-based (if 0 then this update is not for a duplicate)
     uint32_t m_duplicate_index;
 
-  private:
     /* Merges the |sibling| into |page|, returns the merged page and moves
      * the sibling to the freelist */ 
     Page *merge_page(Page *page, Page *sibling);
@@ -77,7 +77,8 @@ class BtreeVisitAction
 
         // follow the pointer to the smallest child
         if (ptr_down)
-          page = env->page_manager()->fetch(m_context, ptr_down, pm_flags);
+          page = env->page_manager()->fetch(m_context, ptr_down,
+                          pm_flags | PageManager::kReadAhead);
         else
           break;
       }
@@ -93,7 +94,8 @@ class BtreeVisitAction
 
         /* follow the pointer to the right sibling */
         if (right)
-          page = env->page_manager()->fetch(m_context, right, pm_flags);
+          page = env->page_manager()->fetch(m_context, right,
+                          pm_flags | PageManager::kReadAhead);
         else
           break;
       }
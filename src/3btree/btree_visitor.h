@@ -39,7 +39,28 @@ namespace upscaledb {
 // The ScanVisitor is the callback implementation for the scan call.
 // It will either receive single keys or multiple keys in an array.
 //
+// If requires_records() returns true then the visitor receives the keys
+// together with their records (and each duplicate separately). Fixed-length
+// records which are stored in the leaf are passed as an array, without
+// copying them.
+//
+// A parallel scan uses one clone() of the visitor for each range of
+// leaves, and then merges their results with combine().
+//
 struct ScanVisitor {
+  virtual ~ScanVisitor() {
+  }
+
+  // Returns a new visitor of the same type with an empty result, or NULL
+  // if the visitor does not support parallel scans
+  virtual ScanVisitor *clone() const {
+    return (0);
+  }
+
+  // Adds the result of |other| (a clone() of this visitor) to this visitor
+  virtual void combine(const ScanVisitor *other) {
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   size_t duplicate_count) = 0;
@@ -47,6 +68,22 @@ struct ScanVisitor {
   // Operates on an array of keys
   virtual void operator()(const void *key_array, size_t key_count) = 0;
 
+  // Returns true if the visitor operates on the records
+  virtual bool requires_records() const {
+    return (false);
+  }
+
+  // Operates on a single key and one of its records
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  const void *record_data, uint32_t record_size) {
+  }
+
+  // Operates on an array of keys and the array of their records; all
+  // records have the fixed record size of the database
+  virtual void operator()(const void *key_array, const void *record_array,
+                  size_t count) {
+  }
+
   // Assigns the internal result to |result|
   virtual void assign_result(uqi_result_t *result) = 0;
 };
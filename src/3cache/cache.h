@@ -18,12 +18,26 @@
 /*
  * The Cache Manager
  *
- * Stores pages in a non-intrusive hash table (each Page instance keeps
- * next/previous pointers for the overflow bucket). Can efficiently purge
- * unused pages, because all pages are also stored in a (non-intrusive)
- * linked list, and whenever a page is accessed it is removed and re-inserted
- * at the head. The tail therefore points to the page which was not used
- * in a long time, and is the primary candidate for purging.
+ * The cache is split into UPS_CACHE_SHARDS independent shards; the shard
+ * of a page is selected by its page id (address / page size). Each shard
+ * has its own lock, its own hash table and its own replacement lists,
+ * therefore lookups of different pages do not serialize on a single list.
+ *
+ * Each shard stores its pages in a non-intrusive hash table (each Page
+ * instance keeps next/previous pointers for the overflow bucket) and in
+ * (non-intrusive) linked lists which implement the replacement policy:
+ *
+ * - UPS_CACHE_POLICY_LRU: whenever a page is accessed it is removed and
+ *   re-inserted at the head of the "hot" list. The tail therefore points
+ *   to the page which was not used in a long time, and is the primary
+ *   candidate for purging.
+ *
+ * - UPS_CACHE_POLICY_2Q: new pages are first stored in a FIFO queue
+ *   ("A1in"). If they are purged from this queue then their address is
+ *   remembered in a "ghost" list ("A1out"). Only pages which are loaded
+ *   again while their address is still in the ghost list are moved to
+ *   the LRU list ("Am"). A single scan over the whole file therefore
+ *   cannot evict the hot working set.
  *
  * @exception_safe: nothrow
  * @thread_safe: yes
@@ -34,11 +48,14 @@
 
 #include "0root/root.h"
 
+#include <map>
+#include <deque>
 #include <vector>
 
 #include "ups/upscaledb_int.h"
 
 // Always verify that a file of level N does not include headers > N!
+#include "1base/spinlock.h"
 #include "2page/page.h"
 #include "2page/page_collection.h"
 #include "2config/env_config.h"
@@ -62,29 +79,124 @@ class Cache
     };
 
     enum {
-      // The number of buckets should be a prime number or similar, as it
-      // is used in a MODULO hash scheme
-      kBucketSize = 10317,
+      // The number of shards
+      kShards = UPS_CACHE_SHARDS,
+
+      // The number of buckets per shard should be a prime number or similar,
+      // as it is used in a MODULO hash scheme
+      kBucketSize = 1289,
+    };
+
+    // The remembered addresses of pages which were purged from the A1in
+    // queue (2Q only). Each address is stored with a sequence number,
+    // otherwise an outdated entry at the front of the queue would remove
+    // an address which was re-inserted later.
+    struct GhostList {
+      GhostList()
+        : sequence(0) {
+      }
+
+      // Returns true if |address| is stored; removes it from the list
+      bool remove(uint64_t address) {
+        return (map.erase(address) > 0);
+      }
+
+      // Stores an |address|; evicts the oldest entries if there are more
+      // than |limit|
+      void put(uint64_t address, size_t limit) {
+        sequence++;
+        map[address] = sequence;
+        queue.push_back(std::make_pair(address, sequence));
+        while (map.size() > limit && !queue.empty()) {
+          std::map<uint64_t, uint64_t>::iterator it
+                  = map.find(queue.front().first);
+          if (it != map.end() && it->second == queue.front().second)
+            map.erase(it);
+          queue.pop_front();
+        }
+        // drop outdated entries if the queue grows too large
+        if (queue.size() > 2 * limit + 16) {
+          std::deque<std::pair<uint64_t, uint64_t> > tmp;
+          for (size_t i = 0; i < queue.size(); i++) {
+            std::map<uint64_t, uint64_t>::iterator it
+                    = map.find(queue[i].first);
+            if (it != map.end() && it->second == queue[i].second)
+              tmp.push_back(queue[i]);
+          }
+          queue.swap(tmp);
+        }
+      }
+
+      std::map<uint64_t, uint64_t> map;
+      std::deque<std::pair<uint64_t, uint64_t> > queue;
+      uint64_t sequence;
+    };
+
+    struct Shard {
+      Shard()
+        : hot(Page::kListCache), in(Page::kListCache),
+          buckets(kBucketSize), alloc_elements(0), cache_hits(0),
+          cache_misses(0) {
+      }
+
+      // Returns the number of cached pages
+      size_t size() const {
+        return (hot.size() + in.size());
+      }
+
+      // protects all members of this shard
+      Spinlock mutex;
+
+      // the LRU list ("Am" for 2Q, and the only list for LRU)
+      PageCollection hot;
+
+      // the FIFO queue for new pages (2Q only)
+      PageCollection in;
+
+      // addresses of pages that were purged from |in| (2Q only)
+      GhostList ghosts;
+
+      // The hash table buckets - each is a linked list of Page pointers
+      std::vector<CacheLine> buckets;
+
+      // the current number of cached elements that were allocated (and not
+      // mapped)
+      size_t alloc_elements;
+
+      // counts the cache hits
+      uint64_t cache_hits;
+
+      // counts the cache misses
+      uint64_t cache_misses;
     };
 
     template<typename Purger>
     struct PurgeIfSelector
     {
-      PurgeIfSelector(Cache *cache, Purger &purger)
-        : m_cache(cache), m_purger(purger) {
+      PurgeIfSelector(Cache *cache, Shard &shard, Purger &purger)
+        : m_cache(cache), m_shard(shard), m_purger(purger) {
       }
 
       bool operator()(Page *page) {
         if (m_purger(page))
-          m_cache->del(page);
+          m_cache->del_impl(m_shard, page);
         // don't remove page from list; it was already removed above
         return (false);
       }
 
       Cache *m_cache;
+      Shard &m_shard;
       Purger &m_purger;
     };
 
+    // Accepts every page; used by |get()|
+    struct AcceptAll
+    {
+      bool operator()(Page *) {
+        return (true);
+      }
+    };
+
   public:
     // The default constructor
     Cache(const EnvironmentConfiguration &config)
@@ -92,105 +204,146 @@ class Cache
                             ? 0xffffffffffffffffull
                             : config.cache_size_bytes),
         m_page_size_bytes(config.page_size_bytes),
-        m_alloc_elements(0), m_totallist(Page::kListCache),
-        m_buckets(kBucketSize), m_cache_hits(0), m_cache_misses(0) {
+        m_policy(config.cache_policy) {
       ups_assert(m_capacity_bytes > 0);
+      uint64_t pages = m_capacity_bytes / m_page_size_bytes;
+      m_shard_capacity = (size_t)(pages / kShards);
+      if (pages % kShards)
+        m_shard_capacity++;
     }
 
     // Fills in the current metrics
     void fill_metrics(ups_env_metrics_t *metrics) const {
-      metrics->cache_hits = m_cache_hits;
-      metrics->cache_misses = m_cache_misses;
+      metrics->cache_hits = 0;
+      metrics->cache_misses = 0;
+      for (int i = 0; i < kShards; i++) {
+        metrics->cache_shard_hits[i] = m_shards[i].cache_hits;
+        metrics->cache_shard_misses[i] = m_shards[i].cache_misses;
+        metrics->cache_hits += m_shards[i].cache_hits;
+        metrics->cache_misses += m_shards[i].cache_misses;
+      }
     }
 
     // Retrieves a page from the cache, also removes the page from the cache
     // and re-inserts it at the front. Returns null if the page was not cached.
     Page *get(uint64_t address) {
-      size_t hash = calc_hash(address);
+      AcceptAll accept;
+      return (get_impl(address, accept, true));
+    }
 
-      Page *page = m_buckets[hash].get(address);
-      if (!page) {
-        m_cache_misses++;
-        return (0);
-      }
+    // Same as |get()|, but returns the page only if |acceptor(page)| returns
+    // true. |acceptor| is called while the shard is locked, and therefore
+    // must not block. Misses are not counted because the caller is expected
+    // to fall back to |get()|.
+    template<typename Acceptor>
+    Page *get_if(uint64_t address, Acceptor &acceptor) {
+      return (get_impl(address, acceptor, false));
+    }
 
-      // Now re-insert the page at the head of the "totallist", and
-      // thus move far away from the tail. The pages at the tail are highest
-      // candidates to be deleted when the cache is purged.
-      m_totallist.del(page);
-      m_totallist.put(page);
-      m_cache_hits++;
-      return (page);
+    // Returns true if a page is cached; does not update the replacement
+    // lists or the statistics
+    bool contains(uint64_t address) {
+      Shard &shard = m_shards[calc_shard(address)];
+      ScopedSpinlock lock(shard.mutex);
+      return (shard.buckets[calc_hash(address)].get(address) != 0);
     }
 
     // Stores a page in the cache
     void put(Page *page) {
       ups_assert(page->get_data());
-      size_t hash = calc_hash(page->get_address());
+      Shard &shard = m_shards[calc_shard(page->get_address())];
+      ScopedSpinlock lock(shard.mutex);
 
       /* First remove the page from the cache, if it's already cached
        *
        * Then re-insert the page at the head of the list. The tail will
        * point to the least recently used page.
        */
-      m_totallist.del(page);
-      m_totallist.put(page);
-      if (page->is_allocated())
-        m_alloc_elements++;
+      switch (page->get_cache_queue()) {
+        case Page::kCacheQueueHot:
+          shard.hot.del(page);
+          shard.hot.put(page);
+          break;
+        case Page::kCacheQueueIn:
+          break;
+        default:
+          if (m_policy == UPS_CACHE_POLICY_2Q
+                  && !shard.ghosts.remove(page->get_address())) {
+            shard.in.put(page);
+            page->set_cache_queue(Page::kCacheQueueIn);
+          }
+          else {
+            shard.hot.put(page);
+            page->set_cache_queue(Page::kCacheQueueHot);
+          }
+          if (page->is_allocated())
+            shard.alloc_elements++;
+          break;
+      }
 
-      m_buckets[hash].put(page);
+      shard.buckets[calc_hash(page->get_address())].put(page);
     }
 
     // Removes a page from the cache
     void del(Page *page) {
       ups_assert(page->get_address() != 0);
-
-      /* remove it from the list of all cached pages */
-      if (m_totallist.del(page) && page->is_allocated())
-        m_alloc_elements--;
-
-      /* remove the page from the cache buckets */
-      size_t hash = calc_hash(page->get_address());
-      m_buckets[hash].del(page);
+      Shard &shard = m_shards[calc_shard(page->get_address())];
+      ScopedSpinlock lock(shard.mutex);
+      del_impl(shard, page);
     }
 
-    // Purges the cache. Implements a LRU eviction algorithm. Dirty pages are
-    // forwarded to the |processor()| for flushing.
+    // Purges the cache. Implements the LRU or 2Q eviction algorithm,
+    // separately for each shard. Dirty pages are forwarded to the
+    // |processor()| for flushing.
     void purge_candidates(std::vector<uint64_t> &candidates,
                     std::vector<Page *> &garbage,
                     Page *ignore_page) {
-      int limit = (int)(current_elements()
-                        - (m_capacity_bytes / m_page_size_bytes));
-
-      Page *page = m_totallist.tail();
-      for (int i = 0; i < limit && page != 0; i++) {
-        if (page->mutex().try_lock()) {
-          if (page->cursor_list() == 0 && page != ignore_page) {
-            if (page->is_dirty())
-              candidates.push_back(page->get_address());
-            else
-              garbage.push_back(page);
+      for (int s = 0; s < kShards; s++) {
+        Shard &shard = m_shards[s];
+        ScopedSpinlock lock(shard.mutex);
+
+        int limit = (int)shard.size() - (int)m_shard_capacity;
+        if (limit <= 0)
+          continue;
+
+        // 2Q: first purge from the FIFO queue, as long as it exceeds
+        // its share of the capacity
+        if (m_policy == UPS_CACHE_POLICY_2Q) {
+          int in_limit = shard.hot.is_empty()
+                            ? limit
+                            : (int)shard.in.size() - (int)(m_shard_capacity / 4);
+          if (in_limit > limit)
+            in_limit = limit;
+          if (in_limit > 0) {
+            select_candidates(shard.in, in_limit, candidates, garbage,
+                            ignore_page);
+            limit -= in_limit;
           }
-          page->mutex().unlock();
         }
 
-        page = page->get_previous(Page::kListCache);
+        if (limit > 0)
+          select_candidates(shard.hot, limit, candidates, garbage,
+                          ignore_page);
       }
     }
 
-    // Visits all pages in the "totallist". If |cb| returns true then the
+    // Visits all cached pages. If |cb| returns true then the
     // page is removed and deleted. This is used by the Environment
     // to flush (and delete) pages.
     template<typename Purger>
     void purge_if(Purger &purger) {
-      PurgeIfSelector<Purger> selector(this, purger);
-      m_totallist.extract(selector);
+      for (int s = 0; s < kShards; s++) {
+        Shard &shard = m_shards[s];
+        ScopedSpinlock lock(shard.mutex);
+        PurgeIfSelector<Purger> selector(this, shard, purger);
+        shard.in.extract(selector);
+        shard.hot.extract(selector);
+      }
     }
 
     // Returns true if the capacity limits are exceeded
     bool is_cache_full() {
-      return (m_totallist.size() * m_page_size_bytes
-                    > m_capacity_bytes);
+      return (current_elements() * m_page_size_bytes > m_capacity_bytes);
     }
 
     // Returns the capacity (in bytes)
@@ -200,19 +353,107 @@ class Cache
 
     // Returns the number of currently cached elements
     size_t current_elements() {
-      return (m_totallist.size());
+      size_t size = 0;
+      for (int s = 0; s < kShards; s++)
+        size += m_shards[s].size();
+      return (size);
     }
 
     // Returns the number of currently cached elements (excluding those that
     // are mmapped)
     size_t allocated_elements() {
-      return (m_alloc_elements);
+      size_t size = 0;
+      for (int s = 0; s < kShards; s++)
+        size += m_shards[s].alloc_elements;
+      return (size);
     }
 
   private:
-    // Calculates the hash of a page address
-    size_t calc_hash(uint64_t value) const {
-      return ((size_t)(value % Cache::kBucketSize));
+    // Implementation of |get()| and |get_if()|
+    template<typename Acceptor>
+    Page *get_impl(uint64_t address, Acceptor &acceptor, bool count_misses) {
+      Shard &shard = m_shards[calc_shard(address)];
+      ScopedSpinlock lock(shard.mutex);
+
+      Page *page = shard.buckets[calc_hash(address)].get(address);
+      if (!page) {
+        if (count_misses)
+          shard.cache_misses++;
+        return (0);
+      }
+
+      if (!acceptor(page))
+        return (0);
+
+      // Now re-insert the page at the head of the LRU list, and
+      // thus move far away from the tail. The pages at the tail are highest
+      // candidates to be deleted when the cache is purged. Pages in the
+      // FIFO queue are not moved.
+      if (page->get_cache_queue() == Page::kCacheQueueHot) {
+        shard.hot.del(page);
+        shard.hot.put(page);
+      }
+      shard.cache_hits++;
+      return (page);
+    }
+
+    // Removes a page from the cache; the shard is already locked
+    void del_impl(Shard &shard, Page *page) {
+      ups_assert(page->get_address() != 0);
+
+      /* remove it from the list of all cached pages */
+      bool removed = false;
+      switch (page->get_cache_queue()) {
+        case Page::kCacheQueueHot:
+          removed = shard.hot.del(page);
+          break;
+        case Page::kCacheQueueIn:
+          removed = shard.in.del(page);
+          // remember the address; if the page is loaded again soon then
+          // it will be stored in the LRU list
+          if (removed)
+            shard.ghosts.put(page->get_address(), m_shard_capacity / 2 + 1);
+          break;
+        default:
+          break;
+      }
+      page->set_cache_queue(Page::kCacheQueueNone);
+      if (removed && page->is_allocated())
+        shard.alloc_elements--;
+
+      /* remove the page from the cache buckets */
+      shard.buckets[calc_hash(page->get_address())].del(page);
+    }
+
+    // Collects up to |limit| purge candidates, starting at the tail of |list|
+    void select_candidates(PageCollection &list, int limit,
+                    std::vector<uint64_t> &candidates,
+                    std::vector<Page *> &garbage, Page *ignore_page) {
+      Page *page = list.tail();
+      for (int i = 0; i < limit && page != 0; i++) {
+        if (page->mutex().try_lock()) {
+          if (page->cursor_list() == 0 && page != ignore_page) {
+            if (page->is_dirty())
+              candidates.push_back(page->get_address());
+            else
+              garbage.push_back(page);
+          }
+          page->mutex().unlock();
+        }
+
+        page = page->get_previous(Page::kListCache);
+      }
+    }
+
+    // Calculates the shard of a page address
+    size_t calc_shard(uint64_t address) const {
+      return ((size_t)((address / m_page_size_bytes) % Cache::kShards));
+    }
+
+    // Calculates the hash of a page address (within its shard)
+    size_t calc_hash(uint64_t address) const {
+      return ((size_t)((address / m_page_size_bytes / Cache::kShards)
+                              % Cache::kBucketSize));
     }
 
     // the capacity (in bytes)
@@ -221,21 +462,14 @@ class Cache
     // the current page size (in bytes)
     uint64_t m_page_size_bytes;
 
-    // the current number of cached elements that were allocated (and not
-    // mapped)
-    size_t m_alloc_elements;
-
-    // linked list of ALL cached pages
-    PageCollection m_totallist;
-
-    // The hash table buckets - each is a linked list of Page pointers
-    std::vector<CacheLine> m_buckets;
+    // the replacement policy (UPS_CACHE_POLICY_LRU or UPS_CACHE_POLICY_2Q)
+    int m_policy;
 
-    // counts the cache hits
-    uint64_t m_cache_hits;
+    // the capacity of each shard (in pages)
+    size_t m_shard_capacity;
 
-    // counts the cache misses
-    uint64_t m_cache_misses;
+    // the shards
+    Shard m_shards[kShards];
 };
 
 } // namespace upscaledb
@@ -56,9 +56,16 @@ struct FlushChangesetVisitor
 
 static void
 async_flush_changeset(std::vector<Page::PersistedData *> list,
-                Device *device, Journal *journal, uint64_t lsn,
-                bool enable_fsync, int fd_index)
+                PageManager *page_manager, Device *device, Journal *journal,
+                uint64_t lsn, bool enable_fsync, int fd_index,
+                uint64_t journal_seqnum)
 {
+  /* write-ahead logging: if the journal was not yet synced then sync it
+   * before the pages are modified on disk. The pages are still locked,
+   * therefore do not wait for the group commit window */
+  if (journal_seqnum)
+    journal->wait_until_durable(journal_seqnum, true);
+
   std::vector<Page::PersistedData *>::iterator it = list.begin();
   for (; it != list.end(); it++) {
     Page::PersistedData *page_data = *it;
@@ -71,13 +78,18 @@ async_flush_changeset(std::vector<Page::PersistedData *> list,
 
     if (page_data->is_without_header == false)
       page_data->raw_data->header.lsn = lsn;
+  }
 
-    Page::flush(device, page_data);
-    page_data->mutex.unlock();
+  /* write all pages (in parallel, if possible), then unlock them */
+  page_manager->flush_pages(list);
+
+  for (it = list.begin(); it != list.end(); it++) {
+    (*it)->mutex.unlock();
     UPS_INDUCE_ERROR(ErrorInducer::kChangesetFlush);
   }
 
-  /* flush the file handle (if required) */
+  /* flush the file handle (if required); this is done only once for
+   * the whole batch */
   if (enable_fsync)
     device->flush();
 
@@ -88,8 +100,11 @@ async_flush_changeset(std::vector<Page::PersistedData *> list,
 }
 
 void
-Changeset::flush(uint64_t lsn)
+Changeset::flush(uint64_t lsn, bool defer_sync)
 {
+  // read-only operations never modify pages
+  ups_assert(!m_shared);
+
   // now flush all modified pages to disk
   if (m_collection.is_empty())
     return;
@@ -107,7 +122,10 @@ Changeset::flush(uint64_t lsn)
    * "write-ahead logs" all changes. */
   uint64_t last_blob_page_id = m_env->page_manager()->last_blob_page_id();
   int fd_index = m_env->journal()->append_changeset(visitor.list,
-                                        last_blob_page_id, lsn);
+                                        last_blob_page_id, lsn, defer_sync);
+  uint64_t journal_seqnum = defer_sync
+                                ? m_env->journal()->unsynced_seqnum()
+                                : 0;
 
   UPS_INDUCE_ERROR(ErrorInducer::kChangesetFlush);
 
@@ -118,9 +136,10 @@ Changeset::flush(uint64_t lsn)
 
   /* The modified pages are now flushed (and unlocked) asynchronously. */
   m_env->page_manager()->run_async(boost::bind(&async_flush_changeset,
-                          visitor.list, m_env->device(), m_env->journal(), lsn,
+                          visitor.list, m_env->page_manager(),
+                          m_env->device(), m_env->journal(), lsn,
                           (m_env->config().flags & UPS_ENABLE_FSYNC) != 0,
-                          fd_index));
+                          fd_index, journal_seqnum));
 }
 
 } // namespace upscaledb
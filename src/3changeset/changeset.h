@@ -29,6 +29,8 @@
 #include "0root/root.h"
 
 #include <stdlib.h>
+#include <vector>
+#include <algorithm>
 
 // Always verify that a file of level N does not include headers > N!
 #include "2page/page.h"
@@ -57,7 +59,22 @@ class Changeset
 
   public:
     Changeset(LocalEnvironment *env)
-      : m_env(env), m_collection(Page::kListChangeset) {
+      : m_env(env), m_collection(Page::kListChangeset), m_shared(false) {
+    }
+
+    /*
+     * Switches the changeset to "shared" mode: pages are locked with a
+     * shared latch, and several threads can hold the same page. Only
+     * allowed for read-only operations and while the changeset is empty.
+     */
+    void set_shared(bool shared) {
+      ups_assert(is_empty());
+      m_shared = shared;
+    }
+
+    /* Returns true if the pages are locked with a shared latch */
+    bool is_shared() const {
+      return (m_shared);
     }
 
     /*
@@ -65,35 +82,83 @@ class Changeset
      * of the changeset
      */
     Page *get(uint64_t address) {
+      if (m_shared) {
+        for (std::vector<Page *>::iterator it = m_shared_pages.begin();
+                it != m_shared_pages.end(); it++)
+          if ((*it)->get_address() == address)
+            return (*it);
+        return (0);
+      }
       return (m_collection.get(address));
     }
 
     /* Append a new page to the changeset. The page is locked. */
     void put(Page *page) {
+      if (m_shared) {
+        if (!has(page)) {
+          page->mutex().lock_shared();
+          m_shared_pages.push_back(page);
+        }
+        return;
+      }
       if (!has(page)) {
         page->mutex().lock();
       }
       m_collection.put(page);
     }
 
+    /* Same as |put()|, but does not block if the page is locked by
+     * someone else. Returns false if the page could not be locked. */
+    bool try_put(Page *page) {
+      if (has(page))
+        return (true);
+      if (m_shared) {
+        if (!page->mutex().try_lock_shared())
+          return (false);
+        m_shared_pages.push_back(page);
+        return (true);
+      }
+      if (!page->mutex().try_lock())
+        return (false);
+      m_collection.put(page);
+      return (true);
+    }
+
     /* Removes a page from the changeset. The page is unlocked. */
     void del(Page *page) {
+      if (m_shared) {
+        std::vector<Page *>::iterator it = std::find(m_shared_pages.begin(),
+                        m_shared_pages.end(), page);
+        if (it != m_shared_pages.end()) {
+          page->mutex().unlock_shared();
+          m_shared_pages.erase(it);
+        }
+        return;
+      }
       page->mutex().unlock();
       m_collection.del(page);
     }
 
     /* Check if the page is already part of the changeset */
     bool has(Page *page) const {
+      if (m_shared)
+        return (std::find(m_shared_pages.begin(), m_shared_pages.end(), page)
+                        != m_shared_pages.end());
       return (m_collection.has(page));
     }
 
     /* Returns true if the changeset is empty */
     bool is_empty() const {
-      return (m_collection.is_empty());
+      return (m_shared_pages.empty() && m_collection.is_empty());
     }
 
     /* Removes all pages from the changeset. The pages are unlocked. */
     void clear() {
+      for (std::vector<Page *>::iterator it = m_shared_pages.begin();
+              it != m_shared_pages.end(); it++)
+        (*it)->mutex().unlock_shared();
+      m_shared_pages.clear();
+
       UnlockPage unlocker;
       m_collection.for_each(unlocker);
       m_collection.clear();
@@ -102,9 +167,11 @@ class Changeset
     /*
      * Flush all pages in the changeset - first write them to the log, then
      * write them to the disk.
+     * If |defer_sync| is true then the log is not synced immediately
+     * (group commit); the pages are written after the log is durable.
      * On success: will clear the changeset and the journal
      */
-    void flush(uint64_t lsn);
+    void flush(uint64_t lsn, bool defer_sync = false);
 
   private:
     /* The Environment */
@@ -112,6 +179,14 @@ class Changeset
 
     /* The pages which were added to this Changeset */
     PageCollection m_collection;
+
+    /* true if pages are locked with shared latches */
+    bool m_shared;
+
+    /* The pages which were added in shared mode; the intrusive
+     * PageCollection cannot be used because the same page can be part of
+     * several changesets at the same time */
+    std::vector<Page *> m_shared_pages;
 };
 
 } // namespace upscaledb
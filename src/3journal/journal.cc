@@ -189,8 +189,11 @@ Journal::append_txn_commit(LocalTransaction *txn, uint64_t lsn)
 
   append_entry(idx, (uint8_t *)&entry, sizeof(entry));
 
-  // and flush the file
-  flush_buffer(idx, m_state.env->get_flags() & UPS_ENABLE_FSYNC);
+  // and flush the file; the sync is performed in wait_until_durable()
+  if (m_state.env->get_flags() & UPS_ENABLE_FSYNC)
+    flush_buffer_deferred(idx);
+  else
+    flush_buffer(idx);
 
   EVENTLOG_APPEND((m_state.env->config().filename.c_str(),
               "j.txn_commit", "%u, %u", (uint32_t)txn->get_id(),
@@ -354,12 +357,108 @@ Journal::append_erase(Database *db, LocalTransaction *txn, ups_key_t *key,
               (uint32_t)lsn));
 }
 
+void
+Journal::flush_buffer_deferred(int idx)
+{
+  size_t size = m_state.buffer[idx].get_size();
+  if (size == 0)
+    return;
+
+  flush_buffer(idx, false);
+
+  ScopedLock lock(m_state.sync_mutex);
+  m_state.write_seqnum++;
+  m_state.needs_sync[idx] = true;
+  m_state.unsynced_bytes += size;
+
+  // wake up a leader which is waiting for more commits
+  if (m_state.group_commit_bytes > 0
+          && m_state.unsynced_bytes >= m_state.group_commit_bytes)
+    m_state.sync_cond.notify_all();
+}
+
+uint64_t
+Journal::unsynced_seqnum()
+{
+  ScopedLock lock(m_state.sync_mutex);
+  return (m_state.write_seqnum > m_state.durable_seqnum
+            ? m_state.write_seqnum
+            : 0);
+}
+
+void
+Journal::wait_until_durable(uint64_t seqnum, bool urgent)
+{
+  ScopedLock lock(m_state.sync_mutex);
+
+  // wake up a leader which is waiting for more commits
+  if (urgent && m_state.durable_seqnum < seqnum) {
+    m_state.sync_requested = true;
+    m_state.sync_cond.notify_all();
+  }
+
+  while (m_state.durable_seqnum < seqnum) {
+    // another thread is already syncing; wait till it's done, then check
+    // if our writes were included
+    if (m_state.sync_in_progress) {
+      m_state.sync_cond.wait(lock);
+      continue;
+    }
+
+    // otherwise become the leader and sync on behalf of everybody
+    m_state.sync_in_progress = true;
+
+    // give other threads the chance to append their commits
+    if (m_state.group_commit_usec > 0 && !urgent) {
+      boost::system_time deadline = boost::get_system_time()
+              + boost::posix_time::microseconds(m_state.group_commit_usec);
+      while (!m_state.sync_requested
+              && (m_state.group_commit_bytes == 0
+                  || m_state.unsynced_bytes < m_state.group_commit_bytes)) {
+        if (!m_state.sync_cond.timed_wait(lock, deadline))
+          break;
+      }
+    }
+
+    uint64_t target = m_state.write_seqnum;
+    m_state.sync_requested = false;
+    bool needs_sync[2] = {m_state.needs_sync[0], m_state.needs_sync[1]};
+    m_state.needs_sync[0] = m_state.needs_sync[1] = false;
+    m_state.unsynced_bytes = 0;
+    lock.unlock();
+
+    try {
+      for (int i = 0; i < 2; i++) {
+        if (needs_sync[i])
+          m_state.files[i].flush();
+      }
+    }
+    catch (...) {
+      lock.lock();
+      m_state.needs_sync[0] |= needs_sync[0];
+      m_state.needs_sync[1] |= needs_sync[1];
+      m_state.sync_in_progress = false;
+      m_state.sync_cond.notify_all();
+      throw;
+    }
+
+    lock.lock();
+    if (m_state.durable_seqnum < target)
+      m_state.durable_seqnum = target;
+    m_state.sync_in_progress = false;
+    m_state.sync_cond.notify_all();
+  }
+}
+
 int
 Journal::append_changeset(std::vector<Page::PersistedData *> &pages,
-                uint64_t last_blob_page, uint64_t lsn)
+                uint64_t last_blob_page, uint64_t lsn, bool defer_sync)
 {
   ups_assert(pages.size() > 0);
 
+  // decremented in changeset_flushed()
+  m_state.pending_changesets++;
+
   if (m_state.disable_logging)
     return (-1);
 
@@ -402,7 +501,11 @@ Journal::append_changeset(std::vector<Page::PersistedData *> &pages,
   UPS_INDUCE_ERROR(ErrorInducer::kChangesetFlush);
 
   // and flush the file
-  flush_buffer(m_state.current_fd, m_state.env->get_flags() & UPS_ENABLE_FSYNC);
+  if (defer_sync && (m_state.env->get_flags() & UPS_ENABLE_FSYNC))
+    flush_buffer_deferred(m_state.current_fd);
+  else
+    flush_buffer(m_state.current_fd,
+                    m_state.env->get_flags() & UPS_ENABLE_FSYNC);
 
   UPS_INDUCE_ERROR(ErrorInducer::kChangesetFlush);
 
@@ -440,6 +543,7 @@ void
 Journal::changeset_flushed(int fd_index)
 {
   m_state.closed_txn[fd_index]++;
+  m_state.pending_changesets--;
 }
 
 void
@@ -1031,9 +1135,14 @@ Journal::test()
 }
 
 JournalState::JournalState(LocalEnvironment *env)
-  : env(env), current_fd(0), threshold(env->config().journal_switch_threshold),
+  : env(env), current_fd(0), pending_changesets(0),
+    threshold(env->config().journal_switch_threshold),
     disable_logging(false), count_bytes_flushed(0),
-    count_bytes_before_compression(0), count_bytes_after_compression(0)
+    count_bytes_before_compression(0), count_bytes_after_compression(0),
+    write_seqnum(0), durable_seqnum(0), sync_in_progress(false),
+    sync_requested(false), unsynced_bytes(0),
+    group_commit_usec(env->config().group_commit_usec),
+    group_commit_bytes(env->config().group_commit_bytes)
 {
   if (threshold == 0)
     threshold = kSwitchTxnThreshold;
@@ -1042,6 +1151,8 @@ JournalState::JournalState(LocalEnvironment *env)
   open_txn[1] = 0;
   closed_txn[0] = 0;
   closed_txn[1] = 0;
+  needs_sync[0] = false;
+  needs_sync[1] = false;
 }
 
 } // namespace upscaledb
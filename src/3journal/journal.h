@@ -179,7 +179,9 @@ class Journal
     // Appends a journal entry for ups_txn_abort/kEntryTypeTxnAbort
     void append_txn_abort(LocalTransaction *txn, uint64_t lsn);
 
-    // Appends a journal entry for ups_txn_commit/kEntryTypeTxnCommit
+    // Appends a journal entry for ups_txn_commit/kEntryTypeTxnCommit.
+    // With UPS_ENABLE_FSYNC, the file is written but not synced; the caller
+    // has to call |wait_until_durable()| (group commit)
     void append_txn_commit(LocalTransaction *txn, uint64_t lsn);
 
     // Appends a journal entry for ups_insert/kEntryTypeInsert
@@ -194,13 +196,35 @@ class Journal
 
     // Appends a journal entry for a whole changeset/kEntryTypeChangeset
     // Returns the current file descriptor, which is the parameter for
-    // on_changeset_flush()
+    // on_changeset_flush(). If |defer_sync| is true then the file is
+    // not synced (see |wait_until_durable()|)
     int append_changeset(std::vector<Page::PersistedData *> &pages,
-                    uint64_t last_blob_page, uint64_t lsn);
+                    uint64_t last_blob_page, uint64_t lsn,
+                    bool defer_sync = false);
+
+    // Returns the sequence number of the most recent write which is not
+    // yet durable, or 0 if all writes are durable
+    uint64_t unsynced_seqnum();
+
+    // Waits till all writes up to |seqnum| are durable. If no other thread
+    // is currently syncing the files then the caller becomes the "leader"
+    // and syncs them on behalf of all waiting threads. Before syncing, the
+    // leader waits up to UPS_PARAM_GROUP_COMMIT_WINDOW microseconds for
+    // more commits, or till UPS_PARAM_GROUP_COMMIT_BYTES were written.
+    // If |urgent| is true then this window is cut short (used by the
+    // worker thread, which holds page locks while waiting).
+    // Must not be called while the Environment's mutex is locked.
+    void wait_until_durable(uint64_t seqnum, bool urgent = false);
 
     // Called by the worker thread as soon as a changeset was flushed
     void changeset_flushed(int fd_index);
 
+    // Returns true if changesets were appended, but their pages were not
+    // yet written by the worker thread
+    bool has_pending_changesets() const {
+      return (m_state.pending_changesets > 0);
+    }
+
     // Adjusts the transaction counters; called whenever |txn| is flushed.
     void transaction_flushed(LocalTransaction *txn);
 
@@ -320,6 +344,10 @@ class Journal
       }
     }
 
+    // Writes a buffer to disk, but leaves the sync to
+    // |wait_until_durable()|
+    void flush_buffer_deferred(int idx);
+
     // Clears a single file
     void clear_file(int idx);
 
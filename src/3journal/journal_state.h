@@ -33,6 +33,7 @@
 #include "ups/upscaledb_int.h" // for metrics
 
 #include "1base/dynamic_array.h"
+#include "1base/mutex.h"
 #include "1base/scoped_ptr.h"
 #include "1os/file.h"
 
@@ -78,6 +79,10 @@ struct JournalState
   // This needs to be atomic since it's updated from the worker thread
   boost::atomic<uint64_t> closed_txn[2];
 
+  // For counting the changesets which are not yet written by the worker
+  // thread (their pages are still locked)
+  boost::atomic<uint32_t> pending_changesets;
+
   // The lsn of the previous checkpoint
   uint64_t last_cp_lsn;
 
@@ -103,6 +108,37 @@ struct JournalState
 
   // The compressor; can be null
   ScopedPtr<Compressor> compressor;
+
+  // Group commit: protects the members below
+  Mutex sync_mutex;
+
+  // Group commit: signalled when a sync completed or when
+  // |group_commit_bytes| were written
+  Condition sync_cond;
+
+  // Group commit: sequence number of the last (unsynced) write
+  uint64_t write_seqnum;
+
+  // Group commit: all writes up to this sequence number are durable
+  uint64_t durable_seqnum;
+
+  // Group commit: true while a "leader" thread syncs the files
+  bool sync_in_progress;
+
+  // Group commit: true if a waiting thread cannot wait for the window
+  bool sync_requested;
+
+  // Group commit: true if a file has unsynced writes
+  bool needs_sync[2];
+
+  // Group commit: number of bytes written since the last sync
+  size_t unsynced_bytes;
+
+  // Group commit: time (in usec) to wait for more commits before syncing
+  uint64_t group_commit_usec;
+
+  // Group commit: sync immediately if this many bytes were written
+  uint64_t group_commit_bytes;
 };
 
 } // namespace upscaledb
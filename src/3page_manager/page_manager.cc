@@ -20,6 +20,7 @@
 #include "0root/root.h"
 
 #include <string.h>
+#include <algorithm>
 
 #include "3rdparty/murmurhash3/MurmurHash3.h"
 // Always verify that a file of level N does not include headers > N!
@@ -66,9 +67,18 @@ async_delete_page_data(Page::PersistedData *ptr)
   delete ptr;
 }
 
+static void
+async_read_ahead(PageManager *page_manager, LocalDatabase *db,
+                uint64_t address)
+{
+  page_manager->read_ahead(db, address);
+}
+
 static void
 async_flush_pages(AsyncFlushMessage *message)
 {
+  std::vector<Page::PersistedData *> locked;
+  std::vector<Page::PersistedData *> dirty;
   std::vector<uint64_t>::iterator it = message->page_ids.begin();
   Page::PersistedData *page_data;
   for (it = message->page_ids.begin(); it != message->page_ids.end(); it++) {
@@ -77,21 +87,27 @@ async_flush_pages(AsyncFlushMessage *message)
       continue;
     ups_assert(page_data->mutex.try_lock() == false);
 
-    // flush dirty pages
-    if (page_data->is_dirty) {
-      try {
-        Page::flush(message->device, page_data);
-      }
-      catch (Exception &) {
-        page_data->mutex.unlock();
-        if (message->signal)
-          message->signal->notify();
-        message->in_progress = false;
-        throw; // TODO really?
-      }
-    }
-    page_data->mutex.unlock();
+    locked.push_back(page_data);
+    if (page_data->is_dirty)
+      dirty.push_back(page_data);
   }
+
+  // flush dirty pages
+  try {
+    message->page_manager->flush_pages(dirty);
+  }
+  catch (Exception &) {
+    for (size_t i = 0; i < locked.size(); i++)
+      locked[i]->mutex.unlock();
+    if (message->signal)
+      message->signal->notify();
+    message->in_progress = false;
+    throw; // TODO really?
+  }
+
+  for (size_t i = 0; i < locked.size(); i++)
+    locked[i]->mutex.unlock();
+
   if (message->in_progress)
     message->in_progress = false;
   if (message->signal)
@@ -104,7 +120,9 @@ PageManagerState::PageManagerState(LocalEnvironment *_env)
     cache(_env->config()), freelist(config), needs_flush(false),
     state_page(0), last_blob_page(0), last_blob_page_id(0),
     page_count_fetched(0), page_count_index(0), page_count_blob(0),
-    page_count_page_manager(0), cache_hits(0), cache_misses(0), message(0)
+    page_count_page_manager(0), cache_hits(0), cache_misses(0),
+    page_count_prefetched(0), prefetch_hits(0), read_ahead_pending(false),
+    message(0)
 {
 }
 
@@ -118,7 +136,7 @@ PageManager::PageManager(LocalEnvironment *env)
   : m_state(env)
 {
   /* start the worker thread */
-  m_worker = new WorkerPool(1);
+  m_worker = new WorkerPool(m_state.config.flush_threads);
 }
 
 PageManager::~PageManager()
@@ -166,11 +184,60 @@ PageManager::initialize(uint64_t pageid)
   }
 }
 
+// Latches a cached page without blocking; used by PageManager::fetch
+struct TryLatchPage
+{
+  TryLatchPage(Context *context_)
+    : context(context_) {
+  }
+
+  bool operator()(Page *page) {
+    return (context->changeset.try_put(page));
+  }
+
+  Context *context;
+};
+
 Page *
 PageManager::fetch(Context *context, uint64_t address, uint32_t flags)
 {
-  ScopedSpinlock lock(m_state.mutex);
-  return (fetch_unlocked(context, address, flags));
+  Page *page = 0;
+
+  // Fast path: pages which are cached can be retrieved without acquiring
+  // the PageManager's mutex; only their cache shard is locked. If the
+  // page cannot be latched immediately then fall back to the slow path.
+  if (address != 0) {
+    TryLatchPage latcher(context);
+    page = m_state.cache.get_if(address, latcher);
+    if (page && (flags & PageManager::kNoHeader))
+      page->set_without_header(true);
+  }
+
+  if (!page) {
+    ScopedSpinlock lock(m_state.mutex);
+    page = fetch_unlocked(context, address, flags);
+  }
+
+  if (!page || m_state.config.prefetch_pages == 0)
+    return (page);
+
+  // A page which was read ahead is fetched for the first time: continue
+  // with the next window if this page is the window's marker. Otherwise
+  // start reading ahead if a scan arrives at a leaf whose right sibling
+  // is not yet cached.
+  uint64_t next;
+  if (page->clear_prefetched(&next)) {
+    m_state.prefetch_hits++;
+    if (next)
+      schedule_read_ahead(context->db, next);
+  }
+  else if (flags & PageManager::kReadAhead) {
+    PBtreeNode *node = PBtreeNode::from_page(page);
+    if (node->is_leaf() && node->get_right() != 0
+            && !m_state.cache.contains(node->get_right()))
+      schedule_read_ahead(context->db, node->get_right());
+  }
+  return (page);
 }
 
 Page *
@@ -231,6 +298,183 @@ PageManager::alloc_multiple_blob_pages(Context *context, size_t num_pages)
   return (page);
 }
 
+static bool
+compare_page_addresses(const Page::PersistedData *lhs,
+                const Page::PersistedData *rhs)
+{
+  return (lhs->address < rhs->address);
+}
+
+// Writes a range of "runs"; each run is a sequence of pages with
+// adjacent addresses
+struct FlushRunsTask
+{
+  FlushRunsTask(Device *device_, Page::PersistedData **list_,
+                  const std::vector<std::pair<size_t, size_t> > *runs_,
+                  size_t begin_, size_t end_)
+    : device(device_), list(list_), runs(runs_), begin(begin_), end(end_) {
+  }
+
+  void operator()() {
+    for (size_t i = begin; i < end; i++)
+      Page::flush(device, &list[(*runs)[i].first], (*runs)[i].second);
+  }
+
+  Device *device;
+  Page::PersistedData **list;
+  const std::vector<std::pair<size_t, size_t> > *runs;
+  size_t begin;
+  size_t end;
+};
+
+void
+PageManager::flush_pages(std::vector<Page::PersistedData *> &list)
+{
+  if (list.empty())
+    return;
+
+  std::sort(list.begin(), list.end(), compare_page_addresses);
+
+  // split the pages into runs of adjacent pages (|first| is the index
+  // of the first page, |second| the number of pages)
+  std::vector<std::pair<size_t, size_t> > runs;
+  size_t run_bytes = 0;
+  for (size_t i = 0; i < list.size(); i++) {
+    if (i > 0
+          && list[i - 1]->address + list[i - 1]->size == list[i]->address
+          && run_bytes + list[i]->size <= kMaxFlushRunBytes) {
+      runs.back().second++;
+      run_bytes += list[i]->size;
+    }
+    else {
+      runs.push_back(std::make_pair(i, (size_t)1));
+      run_bytes = list[i]->size;
+    }
+  }
+
+  // distribute the runs over the threads; each thread receives roughly
+  // the same number of pages
+  size_t num_threads = std::min(m_worker->num_threads(), runs.size());
+  size_t pages_per_thread = (list.size() + num_threads - 1) / num_threads;
+
+  std::vector<FlushRunsTask> tasks;
+  size_t begin = 0;
+  size_t pages = 0;
+  for (size_t i = 0; i < runs.size(); i++) {
+    pages += runs[i].second;
+    if (pages >= pages_per_thread || i == runs.size() - 1) {
+      tasks.push_back(FlushRunsTask(m_state.device, &list[0], &runs,
+                              begin, i + 1));
+      begin = i + 1;
+      pages = 0;
+    }
+  }
+
+  m_worker->run_parallel(tasks);
+}
+
+// Reads the right sibling of a cached btree leaf; used by
+// PageManager::read_ahead. Always returns false, therefore the page is
+// neither latched nor counted as a cache hit.
+struct ReadRightSibling
+{
+  ReadRightSibling()
+    : is_cached(false), is_locked(false), right(0) {
+  }
+
+  bool operator()(Page *page) {
+    is_cached = true;
+    if (page->mutex().try_lock_shared()) {
+      PBtreeNode *node = PBtreeNode::from_page(page);
+      if (node->is_leaf())
+        right = node->get_right();
+      page->mutex().unlock_shared();
+    }
+    else
+      is_locked = true;
+    return (false);
+  }
+
+  bool is_cached;
+  bool is_locked;
+  uint64_t right;
+};
+
+void
+PageManager::schedule_read_ahead(LocalDatabase *db, uint64_t address)
+{
+  if (m_state.config.flags & UPS_IN_MEMORY
+        || m_state.read_ahead_pending.exchange(true))
+    return;
+
+  run_async(boost::bind(&async_read_ahead, this, db, address));
+}
+
+void
+PageManager::read_ahead(LocalDatabase *db, uint64_t address)
+{
+  std::vector<Page *> pages;
+
+  // Pages are written to disk only by messages of the worker thread, and
+  // this method is such a message. Therefore the file cannot be modified
+  // while the leaves are read: if a page is not cached then its persisted
+  // version is up to date.
+  //
+  // Cached pages are not read, unless they are locked by another thread
+  // (i.e. a scan which is in progress). Then the sibling pointer is taken
+  // from the persisted page, and the page is discarded further below.
+  for (int i = 0; i < m_state.config.prefetch_pages && address != 0; i++) {
+    ReadRightSibling reader;
+    m_state.cache.get_if(address, reader);
+    if (reader.is_cached && !reader.is_locked) {
+      address = reader.right;
+      continue;
+    }
+
+    Page *page = new Page(m_state.device, db);
+    try {
+      page->fetch(address);
+      if (m_state.config.flags & UPS_ENABLE_CRC32)
+        verify_crc32(page);
+    }
+    catch (Exception &) {
+      delete page;
+      break;
+    }
+
+    // stop if the sibling pointer was stale
+    PBtreeNode *node = PBtreeNode::from_page(page);
+    if ((page->get_type() != Page::kTypeBindex
+              && page->get_type() != Page::kTypeBroot)
+            || !node->is_leaf()) {
+      delete page;
+      break;
+    }
+
+    pages.push_back(page);
+    address = node->get_right();
+  }
+
+  // the page in the middle of the window triggers the next read-ahead
+  for (size_t i = 0; i < pages.size(); i++)
+    pages[i]->set_prefetched(i == pages.size() / 2 ? address : 0);
+
+  {
+    ScopedSpinlock lock(m_state.mutex);
+    for (size_t i = 0; i < pages.size(); i++) {
+      // the page was fetched by another thread in the meantime
+      if (m_state.cache.contains(pages[i]->get_address())) {
+        delete pages[i];
+        continue;
+      }
+      m_state.cache.put(pages[i]);
+      m_state.page_count_prefetched++;
+    }
+  }
+
+  m_state.read_ahead_pending = false;
+}
+
 void
 PageManager::fill_metrics(ups_env_metrics_t *metrics) const
 {
@@ -241,6 +485,8 @@ PageManager::fill_metrics(ups_env_metrics_t *metrics) const
   metrics->page_count_type_page_manager = m_state.page_count_page_manager;
   metrics->freelist_hits = m_state.freelist.freelist_hits;
   metrics->freelist_misses = m_state.freelist.freelist_misses;
+  metrics->page_count_prefetched = m_state.page_count_prefetched;
+  metrics->prefetch_hits = m_state.prefetch_hits;
   m_state.cache.fill_metrics(metrics);
 }
 
@@ -387,6 +633,29 @@ struct CloseDatabaseVisitor
   AsyncFlushMessage *message;
 };
 
+// Removes all remaining pages of a database from the cache; these pages
+// were read ahead while the database was closed. |ignore_| is sorted.
+struct DropReadAheadPagesVisitor
+{
+  DropReadAheadPagesVisitor(LocalDatabase *db_,
+                  const std::vector<Page *> &ignore_)
+    : db(db_), ignore(ignore_) {
+  }
+
+  bool operator()(Page *page) {
+    if (page->get_db() == db && page->get_address() != 0
+        && !std::binary_search(ignore.begin(), ignore.end(), page)) {
+      pages.push_back(page);
+      return (true);
+    }
+    return (false);
+  }
+
+  LocalDatabase *db;
+  const std::vector<Page *> &ignore;
+  std::vector<Page *> pages;
+};
+
 void
 PageManager::close_database(Context *context, LocalDatabase *db)
 {
@@ -411,7 +680,9 @@ PageManager::close_database(Context *context, LocalDatabase *db)
       message->page_ids.push_back(0);
   }
 
-  if (message->page_ids.size() > 0) {
+  // if read-ahead is enabled then the message is also required to wait
+  // till pending read-ahead messages are processed
+  if (message->page_ids.size() > 0 || m_state.config.prefetch_pages > 0) {
     run_async(boost::bind(&async_flush_pages, message));
     signal.wait();
   }
@@ -419,6 +690,14 @@ PageManager::close_database(Context *context, LocalDatabase *db)
   delete message;
 
   ScopedSpinlock lock(m_state.mutex);
+  if (m_state.config.prefetch_pages > 0) {
+    std::sort(visitor.pages.begin(), visitor.pages.end());
+    DropReadAheadPagesVisitor dropper(db, visitor.pages);
+    m_state.cache.purge_if(dropper);
+    for (size_t i = 0; i < dropper.pages.size(); i++)
+      delete dropper.pages[i];
+  }
+
   // now delete the pages
   for (std::vector<Page *>::iterator it = visitor.pages.begin();
           it != visitor.pages.end();
@@ -466,6 +745,15 @@ PageManager::del(Context *context, Page *page, size_t page_count)
   // relevant for logging.
 }
 
+uint64_t
+PageManager::first_free_page()
+{
+  ScopedSpinlock lock(m_state.mutex);
+  if (m_state.freelist.empty())
+    return (0);
+  return (m_state.freelist.free_pages.begin()->first);
+}
+
 void
 PageManager::close(Context *context)
 {
@@ -521,7 +809,7 @@ PageManager::reset(Context *context)
   close(context);
 
   /* start the worker thread */
-  m_worker = new WorkerPool(1);
+  m_worker = new WorkerPool(m_state.config.flush_threads);
 }
 
 Page *
@@ -70,7 +70,14 @@ class PageManager
       kReadOnly = 2,
 
       // Flag for fetch(): page is part of a multi-page blob, has no header
-      kNoHeader = 4
+      kNoHeader = 4,
+
+      // Flag for fetch(): page is visited by a sequential scan; if it is
+      // a btree leaf then its right siblings are read ahead
+      kReadAhead = 8,
+
+      // flush_pages(): the maximum size of a single (coalesced) write
+      kMaxFlushRunBytes = 1024 * 1024
     };
 
     // Constructor
@@ -119,6 +126,10 @@ class PageManager
     // to the Freelist
     void del(Context *context, Page *page, size_t page_count = 1);
 
+    // Returns the address of the first page in the Freelist, or 0 if the
+    // Freelist is empty. alloc() returns this page next.
+    uint64_t first_free_page();
+
     // Closes the PageManager; flushes all dirty pages
     void close(Context *context);
 
@@ -144,6 +155,23 @@ class PageManager
     // (i.e. because it cannot be locked or cursors are attached) 
     Page::PersistedData *try_lock_purge_candidate(uint64_t page_id);
 
+    // Writes a list of locked, dirty pages to the device. Pages with
+    // adjacent addresses are coalesced into a single write, and the writes
+    // are distributed over the threads of the worker pool. Must only be
+    // called from a message of the worker thread (see |run_async()|).
+    void flush_pages(std::vector<Page::PersistedData *> &list);
+
+    // Reads up to |prefetch_pages| btree leaves into the cache, starting
+    // at |address| and following the right-sibling pointers. Pages which
+    // are already cached are not read again. Must only be called from a
+    // message of the worker thread (see |run_async()|).
+    void read_ahead(LocalDatabase *db, uint64_t address);
+
+    // Returns the thread pool which executes the messages
+    WorkerPool *worker() {
+      return (m_worker);
+    }
+
     // Adds a message to the worker's queue
     template<typename CompletionHandler>
     void run_async(CompletionHandler handler) {
@@ -163,6 +191,10 @@ class PageManager
     // Implementation of alloc(), does not lock the mutex
     Page *alloc_unlocked(Context *context, uint32_t page_type, uint32_t flags);
 
+    // Schedules a read-ahead of the leaves starting at |address|, unless
+    // another read-ahead is still pending
+    void schedule_read_ahead(LocalDatabase *db, uint64_t address);
+
     // PRO: verifies the crc32 of a page
     void verify_crc32(Page *page);
 
@@ -114,6 +114,16 @@ struct PageManagerState
   // tracks number of cache misses
   uint64_t cache_misses;
 
+  // tracks number of pages which were read ahead
+  uint64_t page_count_prefetched;
+
+  // tracks number of read-ahead pages which were fetched afterwards
+  boost::atomic<uint64_t> prefetch_hits;
+
+  // true while a read-ahead message is queued or processed by the
+  // worker thread
+  boost::atomic<bool> read_ahead_pending;
+
   // For sending information to the worker thread; cached to avoid memory
   // allocations
   AsyncFlushMessage *message;
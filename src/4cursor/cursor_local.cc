@@ -105,10 +105,12 @@ LocalCursor::update_dupecache(Context *context, uint32_t what)
     /* now start integrating the items from the transactions */
     op = node->get_oldest_op();
     while (op) {
-      Transaction *optxn = op->get_txn();
+      LocalTransaction *optxn = op->get_txn();
+      LocalTransaction *txn = (LocalTransaction *)get_txn();
       /* collect all ops that are valid (even those that are
-       * from conflicting transactions) */
-      if (!optxn->is_aborted()) {
+       * from conflicting transactions), unless they are invisible
+       * for a read-only transaction */
+      if (!optxn->is_aborted() && !(txn && txn->ignores(optxn))) {
         /* a normal (overwriting) insert will overwrite ALL dupes,
          * but an overwrite of a duplicate will only overwrite
          * an entry in the dupecache */
@@ -19,11 +19,14 @@
 
 #include "0root/root.h"
 
+#include <algorithm>
+
 // Always verify that a file of level N does not include headers > N!
 #include "2protobuf/protocol.h"
 #include "4cursor/cursor_remote.h"
 #include "4db/db_remote.h"
 #include "4env/env_remote.h"
+#include "4txn/txn_remote.h"
 
 #ifndef UPS_ROOT_H
 #  error "root.h was not included"
@@ -43,9 +46,140 @@ RemoteCursor::close()
   ups_assert(reply.id == kCursorCloseReply);
 }
 
+bool
+RemoteCursor::is_batchable(ups_record_t *record, uint32_t flags)
+{
+  // partial records are always fetched separately
+  if (record && (record->flags & UPS_PARTIAL))
+    return (false);
+
+  // with UPS_SKIP_DUPLICATES, moving back does not necessarily return to
+  // the same duplicate; then the remote cursor could not be repositioned
+  uint32_t direction = flags & (UPS_CURSOR_FIRST | UPS_CURSOR_LAST
+                  | UPS_CURSOR_NEXT | UPS_CURSOR_PREVIOUS);
+  if (flags & ~(direction | UPS_ONLY_DUPLICATES))
+    return (false);
+  return (direction == UPS_CURSOR_FIRST || direction == UPS_CURSOR_LAST
+          || direction == UPS_CURSOR_NEXT || direction == UPS_CURSOR_PREVIOUS);
+}
+
+ups_status_t
+RemoteCursor::move_batched(ups_key_t *key, ups_record_t *record,
+                uint32_t flags)
+{
+  // start a new batch unless the current one can serve this move
+  if (!m_batch || flags != m_batch_flags
+      || m_batch_pos >= m_batch->cursor_move_batch_reply().keys_size()) {
+    // the batch size grows exponentially as long as each batch is consumed
+    // completely; otherwise only the requested pair is fetched, and the
+    // remote cursor does not have to be moved back later
+    if (m_batch && flags == m_batch_flags
+        && m_batch_pos >= m_batch->cursor_move_batch_reply().keys_size())
+      m_batch_size = std::min(m_batch_size * 2, (uint32_t)kMaxBatchSize);
+    else
+      m_batch_size = 1;
+
+    discard_batch();
+
+    Protocol request(Protocol::CURSOR_MOVE_BATCH_REQUEST);
+    CursorMoveBatchRequest *r = request.mutable_cursor_move_batch_request();
+    r->set_cursor_handle(m_remote_handle);
+    r->set_flags(flags);
+    r->set_max_count(m_batch_size);
+    r->set_max_bytes(kMaxBatchBytes);
+    r->set_skip_data(false);
+
+    ScopedPtr<Protocol> reply(renv()->perform_request(&request));
+    ups_assert(reply->has_cursor_move_batch_reply());
+
+    ups_status_t st = reply->cursor_move_batch_reply().status();
+    if (st)
+      return (st);
+
+    // the following moves continue in the same direction
+    m_batch_flags = flags & ~(UPS_CURSOR_FIRST | UPS_CURSOR_LAST);
+    if (flags & UPS_CURSOR_FIRST)
+      m_batch_flags |= UPS_CURSOR_NEXT;
+    if (flags & UPS_CURSOR_LAST)
+      m_batch_flags |= UPS_CURSOR_PREVIOUS;
+    m_batch.swap(reply);
+    m_batch_pos = 0;
+  }
+
+  const CursorMoveBatchReply &batch = m_batch->cursor_move_batch_reply();
+  RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(m_txn);
+
+  /* modify key/record, but make sure that USER_ALLOC is respected! */
+  if (key) {
+    const std::string &data = batch.keys(m_batch_pos).data();
+    key->_flags = batch.keys(m_batch_pos).intflags();
+    key->size = (uint16_t)data.size();
+    if (!(key->flags & UPS_KEY_USER_ALLOC)) {
+      ByteArray *arena = &m_db->key_arena(txn);
+      arena->resize(key->size);
+      key->data = arena->get_ptr();
+    }
+    if (key->size)
+      ::memcpy(key->data, &data[0], key->size);
+  }
+
+  if (record) {
+    const std::string &data = batch.records(m_batch_pos).data();
+    record->size = (uint32_t)data.size();
+    if (!(record->flags & UPS_RECORD_USER_ALLOC)) {
+      ByteArray *arena = &m_db->record_arena(txn);
+      arena->resize(record->size);
+      record->data = arena->get_ptr();
+    }
+    if (record->size)
+      ::memcpy(record->data, &data[0], record->size);
+  }
+
+  m_batch_pos++;
+  return (0);
+}
+
+void
+RemoteCursor::discard_batch()
+{
+  if (!m_batch)
+    return;
+
+  int left = m_batch->cursor_move_batch_reply().keys_size() - m_batch_pos;
+  m_batch.reset();
+  m_batch_pos = 0;
+  if (left == 0)
+    return;
+
+  // the remote cursor is positioned on the last pair of the batch; move it
+  // back in the opposite direction
+  uint32_t flags = m_batch_flags & ~(UPS_CURSOR_NEXT | UPS_CURSOR_PREVIOUS);
+  flags |= (m_batch_flags & UPS_CURSOR_NEXT)
+              ? UPS_CURSOR_PREVIOUS
+              : UPS_CURSOR_NEXT;
+
+  Protocol request(Protocol::CURSOR_MOVE_BATCH_REQUEST);
+  CursorMoveBatchRequest *r = request.mutable_cursor_move_batch_request();
+  r->set_cursor_handle(m_remote_handle);
+  r->set_flags(flags);
+  r->set_max_count(left);
+  r->set_max_bytes(0);
+  r->set_skip_data(true);
+
+  ScopedPtr<Protocol> reply(renv()->perform_request(&request));
+  ups_assert(reply->has_cursor_move_batch_reply());
+
+  ups_status_t st = reply->cursor_move_batch_reply().status();
+  if (st)
+    throw Exception(st);
+}
+
 ups_status_t
 RemoteCursor::do_overwrite(ups_record_t *record, uint32_t flags)
 {
+  // the Database is modified; the other cursors must not return stale data
+  rdb()->discard_cursor_batches();
+
   SerializedWrapper request;
   request.id = kCursorOverwriteRequest;
   request.cursor_overwrite_request.cursor_handle = m_remote_handle;
@@ -70,6 +204,8 @@ RemoteCursor::do_overwrite(ups_record_t *record, uint32_t flags)
 ups_status_t
 RemoteCursor::do_get_duplicate_position(uint32_t *pposition)
 {
+  discard_batch();
+
   SerializedWrapper request;
   request.id = kCursorGetDuplicatePositionRequest;
   request.cursor_get_duplicate_position_request.cursor_handle = m_remote_handle;
@@ -87,6 +223,8 @@ RemoteCursor::do_get_duplicate_position(uint32_t *pposition)
 ups_status_t
 RemoteCursor::do_get_duplicate_count(uint32_t flags, uint32_t *pcount)
 {
+  discard_batch();
+
   SerializedWrapper request;
   request.id = kCursorGetRecordCountRequest;
   request.cursor_get_record_count_request.cursor_handle = m_remote_handle;
@@ -107,6 +245,8 @@ RemoteCursor::do_get_duplicate_count(uint32_t flags, uint32_t *pcount)
 ups_status_t
 RemoteCursor::do_get_record_size(uint64_t *psize)
 {
+  discard_batch();
+
   SerializedWrapper request;
   request.id = kCursorGetRecordSizeRequest;
   request.cursor_get_record_size_request.cursor_handle = m_remote_handle;
@@ -30,6 +30,8 @@
 #include "0root/root.h"
 
 // Always verify that a file of level N does not include headers > N!
+#include "1base/scoped_ptr.h"
+#include "2protobuf/protocol.h"
 #include "4db/db_remote.h"
 #include "4cursor/cursor.h"
 
@@ -45,9 +47,18 @@ class RemoteEnvironment;
 class RemoteCursor : public Cursor
 {
   public:
+    enum {
+      // the maximum number of key/record pairs which are fetched in advance
+      kMaxBatchSize = 1024,
+
+      // the maximum size of the keys and records of a batch
+      kMaxBatchBytes = 1024 * 1024
+    };
+
     // Constructor; retrieves pointer to db and txn, initializes all members
     RemoteCursor(RemoteDatabase *db, Transaction *txn = 0)
-      : Cursor(db, txn), m_remote_handle(0) {
+      : Cursor(db, txn), m_remote_handle(0), m_batch_pos(0),
+        m_batch_flags(0), m_batch_size(1) {
     }
 
     // Returns the remote Cursor handle
@@ -63,6 +74,22 @@ class RemoteCursor : public Cursor
     // Closes the cursor (ups_cursor_close)
     virtual void close();
 
+    // Returns true if a move with these parameters can fetch key/record
+    // pairs in advance
+    static bool is_batchable(ups_record_t *record, uint32_t flags);
+
+    // Moves the cursor (ups_cursor_move). Scans fetch many key/record pairs
+    // with a single request; the following moves in the same direction are
+    // then served from this buffer.
+    ups_status_t move_batched(ups_key_t *key, ups_record_t *record,
+                    uint32_t flags);
+
+    // Discards the pairs which were fetched in advance, and moves the
+    // remote cursor back to the pair which was returned most recently.
+    // Required before any other operation is performed on the cursor,
+    // and before the Database is modified.
+    void discard_batch();
+
   private:
     // Implementation of overwrite()
     virtual ups_status_t do_overwrite(ups_record_t *record, uint32_t flags);
@@ -89,6 +116,19 @@ class RemoteCursor : public Cursor
 
     // The remote handle
     uint64_t m_remote_handle;
+
+    // The reply with the pairs which were fetched in advance
+    ScopedPtr<Protocol> m_batch;
+
+    // The index of the next pair in |m_batch|
+    int m_batch_pos;
+
+    // The flags of the moves which can be served from |m_batch|
+    uint32_t m_batch_flags;
+
+    // The number of pairs which are requested with the next batch; doubles
+    // whenever a batch was consumed completely
+    uint32_t m_batch_size;
 };
 
 } // namespace upscaledb
@@ -56,6 +56,34 @@ Database::cursor_create(Cursor **pcursor, Transaction *txn, uint32_t flags)
   }
 }
 
+ups_status_t
+Database::insert_async(Transaction *txn, ups_key_t *key, ups_record_t *record,
+                uint32_t flags, ups_async_callback_t callback, void *context)
+{
+  ups_status_t st = insert(0, txn, key, record, flags);
+  callback((ups_db_t *)this, st, key, 0, context);
+  return (0);
+}
+
+ups_status_t
+Database::find_async(Transaction *txn, ups_key_t *key, uint32_t flags,
+                ups_async_callback_t callback, void *context)
+{
+  ups_record_t record = {0};
+  ups_status_t st = find(0, txn, key, &record, flags);
+  callback((ups_db_t *)this, st, key, st ? 0 : &record, context);
+  return (0);
+}
+
+ups_status_t
+Database::erase_async(Transaction *txn, ups_key_t *key, uint32_t flags,
+                ups_async_callback_t callback, void *context)
+{
+  ups_status_t st = erase(0, txn, key, flags);
+  callback((ups_db_t *)this, st, key, 0, context);
+  return (0);
+}
+
 ups_status_t
 Database::cursor_clone(Cursor **pdest, Cursor *src)
 {
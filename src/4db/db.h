@@ -30,6 +30,7 @@
 
 // Always verify that a file of level N does not include headers > N!
 #include "1base/dynamic_array.h"
+#include "1base/mutex.h"
 #include "2config/db_config.h"
 #include "4env/env.h"
 
@@ -117,6 +118,45 @@ class Database
     virtual ups_status_t find(Cursor *cursor, Transaction *txn, ups_key_t *key,
                     ups_record_t *record, uint32_t flags) = 0;
 
+    // Inserts many key/value pairs (ups_db_insert_many)
+    virtual ups_status_t insert_many(Transaction *txn, ups_key_t *keys,
+                    ups_record_t *records, uint32_t count,
+                    ups_status_t *results, uint32_t flags) = 0;
+
+    // Lookup of many keys (ups_db_find_many)
+    virtual ups_status_t find_many(Transaction *txn, ups_key_t *keys,
+                    ups_record_t *records, uint32_t count,
+                    ups_status_t *results, uint32_t flags) = 0;
+
+    // Erases many keys (ups_db_erase_many)
+    virtual ups_status_t erase_many(Transaction *txn, ups_key_t *keys,
+                    uint32_t count, ups_status_t *results, uint32_t flags) = 0;
+
+    // Inserts a key/value pair asynchronously (ups_db_insert_async); the
+    // default implementation executes the operation immediately
+    virtual ups_status_t insert_async(Transaction *txn, ups_key_t *key,
+                    ups_record_t *record, uint32_t flags,
+                    ups_async_callback_t callback, void *context);
+
+    // Lookup of a key asynchronously (ups_db_find_async)
+    virtual ups_status_t find_async(Transaction *txn, ups_key_t *key,
+                    uint32_t flags, ups_async_callback_t callback,
+                    void *context);
+
+    // Erases a key asynchronously (ups_db_erase_async)
+    virtual ups_status_t erase_async(Transaction *txn, ups_key_t *key,
+                    uint32_t flags, ups_async_callback_t callback,
+                    void *context);
+
+    // Starts a bulk load (ups_db_bulk_begin)
+    virtual ups_status_t bulk_begin(uint32_t fill_factor, uint32_t flags) = 0;
+
+    // Appends a sorted key/value pair to a bulk load (ups_db_bulk_insert)
+    virtual ups_status_t bulk_insert(ups_key_t *key, ups_record_t *record) = 0;
+
+    // Finishes a bulk load (ups_db_bulk_end)
+    virtual ups_status_t bulk_end() = 0;
+
     // Creates a cursor (ups_cursor_create)
     virtual ups_status_t cursor_create(Cursor **pcursor, Transaction *txn,
                     uint32_t flags);
@@ -134,6 +174,12 @@ class Database
     // Closes the Database (ups_db_close)
     ups_status_t close(uint32_t flags);
 
+    // Returns true if read-only operations can share the Environment's
+    // lock with other readers (see UPS_ENABLE_CONCURRENT_READS)
+    virtual bool supports_concurrent_reads() {
+      return (false);
+    }
+
     // Returns the user-provided context pointer (ups_get_context_data)
     void *get_context_data() {
       return (m_context);
@@ -150,22 +196,35 @@ class Database
     }
 
     // Returns the memory buffer for the key data: the per-database buffer
-    // if |txn| is null or temporary, otherwise the buffer from the |txn|
+    // if |txn| is null or temporary, otherwise the buffer from the |txn|.
+    // With UPS_ENABLE_CONCURRENT_READS each thread has its own buffer.
     ByteArray &key_arena(Transaction *txn) {
-      return ((txn == 0 || (txn->get_flags() & UPS_TXN_TEMPORARY))
-                 ? m_key_arena
-                 : txn->key_arena());
+      if (txn == 0 || (txn->get_flags() & UPS_TXN_TEMPORARY))
+        return ((get_flags() & UPS_ENABLE_CONCURRENT_READS)
+                 ? thread_arena(m_thread_key_arena)
+                 : m_key_arena);
+      return (txn->key_arena());
     }
 
     // Returns the memory buffer for the record data: the per-database buffer
-    // if |txn| is null or temporary, otherwise the buffer from the |txn|
+    // if |txn| is null or temporary, otherwise the buffer from the |txn|.
+    // With UPS_ENABLE_CONCURRENT_READS each thread has its own buffer.
     ByteArray &record_arena(Transaction *txn) {
-      return ((txn == 0 || (txn->get_flags() & UPS_TXN_TEMPORARY))
-                 ? m_record_arena
-                 : txn->record_arena());
+      if (txn == 0 || (txn->get_flags() & UPS_TXN_TEMPORARY))
+        return ((get_flags() & UPS_ENABLE_CONCURRENT_READS)
+                 ? thread_arena(m_thread_record_arena)
+                 : m_record_arena);
+      return (txn->record_arena());
     }
 
   protected:
+    // Returns the calling thread's instance of |arena|
+    static ByteArray &thread_arena(boost::thread_specific_ptr<ByteArray> &arena) {
+      if (!arena.get())
+        arena.reset(new ByteArray());
+      return (*arena);
+    }
+
     // Creates a cursor; this is the actual implementation
     virtual Cursor *cursor_create_impl(Transaction *txn) = 0;
 
@@ -194,6 +253,11 @@ class Database
     // This is where record->data points to when returning a
     // record to the user; used if Transactions are disabled
     ByteArray m_record_arena;
+
+    // Per-thread replacements for m_key_arena and m_record_arena; used
+    // if UPS_ENABLE_CONCURRENT_READS is set
+    boost::thread_specific_ptr<ByteArray> m_thread_key_arena;
+    boost::thread_specific_ptr<ByteArray> m_thread_record_arena;
 };
 
 } // namespace upscaledb
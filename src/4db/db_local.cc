@@ -17,10 +17,14 @@
 
 #include "0root/root.h"
 
+#include <string.h>
+#include <vector>
+#include <algorithm>
 #include <boost/scope_exit.hpp>
 
 // Always verify that a file of level N does not include headers > N!
 #include "1globals/callbacks.h"
+#include "2device/device.h"
 #include "3page_manager/page_manager.h"
 #include "3journal/journal.h"
 #include "3blob_manager/blob_manager.h"
@@ -175,15 +179,15 @@ LocalDatabase::insert_txn(Context *context, ups_key_t *key,
   TransactionOperation *op;
   bool node_created = false;
 
-  /* get (or create) the node for this key */
-  TransactionNode *node = m_txn_index->get(key, 0);
-  if (!node) {
-    node = new TransactionNode(this, key);
-    node_created = true;
-    // TODO only store when the operation is successful?
-    m_txn_index->store(node);
+  if (context->txn->get_flags() & UPS_TXN_READ_ONLY) {
+    ups_trace(("cannot modify a Database in a read-only Transaction"));
+    return (UPS_WRITE_PROTECTED);
   }
 
+  /* get (or create) the node for this key */
+  // TODO only store when the operation is successful?
+  TransactionNode *node = m_txn_index->get_or_create(key, &node_created);
+
   // check for conflicts of this key
   //
   // !!
@@ -273,8 +277,9 @@ LocalDatabase::is_key_erased(Context *context, ups_key_t *key)
   /* now traverse the tree, check if the key was erased */
   TransactionOperation *op = node->get_newest_op();
   while (op) {
-    Transaction *optxn = op->get_txn();
-    if (optxn->is_aborted())
+    LocalTransaction *optxn = op->get_txn();
+    if (optxn->is_aborted()
+        || (context->txn && context->txn->ignores(optxn)))
       ; /* nop */
     else if (optxn->is_committed() || context->txn == optxn) {
       if (op->get_flags() & TransactionOperation::kIsFlushed)
@@ -330,8 +335,9 @@ retry:
   if (node)
     op = node->get_newest_op();
   while (op) {
-    Transaction *optxn = op->get_txn();
-    if (optxn->is_aborted())
+    LocalTransaction *optxn = op->get_txn();
+    if (optxn->is_aborted()
+        || (context->txn && context->txn->ignores(optxn)))
       ; /* nop */
     else if (optxn->is_committed() || context->txn == optxn) {
       if (op->get_flags() & TransactionOperation::kIsFlushed)
@@ -548,15 +554,15 @@ LocalDatabase::erase_txn(Context *context, ups_key_t *key, uint32_t flags,
   if (cursor)
     pc = cursor->get_parent();
 
-  /* get (or create) the node for this key */
-  TransactionNode *node = m_txn_index->get(key, 0);
-  if (!node) {
-    node = new TransactionNode(this, key);
-    node_created = true;
-    // TODO only store when the operation is successful?
-    m_txn_index->store(node);
+  if (context->txn->get_flags() & UPS_TXN_READ_ONLY) {
+    ups_trace(("cannot modify a Database in a read-only Transaction"));
+    return (UPS_WRITE_PROTECTED);
   }
 
+  /* get (or create) the node for this key */
+  // TODO only store when the operation is successful?
+  TransactionNode *node = m_txn_index->get_or_create(key, &node_created);
+
   /* check for conflicts of this key - but only if we're not erasing a
    * duplicate key. dupes are checked for conflicts in _local_cursor_move TODO that function no longer exists */
   if (!pc || (!pc->get_dupecache_index())) {
@@ -893,6 +899,7 @@ LocalDatabase::count(Transaction *htxn, bool distinct, uint64_t *pcount)
 
   try {
     Context context(lenv(), txn, this);
+    context.changeset.set_shared(supports_concurrent_reads());
 
     /* purge cache if necessary */
     lenv()->page_manager()->purge_cache(&context);
@@ -918,6 +925,226 @@ LocalDatabase::count(Transaction *htxn, bool distinct, uint64_t *pcount)
   }
 }
 
+bool
+LocalDatabase::supports_concurrent_reads()
+{
+  uint32_t flags = get_flags();
+  if (!(flags & UPS_ENABLE_CONCURRENT_READS)
+      || (flags & (UPS_ENABLE_TRANSACTIONS | UPS_ENABLE_DUPLICATE_KEYS)))
+    return (false);
+  return (m_config.key_size != UPS_KEY_SIZE_UNLIMITED
+          && m_record_compressor.get() == 0
+          && m_key_compression_algo == 0);
+}
+
+// Passes the current key of a scan to the |visitor|, together with its
+// |record| if the visitor requires records
+static inline void
+visit_key(Context *context, LocalCursor *cursor, ScanVisitor *visitor,
+                ups_key_t *key, ups_record_t *record, bool distinct)
+{
+  if (record)
+    (*visitor)(key->data, key->size, record->data, (uint32_t)record->size);
+  else
+    (*visitor)(key->data, key->size, distinct
+                                      ? cursor->get_duplicate_count(context)
+                                      : 1);
+}
+
+// The shared state of the threads of a parallel scan
+struct ParallelScanState
+{
+  ParallelScanState(LocalDatabase *db_,
+                  const std::vector<BtreeScanChunk> &chunks_,
+                  std::vector<ScanVisitor *> &visitors_,
+                  const std::vector<ups_key_t *> &txn_keys_, bool distinct_)
+    : db(db_), chunks(chunks_), visitors(visitors_), txn_keys(txn_keys_),
+      skipped(chunks_.size()), distinct(distinct_), next(0), status(0) {
+  }
+
+  LocalDatabase *db;
+  const std::vector<BtreeScanChunk> &chunks;
+  std::vector<ScanVisitor *> &visitors;
+  const std::vector<ups_key_t *> &txn_keys;
+
+  // the ranges which were skipped, for each chunk
+  std::vector<std::vector<BtreeScanRange> > skipped;
+  bool distinct;
+
+  // protects |next| and |status|
+  Mutex mutex;
+
+  // the index of the next chunk which is scanned
+  size_t next;
+
+  // the first error of the threads
+  ups_status_t status;
+};
+
+// A thread of a parallel scan; scans chunks till all of them are processed
+struct ParallelScanWorker
+{
+  ParallelScanWorker(ParallelScanState *state_)
+    : state(state_) {
+  }
+
+  void operator()() {
+    Context context(state->db->lenv(), 0, state->db);
+    context.changeset.set_shared(true);
+
+    try {
+      while (true) {
+        size_t index;
+        {
+          ScopedLock lock(state->mutex);
+          if (state->next == state->chunks.size() || state->status != 0)
+            return;
+          index = state->next++;
+        }
+
+        state->db->btree_index()->scan_chunk(&context, state->chunks, index,
+                        state->visitors[index], state->distinct,
+                        state->txn_keys, &state->skipped[index]);
+      }
+    }
+    catch (Exception &ex) {
+      ScopedLock lock(state->mutex);
+      if (state->status == 0)
+        state->status = ex.code;
+    }
+  }
+
+  ParallelScanState *state;
+};
+
+bool
+LocalDatabase::scan_parallel(Context *context, ScanVisitor *visitor,
+                bool distinct)
+{
+  size_t threads = (size_t)lenv()->config().scan_threads;
+
+  // duplicate keys, variable length keys and compressed keys require
+  // the Cursor, and therefore are always scanned sequentially. Records
+  // are only scanned in parallel if they are stored in the leaves
+  if (threads <= 1
+        || m_config.key_size == UPS_KEY_SIZE_UNLIMITED
+        || m_key_compression_algo != 0
+        || (get_flags() & UPS_ENABLE_DUPLICATE_KEYS)
+        || (visitor->requires_records()
+            && !(get_flags() & UPS_FORCE_RECORDS_INLINE)))
+    return (false);
+
+  // the visitor must support clone() and combine()
+  ScanVisitor *first = visitor->clone();
+  if (!first)
+    return (false);
+
+  std::vector<ScanVisitor *> visitors;
+  visitors.push_back(first);
+
+  BOOST_SCOPE_EXIT((&visitors)) {
+    for (size_t i = 0; i < visitors.size(); i++)
+      delete visitors[i];
+  } BOOST_SCOPE_EXIT_END
+
+  // create a few more chunks than threads; the chunks do not have the
+  // same size, and the threads pick the next chunk as soon as they're idle
+  std::vector<BtreeScanChunk> chunks;
+  bool is_partitioned = m_btree_index->partition(context, threads * 4,
+                  &chunks);
+  // the threads cannot latch the pages as long as they're locked here
+  context->changeset.clear();
+  if (!is_partitioned)
+    return (false);
+
+  while (visitors.size() < chunks.size())
+    visitors.push_back(visitor->clone());
+
+  // the leaves with keys which are modified in a Transaction are skipped
+  // by the threads
+  std::vector<ups_key_t *> txn_keys;
+  if (get_flags() & UPS_ENABLE_TRANSACTIONS) {
+    for (TransactionNode *node = m_txn_index->get_first(); node != 0;
+            node = node->get_next_sibling())
+      txn_keys.push_back(node->get_key());
+  }
+
+  ParallelScanState state(this, chunks, visitors, txn_keys, distinct);
+  std::vector<Thread *> workers;
+  for (size_t i = 0; i < std::min(threads, chunks.size()); i++)
+    workers.push_back(new Thread(ParallelScanWorker(&state)));
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i]->join();
+    delete workers[i];
+  }
+
+  if (state.status)
+    throw Exception(state.status);
+
+  // now scan the skipped ranges with a regular cursor
+  LocalCursor *cursor = 0;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    for (size_t j = 0; j < state.skipped[i].size(); j++) {
+      if (!cursor)
+        cursor = (LocalCursor *)cursor_create_impl(context->txn);
+      try {
+        scan_range(context, cursor, state.skipped[i][j], visitors[i]);
+      }
+      catch (Exception &) {
+        cursor->close();
+        delete cursor;
+        throw;
+      }
+    }
+  }
+  if (cursor) {
+    cursor->close();
+    delete cursor;
+  }
+
+  // and merge the results in the order of the keys
+  for (size_t i = 0; i < visitors.size(); i++)
+    visitor->combine(visitors[i]);
+  return (true);
+}
+
+void
+LocalDatabase::scan_range(Context *context, LocalCursor *cursor,
+                const BtreeScanRange &range, ScanVisitor *visitor)
+{
+  ups_key_t key = {0};
+  ups_record_t record = {0};
+  ups_record_t *precord = visitor->requires_records() ? &record : 0;
+  ups_status_t st;
+
+  if (range.low.is_set) {
+    key.data = (void *)&range.low.key[0];
+    key.size = (uint16_t)range.low.key.size();
+    st = find_impl(context, cursor, &key, precord, range.low.inclusive
+                            ? UPS_FIND_GEQ_MATCH
+                            : UPS_FIND_GT_MATCH);
+  }
+  else
+    st = cursor_move_impl(context, cursor, &key, precord, UPS_CURSOR_FIRST);
+
+  while (st == 0) {
+    if (range.high.is_set) {
+      ups_key_t high = {0};
+      high.data = (void *)&range.high.key[0];
+      high.size = (uint16_t)range.high.key.size();
+      int cmp = m_btree_index->compare_keys(&key, &high);
+      if (cmp > 0 || (cmp == 0 && !range.high.inclusive))
+        break;
+    }
+
+    visit_key(context, cursor, visitor, &key, precord, false);
+    st = cursor_move_impl(context, cursor, &key, precord, UPS_CURSOR_NEXT);
+  }
+
+  if (st != 0 && st != UPS_KEY_NOT_FOUND)
+    throw Exception(st);
+}
+
 ups_status_t
 LocalDatabase::scan(Transaction *txn, ScanVisitor *visitor, bool distinct)
 {
@@ -929,17 +1156,25 @@ LocalDatabase::scan(Transaction *txn, ScanVisitor *visitor, bool distinct)
 
   try {
     Context context(lenv(), (LocalTransaction *)txn, this);
+    context.changeset.set_shared(supports_concurrent_reads());
 
     Page *page;
     ups_key_t key = {0};
+    ups_record_t record = {0};
+    ups_record_t *precord = visitor->requires_records() ? &record : 0;
 
     /* purge cache if necessary */
     lenv()->page_manager()->purge_cache(&context);
 
+    /* scan the btree leaves with several threads, if possible */
+    if (scan_parallel(&context, visitor, distinct))
+      return (0);
+
     /* create a cursor, move it to the first key */
     cursor = (LocalCursor *)cursor_create_impl(txn);
 
-    st = cursor_move_impl(&context, cursor, &key, 0, UPS_CURSOR_FIRST);
+    st = cursor_move_impl(&context, cursor, &key, precord,
+                    UPS_CURSOR_FIRST);
     if (st)
       goto bail;
 
@@ -947,11 +1182,9 @@ LocalDatabase::scan(Transaction *txn, ScanVisitor *visitor, bool distinct)
     if (!cursor->is_coupled_to_btree()) {
       do {
         /* process the key */
-        (*visitor)(key.data, key.size, distinct
-                                        ? cursor->get_duplicate_count(&context)
-                                        : 1);
+        visit_key(&context, cursor, visitor, &key, precord, distinct);
       } while ((st = cursor_move_impl(&context, cursor, &key,
-                            0, UPS_CURSOR_NEXT)) == 0);
+                            precord, UPS_CURSOR_NEXT)) == 0);
       goto bail;
     }
 
@@ -990,9 +1223,7 @@ LocalDatabase::scan(Transaction *txn, ScanVisitor *visitor, bool distinct)
       // scan the remaining keys directly in the btree
       if (!txnkey) {
         /* process the key */
-        (*visitor)(key.data, key.size, distinct
-                                        ? cursor->get_duplicate_count(&context)
-                                        : 1);
+        visit_key(&context, cursor, visitor, &key, precord, distinct);
         break;
       }
 
@@ -1009,11 +1240,9 @@ LocalDatabase::scan(Transaction *txn, ScanVisitor *visitor, bool distinct)
             break;
           }
           /* process the key */
-          (*visitor)(key.data, key.size, distinct
-                                        ? cursor->get_duplicate_count(&context)
-                                        : 1);
+          visit_key(&context, cursor, visitor, &key, precord, distinct);
         } while ((st = cursor_move_impl(&context, cursor, &key,
-                                0, UPS_CURSOR_NEXT)) == 0);
+                                precord, UPS_CURSOR_NEXT)) == 0);
 
         if (st != UPS_SUCCESS)
           goto bail;
@@ -1030,10 +1259,8 @@ LocalDatabase::scan(Transaction *txn, ScanVisitor *visitor, bool distinct)
 
     /* pick up the remaining transactional keys */
     while ((st = cursor_move_impl(&context, cursor, &key,
-                            0, UPS_CURSOR_NEXT)) == 0) {
-      (*visitor)(key.data, key.size, distinct
-                                     ? cursor->get_duplicate_count(&context)
-                                     : 1);
+                            precord, UPS_CURSOR_NEXT)) == 0) {
+      visit_key(&context, cursor, visitor, &key, precord, distinct);
     }
 
 bail:
@@ -1056,9 +1283,21 @@ ups_status_t
 LocalDatabase::insert(Cursor *hcursor, Transaction *txn, ups_key_t *key,
             ups_record_t *record, uint32_t flags)
 {
-  LocalCursor *cursor = (LocalCursor *)hcursor;
+  return (insert_one((LocalCursor *)hcursor, txn, key, record, flags, 0));
+}
+
+ups_status_t
+LocalDatabase::insert_one(LocalCursor *cursor, Transaction *txn,
+            ups_key_t *key, ups_record_t *record, uint32_t flags,
+            uint64_t *leaf_hint)
+{
   Context context(lenv(), (LocalTransaction *)txn, this);
 
+  if (m_bulk_loader) {
+    ups_trace(("cannot insert while a bulk load is active"));
+    return (UPS_INV_PARAMETER);
+  }
+
   try {
     if (m_config.flags & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64)) {
       if (key->size == 0 && key->data == 0) {
@@ -1152,7 +1391,7 @@ LocalDatabase::insert(Cursor *hcursor, Transaction *txn, ups_key_t *key,
       context.txn = local_txn;
     }
 
-    st = insert_impl(&context, cursor, key, record, flags);
+    st = insert_impl(&context, cursor, key, record, flags, leaf_hint);
     return (finalize(&context, st, local_txn));
   }
   catch (Exception &ex) {
@@ -1167,6 +1406,11 @@ LocalDatabase::erase(Cursor *hcursor, Transaction *txn, ups_key_t *key,
   LocalCursor *cursor = (LocalCursor *)hcursor;
   Context context(lenv(), (LocalTransaction *)txn, this);
 
+  if (m_bulk_loader) {
+    ups_trace(("cannot erase while a bulk load is active"));
+    return (UPS_INV_PARAMETER);
+  }
+
   try {
     ups_status_t st = 0;
     LocalTransaction *local_txn = 0;
@@ -1206,8 +1450,16 @@ ups_status_t
 LocalDatabase::find(Cursor *hcursor, Transaction *txn, ups_key_t *key,
             ups_record_t *record, uint32_t flags)
 {
-  LocalCursor *cursor = (LocalCursor *)hcursor;
+  return (find_one((LocalCursor *)hcursor, txn, key, record, flags, 0));
+}
+
+ups_status_t
+LocalDatabase::find_one(LocalCursor *cursor, Transaction *txn,
+            ups_key_t *key, ups_record_t *record, uint32_t flags,
+            uint64_t *leaf_hint)
+{
   Context context(lenv(), (LocalTransaction *)txn, this);
+  context.changeset.set_shared(supports_concurrent_reads());
 
   try {
     ups_status_t st = 0;
@@ -1236,7 +1488,7 @@ LocalDatabase::find(Cursor *hcursor, Transaction *txn, ups_key_t *key,
     if (cursor)
       cursor->set_to_nil(LocalCursor::kBoth);
 
-    st = find_impl(&context, cursor, key, record, flags);
+    st = find_impl(&context, cursor, key, record, flags, leaf_hint);
     if (st)
       return (finalize(&context, st, 0));
 
@@ -1277,6 +1529,261 @@ LocalDatabase::find(Cursor *hcursor, Transaction *txn, ups_key_t *key,
   }
 }
 
+// Sorts the indices of a key array; used by find_many()
+struct KeyIndexComparator
+{
+  KeyIndexComparator(BtreeIndex *btree, ups_key_t *keys)
+    : btree(btree), keys(keys) {
+  }
+
+  bool operator()(uint32_t lhs, uint32_t rhs) const {
+    return (btree->compare_keys(&keys[lhs], &keys[rhs]) < 0);
+  }
+
+  BtreeIndex *btree;
+  ups_key_t *keys;
+};
+
+ups_status_t
+LocalDatabase::insert_many(Transaction *txn, ups_key_t *keys,
+            ups_record_t *records, uint32_t count, ups_status_t *results,
+            uint32_t flags)
+{
+  try {
+    /* record number: each key requires its own memory for the new
+     * record number; allocate all of them in advance */
+    if ((get_flags() & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64))
+        && !(flags & UPS_OVERWRITE)) {
+      uint16_t size = (get_flags() & UPS_RECORD_NUMBER32)
+                          ? sizeof(uint32_t)
+                          : sizeof(uint64_t);
+      ByteArray *arena = &key_arena(txn);
+      arena->resize(count * size);
+      for (uint32_t i = 0; i < count; i++) {
+        if (!keys[i].data) {
+          keys[i].data = arena->get_ptr() + i * size;
+          keys[i].size = size;
+        }
+      }
+    }
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+
+  /* if the keys are sorted then the next key is usually inserted in the
+   * same leaf as the previous one */
+  uint64_t leaf_hint = 0;
+  for (uint32_t i = 0; i < count; i++)
+    results[i] = insert_one(0, txn, &keys[i], &records[i], flags, &leaf_hint);
+  return (0);
+}
+
+ups_status_t
+LocalDatabase::find_many(Transaction *txn, ups_key_t *keys,
+            ups_record_t *records, uint32_t count, ups_status_t *results,
+            uint32_t flags)
+{
+  try {
+    /* sort the keys; then subsequent keys are usually found in the
+     * same leaf */
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; i++)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                    KeyIndexComparator(m_btree_index.get(), keys));
+
+    /* each lookup overwrites the record arena; therefore the record data
+     * is collected in a temporary buffer, and copied to the arena when
+     * all lookups are completed */
+    std::vector<uint8_t> buffer;
+    std::vector<size_t> offsets(count);
+    uint64_t leaf_hint = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t idx = order[i];
+      ups_record_t *record = &records[idx];
+      results[idx] = find_one(0, txn, &keys[idx], record, flags, &leaf_hint);
+      if (results[idx] != 0
+          || (record->flags & UPS_RECORD_USER_ALLOC)
+          || (flags & UPS_DIRECT_ACCESS))
+        continue;
+      offsets[idx] = buffer.size();
+      buffer.insert(buffer.end(), (uint8_t *)record->data,
+                      (uint8_t *)record->data + record->size);
+    }
+
+    ByteArray *arena = &record_arena(txn);
+    if (!buffer.empty()) {
+      arena->resize(buffer.size());
+      ::memcpy(arena->get_ptr(), &buffer[0], buffer.size());
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+      if (results[i] != 0
+          || (records[i].flags & UPS_RECORD_USER_ALLOC)
+          || (flags & UPS_DIRECT_ACCESS))
+        continue;
+      records[i].data = records[i].size
+                            ? arena->get_ptr() + offsets[i]
+                            : 0;
+    }
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ups_status_t
+LocalDatabase::erase_many(Transaction *txn, ups_key_t *keys, uint32_t count,
+            ups_status_t *results, uint32_t flags)
+{
+  for (uint32_t i = 0; i < count; i++)
+    results[i] = erase(0, txn, &keys[i], flags);
+  return (0);
+}
+
+ups_status_t
+LocalDatabase::bulk_begin(uint32_t fill_factor, uint32_t flags)
+{
+  Context context(lenv(), 0, this);
+
+  if (m_bulk_loader) {
+    ups_trace(("a bulk load is already active"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (get_flags() & UPS_READ_ONLY) {
+    ups_trace(("cannot bulk load a read-only database"));
+    return (UPS_WRITE_PROTECTED);
+  }
+  if (m_cursor_list) {
+    ups_trace(("cannot bulk load a database with open cursors"));
+    return (UPS_CURSOR_STILL_OPEN);
+  }
+
+  try {
+    // all committed Transactions have to be flushed to the btree
+    if (lenv()->txn_manager())
+      lenv()->txn_manager()->flush_committed_txns(&context);
+    if (m_txn_index && m_txn_index->get_first()) {
+      ups_trace(("cannot bulk load a database that is modified by "
+                 "a Transaction"));
+      return (UPS_TXN_STILL_OPEN);
+    }
+
+    Page *root = lenv()->page_manager()->fetch(&context,
+                    m_btree_index->root_address());
+    BtreeNodeProxy *node = m_btree_index->get_node_from_page(root);
+    if (!node->is_leaf() || node->get_count() > 0) {
+      ups_trace(("bulk loads require an empty database"));
+      return (UPS_INV_PARAMETER);
+    }
+
+    m_bulk_loader.reset(new BtreeBulkLoader(&context, m_btree_index.get(),
+                            fill_factor));
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ups_status_t
+LocalDatabase::bulk_insert(ups_key_t *key, ups_record_t *record)
+{
+  Context context(lenv(), 0, this);
+
+  if (!m_bulk_loader) {
+    ups_trace(("no bulk load is active; call ups_db_bulk_begin first"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  try {
+    if (m_config.flags & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64)) {
+      if (key->size == 0 && key->data != 0) {
+        ups_trace(("for record number keys set key size to 0, "
+                               "key->data to null"));
+        return (UPS_INV_PARAMETER);
+      }
+      if (key->size != 0 && key->size != m_config.key_size) {
+        ups_trace(("invalid key size (%u instead of %u)",
+              key->size, m_config.key_size));
+        return (UPS_INV_KEY_SIZE);
+      }
+    }
+    else if (m_config.key_size != UPS_KEY_SIZE_UNLIMITED
+        && key->size != m_config.key_size) {
+      ups_trace(("invalid key size (%u instead of %u)",
+            key->size, m_config.key_size));
+      return (UPS_INV_KEY_SIZE);
+    }
+    if (m_config.record_size != UPS_RECORD_SIZE_UNLIMITED
+        && record->size != m_config.record_size) {
+      ups_trace(("invalid record size (%u instead of %u)",
+            record->size, m_config.record_size));
+      return (UPS_INV_RECORD_SIZE);
+    }
+
+    // record number databases: assign the next record number, or continue
+    // with the record number of the key
+    if (m_config.flags & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64)) {
+      if (key->size == 0) {
+        uint64_t recno = next_record_number();
+        ByteArray *arena = &key_arena(0);
+        arena->resize(m_config.key_size);
+        key->data = arena->get_ptr();
+        key->size = m_config.key_size;
+        if (m_config.flags & UPS_RECORD_NUMBER32)
+          *(uint32_t *)key->data = (uint32_t)recno;
+        else
+          *(uint64_t *)key->data = recno;
+      }
+      else {
+        uint64_t recno = m_config.flags & UPS_RECORD_NUMBER32
+                            ? *(uint32_t *)key->data
+                            : *(uint64_t *)key->data;
+        if (recno <= m_recno) {
+          ups_trace(("keys are not sorted"));
+          return (UPS_INV_PARAMETER);
+        }
+        m_recno = recno;
+      }
+    }
+
+    /* purge cache if necessary */
+    lenv()->page_manager()->purge_cache(&context);
+
+    return (m_bulk_loader->append(&context, key, record));
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ups_status_t
+LocalDatabase::bulk_end()
+{
+  if (!m_bulk_loader) {
+    ups_trace(("no bulk load is active"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  m_bulk_loader.reset();
+
+  // the loaded pages are not journalled; write them to disk
+  try {
+    if ((get_flags() & UPS_IN_MEMORY) == 0) {
+      lenv()->page_manager()->flush_all_pages();
+      lenv()->device()->flush();
+    }
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
 Cursor *
 LocalDatabase::cursor_create_impl(Transaction *txn)
 {
@@ -1298,6 +1805,7 @@ LocalDatabase::cursor_move(Cursor *hcursor, ups_key_t *key,
   try {
     Context context(lenv(), (LocalTransaction *)cursor->get_txn(),
             this);
+    context.changeset.set_shared(supports_concurrent_reads());
 
     return (cursor_move_impl(&context, cursor, key, record, flags));
   }
@@ -1368,6 +1876,9 @@ LocalDatabase::close_impl(uint32_t flags)
 {
   Context context(lenv(), 0, this);
 
+  // an unfinished bulk load is closed; its pages are flushed below
+  m_bulk_loader.reset();
+
   if (is_modified_by_active_transaction()) {
     ups_trace(("cannot close a Database that is modified by "
                "a currently active Transaction"));
@@ -1597,7 +2108,8 @@ LocalDatabase::drop(Context *context)
 
 ups_status_t
 LocalDatabase::insert_impl(Context *context, LocalCursor *cursor,
-                ups_key_t *key, ups_record_t *record, uint32_t flags)
+                ups_key_t *key, ups_record_t *record, uint32_t flags,
+                uint64_t *leaf_hint)
 {
   ups_status_t st = 0;
 
@@ -1612,7 +2124,8 @@ LocalDatabase::insert_impl(Context *context, LocalCursor *cursor,
                                                 ? cursor->get_txn_cursor()
                                                 : 0);
   else
-    st = m_btree_index->insert(context, cursor, key, record, flags);
+    st = m_btree_index->insert(context, cursor, key, record, flags,
+                    leaf_hint);
 
   // couple the cursor to the inserted key
   if (st == 0 && cursor) {
@@ -1655,7 +2168,8 @@ LocalDatabase::insert_impl(Context *context, LocalCursor *cursor,
 
 ups_status_t
 LocalDatabase::find_impl(Context *context, LocalCursor *cursor,
-                ups_key_t *key, ups_record_t *record, uint32_t flags)
+                ups_key_t *key, ups_record_t *record, uint32_t flags,
+                uint64_t *leaf_hint)
 {
   /* purge cache if necessary */
   lenv()->page_manager()->purge_cache(context);
@@ -1668,7 +2182,8 @@ LocalDatabase::find_impl(Context *context, LocalCursor *cursor,
     return (find_txn(context, cursor, key, record, flags));
 
   return (m_btree_index->find(context, cursor, key, &key_arena(context->txn),
-                          record, &record_arena(context->txn), flags));
+                          record, &record_arena(context->txn), flags,
+                          leaf_hint));
 }
 
 ups_status_t
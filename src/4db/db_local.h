@@ -34,6 +34,7 @@
 // destructor
 #include "2compressor/compressor.h"
 #include "3btree/btree_index.h"
+#include "3btree/btree_bulk.h"
 #include "4txn/txn_local.h"
 #include "4db/db.h"
 
@@ -65,7 +66,8 @@ class LocalDatabase : public Database {
 
     // Constructor
     LocalDatabase(Environment *env, DatabaseConfiguration &config)
-      : Database(env, config), m_recno(0), m_cmp_func(0) {
+      : Database(env, config), m_recno(0), m_cmp_func(0),
+        m_key_compression_algo(0) {
     }
 
     // Returns the btree index
@@ -121,10 +123,39 @@ class LocalDatabase : public Database {
     virtual ups_status_t find(Cursor *cursor, Transaction *txn, ups_key_t *key,
                     ups_record_t *record, uint32_t flags);
 
+    // Inserts many key/value pairs (ups_db_insert_many)
+    virtual ups_status_t insert_many(Transaction *txn, ups_key_t *keys,
+                    ups_record_t *records, uint32_t count,
+                    ups_status_t *results, uint32_t flags);
+
+    // Lookup of many keys (ups_db_find_many)
+    virtual ups_status_t find_many(Transaction *txn, ups_key_t *keys,
+                    ups_record_t *records, uint32_t count,
+                    ups_status_t *results, uint32_t flags);
+
+    // Erases many keys (ups_db_erase_many)
+    virtual ups_status_t erase_many(Transaction *txn, ups_key_t *keys,
+                    uint32_t count, ups_status_t *results, uint32_t flags);
+
+    // Starts a bulk load (ups_db_bulk_begin)
+    virtual ups_status_t bulk_begin(uint32_t fill_factor, uint32_t flags);
+
+    // Appends a sorted key/value pair to a bulk load (ups_db_bulk_insert)
+    virtual ups_status_t bulk_insert(ups_key_t *key, ups_record_t *record);
+
+    // Finishes a bulk load (ups_db_bulk_end)
+    virtual ups_status_t bulk_end();
+
     // Moves a cursor, returns key and/or record (ups_cursor_move)
     virtual ups_status_t cursor_move(Cursor *cursor, ups_key_t *key,
                     ups_record_t *record, uint32_t flags);
 
+    // Returns true if read-only operations can run concurrently. Requires
+    // UPS_ENABLE_CONCURRENT_READS; Transactions, duplicate keys, variable
+    // length keys and compression are not supported because their read
+    // paths update shared caches.
+    virtual bool supports_concurrent_reads();
+
     // Inserts a key/record pair in a txn node; if cursor is not NULL it will
     // be attached to the new txn_op structure
     // TODO this should be private
@@ -215,13 +246,37 @@ class LocalDatabase : public Database {
     ups_status_t cursor_move_impl(Context *context, LocalCursor *cursor,
                     ups_key_t *key, ups_record_t *record, uint32_t flags);
 
+    // Implements scan() with several threads (see UPS_PARAM_SCAN_THREADS).
+    // Returns false if the scan cannot run in parallel; then nothing was
+    // scanned
+    bool scan_parallel(Context *context, ScanVisitor *visitor, bool distinct);
+
+    // Scans the keys of |range| with a cursor; used by scan_parallel()
+    // for the leaves which are modified by Transactions
+    void scan_range(Context *context, LocalCursor *cursor,
+                    const BtreeScanRange &range, ScanVisitor *visitor);
+
+    // Implements insert() and insert_many(). |leaf_hint| is the address
+    // of the Btree leaf which received the previous key of a batch
+    // (or 0); it is updated with the leaf of the inserted key
+    ups_status_t insert_one(LocalCursor *cursor, Transaction *txn,
+                    ups_key_t *key, ups_record_t *record, uint32_t flags,
+                    uint64_t *leaf_hint);
+
+    // Implements find() and find_many(); see insert_one() for |leaf_hint|
+    ups_status_t find_one(LocalCursor *cursor, Transaction *txn,
+                    ups_key_t *key, ups_record_t *record, uint32_t flags,
+                    uint64_t *leaf_hint);
+
     // The actual implementation of insert()
     ups_status_t insert_impl(Context *context, LocalCursor *cursor,
-                    ups_key_t *key, ups_record_t *record, uint32_t flags);
+                    ups_key_t *key, ups_record_t *record, uint32_t flags,
+                    uint64_t *leaf_hint = 0);
 
     // The actual implementation of find()
     ups_status_t find_impl(Context *context, LocalCursor *cursor,
-                    ups_key_t *key, ups_record_t *record, uint32_t flags);
+                    ups_key_t *key, ups_record_t *record, uint32_t flags,
+                    uint64_t *leaf_hint = 0);
 
     // The actual implementation of erase()
     ups_status_t erase_impl(Context *context, LocalCursor *cursor,
@@ -275,6 +330,9 @@ class LocalDatabase : public Database {
     // the transaction index
     ScopedPtr<TransactionIndex> m_txn_index;
 
+    // the bulk loader; only set between bulk_begin() and bulk_end()
+    ScopedPtr<BtreeBulkLoader> m_bulk_loader;
+
     // the comparison function
     ups_compare_func_t m_cmp_func;
 
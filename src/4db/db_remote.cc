@@ -158,6 +158,9 @@ RemoteDatabase::insert(Cursor *hcursor, Transaction *htxn, ups_key_t *key,
   RemoteCursor *cursor = (RemoteCursor *)hcursor;
 
   try {
+    // the Database is modified; the cursors must not return stale data
+    discard_cursor_batches();
+
     bool send_key = true;
     RemoteEnvironment *env = renv();
     RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(htxn);
@@ -276,6 +279,9 @@ RemoteDatabase::erase(Cursor *hcursor, Transaction *htxn, ups_key_t *key,
   RemoteCursor *cursor = (RemoteCursor *)hcursor;
 
   try {
+    // the Database is modified; the cursors must not return stale data
+    discard_cursor_batches();
+
     if (cursor) {
       SerializedWrapper request;
       request.id = kCursorEraseRequest;
@@ -321,6 +327,9 @@ RemoteDatabase::find(Cursor *hcursor, Transaction *htxn, ups_key_t *key,
   RemoteCursor *cursor = (RemoteCursor *)hcursor;
 
   try {
+    if (cursor)
+      cursor->discard_batch();
+
     if (cursor && !htxn)
       htxn = cursor->get_txn();
 
@@ -386,6 +395,260 @@ RemoteDatabase::find(Cursor *hcursor, Transaction *htxn, ups_key_t *key,
   }
 }
 
+ups_status_t
+RemoteDatabase::insert_async(Transaction *htxn, ups_key_t *key,
+            ups_record_t *record, uint32_t flags,
+            ups_async_callback_t callback, void *context)
+{
+  try {
+    // the Database is modified; the cursors must not return stale data
+    discard_cursor_batches();
+
+    RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(htxn);
+
+    SerializedWrapper request;
+    request.id = kDbInsertRequest;
+    request.db_insert_request.db_handle = m_remote_handle;
+    request.db_insert_request.txn_handle = txn ? txn->get_remote_handle() : 0;
+    request.db_insert_request.flags = flags;
+    /* recno: the key is generated by the server */
+    if (!(get_flags() & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64))) {
+      request.db_insert_request.has_key = true;
+      request.db_insert_request.key.has_data = true;
+      request.db_insert_request.key.data.size = key->size;
+      request.db_insert_request.key.data.value = (uint8_t *)key->data;
+      request.db_insert_request.key.flags = key->flags;
+      request.db_insert_request.key.intflags = key->_flags;
+    }
+    request.db_insert_request.has_record = true;
+    request.db_insert_request.record.has_data = true;
+    request.db_insert_request.record.data.size = record->size;
+    request.db_insert_request.record.data.value = (uint8_t *)record->data;
+    request.db_insert_request.record.flags = record->flags;
+    request.db_insert_request.record.partial_size = record->partial_size;
+    request.db_insert_request.record.partial_offset = record->partial_offset;
+
+    renv()->perform_async_request(this, &request, key, callback, context);
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ups_status_t
+RemoteDatabase::find_async(Transaction *htxn, ups_key_t *key, uint32_t flags,
+            ups_async_callback_t callback, void *context)
+{
+  try {
+    RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(htxn);
+
+    SerializedWrapper request;
+    request.id = kDbFindRequest;
+    request.db_find_request.db_handle = m_remote_handle;
+    request.db_find_request.txn_handle = txn ? txn->get_remote_handle() : 0;
+    request.db_find_request.flags = flags;
+    request.db_find_request.key.has_data = true;
+    request.db_find_request.key.data.size = key->size;
+    request.db_find_request.key.data.value = (uint8_t *)key->data;
+    request.db_find_request.key.flags = key->flags;
+    request.db_find_request.key.intflags = key->_flags;
+    request.db_find_request.has_record = true;
+
+    renv()->perform_async_request(this, &request, key, callback, context);
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ups_status_t
+RemoteDatabase::erase_async(Transaction *htxn, ups_key_t *key, uint32_t flags,
+            ups_async_callback_t callback, void *context)
+{
+  try {
+    // the Database is modified; the cursors must not return stale data
+    discard_cursor_batches();
+
+    RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(htxn);
+
+    SerializedWrapper request;
+    request.id = kDbEraseRequest;
+    request.db_erase_request.db_handle = m_remote_handle;
+    request.db_erase_request.txn_handle = txn ? txn->get_remote_handle() : 0;
+    request.db_erase_request.flags = flags;
+    request.db_erase_request.key.has_data = true;
+    request.db_erase_request.key.data.size = key->size;
+    request.db_erase_request.key.data.value = (uint8_t *)key->data;
+    request.db_erase_request.key.flags = key->flags;
+    request.db_erase_request.key.intflags = key->_flags;
+
+    renv()->perform_async_request(this, &request, key, callback, context);
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ups_status_t
+RemoteDatabase::insert_many(Transaction *htxn, ups_key_t *keys,
+                ups_record_t *records, uint32_t count, ups_status_t *results,
+                uint32_t flags)
+{
+  try {
+    // the Database is modified; the cursors must not return stale data
+    discard_cursor_batches();
+
+    RemoteEnvironment *env = renv();
+    RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(htxn);
+
+    bool is_recno = (get_flags()
+                    & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64)) != 0;
+
+    Protocol request(Protocol::DB_INSERT_MANY_REQUEST);
+    DbInsertManyRequest *r = request.mutable_db_insert_many_request();
+    r->set_db_handle(m_remote_handle);
+    r->set_txn_handle(txn ? txn->get_remote_handle() : 0);
+    r->set_flags(flags);
+    for (uint32_t i = 0; i < count; i++) {
+      /* recno: do not send the key */
+      Protocol::assign_key(r->add_keys(), &keys[i], !is_recno);
+      Protocol::assign_record(r->add_records(), &records[i]);
+    }
+
+    ScopedPtr<Protocol> reply(env->perform_request(&request));
+
+    ups_assert(reply->has_db_insert_many_reply());
+
+    ups_status_t st = reply->db_insert_many_reply().status();
+    if (st)
+      return (st);
+
+    for (uint32_t i = 0; i < count; i++)
+      results[i] = reply->db_insert_many_reply().results(i);
+
+    /* recno: copy the new keys; the memory is allocated in one chunk */
+    if (reply->db_insert_many_reply().keys_size() > 0) {
+      size_t size = (get_flags() & UPS_RECORD_NUMBER32)
+                        ? sizeof(uint32_t)
+                        : sizeof(uint64_t);
+      ByteArray *arena = &key_arena(txn);
+      arena->resize(count * size);
+
+      for (uint32_t i = 0; i < count; i++) {
+        if (results[i])
+          continue;
+        if (!keys[i].data) {
+          keys[i].data = arena->get_ptr() + i * size;
+          keys[i].size = (uint16_t)size;
+        }
+        ups_assert(keys[i].size
+                == reply->db_insert_many_reply().keys(i).data().size());
+        ::memcpy(keys[i].data, &reply->db_insert_many_reply().keys(i).data()[0],
+                keys[i].size);
+      }
+    }
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ups_status_t
+RemoteDatabase::find_many(Transaction *htxn, ups_key_t *keys,
+                ups_record_t *records, uint32_t count, ups_status_t *results,
+                uint32_t flags)
+{
+  try {
+    RemoteEnvironment *env = renv();
+    RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(htxn);
+
+    Protocol request(Protocol::DB_FIND_MANY_REQUEST);
+    DbFindManyRequest *r = request.mutable_db_find_many_request();
+    r->set_db_handle(m_remote_handle);
+    r->set_txn_handle(txn ? txn->get_remote_handle() : 0);
+    r->set_flags(flags);
+    for (uint32_t i = 0; i < count; i++)
+      Protocol::assign_key(r->add_keys(), &keys[i]);
+
+    ScopedPtr<Protocol> reply(env->perform_request(&request));
+
+    ups_assert(reply->has_db_find_many_reply());
+
+    ups_status_t st = reply->db_find_many_reply().status();
+    if (st)
+      return (st);
+
+    /* the records share a single buffer in the record arena */
+    size_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      results[i] = reply->db_find_many_reply().results(i);
+      if (results[i] == 0 && !(records[i].flags & UPS_RECORD_USER_ALLOC))
+        total += reply->db_find_many_reply().records(i).data().size();
+    }
+
+    ByteArray *arena = &record_arena(txn);
+    arena->resize(total);
+
+    size_t offset = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      if (results[i])
+        continue;
+      const std::string &data = reply->db_find_many_reply().records(i).data();
+      records[i].size = (uint32_t)data.size();
+      if (!(records[i].flags & UPS_RECORD_USER_ALLOC)) {
+        records[i].data = arena->get_ptr() + offset;
+        offset += data.size();
+      }
+      if (records[i].size)
+        ::memcpy(records[i].data, data.data(), records[i].size);
+    }
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ups_status_t
+RemoteDatabase::erase_many(Transaction *htxn, ups_key_t *keys,
+                uint32_t count, ups_status_t *results, uint32_t flags)
+{
+  try {
+    // the Database is modified; the cursors must not return stale data
+    discard_cursor_batches();
+
+    RemoteEnvironment *env = renv();
+    RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(htxn);
+
+    Protocol request(Protocol::DB_ERASE_MANY_REQUEST);
+    DbEraseManyRequest *r = request.mutable_db_erase_many_request();
+    r->set_db_handle(m_remote_handle);
+    r->set_txn_handle(txn ? txn->get_remote_handle() : 0);
+    r->set_flags(flags);
+    for (uint32_t i = 0; i < count; i++)
+      Protocol::assign_key(r->add_keys(), &keys[i]);
+
+    ScopedPtr<Protocol> reply(env->perform_request(&request));
+
+    ups_assert(reply->has_db_erase_many_reply());
+
+    ups_status_t st = reply->db_erase_many_reply().status();
+    if (st)
+      return (st);
+
+    for (uint32_t i = 0; i < count; i++)
+      results[i] = reply->db_erase_many_reply().results(i);
+    return (0);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
 Cursor *
 RemoteDatabase::cursor_create_impl(Transaction *htxn)
 {
@@ -416,6 +679,8 @@ RemoteDatabase::cursor_clone_impl(Cursor *hsrc)
 {
   RemoteCursor *src = (RemoteCursor *)hsrc;
 
+  src->discard_batch();
+
   SerializedWrapper request;
   request.id = kCursorCloneRequest;
   request.cursor_clone_request.cursor_handle = src->remote_handle();
@@ -439,6 +704,12 @@ RemoteDatabase::cursor_move(Cursor *hcursor, ups_key_t *key,
   RemoteCursor *cursor = (RemoteCursor *)hcursor;
 
   try {
+    // scans fetch many key/record pairs with a single request
+    if (RemoteCursor::is_batchable(record, flags))
+      return (cursor->move_batched(key, record, flags));
+
+    cursor->discard_batch();
+
     RemoteEnvironment *env = renv();
 
     RemoteTransaction *txn = dynamic_cast<RemoteTransaction *>(cursor->get_txn());
@@ -494,6 +765,13 @@ RemoteDatabase::cursor_move(Cursor *hcursor, ups_key_t *key,
   }
 }
 
+void
+RemoteDatabase::discard_cursor_batches()
+{
+  for (Cursor *c = cursor_list(); c != 0; c = c->get_next())
+    ((RemoteCursor *)c)->discard_batch();
+}
+
 ups_status_t
 RemoteDatabase::close_impl(uint32_t flags)
 {
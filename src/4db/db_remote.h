@@ -82,10 +82,58 @@ class RemoteDatabase : public Database
     virtual ups_status_t find(Cursor *cursor, Transaction *txn, ups_key_t *key,
                     ups_record_t *record, uint32_t flags);
 
+    // Inserts a batch of key/value pairs (ups_db_insert_many)
+    virtual ups_status_t insert_many(Transaction *txn, ups_key_t *keys,
+                    ups_record_t *records, uint32_t count,
+                    ups_status_t *results, uint32_t flags);
+
+    // Looks up a batch of keys (ups_db_find_many)
+    virtual ups_status_t find_many(Transaction *txn, ups_key_t *keys,
+                    ups_record_t *records, uint32_t count,
+                    ups_status_t *results, uint32_t flags);
+
+    // Erases a batch of keys (ups_db_erase_many)
+    virtual ups_status_t erase_many(Transaction *txn, ups_key_t *keys,
+                    uint32_t count, ups_status_t *results, uint32_t flags);
+
+    // Inserts a key/value pair asynchronously (ups_db_insert_async)
+    virtual ups_status_t insert_async(Transaction *txn, ups_key_t *key,
+                    ups_record_t *record, uint32_t flags,
+                    ups_async_callback_t callback, void *context);
+
+    // Lookup of a key asynchronously (ups_db_find_async)
+    virtual ups_status_t find_async(Transaction *txn, ups_key_t *key,
+                    uint32_t flags, ups_async_callback_t callback,
+                    void *context);
+
+    // Erases a key asynchronously (ups_db_erase_async)
+    virtual ups_status_t erase_async(Transaction *txn, ups_key_t *key,
+                    uint32_t flags, ups_async_callback_t callback,
+                    void *context);
+
+    // Starts a bulk load (ups_db_bulk_begin)
+    virtual ups_status_t bulk_begin(uint32_t fill_factor, uint32_t flags) {
+      return (UPS_NOT_IMPLEMENTED);
+    }
+
+    // Appends a sorted key/value pair to a bulk load (ups_db_bulk_insert)
+    virtual ups_status_t bulk_insert(ups_key_t *key, ups_record_t *record) {
+      return (UPS_NOT_IMPLEMENTED);
+    }
+
+    // Finishes a bulk load (ups_db_bulk_end)
+    virtual ups_status_t bulk_end() {
+      return (UPS_NOT_IMPLEMENTED);
+    }
+
     // Moves a cursor, returns key and/or record (ups_cursor_move)
     virtual ups_status_t cursor_move(Cursor *cursor, ups_key_t *key,
                     ups_record_t *record, uint32_t flags);
 
+    // Discards the key/record pairs which the cursors fetched in advance;
+    // called before the Database is modified
+    void discard_cursor_batches();
+
   protected:
     // Creates a cursor; this is the actual implementation
     virtual Cursor *cursor_create_impl(Transaction *txn);
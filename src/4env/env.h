@@ -84,7 +84,7 @@ class Environment
     }
 
     // Returns this Environment's mutex
-    Mutex &mutex() {
+    SharedMutex &mutex() {
       return (m_mutex);
     }
 
@@ -104,6 +104,10 @@ class Environment
     // Accepted flags: UPS_FLUSH_BLOCKING
     ups_status_t flush(uint32_t flags);
 
+    // Waits till all asynchronous operations were completed
+    // (ups_env_wait_async)
+    ups_status_t wait_async();
+
     // Creates a new database in the environment (ups_env_create_db)
     ups_status_t create_db(Database **db, DatabaseConfiguration &config,
                     const ups_parameter_t *param);
@@ -183,6 +187,23 @@ class Environment
     // Commits a transaction (ups_txn_commit)
     virtual ups_status_t do_txn_commit(Transaction *txn, uint32_t flags) = 0;
 
+    // Returns a ticket for waiting till the most recent commit is durable,
+    // or 0 if no wait is required. Called with the mutex locked.
+    virtual uint64_t do_txn_commit_ticket() {
+      return (0);
+    }
+
+    // Waits till the commit identified by |ticket| is durable. Called
+    // without holding the mutex
+    virtual void do_txn_commit_wait(uint64_t ticket) {
+    }
+
+    // Waits till all asynchronous operations were completed
+    // (ups_env_wait_async); local Environments have nothing to wait for
+    virtual ups_status_t do_wait_async() {
+      return (0);
+    }
+
     // Commits a transaction (ups_txn_abort)
     virtual ups_status_t do_txn_abort(Transaction *txn, uint32_t flags) = 0;
 
@@ -193,8 +214,9 @@ class Environment
     virtual void do_fill_metrics(ups_env_metrics_t *metrics) const = 0;
 
   protected:
-    // A mutex to serialize access to this Environment
-    Mutex m_mutex;
+    // A mutex to serialize access to this Environment; read-only operations
+    // acquire it in shared mode if UPS_ENABLE_CONCURRENT_READS is set
+    SharedMutex m_mutex;
 
     // The Environment's configuration
     EnvironmentConfiguration m_config;
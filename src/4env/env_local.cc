@@ -153,6 +153,7 @@ LocalEnvironment::do_create()
   if (m_journal.get())
     Page::flush(m_device.get(), m_header->header_page()->get_persisted_data());
 
+  start_janitor();
   return (0);
 }
 
@@ -273,9 +274,21 @@ fail_with_fake_cleansing:
   if (m_header->page_manager_blobid() != 0)
     m_page_manager->initialize(m_header->page_manager_blobid());
 
+  /* the janitor is started after the recovery */
+  start_janitor();
   return (0);
 }
 
+void
+LocalEnvironment::start_janitor()
+{
+  if (m_config.janitor_interval_msec == 0
+      || (m_config.flags & (UPS_IN_MEMORY | UPS_READ_ONLY)))
+    return;
+
+  m_janitor.reset(new Janitor(this, m_config.janitor_interval_msec));
+}
+
 ups_status_t
 LocalEnvironment::do_get_database_names(uint16_t *names, uint32_t *count)
 {
@@ -346,6 +359,27 @@ LocalEnvironment::do_get_parameters(ups_parameter_t *param)
       case UPS_PARAM_POSIX_FADVISE:
         p->value = m_config.posix_advice;
         break;
+      case UPS_PARAM_CACHE_POLICY:
+        p->value = m_config.cache_policy;
+        break;
+      case UPS_PARAM_FLUSH_THREADS:
+        p->value = m_config.flush_threads;
+        break;
+      case UPS_PARAM_PREFETCH_PAGES:
+        p->value = m_config.prefetch_pages;
+        break;
+      case UPS_PARAM_GROUP_COMMIT_WINDOW:
+        p->value = m_config.group_commit_usec;
+        break;
+      case UPS_PARAM_GROUP_COMMIT_BYTES:
+        p->value = m_config.group_commit_bytes;
+        break;
+      case UPS_PARAM_JANITOR_INTERVAL:
+        p->value = m_config.janitor_interval_msec;
+        break;
+      case UPS_PARAM_SCAN_THREADS:
+        p->value = m_config.scan_threads;
+        break;
       default:
         ups_trace(("unknown parameter %d", (int)p->name));
         return (UPS_INV_PARAMETER);
@@ -739,6 +773,18 @@ LocalEnvironment::do_txn_commit(Transaction *txn, uint32_t flags)
   return (m_txn_manager->commit(txn, flags));
 }
 
+uint64_t
+LocalEnvironment::do_txn_commit_ticket()
+{
+  return (m_journal.get() ? m_journal->unsynced_seqnum() : 0);
+}
+
+void
+LocalEnvironment::do_txn_commit_wait(uint64_t ticket)
+{
+  m_journal->wait_until_durable(ticket);
+}
+
 ups_status_t
 LocalEnvironment::do_txn_abort(Transaction *txn, uint32_t flags)
 {
@@ -750,6 +796,10 @@ LocalEnvironment::do_close(uint32_t flags)
 {
   Context context(this);
 
+  /* stop the janitor before the worker pool is closed */
+  if (m_janitor)
+    m_janitor->close();
+
   /* flush all committed transactions */
   if (m_txn_manager)
     m_txn_manager->flush_committed_txns(&context);
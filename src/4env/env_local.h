@@ -34,6 +34,7 @@
 #include "4env/env.h"
 #include "4env/env_header.h"
 #include "4env/env_local_test.h"
+#include "4env/janitor.h"
 #include "4context/context.h"
 
 #ifndef UPS_ROOT_H
@@ -93,6 +94,11 @@ class LocalEnvironment : public Environment
       return (m_txn_manager.get());
     }
 
+    // Returns the Janitor; can be null (see UPS_PARAM_JANITOR_INTERVAL)
+    Janitor *janitor() {
+      return (m_janitor.get());
+    }
+
     // Increments the lsn and returns the incremented value
     uint64_t next_lsn() {
       return (m_lsn_manager.next());
@@ -141,6 +147,12 @@ class LocalEnvironment : public Environment
     // Commits a transaction (ups_txn_commit)
     virtual ups_status_t do_txn_commit(Transaction *txn, uint32_t flags);
 
+    // Returns the journal's sequence number of the last unsynced write
+    virtual uint64_t do_txn_commit_ticket();
+
+    // Waits till the journal is synced (group commit)
+    virtual void do_txn_commit_wait(uint64_t ticket);
+
     // Commits a transaction (ups_txn_abort)
     virtual ups_status_t do_txn_abort(Transaction *txn, uint32_t flags);
 
@@ -152,10 +164,14 @@ class LocalEnvironment : public Environment
 
   private:
     friend class LocalEnvironmentTest;
+    friend class Janitor;
 
     // Runs the recovery process
     void recover(uint32_t flags);
 
+    // Creates the Janitor (if UPS_PARAM_JANITOR_INTERVAL was specified)
+    void start_janitor();
+
     // Get the btree configuration of the database #i, where |i| is a
     // zero-based index
     PBtreeHeader *btree_header(int i);
@@ -186,6 +202,10 @@ class LocalEnvironment : public Environment
 
     // The lsn manager
     LsnManager m_lsn_manager;
+
+    // The background compaction; destroyed first because its timer runs
+    // on the worker pool of the PageManager
+    ScopedPtr<Janitor> m_janitor;
 };
 
 } // namespace upscaledb
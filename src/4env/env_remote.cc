@@ -35,13 +35,17 @@
 namespace upscaledb {
 
 RemoteEnvironment::RemoteEnvironment(EnvironmentConfiguration config)
-  : Environment(config), m_remote_handle(0), m_buffer(1024 * 4)
+  : Environment(config), m_remote_handle(0), m_buffer(1024 * 4),
+    m_request_id(0)
 {
 }
 
 Protocol *
 RemoteEnvironment::perform_request(Protocol *request)
 {
+  // the replies of the asynchronous requests arrive first
+  complete_async_requests(0);
+
   // use ByteArray to avoid frequent reallocs!
   m_buffer.clear();
 
@@ -68,6 +72,43 @@ void
 RemoteEnvironment::perform_request(SerializedWrapper *request,
                 SerializedWrapper *reply)
 {
+  // the replies of the asynchronous requests arrive first
+  complete_async_requests(0);
+
+  uint32_t request_id = send_request(request);
+  receive_reply(reply);
+  if (reply->request_id != request_id) {
+    ups_log(("unexpected reply %u for request %u",
+                (unsigned)reply->request_id, (unsigned)request_id));
+    throw Exception(UPS_INTERNAL_ERROR);
+  }
+}
+
+void
+RemoteEnvironment::perform_async_request(Database *db,
+                SerializedWrapper *request, ups_key_t *key,
+                ups_async_callback_t callback, void *context)
+{
+  // limit the number of requests in flight
+  complete_async_requests(kMaxAsyncRequests - 1);
+
+  uint32_t request_id = send_request(request);
+
+  m_async_requests.push_back(AsyncRequest());
+  AsyncRequest &ar = m_async_requests.back();
+  ar.request_id = request_id;
+  ar.db = db;
+  ar.callback = callback;
+  ar.context = context;
+  if (key && key->size)
+    ar.key.assign((uint8_t *)key->data, (uint8_t *)key->data + key->size);
+}
+
+uint32_t
+RemoteEnvironment::send_request(SerializedWrapper *request)
+{
+  request->request_id = ++m_request_id;
+
   int size_left = (int)request->get_size();
   request->size = size_left;
   request->magic = UPS_TRANSFER_MAGIC_V2;
@@ -78,25 +119,105 @@ RemoteEnvironment::perform_request(SerializedWrapper *request,
   ups_assert(size_left == 0);
 
   m_socket.send((uint8_t *)m_buffer.get_ptr(), request->size);
+  return (request->request_id);
+}
 
-  // now block and wait for the reply; first read the header, then the
+void
+RemoteEnvironment::receive_reply(SerializedWrapper *reply)
+{
+  // block and wait for the reply; first read the header, then the
   // remaining data
+  m_buffer.resize(8);
   m_socket.recv((uint8_t *)m_buffer.get_ptr(), 8);
 
   // now check the magic and receive the remaining data
   uint32_t magic = *(uint32_t *)((char *)m_buffer.get_ptr() + 0);
   if (magic != UPS_TRANSFER_MAGIC_V2)
     throw Exception(UPS_INTERNAL_ERROR);
-  // TODO check the magic
   int size = (int)*(uint32_t *)((char *)m_buffer.get_ptr() + 4);
   m_buffer.resize(size);
   m_socket.recv((uint8_t *)m_buffer.get_ptr() + 8, size - 8);
 
-  ptr = (uint8_t *)m_buffer.get_ptr();
+  uint8_t *ptr = (uint8_t *)m_buffer.get_ptr();
   reply->deserialize(&ptr, &size);
   ups_assert(size == 0);
 }
 
+void
+RemoteEnvironment::complete_async_requests(size_t max_pending)
+{
+  while (m_async_requests.size() > max_pending) {
+    AsyncRequest &ar = m_async_requests.front();
+
+    // the connection is unusable if a reply is lost; then the remaining
+    // requests are discarded
+    SerializedWrapper reply;
+    try {
+      receive_reply(&reply);
+      if (reply.request_id != ar.request_id) {
+        ups_log(("unexpected reply %u for request %u",
+                    (unsigned)reply.request_id, (unsigned)ar.request_id));
+        throw Exception(UPS_INTERNAL_ERROR);
+      }
+    }
+    catch (Exception &) {
+      m_async_requests.clear();
+      throw;
+    }
+
+    ups_key_t key = {0};
+    key.data = ar.key.empty() ? 0 : &ar.key[0];
+    key.size = (uint16_t)ar.key.size();
+    ups_record_t record = {0};
+    ups_record_t *precord = 0;
+    ups_status_t st;
+
+    switch (reply.id) {
+      case kDbInsertReply:
+        st = reply.db_insert_reply.status;
+        // record number databases: the key was generated by the server
+        if (st == 0 && reply.db_insert_reply.has_key) {
+          key.data = reply.db_insert_reply.key.data.value;
+          key.size = (uint16_t)reply.db_insert_reply.key.data.size;
+        }
+        break;
+      case kDbFindReply:
+        st = reply.db_find_reply.status;
+        if (st == 0) {
+          // approx. matching: the key which was found is returned
+          if (reply.db_find_reply.has_key) {
+            key.data = reply.db_find_reply.key.data.value;
+            key.size = (uint16_t)reply.db_find_reply.key.data.size;
+            key._flags = reply.db_find_reply.key.intflags;
+          }
+          if (reply.db_find_reply.has_record) {
+            record.data = reply.db_find_reply.record.data.value;
+            record.size = reply.db_find_reply.record.data.size;
+            precord = &record;
+          }
+        }
+        break;
+      case kDbEraseReply:
+        st = reply.db_erase_reply.status;
+        break;
+      default:
+        m_async_requests.clear();
+        throw Exception(UPS_INTERNAL_ERROR);
+    }
+
+    // the key and record point into |m_buffer| and |ar|, which stay valid
+    // till the callback returns
+    std::vector<uint8_t> keydata;
+    keydata.swap(ar.key);
+    Database *db = ar.db;
+    ups_async_callback_t callback = ar.callback;
+    void *context = ar.context;
+    m_async_requests.pop_front();
+
+    callback((ups_db_t *)db, st, &key, precord, context);
+  }
+}
+
 ups_status_t
 RemoteEnvironment::do_create()
 {
@@ -439,6 +560,13 @@ RemoteEnvironment::do_close(uint32_t flags)
   return (0);
 }
 
+ups_status_t
+RemoteEnvironment::do_wait_async()
+{
+  complete_async_requests(0);
+  return (0);
+}
+
 void
 RemoteEnvironment::do_fill_metrics(ups_env_metrics_t *metrics) const
 {
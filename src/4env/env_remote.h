@@ -27,6 +27,9 @@
 
 #include "0root/root.h"
 
+#include <deque>
+#include <vector>
+
 #include "ups/upscaledb.h"
 
 // Always verify that a file of level N does not include headers > N!
@@ -59,6 +62,13 @@ class RemoteEnvironment : public Environment
     // reply was fully received. Fills |reply| with the received data.
     void perform_request(SerializedWrapper *request, SerializedWrapper *reply);
 
+    // Sends |request| message with the builtin Serde API, but does not wait
+    // for the reply. |callback| is invoked with |db|, |key| and |context|
+    // when the reply is received (ups_db_insert_async etc).
+    void perform_async_request(Database *db, SerializedWrapper *request,
+                    ups_key_t *key, ups_async_callback_t callback,
+                    void *context);
+
   protected:
     // Creates a new Environment (ups_env_create)
     virtual ups_status_t do_create();
@@ -108,7 +118,42 @@ class RemoteEnvironment : public Environment
     // Fills in the current metrics
     virtual void do_fill_metrics(ups_env_metrics_t *metrics) const;
 
+    // Waits till all asynchronous operations were completed
+    // (ups_env_wait_async)
+    virtual ups_status_t do_wait_async();
+
   private:
+    // An asynchronous request which waits for its reply
+    struct AsyncRequest {
+      // the id which is sent back with the reply
+      uint32_t request_id;
+
+      // the Database of the request
+      Database *db;
+
+      // the callback and its user-defined parameter
+      ups_async_callback_t callback;
+      void *context;
+
+      // a copy of the key, since the caller can reuse its buffers
+      std::vector<uint8_t> key;
+    };
+
+    enum {
+      // the maximum number of asynchronous requests in flight
+      kMaxAsyncRequests = 1024
+    };
+
+    // Serializes and sends a request; returns its request id
+    uint32_t send_request(SerializedWrapper *request);
+
+    // Blocks till the next reply was fully received
+    void receive_reply(SerializedWrapper *reply);
+
+    // Receives the replies of the asynchronous requests and invokes their
+    // callbacks till at most |max_pending| requests are in flight
+    void complete_async_requests(size_t max_pending);
+
     // the remote handle
     uint64_t m_remote_handle;
 
@@ -117,6 +162,13 @@ class RemoteEnvironment : public Environment
 
     // a buffer to avoid frequent memory allocations
     ByteArray m_buffer;
+
+    // the id of the most recent request
+    uint32_t m_request_id;
+
+    // the asynchronous requests in flight, in the order in which they
+    // were sent (the server replies in the same order)
+    std::deque<AsyncRequest> m_async_requests;
 };
 
 } // namespace upscaledb
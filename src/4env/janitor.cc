@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+#include "0root/root.h"
+
+#include <boost/bind.hpp>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "2device/device.h"
+#include "2worker/worker.h"
+#include "3page_manager/page_manager.h"
+#include "3journal/journal.h"
+#include "3btree/btree_index.h"
+#include "4context/context.h"
+#include "4db/db_local.h"
+#include "4env/env_local.h"
+#include "4env/janitor.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+Janitor::Janitor(LocalEnvironment *env, uint32_t interval_msec)
+  : m_env(env), m_interval_msec(interval_msec), m_timer(0),
+    m_timer_active(false), m_closed(false), m_current_db(0), m_rescan(false)
+{
+  m_timer = new boost::asio::deadline_timer(
+                  m_env->page_manager()->worker()->service);
+}
+
+Janitor::~Janitor()
+{
+  close();
+}
+
+void
+Janitor::schedule(LocalDatabase *db)
+{
+  if (db->name() == m_current_db)
+    m_rescan = true;
+  else
+    m_pending.insert(db->name());
+
+  ScopedLock lock(m_mutex);
+  if (!m_timer_active)
+    start_timer();
+}
+
+void
+Janitor::close()
+{
+  ScopedLock lock(m_mutex);
+  m_closed = true;
+
+  // a callback which is still pending will be called with an error
+  if (m_timer) {
+    m_timer->cancel();
+    delete m_timer;
+    m_timer = 0;
+  }
+}
+
+bool
+Janitor::run()
+{
+  // The pages of a changeset stay locked till the worker thread wrote
+  // them. These messages are queued after the current one; locking the
+  // pages now would block forever.
+  Journal *journal = m_env->journal();
+  if (journal && journal->has_pending_changesets())
+    return (true);
+
+  if (m_current_db == 0) {
+    if (m_pending.empty())
+      return (false);
+    m_current_db = *m_pending.begin();
+    m_pending.erase(m_pending.begin());
+    m_resume_key.clear();
+    m_rescan = false;
+  }
+
+  // skip the Database if it was closed in the meantime
+  Environment::DatabaseMap::iterator it
+          = m_env->m_database_map.find(m_current_db);
+  if (it == m_env->m_database_map.end()) {
+    m_current_db = 0;
+    return (!m_pending.empty());
+  }
+
+  LocalDatabase *db = (LocalDatabase *)it->second;
+  Context context(m_env, 0, db);
+
+  try {
+    bool done = db->btree_index()->compact(&context, &m_resume_key,
+                    kMaxVisits, kMaxMerges);
+    if (done) {
+      if (m_rescan)
+        m_rescan = false;
+      else
+        m_current_db = 0;
+    }
+
+    // truncate the file if the merged pages were at the end of the file
+    bool try_reclaim = (m_env->get_flags() & UPS_DISABLE_RECLAIM_INTERNAL)
+                ? false
+                : true;
+#ifdef WIN32
+    // Win32: the file cannot be truncated while it is mapped
+    if (!(m_env->get_flags() & UPS_DISABLE_MMAP))
+      try_reclaim = false;
+#endif
+    if (try_reclaim) {
+      // after a full pass the leaves were moved to the front of the file;
+      // also cut off the space which the device allocated in advance,
+      // otherwise the free pages are not at the end of the file
+      if (done)
+        m_env->device()->reclaim_space();
+      m_env->page_manager()->reclaim_space(&context);
+    }
+
+    if (journal)
+      context.changeset.flush(m_env->next_lsn());
+  }
+  catch (Exception &ex) {
+    ups_log(("janitor failed to compact database %u: %d",
+                (unsigned)m_current_db, ex.code));
+    context.changeset.clear();
+    m_current_db = 0;
+    m_resume_key.clear();
+  }
+
+  return (m_current_db != 0 || !m_pending.empty());
+}
+
+void
+Janitor::start_timer()
+{
+  if (m_closed)
+    return;
+
+  m_timer_active = true;
+  m_timer->expires_from_now(boost::posix_time::milliseconds(m_interval_msec));
+  // the callback is serialized with the other messages of the worker
+  m_timer->async_wait(m_env->page_manager()->worker()->strand.wrap(
+                  boost::bind(&Janitor::on_timer, this,
+                          boost::asio::placeholders::error)));
+}
+
+void
+Janitor::on_timer(const boost::system::error_code &error)
+{
+  // the timer was cancelled
+  if (error)
+    return;
+
+  // the Environment is in use; try again later
+  SharedMutex &mutex = m_env->mutex();
+  if (!mutex.try_lock()) {
+    ScopedLock lock(m_mutex);
+    start_timer();
+    return;
+  }
+
+  bool more = run();
+
+  {
+    ScopedLock lock(m_mutex);
+    m_timer_active = false;
+    if (more)
+      start_timer();
+  }
+
+  mutex.unlock();
+}
+
+} // namespace upscaledb
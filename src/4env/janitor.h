@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * The Janitor compacts the btrees in the background
+ * (UPS_PARAM_JANITOR_INTERVAL).
+ *
+ * ups_db_erase does not merge underfull leaves unless their siblings are
+ * cached, and empty leaves are never returned to the freelist. Whenever
+ * an erase leaves an underfull leaf, the Database is scheduled for
+ * compaction. A timer of the PageManager's worker pool then performs
+ * small compaction steps: each step merges a few leaves (starting where
+ * the previous step stopped), moves the freed pages to the freelist and
+ * truncates the file.
+ *
+ * The steps are executed by the worker thread, which only try-locks the
+ * Environment. If the Environment is in use (or if the worker thread
+ * still has to write pages of a changeset) then the step is postponed
+ * till the timer expires again. The foreground threads therefore never
+ * wait for the Janitor.
+ *
+ * @exception_safe: nothrow
+ * @thread_safe: yes
+ */
+
+#ifndef UPS_JANITOR_H
+#define UPS_JANITOR_H
+
+#include "0root/root.h"
+
+#include <set>
+#include <boost/asio.hpp>
+
+#include "ups/upscaledb.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/dynamic_array.h"
+#include "1base/mutex.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+class LocalDatabase;
+class LocalEnvironment;
+
+class Janitor
+{
+  public:
+    enum {
+      // the maximum number of leaves which are checked in each step
+      kMaxVisits = 64,
+
+      // the maximum number of leaves which are merged in each step
+      kMaxMerges = 16
+    };
+
+    // Constructor; |interval_msec| is the minimum time between two steps
+    Janitor(LocalEnvironment *env, uint32_t interval_msec);
+
+    // Destructor; close() must have been called
+    ~Janitor();
+
+    // Schedules the compaction of |db|. Called whenever an erase left an
+    // underfull leaf. The Environment's mutex is locked.
+    void schedule(LocalDatabase *db);
+
+    // Stops the timer. Called before the Environment (and the worker pool
+    // of the PageManager) is closed. The Environment's mutex is locked.
+    void close();
+
+    // Performs a single compaction step; returns true if more steps are
+    // required. The Environment's mutex is locked.
+    bool run();
+
+  private:
+    // Starts the timer; |m_mutex| is locked
+    void start_timer();
+
+    // Callback of the timer; executed by the worker thread
+    void on_timer(const boost::system::error_code &error);
+
+    // The Environment
+    LocalEnvironment *m_env;
+
+    // The minimum time between two steps
+    uint32_t m_interval_msec;
+
+    // Protects |m_timer|, |m_timer_active| and |m_closed|
+    Mutex m_mutex;
+
+    // The timer; runs on the worker pool of the PageManager
+    boost::asio::deadline_timer *m_timer;
+
+    // True if the timer is running (or its callback is executed)
+    bool m_timer_active;
+
+    // True if close() was called
+    bool m_closed;
+
+    // The Databases which are waiting for compaction (excluding
+    // |m_current_db|)
+    std::set<uint16_t> m_pending;
+
+    // The Database which is currently compacted, or 0
+    uint16_t m_current_db;
+
+    // The position where the compaction of |m_current_db| continues
+    ByteArray m_resume_key;
+
+    // True if |m_current_db| was scheduled again; then it is compacted
+    // once more from the beginning
+    bool m_rescan;
+};
+
+} // namespace upscaledb
+
+#endif /* UPS_JANITOR_H */
@@ -25,7 +25,7 @@
  * When a Database is created, it contains a BtreeIndex for persistent
  * (committed and flushed) data, and a TransactionIndex for active Transactions
  * and those Transactions which were committed but not yet flushed to disk.
- * This TransactionTree is implemented as a binary search tree (see rb.h).
+ * This TransactionTree is implemented as a skiplist (see TransactionIndex).
  *
  * Each node in the TransactionTree is implemented by TransactionNode. Each
  * node is identified by its database key, and groups all modifications of this
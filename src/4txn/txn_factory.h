@@ -46,7 +46,7 @@ struct TransactionFactory
             TransactionNode *node, uint32_t flags, uint32_t orig_flags,
             uint64_t lsn, ups_key_t *key, ups_record_t *record) {
     TransactionOperation *op;
-    op = Memory::allocate<TransactionOperation>(sizeof(*op)
+    op = (TransactionOperation *)txn->allocate_operation(sizeof(*op)
                                             + (record ? record->size : 0)
                                             + (key ? key->size : 0));
     op->initialize(txn, node, flags, orig_flags, lsn, key, record);
@@ -34,35 +34,6 @@
 
 namespace upscaledb {
 
-/* stuff for rb.h */
-#ifndef __ssize_t_defined
-typedef signed ssize_t;
-#endif
-#ifndef __cplusplus
-typedef int bool;
-#define true 1
-#define false (!true)
-#endif /* __cpluscplus */
-
-static int
-compare(void *vlhs, void *vrhs)
-{
-  TransactionNode *lhs = (TransactionNode *)vlhs;
-  TransactionNode *rhs = (TransactionNode *)vrhs;
-  LocalDatabase *db = lhs->get_db();
-
-  if (lhs == rhs)
-    return (0);
-
-  ups_key_t *lhskey = lhs->get_key();
-  ups_key_t *rhskey = rhs->get_key();
-  ups_assert(lhskey && rhskey);
-  return (db->btree_index()->compare_keys(lhskey, rhskey));
-}
-
-rb_proto(static, rbt_, TransactionIndex, TransactionNode)
-rb_gen(static, rbt_, TransactionIndex, TransactionNode, node, compare)
-
 void
 TransactionOperation::initialize(LocalTransaction *txn, TransactionNode *node,
             uint32_t flags, uint32_t orig_flags, uint64_t lsn,
@@ -130,23 +101,12 @@ TransactionOperation::destroy()
   if (delete_node)
     delete node;
 
-  Memory::release(this);
-}
-
-TransactionNode *
-TransactionNode::get_next_sibling()
-{
-  return (rbt_next(get_db()->txn_index(), this));
-}
-
-TransactionNode *
-TransactionNode::get_previous_sibling()
-{
-  return (rbt_prev(get_db()->txn_index(), this));
+  // the memory is owned by the Transaction
 }
 
 TransactionNode::TransactionNode(LocalDatabase *db, ups_key_t *key)
-  : m_db(db), m_oldest_op(0), m_newest_op(0), m_key(key)
+  : m_db(db), m_oldest_op(0), m_newest_op(0), m_key(key), m_height(0),
+    m_next(0), m_previous(0), m_upper(0)
 {
   /* make sure that a node with this key does not yet exist */
   // TODO re-enable this; currently leads to a stack overflow because
@@ -203,13 +163,129 @@ TransactionNode::append(LocalTransaction *txn, uint32_t orig_flags,
 void
 TransactionIndex::store(TransactionNode *node)
 {
-  rbt_insert(this, node);
+  TransactionNode *path[kMaxHeight];
+  TransactionNode *next = lower_bound(node->get_key(), &path[0]);
+  ups_assert(next == 0 || compare(node->get_key(), next) != 0);
+
+  link(node, path, next);
+}
+
+TransactionNode *
+TransactionIndex::get_or_create(ups_key_t *key, bool *created)
+{
+  TransactionNode *path[kMaxHeight];
+  TransactionNode *next = lower_bound(key, &path[0]);
+
+  if (next && compare(key, next) == 0) {
+    *created = false;
+    return (next);
+  }
+
+  TransactionNode *node = new TransactionNode(m_db, key);
+  link(node, path, next);
+  *created = true;
+  return (node);
+}
+
+void
+TransactionIndex::link(TransactionNode *node, TransactionNode **path,
+                TransactionNode *next)
+{
+  int height = random_height();
+  for (int i = m_height; i < height; i++)
+    path[i] = &m_head;
+  if (height > m_height)
+    m_height = height;
+
+  node->m_height = height;
+  if (height > 1)
+    node->m_upper = Memory::allocate<TransactionNode *>((height - 1)
+                            * sizeof(TransactionNode *));
+
+  // link the node on each level, starting with the lowest one
+  for (int i = 0; i < height; i++) {
+    node->next(i) = path[i]->next(i);
+    path[i]->next(i) = node;
+  }
+
+  node->m_previous = path[0] == &m_head ? 0 : path[0];
+  if (next)
+    next->m_previous = node;
+  else
+    m_last = node;
 }
 
 void
 TransactionIndex::remove(TransactionNode *node)
 {
-  rbt_remove(this, node);
+  // the predecessor on each level is the closest previous node which is
+  // high enough; walking backwards avoids comparing keys
+  TransactionNode *prev = node->m_previous;
+  for (int i = 0; i < node->m_height; i++) {
+    while (prev && prev->m_height <= i)
+      prev = prev->m_previous;
+    TransactionNode *p = prev ? prev : &m_head;
+    ups_assert(p->next(i) == node);
+    p->next(i) = node->next(i);
+  }
+
+  if (node->m_next)
+    node->m_next->m_previous = node->m_previous;
+  else
+    m_last = node->m_previous;
+
+  while (m_height > 1 && m_head.next(m_height - 1) == 0)
+    m_height--;
+
+  Memory::release(node->m_upper);
+  node->m_upper = 0;
+  node->m_height = 0;
+  node->m_next = 0;
+  node->m_previous = 0;
+}
+
+TransactionNode *
+TransactionIndex::lower_bound(ups_key_t *key, TransactionNode **path)
+{
+  TransactionNode *node = &m_head;
+  TransactionNode *next = 0;
+  TransactionNode *bound = 0;
+
+  for (int i = m_height - 1; i >= 0; i--) {
+    // |bound| is already known to be >= key
+    while ((next = node->next(i)) && next != bound && compare(key, next) > 0)
+      node = next;
+    bound = next;
+    if (path)
+      path[i] = node;
+  }
+
+  return (node->m_next);
+}
+
+int
+TransactionIndex::compare(ups_key_t *key, TransactionNode *node)
+{
+  ups_key_t *rhs = node->get_key();
+  ups_assert(key && rhs);
+  return (m_db->btree_index()->compare_keys(key, rhs));
+}
+
+int
+TransactionIndex::random_height()
+{
+  // xorshift32; each level is used with a probability of 1/4
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+
+  int height = 1;
+  uint32_t r = m_random;
+  while (height < kMaxHeight && (r & 3) == 0) {
+    height++;
+    r >>= 2;
+  }
+  return (height);
 }
 
 LocalTransactionManager::LocalTransactionManager(Environment *env)
@@ -220,7 +296,9 @@ LocalTransactionManager::LocalTransactionManager(Environment *env)
 LocalTransaction::LocalTransaction(LocalEnvironment *env, const char *name,
         uint32_t flags)
   : Transaction(env, name, flags), m_log_desc(0), m_oldest_op(0),
-    m_newest_op(0), m_op_counter(0), m_accum_data_size(0)
+    m_newest_op(0), m_op_counter(0), m_accum_data_size(0),
+    m_arena_chunk(0), m_arena_capacity(0), m_arena_used(0), m_commit_lsn(0),
+    m_snapshot_lsn(0)
 {
   LocalTransactionManager *ltm = 
         (LocalTransactionManager *)env->txn_manager();
@@ -281,65 +359,107 @@ LocalTransaction::free_operations()
 
   set_oldest_op(0);
   set_newest_op(0);
+
+  for (std::vector<uint8_t *>::iterator it = m_arena.begin();
+                  it != m_arena.end(); it++)
+    Memory::release(*it);
+  m_arena.clear();
+  m_arena_chunk = 0;
+  m_arena_capacity = 0;
+  m_arena_used = 0;
+}
+
+void *
+LocalTransaction::allocate_operation(size_t size)
+{
+  enum {
+    kMinChunkSize = 1024,
+    kMaxChunkSize = 64 * 1024
+  };
+
+  size = (size + 7) & ~(size_t)7;
+
+  if (m_arena_used + size > m_arena_capacity) {
+    // large operations get their own chunk; the current chunk can still
+    // be filled
+    if (size > kMaxChunkSize / 4) {
+      uint8_t *p = Memory::allocate<uint8_t>(size);
+      m_arena.push_back(p);
+      return (p);
+    }
+
+    // each chunk is twice as big as the previous one; the first one is
+    // small because most Transactions only have a few operations
+    size_t capacity = m_arena_capacity ? m_arena_capacity * 2 : kMinChunkSize;
+    while (capacity < size)
+      capacity *= 2;
+    if (capacity > kMaxChunkSize)
+      capacity = kMaxChunkSize;
+
+    m_arena_chunk = Memory::allocate<uint8_t>(capacity);
+    m_arena.push_back(m_arena_chunk);
+    m_arena_capacity = capacity;
+    m_arena_used = 0;
+  }
+
+  void *p = m_arena_chunk + m_arena_used;
+  m_arena_used += size;
+  return (p);
 }
 
 TransactionIndex::TransactionIndex(LocalDatabase *db)
-  : m_db(db)
+  : m_db(db), m_height(1), m_last(0), m_random(0x2545f491)
 {
-  rbt_new(this);
+  m_head.m_height = kMaxHeight;
+  m_head.m_upper = &m_head_upper[0];
+  for (int i = 0; i < kMaxHeight - 1; i++)
+    m_head_upper[i] = 0;
 }
 
 TransactionIndex::~TransactionIndex()
 {
   TransactionNode *node;
 
-  while ((node = rbt_last(this))) {
+  while ((node = get_last())) {
     remove(node);
     delete node;
   }
 
-  // re-initialize the tree
-  rbt_new(this);
+  // |m_head| does not own its links
+  m_head.m_upper = 0;
 }
 
 TransactionNode *
 TransactionIndex::get(ups_key_t *key, uint32_t flags)
 {
-  TransactionNode *node = 0;
   int match = 0;
 
-  /* create a temporary node that we can search for */
-  TransactionNode tmp(m_db, key);
+  /* search the first node which is >= key */
+  TransactionNode *node = lower_bound(key, 0);
+  bool exact = node && compare(key, node) == 0;
 
   /* search if node already exists - if yes, return it */
   if ((flags & UPS_FIND_GEQ_MATCH) == UPS_FIND_GEQ_MATCH) {
-    node = rbt_nsearch(this, &tmp);
     if (node)
-      match = compare(&tmp, node);
+      match = compare(key, node);
   }
   else if ((flags & UPS_FIND_LEQ_MATCH) == UPS_FIND_LEQ_MATCH) {
-    node = rbt_psearch(this, &tmp);
+    if (!exact)
+      node = node ? node->get_previous_sibling() : m_last;
     if (node)
-      match = compare(&tmp, node);
+      match = compare(key, node);
   }
   else if (flags & UPS_FIND_GT_MATCH) {
-    node = rbt_search(this, &tmp);
-    if (node)
+    if (exact)
       node = node->get_next_sibling();
-    else
-      node = rbt_nsearch(this, &tmp);
     match = 1;
   }
   else if (flags & UPS_FIND_LT_MATCH) {
-    node = rbt_search(this, &tmp);
-    if (node)
-      node = node->get_previous_sibling();
-    else
-      node = rbt_psearch(this, &tmp);
+    node = node ? node->get_previous_sibling() : m_last;
     match = -1;
   }
   else
-    return (rbt_search(this, &tmp));
+    return (exact ? node : 0);
 
   /* tree is empty? */
   if (!node)
@@ -359,24 +479,24 @@ TransactionIndex::get(ups_key_t *key, uint32_t flags)
 TransactionNode *
 TransactionIndex::get_first()
 {
-  return (rbt_first(this));
+  return (m_head.m_next);
 }
 
 TransactionNode *
 TransactionIndex::get_last()
 {
-  return (rbt_last(this));
+  return (m_last);
 }
 
 void
 TransactionIndex::enumerate(Context *context,
                 TransactionIndex::Visitor *visitor)
 {
-  TransactionNode *node = rbt_first(this);
+  TransactionNode *node = get_first();
 
   while (node) {
     visitor->visit(context, node);
-    node = rbt_next(this, node);
+    node = node->get_next_sibling();
   }
 }
 
@@ -406,7 +526,7 @@ struct KeyCounter : public TransactionIndex::Visitor
     op = node->get_newest_op();
     while (op) {
       LocalTransaction *optxn = op->get_txn();
-      if (optxn->is_aborted())
+      if (optxn->is_aborted() || (txn && txn->ignores(optxn)))
         ; // nop
       else if (optxn->is_committed() || txn == optxn) {
         if (op->get_flags() & TransactionOperation::kIsFlushed)
@@ -470,8 +590,17 @@ TransactionIndex::count(Context *context, LocalTransaction *txn, bool distinct)
 }
 
 void
-LocalTransactionManager::begin(Transaction *txn)
+LocalTransactionManager::begin(Transaction *htxn)
 {
+  LocalTransaction *txn = dynamic_cast<LocalTransaction *>(htxn);
+
+  // a read-only transaction sees all transactions which were committed
+  // up to now
+  if (txn->get_flags() & UPS_TXN_READ_ONLY) {
+    txn->m_snapshot_lsn = lenv()->next_lsn();
+    m_snapshots.insert(txn->m_snapshot_lsn);
+  }
+
   append_txn_at_tail(txn);
 }
 
@@ -481,15 +610,23 @@ LocalTransactionManager::commit(Transaction *htxn, uint32_t flags)
   LocalTransaction *txn = dynamic_cast<LocalTransaction *>(htxn);
   Context context(lenv(), txn, 0);
 
+  // Group commit: the journal of a (non-temporary) transaction is synced
+  // after the Environment's mutex was released (see
+  // LocalEnvironment::do_txn_commit_wait()); all transactions which commit
+  // in the meantime share this sync
+  bool defer_sync = !(txn->get_flags() & UPS_TXN_TEMPORARY);
+
   try {
     txn->commit(flags);
+    txn->m_commit_lsn = lenv()->next_lsn();
+    release_snapshot(txn);
 
     /* append journal entry */
     if (lenv()->journal() && !(txn->get_flags() & UPS_TXN_TEMPORARY))
-      lenv()->journal()->append_txn_commit(txn, lenv()->next_lsn());
+      lenv()->journal()->append_txn_commit(txn, txn->m_commit_lsn);
 
     /* flush committed transactions */
-    maybe_flush_committed_txns(&context);
+    maybe_flush_committed_txns(&context, defer_sync);
   }
   catch (Exception &ex) {
     return (ex.code);
@@ -505,6 +642,7 @@ LocalTransactionManager::abort(Transaction *htxn, uint32_t flags)
 
   try {
     txn->abort(flags);
+    release_snapshot(txn);
 
     /* append journal entry */
     if (lenv()->journal() && !(txn->get_flags() & UPS_TXN_TEMPORARY))
@@ -521,10 +659,22 @@ LocalTransactionManager::abort(Transaction *htxn, uint32_t flags)
 }
 
 void
-LocalTransactionManager::maybe_flush_committed_txns(Context *context)
+LocalTransactionManager::release_snapshot(LocalTransaction *txn)
+{
+  if (txn->get_flags() & UPS_TXN_READ_ONLY) {
+    std::multiset<uint64_t>::iterator it;
+    it = m_snapshots.find(txn->m_snapshot_lsn);
+    ups_assert(it != m_snapshots.end());
+    m_snapshots.erase(it);
+  }
+}
+
+void
+LocalTransactionManager::maybe_flush_committed_txns(Context *context,
+                bool defer_sync)
 {
   if ((lenv()->get_flags() & UPS_DONT_FLUSH_TRANSACTIONS) == 0)
-    flush_committed_txns_impl(context);
+    flush_committed_txns_impl(context, defer_sync);
 }
 
 void 
@@ -539,7 +689,8 @@ LocalTransactionManager::flush_committed_txns(Context *context /* = 0 */)
 }
 
 void 
-LocalTransactionManager::flush_committed_txns_impl(Context *context)
+LocalTransactionManager::flush_committed_txns_impl(Context *context,
+                bool defer_sync)
 {
   LocalTransaction *oldest;
   Journal *journal = lenv()->journal();
@@ -551,6 +702,12 @@ LocalTransactionManager::flush_committed_txns_impl(Context *context)
    * it; if it was aborted: discard it; otherwise return */
   while ((oldest = (LocalTransaction *)get_oldest_txn())) {
     if (oldest->is_committed()) {
+      /* do not modify the btree as long as this transaction is invisible
+       * for an active read-only transaction */
+      if (!m_snapshots.empty()
+          && oldest->get_commit_lsn() > *m_snapshots.begin())
+        break;
+
       uint64_t lsn = flush_txn(context, (LocalTransaction *)oldest);
       if (lsn > highest_lsn)
         highest_lsn = lsn;
@@ -574,7 +731,7 @@ LocalTransactionManager::flush_committed_txns_impl(Context *context)
 
   /* now flush the changeset and write the modified pages to disk */
   if (highest_lsn && context->env->journal())
-    context->changeset.flush(highest_lsn);
+    context->changeset.flush(highest_lsn, defer_sync);
   else
     context->changeset.clear();
   ups_assert(context->changeset.is_empty());
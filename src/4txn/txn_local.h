@@ -25,8 +25,10 @@
 
 #include "0root/root.h"
 
+#include <set>
+#include <vector>
+
 // Always verify that a file of level N does not include headers > N!
-#include "1rb/rb.h"
 #include "4txn/txn.h"
 
 #ifndef UPS_ROOT_H
@@ -236,9 +238,9 @@ class TransactionOperation
 
 
 //
-// A node in the Transaction Index, used as the node structure in rb.h.
-// Manages a group of TransactionOperation objects which all modify the
-// same key.
+// A node in the Transaction Index, used as the node structure of the
+// skiplist. Manages a group of TransactionOperation objects which all
+// modify the same key.
 //
 // To avoid chicken-egg problems when inserting a new TransactionNode
 // into the TransactionTree, it is possible to assign a temporary key
@@ -251,15 +253,13 @@ class TransactionNode
 {
   public:
     // Constructor;
-    // The default parameters are required for the compilation of rb.h.
     // |key| is just a temporary pointer which allows to create a
     // TransactionNode without further memory allocations/copying. The actual
     // key is then fetched from |m_oldest_op| as soon as this node is fully
     // initialized.
     TransactionNode(LocalDatabase *db = 0, ups_key_t *key = 0);
 
-    // Destructor; removes this node from the tree, unless |dont_insert|
-    // was set to true
+    // Destructor
     ~TransactionNode();
 
     // Returns the database
@@ -274,11 +274,15 @@ class TransactionNode
 
     // Retrieves the next larger sibling of a given node, or NULL if there
     // is no sibling
-    TransactionNode *get_next_sibling();
+    TransactionNode *get_next_sibling() {
+      return (m_next);
+    }
 
     // Retrieves the previous larger sibling of a given node, or NULL if there
     // is no sibling
-    TransactionNode *get_previous_sibling();
+    TransactionNode *get_previous_sibling() {
+      return (m_previous);
+    }
 
     // Returns the first (oldest) TransactionOperation in this node
     TransactionOperation *get_oldest_op() {
@@ -305,12 +309,15 @@ class TransactionNode
                 uint32_t flags, uint64_t lsn, ups_key_t *key,
                 ups_record_t *record);
 
-    // red-black tree stub, required for rb.h
-    rb_node(TransactionNode) node;
-
   private:
+    friend class TransactionIndex;
     friend struct TxnFixture;
 
+    // Returns the successor of this node on |level| of the skiplist
+    TransactionNode *&next(int level) {
+      return (level == 0 ? m_next : m_upper[level - 1]);
+    }
+
     // the database - need this to get the compare function
     LocalDatabase *m_db;
 
@@ -321,18 +328,42 @@ class TransactionNode
     TransactionOperation *m_newest_op;
 
     // Pointer to the key data; only used as long as there are no operations
-    // attached. Otherwise we have a chicken-egg problem in rb.h.
+    // attached. Otherwise we have a chicken-egg problem when searching
+    // for the node.
     ups_key_t *m_key;
+
+    // the number of skiplist levels of this node
+    int m_height;
+
+    // the successor on the lowest level of the skiplist
+    TransactionNode *m_next;
+
+    // the predecessor on the lowest level of the skiplist
+    TransactionNode *m_previous;
+
+    // the successors on the upper levels of the skiplist (if |m_height| > 1)
+    TransactionNode **m_upper;
 };
 
 
 //
-// Each Database has a binary tree which stores the current Transaction
-// operations; this tree is implemented in TransactionIndex
+// Each Database has a skiplist which stores the current Transaction
+// operations; this list is implemented in TransactionIndex.
+//
+// The level of each node is chosen randomly when it is stored. Unlike a
+// balanced tree, inserting or removing a node only updates the links of
+// its direct neighbours and never restructures the index; lookups only
+// follow forward links. The sorted neighbours of a node (required by
+// cursors) are available through the links of the lowest level.
 //
 class TransactionIndex
 {
   public:
+    enum {
+      // the maximum number of levels
+      kMaxHeight = 16
+    };
+
     // Traverses a TransactionIndex; for each node, a callback is executed
     struct Visitor {
       virtual void visit(Context *context, TransactionNode *node) = 0;
@@ -347,6 +378,11 @@ class TransactionIndex
     // Stores a new TransactionNode in the index
     void store(TransactionNode *node);
 
+    // Returns the TransactionNode of |key|. If it does not exist then a
+    // new node is created and stored; |created| is then set to true.
+    // Requires only one search, whereas get() and store() require two.
+    TransactionNode *get_or_create(ups_key_t *key, bool *created);
+
     // Removes a TransactionNode from the index
     void remove(TransactionNode *node);
 
@@ -369,13 +405,40 @@ class TransactionIndex
     // Returns the key count of this index
     uint64_t count(Context *context, LocalTransaction *txn, bool distinct);
 
- // private: //TODO re-enable this; currently disabled because rb.h needs it
+  private:
+    // Returns the first node which is >= |key|, or NULL. If |path| is not
+    // NULL then it receives the last node on each level which is < |key|
+    TransactionNode *lower_bound(ups_key_t *key, TransactionNode **path);
+
+    // Links a new |node| right of the nodes in |path|; |next| is its
+    // successor on the lowest level
+    void link(TransactionNode *node, TransactionNode **path,
+                    TransactionNode *next);
+
+    // Compares |key| to the key of a |node|
+    int compare(ups_key_t *key, TransactionNode *node);
+
+    // Returns a random level for a new node
+    int random_height();
+
     // the Database for all operations in this tree
     LocalDatabase *m_db;
 
-    // stuff for rb.h
-    TransactionNode *rbt_root;
-    TransactionNode rbt_nil;
+    // the head of the skiplist; its successors are the first nodes of
+    // each level
+    TransactionNode m_head;
+
+    // the upper levels of |m_head|
+    TransactionNode *m_head_upper[kMaxHeight - 1];
+
+    // the current number of levels
+    int m_height;
+
+    // the last (= "greatest") node
+    TransactionNode *m_last;
+
+    // the state of the random number generator
+    uint32_t m_random;
 };
 
 
@@ -436,8 +499,34 @@ class LocalTransaction : public Transaction
       return (m_accum_data_size);
     }
 
+    // Allocates memory for a TransactionOperation. The memory is owned
+    // by this Transaction, and released when its operations are freed
+    void *allocate_operation(size_t size);
+
+    // Returns the lsn of the commit; 0 if the Transaction is not committed
+    uint64_t get_commit_lsn() const {
+      return (m_commit_lsn);
+    }
+
+    // Returns the snapshot lsn of a read-only Transaction
+    uint64_t get_snapshot_lsn() const {
+      return (m_snapshot_lsn);
+    }
+
+    // Returns true if the operations of |other| are invisible for this
+    // Transaction. A read-only Transaction reads from a snapshot, and only
+    // sees the Transactions which were committed before it was started.
+    // Therefore it never conflicts with active Transactions.
+    bool ignores(const LocalTransaction *other) const {
+      return ((m_flags & UPS_TXN_READ_ONLY) != 0
+                && other != this
+                && (!other->is_committed()
+                    || other->m_commit_lsn > m_snapshot_lsn));
+    }
+
   private:
     friend class Journal;
+    friend class LocalTransactionManager;
     friend struct TxnFixture;
     friend struct TxnCursorFixture;
 
@@ -471,6 +560,25 @@ class LocalTransaction : public Transaction
     // The approximate accumulated memory consumed by this Transaction
     // (sums up key->size and record->size over all operations)
     int m_accum_data_size;
+
+    // The memory chunks of the TransactionOperations
+    std::vector<uint8_t *> m_arena;
+
+    // The chunk which is currently filled
+    uint8_t *m_arena_chunk;
+
+    // The size of |m_arena_chunk|
+    size_t m_arena_capacity;
+
+    // The used bytes of |m_arena_chunk|
+    size_t m_arena_used;
+
+    // The lsn of the commit
+    uint64_t m_commit_lsn;
+
+    // For read-only Transactions: the lsn when the Transaction was started;
+    // all Transactions with a smaller |m_commit_lsn| are visible
+    uint64_t m_snapshot_lsn;
 };
 
 
@@ -514,7 +622,9 @@ class LocalTransactionManager : public TransactionManager
     }
 
   private:
-    void flush_committed_txns_impl(Context *context);
+    // Flushes all committed transactions. If |defer_sync| is true then the
+    // journal is not synced (see Journal::wait_until_durable())
+    void flush_committed_txns_impl(Context *context, bool defer_sync = false);
 
     // Flushes a single committed Transaction; returns the lsn of the
     // last operation in this transaction
@@ -527,10 +637,19 @@ class LocalTransactionManager : public TransactionManager
 
     // Flushes committed transactions if there are enough committed
     // transactions waiting to be flushed, or if other conditions apply
-    void maybe_flush_committed_txns(Context *context);
+    void maybe_flush_committed_txns(Context *context,
+                    bool defer_sync = false);
+
+    // Removes the snapshot of a read-only Transaction
+    void release_snapshot(LocalTransaction *txn);
 
     // The current transaction ID
     uint64_t m_txn_id;
+
+    // The snapshot lsns of all active read-only Transactions. Committed
+    // Transactions are not flushed as long as they are invisible for one
+    // of these snapshots
+    std::multiset<uint64_t> m_snapshots;
 };
 
 } // namespace upscaledb
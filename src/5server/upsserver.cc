@@ -16,6 +16,7 @@
  */
 
 #include <string.h>
+#include <vector>
 
 // winsock2.h is required for libuv
 #ifdef WIN32
@@ -25,6 +26,8 @@
 // include this BEFORE os.h!
 #include <uv.h>
 
+#include <boost/bind.hpp>
+
 // Always verify that a file of level N does not include headers > N!
 #include "1os/os.h"
 #include "1base/error.h"
@@ -40,6 +43,14 @@
 #  error "root.h was not included"
 #endif
 
+// Several event loops can listen on the same port (uv_tcp_init_ex() is
+// available since libuv 1.7)
+#if defined(SO_REUSEPORT) \
+      && (UV_VERSION_MAJOR > 1 \
+        || (UV_VERSION_MAJOR == 1 && UV_VERSION_MINOR >= 7))
+#  define UPS_SRV_REUSEPORT 1
+#endif
+
 namespace upscaledb {
 
 static void
@@ -49,11 +60,31 @@ on_write_cb(uv_write_t *req, int status)
   delete req;
 };
 
+// Writes |data| to the client; |data| is released as soon as it was written
 static void
-on_write_cb2(uv_write_t *req, int status)
+write_data(uv_stream_t *tcp, uint8_t *data, uint32_t data_size)
 {
-  delete req;
-};
+  // |req| needs to exist till the request was finished asynchronously;
+  // therefore it must be allocated on the heap
+  uv_write_t *req = new uv_write_t();
+  uv_buf_t buf = uv_buf_init((char *)data, data_size);
+  req->data = data;
+  // |req| and |data| are freed in on_write_cb()
+  uv_write(req, tcp, &buf, 1, on_write_cb);
+}
+
+// Sends a reply to the client. If the request is executed by a worker
+// thread then the reply is sent later by the thread of the event loop
+// (see on_async_cb()), because libuv is not thread-safe
+static void
+send_data(uv_stream_t *tcp, uint8_t *data, uint32_t data_size)
+{
+  ClientContext *client = (ClientContext *)tcp->data;
+  if (client->strand)
+    client->replies.push_back(std::make_pair(data, data_size));
+  else
+    write_data(tcp, data, data_size);
+}
 
 static void
 send_wrapper(ServerContext *srv, uv_stream_t *tcp, Protocol *reply)
@@ -64,13 +95,7 @@ send_wrapper(ServerContext *srv, uv_stream_t *tcp, Protocol *reply)
   if (!reply->pack(&data, &data_size))
     return;
 
-  // |req| needs to exist till the request was finished asynchronously;
-  // therefore it must be allocated on the heap
-  uv_write_t *req = new uv_write_t();
-  uv_buf_t buf = uv_buf_init((char *)data, data_size);
-  req->data = data;
-  // |req| and |data| are freed in on_write_cb()
-  uv_write(req, (uv_stream_t *)tcp, &buf, 1, on_write_cb);
+  send_data(tcp, data, data_size);
 }
 
 static void
@@ -80,27 +105,24 @@ send_wrapper(ServerContext *srv, uv_stream_t *tcp, SerializedWrapper *reply)
   int reply_size = size_left;
   reply->magic = UPS_TRANSFER_MAGIC_V2;
   reply->size = size_left;
-  srv->buffer.resize(size_left);
-  uint8_t *ptr = (uint8_t *)srv->buffer.get_ptr();
+  reply->request_id = ((ClientContext *)tcp->data)->request_id;
+
+  // each reply has its own buffer; the buffers of several clients are
+  // serialized in parallel
+  uint8_t *data = Memory::allocate<uint8_t>(reply_size);
+  uint8_t *ptr = data;
 
   reply->serialize(&ptr, &size_left);
   ups_assert(size_left == 0);
 
-  // |req| needs to exist till the request was finished asynchronously;
-  // therefore it must be allocated on the heap
-  uv_write_t *req = new uv_write_t();
-  uv_buf_t buf = uv_buf_init((char *)srv->buffer.get_ptr(), reply_size);
-  req->data = (uint8_t *)srv->buffer.get_ptr();
-
-  // |req| is freed in on_write_cb()
-  uv_write(req, (uv_stream_t *)tcp, &buf, 1, on_write_cb2);
+  send_data(tcp, data, reply_size);
 }
 
 static void
 handle_connect(ServerContext *srv, uv_stream_t *tcp, Protocol *request)
 {
   ups_assert(request != 0);
-  Environment *env = srv->open_envs[request->connect_request().path()];
+  Environment *env = srv->get_env_by_url(request->connect_request().path());
 
   if (ErrorInducer::is_active()) {
     if (ErrorInducer::get_instance()->induce(ErrorInducer::kServerConnect)) {
@@ -960,6 +982,193 @@ handle_db_erase(ServerContext *srv, uv_stream_t *tcp,
   send_wrapper(srv, tcp, &reply);
 }
 
+static void
+handle_db_insert_many(ServerContext *srv, uv_stream_t *tcp,
+                Protocol *request)
+{
+  ups_status_t st = 0;
+  bool send_keys = false;
+
+  ups_assert(request != 0);
+  ups_assert(request->has_db_insert_many_request());
+
+  const DbInsertManyRequest &r = request->db_insert_many_request();
+  uint32_t count = (uint32_t)r.keys_size();
+  std::vector<ups_key_t> keys(count);
+  std::vector<ups_record_t> records(count);
+  std::vector<ups_status_t> results(count);
+
+  Transaction *txn = 0;
+  Database *db = 0;
+
+  if (r.records_size() != r.keys_size())
+    st = UPS_INV_PARAMETER;
+
+  if (st == 0 && r.txn_handle()) {
+    txn = srv->get_txn(r.txn_handle());
+    if (!txn)
+      st = UPS_INV_PARAMETER;
+  }
+
+  if (st == 0) {
+    db = srv->get_db(r.db_handle());
+    if (!db)
+      st = UPS_INV_PARAMETER;
+  }
+
+  if (st == 0 && count > 0) {
+    for (uint32_t i = 0; i < count; i++) {
+      ups_key_t *key = &keys[i];
+      ::memset(key, 0, sizeof(*key));
+      key->size = (uint16_t)r.keys(i).data().size();
+      if (key->size)
+        key->data = (void *)&r.keys(i).data()[0];
+      key->flags = r.keys(i).flags() & (~UPS_KEY_USER_ALLOC);
+
+      ups_record_t *rec = &records[i];
+      ::memset(rec, 0, sizeof(*rec));
+      rec->size = (uint32_t)r.records(i).data().size();
+      if (rec->size)
+        rec->data = (void *)&r.records(i).data()[0];
+      rec->partial_size = r.records(i).partial_size();
+      rec->partial_offset = r.records(i).partial_offset();
+      rec->flags = r.records(i).flags() & (~UPS_RECORD_USER_ALLOC);
+    }
+
+    st = ups_db_insert_many((ups_db_t *)db, (ups_txn_t *)txn, &keys[0],
+                    &records[0], count, &results[0], r.flags());
+
+    /* recno: return the modified keys */
+    if ((st == 0)
+        && (db->get_flags() & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64)))
+      send_keys = true;
+  }
+
+  Protocol reply(Protocol::DB_INSERT_MANY_REPLY);
+  reply.mutable_db_insert_many_reply()->set_status(st);
+  if (st == 0) {
+    for (uint32_t i = 0; i < count; i++) {
+      reply.mutable_db_insert_many_reply()->add_results(results[i]);
+      if (send_keys)
+        Protocol::assign_key(reply.mutable_db_insert_many_reply()->add_keys(),
+                        &keys[i]);
+    }
+  }
+
+  send_wrapper(srv, tcp, &reply);
+}
+
+static void
+handle_db_find_many(ServerContext *srv, uv_stream_t *tcp,
+                Protocol *request)
+{
+  ups_status_t st = 0;
+
+  ups_assert(request != 0);
+  ups_assert(request->has_db_find_many_request());
+
+  const DbFindManyRequest &r = request->db_find_many_request();
+  uint32_t count = (uint32_t)r.keys_size();
+  std::vector<ups_key_t> keys(count);
+  std::vector<ups_record_t> records(count);
+  std::vector<ups_status_t> results(count);
+
+  Transaction *txn = 0;
+  Database *db = 0;
+
+  if (r.txn_handle()) {
+    txn = srv->get_txn(r.txn_handle());
+    if (!txn)
+      st = UPS_INV_PARAMETER;
+  }
+
+  if (st == 0) {
+    db = srv->get_db(r.db_handle());
+    if (!db)
+      st = UPS_INV_PARAMETER;
+  }
+
+  if (st == 0 && count > 0) {
+    for (uint32_t i = 0; i < count; i++) {
+      ups_key_t *key = &keys[i];
+      ::memset(key, 0, sizeof(*key));
+      key->size = (uint16_t)r.keys(i).data().size();
+      if (key->size)
+        key->data = (void *)&r.keys(i).data()[0];
+      key->flags = r.keys(i).flags() & (~UPS_KEY_USER_ALLOC);
+      ::memset(&records[i], 0, sizeof(records[i]));
+    }
+
+    st = ups_db_find_many((ups_db_t *)db, (ups_txn_t *)txn, &keys[0],
+                    &records[0], count, &results[0], r.flags());
+  }
+
+  Protocol reply(Protocol::DB_FIND_MANY_REPLY);
+  reply.mutable_db_find_many_reply()->set_status(st);
+  if (st == 0) {
+    for (uint32_t i = 0; i < count; i++) {
+      reply.mutable_db_find_many_reply()->add_results(results[i]);
+      Protocol::assign_record(reply.mutable_db_find_many_reply()->add_records(),
+                      &records[i]);
+    }
+  }
+
+  send_wrapper(srv, tcp, &reply);
+}
+
+static void
+handle_db_erase_many(ServerContext *srv, uv_stream_t *tcp,
+                Protocol *request)
+{
+  ups_status_t st = 0;
+
+  ups_assert(request != 0);
+  ups_assert(request->has_db_erase_many_request());
+
+  const DbEraseManyRequest &r = request->db_erase_many_request();
+  uint32_t count = (uint32_t)r.keys_size();
+  std::vector<ups_key_t> keys(count);
+  std::vector<ups_status_t> results(count);
+
+  Transaction *txn = 0;
+  Database *db = 0;
+
+  if (r.txn_handle()) {
+    txn = srv->get_txn(r.txn_handle());
+    if (!txn)
+      st = UPS_INV_PARAMETER;
+  }
+
+  if (st == 0) {
+    db = srv->get_db(r.db_handle());
+    if (!db)
+      st = UPS_INV_PARAMETER;
+  }
+
+  if (st == 0 && count > 0) {
+    for (uint32_t i = 0; i < count; i++) {
+      ups_key_t *key = &keys[i];
+      ::memset(key, 0, sizeof(*key));
+      key->size = (uint16_t)r.keys(i).data().size();
+      if (key->size)
+        key->data = (void *)&r.keys(i).data()[0];
+      key->flags = r.keys(i).flags() & (~UPS_KEY_USER_ALLOC);
+    }
+
+    st = ups_db_erase_many((ups_db_t *)db, (ups_txn_t *)txn, &keys[0],
+                    count, &results[0], r.flags());
+  }
+
+  Protocol reply(Protocol::DB_ERASE_MANY_REPLY);
+  reply.mutable_db_erase_many_reply()->set_status(st);
+  if (st == 0) {
+    for (uint32_t i = 0; i < count; i++)
+      reply.mutable_db_erase_many_reply()->add_results(results[i]);
+  }
+
+  send_wrapper(srv, tcp, &reply);
+}
+
 static void
 handle_txn_begin(ServerContext *srv, uv_stream_t *tcp, Protocol *request)
 {
@@ -1658,6 +1867,64 @@ bail:
   send_wrapper(srv, tcp, &reply);
 }
 
+static void
+handle_cursor_move_batch(ServerContext *srv, uv_stream_t *tcp,
+                Protocol *request)
+{
+  ups_status_t st = 0;
+
+  ups_assert(request != 0);
+  ups_assert(request->has_cursor_move_batch_request());
+
+  const CursorMoveBatchRequest &r = request->cursor_move_batch_request();
+  Protocol reply(Protocol::CURSOR_MOVE_BATCH_REPLY);
+
+  Cursor *cursor = srv->get_cursor(r.cursor_handle());
+  if (!cursor)
+    st = UPS_INV_PARAMETER;
+  else {
+    // the first move uses the flags of the request, the following moves
+    // continue in the same direction
+    uint32_t flags = r.flags();
+    uint32_t next_flags = flags & ~(UPS_CURSOR_FIRST | UPS_CURSOR_LAST
+                    | UPS_CURSOR_NEXT | UPS_CURSOR_PREVIOUS);
+    if (flags & (UPS_CURSOR_FIRST | UPS_CURSOR_NEXT))
+      next_flags |= UPS_CURSOR_NEXT;
+    else
+      next_flags |= UPS_CURSOR_PREVIOUS;
+
+    uint32_t bytes = 0;
+    for (uint32_t i = 0; i < r.max_count(); i++) {
+      ups_key_t key = {0};
+      ups_record_t rec = {0};
+      ups_status_t s = ups_cursor_move((ups_cursor_t *)cursor,
+                            r.skip_data() ? 0 : &key,
+                            r.skip_data() ? 0 : &rec,
+                            i == 0 ? flags : next_flags);
+      // a failing move ends the batch; the cursor stays at the last pair
+      if (s) {
+        if (i == 0)
+          st = s;
+        break;
+      }
+      if (r.skip_data())
+        continue;
+
+      Protocol::assign_key(reply.mutable_cursor_move_batch_reply()->add_keys(),
+                      &key);
+      Protocol::assign_record(
+                      reply.mutable_cursor_move_batch_reply()->add_records(),
+                      &rec);
+      bytes += key.size + rec.size;
+      if (r.max_bytes() && bytes >= r.max_bytes())
+        break;
+    }
+  }
+
+  reply.mutable_cursor_move_batch_reply()->set_status(st);
+  send_wrapper(srv, tcp, &reply);
+}
+
 static void
 handle_cursor_close(ServerContext *srv, uv_stream_t *tcp, Protocol *request)
 {
@@ -1718,6 +1985,10 @@ dispatch(ServerContext *srv, uv_stream_t *tcp, uint32_t magic,
     request.deserialize(&data, &size_left);
     ups_assert(size_left == 0);
 
+    // the client can send several requests without waiting for the
+    // replies; the id identifies the request which is answered
+    ((ClientContext *)tcp->data)->request_id = request.request_id;
+
     switch (request.id) {
       case kDbInsertRequest:
         handle_db_insert(srv, tcp, &request);
@@ -1830,6 +2101,15 @@ dispatch(ServerContext *srv, uv_stream_t *tcp, uint32_t magic,
     case ProtoWrapper_Type_DB_ERASE_REQUEST:
       handle_db_erase(srv, tcp, wrapper);
       break;
+    case ProtoWrapper_Type_DB_INSERT_MANY_REQUEST:
+      handle_db_insert_many(srv, tcp, wrapper);
+      break;
+    case ProtoWrapper_Type_DB_FIND_MANY_REQUEST:
+      handle_db_find_many(srv, tcp, wrapper);
+      break;
+    case ProtoWrapper_Type_DB_ERASE_MANY_REQUEST:
+      handle_db_erase_many(srv, tcp, wrapper);
+      break;
     case ProtoWrapper_Type_TXN_BEGIN_REQUEST:
       handle_txn_begin(srv, tcp, wrapper);
       break;
@@ -1866,6 +2146,9 @@ dispatch(ServerContext *srv, uv_stream_t *tcp, uint32_t magic,
     case ProtoWrapper_Type_CURSOR_MOVE_REQUEST:
       handle_cursor_move(srv, tcp, wrapper);
       break;
+    case ProtoWrapper_Type_CURSOR_MOVE_BATCH_REQUEST:
+      handle_cursor_move_batch(srv, tcp, wrapper);
+      break;
     case ProtoWrapper_Type_CURSOR_CLOSE_REQUEST:
       handle_cursor_close(srv, tcp, wrapper);
       break;
@@ -1882,8 +2165,67 @@ dispatch(ServerContext *srv, uv_stream_t *tcp, uint32_t magic,
 static void
 on_close_connection(uv_handle_t *handle)
 {
-  delete (ClientContext *)handle->data;
-  Memory::release(handle);
+  ClientContext *client = (ClientContext *)handle->data;
+  client->closed = true;
+
+  // requests which are still executed by the worker threads refer to the
+  // client; then it is deleted as soon as they are completed
+  if (client->pending == 0) {
+    delete client;
+    Memory::release(handle);
+  }
+}
+
+static void
+close_connection(uv_stream_t *tcp)
+{
+  if (!uv_is_closing((uv_handle_t *)tcp))
+    uv_close((uv_handle_t *)tcp, on_close_connection);
+}
+
+// Executes a request in a worker thread. The requests of a client are
+// executed one at a time (see ClientContext::strand), therefore the replies
+// are sent in the same order as the requests were received.
+static void
+execute(uv_stream_t *tcp, uint32_t magic, uint8_t *data, uint32_t size)
+{
+  ClientContext *client = (ClientContext *)tcp->data;
+  Completion completion(client);
+
+  if (!client->close_requested) {
+    if (!dispatch(client->srv, tcp, magic, data, size)) {
+      client->close_requested = true;
+      completion.close_client = true;
+    }
+  }
+  Memory::release(data);
+
+  completion.replies.swap(client->replies);
+
+  EventLoop *loop = client->loop;
+  {
+    ScopedLock lock(loop->completion_mutex);
+    loop->completions.push_back(completion);
+  }
+  uv_async_send(&loop->async);
+}
+
+// Executes a request or hands it over to the worker threads; returns false
+// if the client should be closed
+static bool
+process(uv_stream_t *tcp, uint32_t magic, uint8_t *data, uint32_t size)
+{
+  ClientContext *client = (ClientContext *)tcp->data;
+  if (!client->strand)
+    return (dispatch(client->srv, tcp, magic, data, size));
+
+  // |data| is released by the caller, but the request is executed later
+  uint8_t *copy = Memory::allocate<uint8_t>(size);
+  ::memcpy(copy, data, size);
+
+  client->pending++;
+  client->strand->post(boost::bind(&execute, tcp, magic, copy, size));
+  return (true);
 }
 
 #if UV_VERSION_MINOR >= 11
@@ -1929,7 +2271,7 @@ on_read_data(uv_stream_t *tcp, ssize_t nread, uv_buf_t buf_struct)
       buffer->append((uint8_t *)buf->base, nread);
 
       // for each full package in the buffer...
-      while (buffer->get_size() > 8) {
+      while (buffer->get_size() >= 8) {
         uint8_t *p = (uint8_t *)buffer->get_ptr();
         magic = *(uint32_t *)(p + 0);
         size = *(uint32_t *)(p + 4);
@@ -1939,7 +2281,7 @@ on_read_data(uv_stream_t *tcp, ssize_t nread, uv_buf_t buf_struct)
         if (buffer->get_size() < size)
           goto bail;
         // otherwise dispatch the message
-        close_client = !dispatch(context->srv, tcp, magic, p, size);
+        close_client = !process(tcp, magic, p, size);
         // and move the remaining data to "the left"
         if (buffer->get_size() == size) {
           buffer->clear();
@@ -1959,12 +2301,15 @@ on_read_data(uv_stream_t *tcp, ssize_t nread, uv_buf_t buf_struct)
     // current network packet
     uint8_t *p = (uint8_t *)buf->base;
     while (p < (uint8_t *)buf->base + nread) {
-      magic = *(uint32_t *)(p + 0);
-      size = *(uint32_t *)(p + 4);
-      if (magic == UPS_TRANSFER_MAGIC_V1)
-        size += 8;
-      if (size <= (uint32_t)nread) {
-        close_client = !dispatch(context->srv, tcp, magic, p, size);
+      // pipelined requests can be split anywhere, even in the header
+      if (nread >= 8) {
+        magic = *(uint32_t *)(p + 0);
+        size = *(uint32_t *)(p + 4);
+        if (magic == UPS_TRANSFER_MAGIC_V1)
+          size += 8;
+      }
+      if (nread >= 8 && size <= (uint32_t)nread) {
+        close_client = !process(tcp, magic, p, size);
         if (close_client)
           goto bail;
         nread -= size;
@@ -1982,7 +2327,7 @@ on_read_data(uv_stream_t *tcp, ssize_t nread, uv_buf_t buf_struct)
 
 bail:
   if (close_client || nread < 0)
-    uv_close((uv_handle_t *)tcp, on_close_connection);
+    close_connection(tcp);
   Memory::release(buf->base);
   //buf->base = 0;
 }
@@ -1993,16 +2338,12 @@ on_new_connection(uv_stream_t *server, int status)
   if (status == -1)
     return;
 
-  ServerContext *srv = (ServerContext *)server->data;
+  EventLoop *loop = (EventLoop *)server->data;
 
   uv_tcp_t *client = Memory::allocate<uv_tcp_t>(sizeof(uv_tcp_t));
-  client->data = new ClientContext(srv);
+  client->data = new ClientContext(loop->srv, loop, client);
 
-#if UV_VERSION_MINOR >= 11
-  uv_tcp_init(&srv->loop, client);
-#else
-  uv_tcp_init(srv->loop, client);
-#endif
+  uv_tcp_init(loop->get_loop(), client);
   if (uv_accept(server, (uv_stream_t *)client) == 0)
     uv_read_start((uv_stream_t *)client, on_alloc_buffer, on_read_data);
   else
@@ -2022,55 +2363,112 @@ on_async_cb(uv_async_t *handle, int status)
 on_async_cb(uv_async_t *handle)
 #endif
 {
-  ServerContext *srv = (ServerContext *)handle->data;
+  EventLoop *loop = (EventLoop *)handle->data;
 
-  // simply copy the Environments in the queue to the map of opened
-  // Environments
-  ScopedLock lock(srv->open_queue_mutex);
-  for (EnvironmentMap::iterator it = srv->open_queue.begin();
-          it != srv->open_queue.end(); it++) {
-    srv->open_envs[it->first] = it->second;
+  std::vector<Completion> completions;
+  {
+    ScopedLock lock(loop->completion_mutex);
+    completions.swap(loop->completions);
   }
-}
 
-} // namespace upscaledb
+  // send the replies of the requests which were executed by the workers
+  for (std::vector<Completion>::iterator it = completions.begin();
+          it != completions.end(); it++) {
+    ClientContext *client = it->client;
+    uv_stream_t *tcp = (uv_stream_t *)client->tcp;
 
-// global namespace is below
+    for (size_t i = 0; i < it->replies.size(); i++) {
+      if (uv_is_closing((uv_handle_t *)tcp))
+        Memory::release(it->replies[i].first);
+      else
+        write_data(tcp, it->replies[i].first, it->replies[i].second);
+    }
 
-ups_status_t
-ups_srv_init(ups_srv_config_t *config, ups_srv_t **psrv)
+    client->pending--;
+    if (client->closed) {
+      if (client->pending == 0) {
+        delete client;
+        Memory::release(tcp);
+      }
+    }
+    else if (it->close_client)
+      close_connection(tcp);
+  }
+}
+
+// Initializes an event loop and starts listening. With |reuse_port|
+// several event loops listen on the same port, and the kernel distributes
+// the connections.
+static bool
+init_loop(EventLoop *loop, uint16_t port, bool reuse_port)
 {
-  ServerContext *srv = new ServerContext();
   struct sockaddr_in bind_addr;
 
 #if UV_VERSION_MINOR >= 11
-  uv_loop_init(&srv->loop);
-  uv_tcp_init(&srv->loop, &srv->server);
-  uv_ip4_addr("0.0.0.0", config->port, &bind_addr);
-  uv_tcp_bind(&srv->server, (sockaddr *)&bind_addr, 0);
+  uv_loop_init(&loop->loop);
+#  ifdef UPS_SRV_REUSEPORT
+  if (reuse_port) {
+    uv_os_fd_t fd;
+    int on = 1;
+    uv_tcp_init_ex(&loop->loop, &loop->server, AF_INET);
+    uv_fileno((uv_handle_t *)&loop->server, &fd);
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+  }
+  else
+#  endif
+  uv_tcp_init(&loop->loop, &loop->server);
+  uv_ip4_addr("0.0.0.0", port, &bind_addr);
+  uv_tcp_bind(&loop->server, (sockaddr *)&bind_addr, 0);
 #else
-  srv->loop = uv_loop_new();
-  uv_tcp_init(srv->loop, &srv->server);
-  bind_addr = uv_ip4_addr("0.0.0.0", config->port);
-  uv_tcp_bind(&srv->server, bind_addr);
+  loop->loop = uv_loop_new();
+  uv_tcp_init(loop->loop, &loop->server);
+  bind_addr = uv_ip4_addr("0.0.0.0", port);
+  uv_tcp_bind(&loop->server, bind_addr);
 #endif
 
-  srv->server.data = srv;
-  int r = uv_listen((uv_stream_t *)&srv->server, 128,
+  loop->server.data = loop;
+  int r = uv_listen((uv_stream_t *)&loop->server, 128,
             upscaledb::on_new_connection);
   if (r) {
-    ups_log(("failed to listen to port %d", config->port)); 
-    return (UPS_IO_ERROR);
+    ups_log(("failed to listen to port %d", port)); 
+    return (false);
   }
 
-  srv->async.data = srv;
-#if UV_VERSION_MINOR >= 11
-  uv_async_init(&srv->loop, &srv->async, on_async_cb);
-  uv_thread_create(&srv->thread_id, on_run_thread, &srv->loop);
-#else
-  uv_async_init(srv->loop, &srv->async, on_async_cb);
-  uv_thread_create(&srv->thread_id, on_run_thread, srv->loop);
+  loop->async.data = loop;
+  uv_async_init(loop->get_loop(), &loop->async, on_async_cb);
+  return (true);
+}
+
+} // namespace upscaledb
+
+// global namespace is below
+
+ups_status_t
+ups_srv_init(ups_srv_config_t *config, ups_srv_t **psrv)
+{
+  ServerContext *srv = new ServerContext();
+
+  // with several threads the requests are executed by a thread pool; if
+  // the OS supports it then each thread also runs its own event loop
+  size_t num_loops = 1;
+  if (config->num_threads > 1) {
+    srv->workers = new WorkerPool(config->num_threads);
+#ifdef UPS_SRV_REUSEPORT
+    num_loops = config->num_threads;
 #endif
+  }
+
+  for (size_t i = 0; i < num_loops; i++) {
+    EventLoop *loop = new EventLoop(srv);
+    srv->loops.push_back(loop);
+    if (!init_loop(loop, config->port, num_loops > 1))
+      return (UPS_IO_ERROR);
+  }
+
+  for (size_t i = 0; i < num_loops; i++) {
+    EventLoop *loop = srv->loops[i];
+    uv_thread_create(&loop->thread_id, on_run_thread, loop->get_loop());
+  }
 
   *psrv = (ups_srv_t *)srv;
   return (UPS_SUCCESS);
@@ -2085,12 +2483,7 @@ ups_srv_add_env(ups_srv_t *hsrv, ups_env_t *env, const char *urlname)
     return (UPS_INV_PARAMETER);
   }
 
-  {
-    ScopedLock lock(srv->open_queue_mutex);
-    srv->open_queue[urlname] = (Environment *)env;
-  }
-
-  uv_async_send(&srv->async);
+  srv->add_env(urlname, (Environment *)env);
   return (UPS_SUCCESS);
 }
 
@@ -2101,36 +2494,45 @@ ups_srv_close(ups_srv_t *hsrv)
   if (!srv)
     return;
 
-  uv_unref((uv_handle_t *)&srv->server);
-  uv_unref((uv_handle_t *)&srv->async);
-
   // TODO clean up all allocated objects and handles
 
-  /* stop the event loop */
-#if UV_VERSION_MINOR >= 11
-  uv_stop(&srv->loop);
-#else
-  uv_stop(srv->loop);
-#endif
-  uv_async_send(&srv->async);
+  /* stop the event loops */
+  for (size_t i = 0; i < srv->loops.size(); i++) {
+    EventLoop *loop = srv->loops[i];
+    uv_unref((uv_handle_t *)&loop->server);
+    uv_unref((uv_handle_t *)&loop->async);
+    uv_stop(loop->get_loop());
+    uv_async_send(&loop->async);
+  }
+
+  /* join the libuv threads */
+  for (size_t i = 0; i < srv->loops.size(); i++)
+    (void)uv_thread_join(&srv->loops[i]->thread_id);
+
+  /* join the worker threads; they no longer receive requests, but still
+   * send notifications to the async handles */
+  delete srv->workers;
+  srv->workers = 0;
 
-  /* join the libuv thread */
-  (void)uv_thread_join(&srv->thread_id);
+  for (size_t i = 0; i < srv->loops.size(); i++) {
+    EventLoop *loop = srv->loops[i];
 
-  /* close the async handle and the server socket */
-  uv_close((uv_handle_t *)&srv->async, 0);
-  uv_close((uv_handle_t *)&srv->server, 0);
+    /* close the async handle and the server socket */
+    uv_close((uv_handle_t *)&loop->async, 0);
+    uv_close((uv_handle_t *)&loop->server, 0);
 
-  /* clean up libuv */
+    /* clean up libuv */
 #if UV_VERSION_MINOR >= 11
-  uv_loop_close(&srv->loop);
+    uv_loop_close(&loop->loop);
 #else
-  uv_loop_delete(srv->loop);
+    uv_loop_delete(loop->loop);
 #endif
 
+    delete loop;
+  }
+
   delete srv;
 
   /* free libprotocol static data */
   Protocol::shutdown();
 }
-
@@ -34,6 +34,7 @@
 #include "ups/upscaledb_srv.h"
 
 #include "1base/mutex.h"
+#include "2worker/worker.h"
 #include "4db/db.h"
 #include "4cursor/cursor.h"
 
@@ -63,18 +64,63 @@ typedef std::vector< Handle<Cursor> > CursorVector;
 typedef std::vector< Handle<Transaction> > TransactionVector;
 typedef std::map<std::string, Environment *> EnvironmentMap;
 
+class ServerContext;
+struct ClientContext;
+
+// A request which was executed by a worker thread; its replies are sent
+// by the thread of the event loop
+struct Completion {
+  Completion(ClientContext *_client)
+    : client(_client), close_client(false) {
+  }
+
+  ClientContext *client;
+  std::vector<std::pair<uint8_t *, uint32_t> > replies;
+  bool close_client;
+};
+
+// An event loop with its own thread and its own listening socket
+struct EventLoop {
+  EventLoop(ServerContext *_srv)
+    : srv(_srv), thread_id(0) {
+    memset(&server, 0, sizeof(server));
+    memset(&async, 0, sizeof(async));
+  }
+
+  uv_loop_t *get_loop() {
+#if UV_VERSION_MINOR >= 11
+    return (&loop);
+#else
+    return (loop);
+#endif
+  }
+
+  ServerContext *srv;
+  uv_tcp_t server;
+  uv_thread_t thread_id;
+  uv_async_t async;
+#if UV_VERSION_MINOR >= 11
+  uv_loop_t loop;
+#else
+  uv_loop_t *loop;
+#endif
+
+  // The requests which were executed by the worker threads
+  Mutex completion_mutex;
+  std::vector<Completion> completions;
+};
+
 class ServerContext {
   public:
     ServerContext()
-      : thread_id(0), m_handle_counter(1) {
-      memset(&server, 0, sizeof(server));
-      memset(&async, 0, sizeof(async));
+      : workers(0), m_handle_counter(1) {
     }
 
     // allocates a new handle
     // TODO the allocate_handle methods have lots of duplicate code;
     // try to find a generic solution!
     uint64_t allocate_handle(Environment *env) {
+      ScopedLock lock(m_mutex);
       uint64_t c = 0;
       for (EnvironmentVector::iterator it = m_environments.begin();
               it != m_environments.end(); it++, c++) {
@@ -94,6 +140,7 @@ class ServerContext {
     }
 
     uint64_t allocate_handle(Database *db) {
+      ScopedLock lock(m_mutex);
       uint64_t c = 0;
       for (DatabaseVector::iterator it = m_databases.begin();
               it != m_databases.end(); it++, c++) {
@@ -113,6 +160,7 @@ class ServerContext {
     }
 
     uint64_t allocate_handle(Transaction *txn) {
+      ScopedLock lock(m_mutex);
       uint64_t c = 0;
       for (TransactionVector::iterator it = m_transactions.begin();
               it != m_transactions.end(); it++, c++) {
@@ -132,6 +180,7 @@ class ServerContext {
     }
 
     uint64_t allocate_handle(Cursor *cursor) {
+      ScopedLock lock(m_mutex);
       uint64_t c = 0;
       for (CursorVector::iterator it = m_cursors.begin();
               it != m_cursors.end(); it++, c++) {
@@ -151,6 +200,7 @@ class ServerContext {
     }
 
     void remove_env_handle(uint64_t handle) {
+      ScopedLock lock(m_mutex);
       uint32_t index = handle & 0xffffffff;
       //ups_assert(index < m_environments.size());
       if (index >= m_environments.size())
@@ -164,6 +214,7 @@ class ServerContext {
     }
 
     void remove_db_handle(uint64_t handle) {
+      ScopedLock lock(m_mutex);
       uint32_t index = handle & 0xffffffff;
       ups_assert(index < m_databases.size());
       if (index >= m_databases.size())
@@ -177,6 +228,7 @@ class ServerContext {
     }
 
     void remove_txn_handle(uint64_t handle) {
+      ScopedLock lock(m_mutex);
       uint32_t index = handle & 0xffffffff;
       ups_assert(index < m_transactions.size());
       if (index >= m_transactions.size())
@@ -190,6 +242,7 @@ class ServerContext {
     }
 
     void remove_cursor_handle(uint64_t handle) {
+      ScopedLock lock(m_mutex);
       uint32_t index = handle & 0xffffffff;
       ups_assert(index < m_cursors.size());
       if (index >= m_cursors.size())
@@ -203,6 +256,7 @@ class ServerContext {
     }
 
     Environment *get_env(uint64_t handle) {
+      ScopedLock lock(m_mutex);
       uint32_t index = handle & 0xffffffff;
       ups_assert(index < m_environments.size());
       if (index >= m_environments.size())
@@ -215,6 +269,7 @@ class ServerContext {
     }
 
     Database *get_db(uint64_t handle) {
+      ScopedLock lock(m_mutex);
       uint32_t index = handle & 0xffffffff;
       ups_assert(index < m_databases.size());
       if (index >= m_databases.size())
@@ -227,6 +282,7 @@ class ServerContext {
     }
 
     Transaction *get_txn(uint64_t handle) {
+      ScopedLock lock(m_mutex);
       uint32_t index = handle & 0xffffffff;
       ups_assert(index < m_transactions.size());
       if (index >= m_transactions.size())
@@ -239,6 +295,7 @@ class ServerContext {
     }
 
     Cursor *get_cursor(uint64_t handle) {
+      ScopedLock lock(m_mutex);
       uint32_t index = handle & 0xffffffff;
       ups_assert(index < m_cursors.size());
       if (index >= m_cursors.size())
@@ -251,6 +308,7 @@ class ServerContext {
     }
 
     Handle<Database> get_db_by_name(uint16_t dbname) {
+      ScopedLock lock(m_mutex);
       for (size_t i = 0; i < m_databases.size(); i++) {
         Database *db = m_databases[i].object;
         if (db && db->name() == dbname)
@@ -259,21 +317,32 @@ class ServerContext {
       return (Handle<Database>(0, 0));
     }
 
-    uv_tcp_t server;
-    uv_thread_t thread_id;
-    uv_async_t async;
-#if UV_VERSION_MINOR >= 11
-	uv_loop_t loop;
-#else
-	uv_loop_t *loop;
-#endif
-    EnvironmentMap open_envs;
+    // Adds an Environment which is served at |urlname|
+    void add_env(const char *urlname, Environment *env) {
+      ScopedLock lock(m_mutex);
+      m_open_envs[urlname] = env;
+    }
 
-    Mutex open_queue_mutex;
-    EnvironmentMap open_queue;
-    ByteArray buffer;
+    // Returns the Environment which is served at |urlname|, or null
+    Environment *get_env_by_url(const std::string &urlname) {
+      ScopedLock lock(m_mutex);
+      EnvironmentMap::iterator it = m_open_envs.find(urlname);
+      return (it != m_open_envs.end() ? it->second : 0);
+    }
+
+    // The event loops; each one runs in its own thread
+    std::vector<EventLoop *> loops;
+
+    // The threads which execute the requests; null if the requests are
+    // executed by the threads of the event loops
+    WorkerPool *workers;
 
   private:
+    // Protects the handles and the Environments; the handlers are called
+    // by several threads if |workers| is not null
+    Mutex m_mutex;
+
+    EnvironmentMap m_open_envs;
     EnvironmentVector m_environments;
     DatabaseVector m_databases;
     CursorVector m_cursors;
@@ -282,13 +351,47 @@ class ServerContext {
 };
 
 struct ClientContext {
-  ClientContext(ServerContext *_srv)
-    : buffer(0), srv(_srv) {
+  ClientContext(ServerContext *_srv, EventLoop *_loop, uv_tcp_t *_tcp)
+    : buffer(0), srv(_srv), loop(_loop), tcp(_tcp), strand(0), pending(0),
+      closed(false), close_requested(false), request_id(0) {
     ups_assert(srv != 0);
+    if (srv->workers)
+      strand = new boost::asio::io_service::strand(srv->workers->service);
+  }
+
+  ~ClientContext() {
+    delete strand;
   }
 
   ByteArray buffer;
   ServerContext *srv;
+  EventLoop *loop;
+  uv_tcp_t *tcp;
+
+  // Executes the requests of this client one at a time and in the order
+  // in which they were received; null if the requests are executed by
+  // the thread of the event loop
+  boost::asio::io_service::strand *strand;
+
+  // The number of requests which were handed over to the worker threads
+  // and not yet completed; only accessed by the thread of the event loop
+  size_t pending;
+
+  // True if the connection was closed; only accessed by the thread of
+  // the event loop
+  bool closed;
+
+  // True if a request failed and the connection will be closed; only
+  // accessed by the worker threads
+  bool close_requested;
+
+  // The replies of the request which is currently executed by a
+  // worker thread
+  std::vector<std::pair<uint8_t *, uint32_t> > replies;
+
+  // The id of the request which is currently executed; sent back with
+  // the reply (see SerializedWrapper::request_id)
+  uint32_t request_id;
 };
 
 } // namespace upscaledb
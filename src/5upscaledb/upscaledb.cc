@@ -264,6 +264,195 @@ __prepare_record(ups_record_t *record)
   return (true);
 }
 
+/**
+ * Verifies the parameters of @ref ups_db_find and @ref ups_db_find_many
+ */
+static ups_status_t
+check_find_parameters(Database *db, ups_key_t *key, ups_record_t *record,
+                uint32_t flags)
+{
+  Environment *env = db->get_env();
+
+  if (!key) {
+    ups_trace(("parameter 'key' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!record) {
+    ups_trace(("parameter 'record' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (flags & UPS_HINT_PREPEND) {
+    ups_trace(("flag UPS_HINT_PREPEND is only allowed in "
+          "ups_cursor_insert"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (flags & UPS_HINT_APPEND) {
+    ups_trace(("flag UPS_HINT_APPEND is only allowed in "
+          "ups_cursor_insert"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((flags & UPS_DIRECT_ACCESS)
+      && !(env->get_flags() & UPS_IN_MEMORY)) {
+    ups_trace(("flag UPS_DIRECT_ACCESS is only allowed in "
+          "In-Memory Databases"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((flags & UPS_DIRECT_ACCESS)
+      && (env->get_flags() & UPS_ENABLE_TRANSACTIONS)) {
+    ups_trace(("flag UPS_DIRECT_ACCESS is not allowed in "
+          "combination with Transactions"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((flags & UPS_PARTIAL)
+      && (db->get_flags() & UPS_ENABLE_TRANSACTIONS)) {
+    ups_trace(("flag UPS_PARTIAL is not allowed in combination with "
+          "transactions"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  /* record number: make sure that we have a valid key structure */
+  if ((db->get_flags() & UPS_RECORD_NUMBER32) && !key->data) {
+    ups_trace(("key->data must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((db->get_flags() & UPS_RECORD_NUMBER64) && !key->data) {
+    ups_trace(("key->data must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  if (!__prepare_key(key) || !__prepare_record(record))
+    return (UPS_INV_PARAMETER);
+
+  return (0);
+}
+
+/**
+ * Verifies the parameters of @ref ups_db_insert and @ref ups_db_insert_many
+ */
+static ups_status_t
+check_insert_parameters(Database *db, ups_key_t *key, ups_record_t *record,
+                uint32_t flags)
+{
+  if (!key) {
+    ups_trace(("parameter 'key' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!record) {
+    ups_trace(("parameter 'record' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (flags & UPS_HINT_APPEND) {
+    ups_trace(("flags UPS_HINT_APPEND is only allowed in "
+          "ups_cursor_insert"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (flags & UPS_HINT_PREPEND) {
+    ups_trace(("flags UPS_HINT_PREPEND is only allowed in "
+          "ups_cursor_insert"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (db->get_flags() & UPS_READ_ONLY) {
+    ups_trace(("cannot insert in a read-only database"));
+    return (UPS_WRITE_PROTECTED);
+  }
+  if ((flags & UPS_OVERWRITE) && (flags & UPS_DUPLICATE)) {
+    ups_trace(("cannot combine UPS_OVERWRITE and UPS_DUPLICATE"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((flags & UPS_PARTIAL)
+      && (db->get_flags() & UPS_ENABLE_TRANSACTIONS)) {
+    ups_trace(("flag UPS_PARTIAL is not allowed in combination with "
+          "transactions"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((flags & UPS_PARTIAL) && (record->size <= sizeof(uint64_t))) {
+    ups_trace(("flag UPS_PARTIAL is not allowed if record->size "
+          "<= 8"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((flags & UPS_PARTIAL)
+      && (record->partial_size + record->partial_offset > record->size)) {
+    ups_trace(("partial offset+size is greater than the total "
+          "record size"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((flags & UPS_DUPLICATE)
+      && !(db->get_flags() & UPS_ENABLE_DUPLICATE_KEYS)) {
+    ups_trace(("database does not support duplicate keys "
+          "(see UPS_ENABLE_DUPLICATE_KEYS)"));
+    return (UPS_INV_PARAMETER);
+  }
+  if ((flags & UPS_DUPLICATE_INSERT_AFTER)
+      || (flags & UPS_DUPLICATE_INSERT_BEFORE)
+      || (flags & UPS_DUPLICATE_INSERT_LAST)
+      || (flags & UPS_DUPLICATE_INSERT_FIRST)) {
+    ups_trace(("function does not support flags UPS_DUPLICATE_INSERT_*; "
+          "see ups_cursor_insert"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  if (!__prepare_key(key) || !__prepare_record(record))
+    return (UPS_INV_PARAMETER);
+
+  /* allocate temp. storage for a recno key */
+  if ((db->get_flags() & UPS_RECORD_NUMBER32)
+      || (db->get_flags() & UPS_RECORD_NUMBER64)) {
+    if (flags & UPS_OVERWRITE) {
+      if (!key->data) {
+        ups_trace(("key->data must not be NULL"));
+        return (UPS_INV_PARAMETER);
+      }
+    }
+    else {
+      if (key->flags & UPS_KEY_USER_ALLOC) {
+        if (!key->data) {
+          ups_trace(("key->data must not be NULL"));
+          return (UPS_INV_PARAMETER);
+        }
+      }
+      else {
+        if (key->data || key->size) {
+          ups_trace(("key->size must be 0, key->data must be NULL"));
+          return (UPS_INV_PARAMETER);
+        }
+      }
+    }
+  }
+
+  return (0);
+}
+
+/**
+ * Verifies the parameters of @ref ups_db_erase and @ref ups_db_erase_many
+ */
+static ups_status_t
+check_erase_parameters(Database *db, ups_key_t *key, uint32_t flags)
+{
+  if (!key) {
+    ups_trace(("parameter 'key' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (flags & UPS_HINT_PREPEND) {
+    ups_trace(("flag UPS_HINT_PREPEND is only allowed in "
+          "ups_cursor_insert"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (flags & UPS_HINT_APPEND) {
+    ups_trace(("flag UPS_HINT_APPEND is only allowed in "
+          "ups_cursor_insert"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (db->get_flags() & UPS_READ_ONLY) {
+    ups_trace(("cannot erase from a read-only database"));
+    return (UPS_WRITE_PROTECTED);
+  }
+
+  if (!__prepare_key(key))
+    return (UPS_INV_PARAMETER);
+
+  return (0);
+}
+
 void UPS_CALLCONV
 ups_get_version(uint32_t *major, uint32_t *minor, uint32_t *revision)
 {
@@ -310,6 +499,16 @@ ups_env_create(ups_env_t **henv, const char *filename,
   if (flags & UPS_AUTO_RECOVERY)
     flags |= UPS_ENABLE_TRANSACTIONS;
 
+  /* flag UPS_ENABLE_DIRECT_IO requires UPS_ENABLE_IO_URING and implies
+   * UPS_DISABLE_MMAP */
+  if (flags & UPS_ENABLE_DIRECT_IO) {
+    if (!(flags & UPS_ENABLE_IO_URING)) {
+      ups_trace(("UPS_ENABLE_DIRECT_IO requires UPS_ENABLE_IO_URING"));
+      return (UPS_INV_PARAMETER);
+    }
+    flags |= UPS_DISABLE_MMAP;
+  }
+
   if (param) {
     for (; param->name; param++) {
       switch (param->name) {
@@ -375,6 +574,57 @@ ups_env_create(ups_env_t **henv, const char *filename,
       case UPS_PARAM_POSIX_FADVISE:
         config.posix_advice = (int)param->value;
         break;
+      case UPS_PARAM_CACHE_POLICY:
+        if (param->value != UPS_CACHE_POLICY_LRU
+                && param->value != UPS_CACHE_POLICY_2Q) {
+          ups_trace(("invalid cache policy %d", (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.cache_policy = (int)param->value;
+        break;
+      case UPS_PARAM_FLUSH_THREADS:
+        if (param->value == 0 || param->value > 64) {
+          ups_trace(("invalid number of flush threads %d",
+                                  (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.flush_threads = (int)param->value;
+        break;
+      case UPS_PARAM_PREFETCH_PAGES:
+        if (param->value > 1024) {
+          ups_trace(("invalid number of prefetch pages %d",
+                                  (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.prefetch_pages = (int)param->value;
+        break;
+      case UPS_PARAM_GROUP_COMMIT_WINDOW:
+        if (param->value > 1000000) {
+          ups_trace(("invalid group commit window %u",
+                                  (unsigned)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.group_commit_usec = param->value;
+        break;
+      case UPS_PARAM_GROUP_COMMIT_BYTES:
+        config.group_commit_bytes = param->value;
+        break;
+      case UPS_PARAM_JANITOR_INTERVAL:
+        if (param->value > 3600 * 1000) {
+          ups_trace(("invalid janitor interval %u",
+                                  (unsigned)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.janitor_interval_msec = (uint32_t)param->value;
+        break;
+      case UPS_PARAM_SCAN_THREADS:
+        if (param->value == 0 || param->value > 64) {
+          ups_trace(("invalid number of scan threads %d",
+                                  (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.scan_threads = (int)param->value;
+        break;
       default:
         ups_trace(("unknown parameter %d", (int)param->name));
         return (UPS_INV_PARAMETER);
@@ -541,6 +791,16 @@ ups_env_open(ups_env_t **henv, const char *filename, uint32_t flags,
   if (flags & UPS_AUTO_RECOVERY)
     flags |= UPS_ENABLE_TRANSACTIONS;
 
+  /* flag UPS_ENABLE_DIRECT_IO requires UPS_ENABLE_IO_URING and implies
+   * UPS_DISABLE_MMAP */
+  if (flags & UPS_ENABLE_DIRECT_IO) {
+    if (!(flags & UPS_ENABLE_IO_URING)) {
+      ups_trace(("UPS_ENABLE_DIRECT_IO requires UPS_ENABLE_IO_URING"));
+      return (UPS_INV_PARAMETER);
+    }
+    flags |= UPS_DISABLE_MMAP;
+  }
+
   if (config.filename.empty() && !(flags & UPS_IN_MEMORY)) {
     ups_trace(("filename is missing"));
     return (UPS_INV_PARAMETER);
@@ -589,6 +849,57 @@ ups_env_open(ups_env_t **henv, const char *filename, uint32_t flags,
       case UPS_PARAM_POSIX_FADVISE:
         config.posix_advice = (int)param->value;
         break;
+      case UPS_PARAM_CACHE_POLICY:
+        if (param->value != UPS_CACHE_POLICY_LRU
+                && param->value != UPS_CACHE_POLICY_2Q) {
+          ups_trace(("invalid cache policy %d", (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.cache_policy = (int)param->value;
+        break;
+      case UPS_PARAM_FLUSH_THREADS:
+        if (param->value == 0 || param->value > 64) {
+          ups_trace(("invalid number of flush threads %d",
+                                  (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.flush_threads = (int)param->value;
+        break;
+      case UPS_PARAM_PREFETCH_PAGES:
+        if (param->value > 1024) {
+          ups_trace(("invalid number of prefetch pages %d",
+                                  (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.prefetch_pages = (int)param->value;
+        break;
+      case UPS_PARAM_GROUP_COMMIT_WINDOW:
+        if (param->value > 1000000) {
+          ups_trace(("invalid group commit window %u",
+                                  (unsigned)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.group_commit_usec = param->value;
+        break;
+      case UPS_PARAM_GROUP_COMMIT_BYTES:
+        config.group_commit_bytes = param->value;
+        break;
+      case UPS_PARAM_JANITOR_INTERVAL:
+        if (param->value > 3600 * 1000) {
+          ups_trace(("invalid janitor interval %u",
+                                  (unsigned)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.janitor_interval_msec = (uint32_t)param->value;
+        break;
+      case UPS_PARAM_SCAN_THREADS:
+        if (param->value == 0 || param->value > 64) {
+          ups_trace(("invalid number of scan threads %d",
+                                  (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.scan_threads = (int)param->value;
+        break;
       default:
         ups_trace(("unknown parameter %d", (int)param->name));
         return (UPS_INV_PARAMETER);
@@ -746,6 +1057,18 @@ ups_env_flush(ups_env_t *henv, uint32_t flags)
   return (env->flush(flags));
 }
 
+ups_status_t UPS_CALLCONV
+ups_env_wait_async(ups_env_t *henv)
+{
+  Environment *env = (Environment *)henv;
+  if (!env) {
+    ups_trace(("parameter 'env' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  return (env->wait_async());
+}
+
 ups_status_t UPS_CALLCONV
 ups_env_close(ups_env_t *henv, uint32_t flags)
 {
@@ -795,7 +1118,7 @@ ups_db_get_parameters(ups_db_t *hdb, ups_parameter_t *param)
     return UPS_INV_PARAMETER;
   }
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   /* get the parameters */
   return (db->get_parameters(param));
@@ -830,7 +1153,7 @@ ups_db_set_compare_func(ups_db_t *hdb, ups_compare_func_t foo)
   EVENTLOG_APPEND((ldb->get_env()->config().filename.c_str(),
               "f.db_set_compare_func", "%u", (uint32_t)ldb->name()));
 
-  ScopedLock lock(ldb->get_env()->mutex());
+  ScopedExclusiveLock lock(ldb->get_env()->mutex());
 
   /* set the compare functions */
   return (ldb->set_compare_func(foo));
@@ -850,81 +1173,97 @@ ups_db_find(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
   }
   env = db->get_env();
 
-  ScopedLock lock(env->mutex());
+  ScopedReadWriteLock lock(env->mutex(), db->supports_concurrent_reads());
 
-  if (!key) {
-    ups_trace(("parameter 'key' must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-  if (!record) {
-    ups_trace(("parameter 'record' must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-  if (flags & UPS_HINT_PREPEND) {
-    ups_trace(("flag UPS_HINT_PREPEND is only allowed in "
-          "ups_cursor_insert"));
-    return (UPS_INV_PARAMETER);
-  }
-  if (flags & UPS_HINT_APPEND) {
-    ups_trace(("flag UPS_HINT_APPEND is only allowed in "
-          "ups_cursor_insert"));
-    return (UPS_INV_PARAMETER);
-  }
-  if ((flags & UPS_DIRECT_ACCESS)
-      && !(env->get_flags() & UPS_IN_MEMORY)) {
-    ups_trace(("flag UPS_DIRECT_ACCESS is only allowed in "
-          "In-Memory Databases"));
-    return (UPS_INV_PARAMETER);
-  }
-  if ((flags & UPS_DIRECT_ACCESS)
-      && (env->get_flags() & UPS_ENABLE_TRANSACTIONS)) {
-    ups_trace(("flag UPS_DIRECT_ACCESS is not allowed in "
-          "combination with Transactions"));
-    return (UPS_INV_PARAMETER);
-  }
-  if ((flags & UPS_PARTIAL)
-      && (db->get_flags() & UPS_ENABLE_TRANSACTIONS)) {
-    ups_trace(("flag UPS_PARTIAL is not allowed in combination with "
-          "transactions"));
-    return (UPS_INV_PARAMETER);
+  ups_status_t st = check_find_parameters(db, key, record, flags);
+  if (st)
+    return (st);
+
+  EVENTLOG_APPEND((env->config().filename.c_str(),
+              "f.db_find", "%u, %u, %s, 0x%x", (uint32_t)db->name(),
+              txn ? (uint32_t)txn->get_id() : 0,
+              key ? EventLog::escape(key->data, key->size) : "",
+              flags));
+
+  return (db->find(0, txn, key, record, flags));
+}
+
+UPS_EXPORT int UPS_CALLCONV
+ups_key_get_approximate_match_type(ups_key_t *key)
+{
+  if (key && (ups_key_get_intflags(key) & BtreeKey::kApproximate)) {
+    int rv = (ups_key_get_intflags(key) & BtreeKey::kLower) ? -1 : +1;
+    return (rv);
   }
 
-  /* record number: make sure that we have a valid key structure */
-  if ((db->get_flags() & UPS_RECORD_NUMBER32) && !key->data) {
-    ups_trace(("key->data must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-  if ((db->get_flags() & UPS_RECORD_NUMBER64) && !key->data) {
-    ups_trace(("key->data must not be NULL"));
-    return (UPS_INV_PARAMETER);
+  return (0);
+}
+
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_insert(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
+                ups_record_t *record, uint32_t flags)
+{
+  Database *db = (Database *)hdb;
+  Transaction *txn = (Transaction *)htxn;
+  Environment *env;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return UPS_INV_PARAMETER;
   }
+  env = db->get_env();
 
-  if (!__prepare_key(key) || !__prepare_record(record))
-    return (UPS_INV_PARAMETER);
+  ScopedExclusiveLock lock;
+  if (!(flags & UPS_DONT_LOCK))
+    lock = ScopedExclusiveLock(env->mutex());
+
+  ups_status_t st = check_insert_parameters(db, key, record, flags);
+  if (st)
+    return (st);
 
   EVENTLOG_APPEND((env->config().filename.c_str(),
-              "f.db_find", "%u, %u, %s, 0x%x", (uint32_t)db->name(),
+              "f.db_insert", "%u, %u, %s, %u, 0x%x", (uint32_t)db->name(),
               txn ? (uint32_t)txn->get_id() : 0,
               key ? EventLog::escape(key->data, key->size) : "",
-              flags));
+              (uint32_t)record->size, flags));
 
-  return (db->find(0, txn, key, record, flags));
+  return (db->insert(0, txn, key, record, flags));
 }
 
-UPS_EXPORT int UPS_CALLCONV
-ups_key_get_approximate_match_type(ups_key_t *key)
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_erase(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key, uint32_t flags)
 {
-  if (key && (ups_key_get_intflags(key) & BtreeKey::kApproximate)) {
-    int rv = (ups_key_get_intflags(key) & BtreeKey::kLower) ? -1 : +1;
-    return (rv);
+  Database *db = (Database *)hdb;
+  Transaction *txn = (Transaction *)htxn;
+  Environment *env;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
   }
+  env = db->get_env();
 
-  return (0);
+  ScopedExclusiveLock lock;
+  if (!(flags & UPS_DONT_LOCK))
+    lock = ScopedExclusiveLock(env->mutex());
+
+  ups_status_t st = check_erase_parameters(db, key, flags);
+  if (st)
+    return (st);
+
+  EVENTLOG_APPEND((env->config().filename.c_str(),
+              "f.db_erase", "%u, %u, %s, 0x%x", (uint32_t)db->name(),
+              txn ? (uint32_t)txn->get_id() : 0,
+              key ? EventLog::escape(key->data, key->size) : "",
+              flags));
+
+  return (db->erase(0, txn, key, flags));
 }
 
 UPS_EXPORT ups_status_t UPS_CALLCONV
-ups_db_insert(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
-                ups_record_t *record, uint32_t flags)
+ups_db_insert_many(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *keys,
+                ups_record_t *records, uint32_t count, ups_status_t *results,
+                uint32_t flags)
 {
   Database *db = (Database *)hdb;
   Transaction *txn = (Transaction *)htxn;
@@ -932,111 +1271,184 @@ ups_db_insert(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
 
   if (!db) {
     ups_trace(("parameter 'db' must not be NULL"));
-    return UPS_INV_PARAMETER;
+    return (UPS_INV_PARAMETER);
+  }
+  if (count && (!keys || !records || !results)) {
+    ups_trace(("parameters 'keys', 'records' and 'results' must not "
+          "be NULL"));
+    return (UPS_INV_PARAMETER);
   }
   env = db->get_env();
 
-  ScopedLock lock;
+  ScopedExclusiveLock lock;
   if (!(flags & UPS_DONT_LOCK))
-    lock = ScopedLock(env->mutex());
+    lock = ScopedExclusiveLock(env->mutex());
 
-  if (!key) {
-    ups_trace(("parameter 'key' must not be NULL"));
-    return (UPS_INV_PARAMETER);
+  for (uint32_t i = 0; i < count; i++) {
+    ups_status_t st = check_insert_parameters(db, &keys[i], &records[i], flags);
+    if (st)
+      return (st);
   }
-  if (!record) {
-    ups_trace(("parameter 'record' must not be NULL"));
+
+  EVENTLOG_APPEND((env->config().filename.c_str(),
+              "f.db_insert_many", "%u, %u, %u, 0x%x", (uint32_t)db->name(),
+              txn ? (uint32_t)txn->get_id() : 0, count, flags));
+
+  if (count == 0)
+    return (0);
+  return (db->insert_many(txn, keys, records, count, results, flags));
+}
+
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_find_many(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *keys,
+                ups_record_t *records, uint32_t count, ups_status_t *results,
+                uint32_t flags)
+{
+  Database *db = (Database *)hdb;
+  Transaction *txn = (Transaction *)htxn;
+  Environment *env;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if (flags & UPS_HINT_APPEND) {
-    ups_trace(("flags UPS_HINT_APPEND is only allowed in "
-          "ups_cursor_insert"));
+  if (count && (!keys || !records || !results)) {
+    ups_trace(("parameters 'keys', 'records' and 'results' must not "
+          "be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if (flags & UPS_HINT_PREPEND) {
-    ups_trace(("flags UPS_HINT_PREPEND is only allowed in "
-          "ups_cursor_insert"));
+  if (flags & (UPS_FIND_LT_MATCH | UPS_FIND_GT_MATCH)) {
+    ups_trace(("approximate matching is not supported by "
+          "ups_db_find_many"));
     return (UPS_INV_PARAMETER);
   }
-  if (db->get_flags() & UPS_READ_ONLY) {
-    ups_trace(("cannot insert in a read-only database"));
-    return (UPS_WRITE_PROTECTED);
+  env = db->get_env();
+
+  ScopedReadWriteLock lock(env->mutex(), db->supports_concurrent_reads());
+
+  for (uint32_t i = 0; i < count; i++) {
+    ups_status_t st = check_find_parameters(db, &keys[i], &records[i], flags);
+    if (st)
+      return (st);
   }
-  if ((flags & UPS_OVERWRITE) && (flags & UPS_DUPLICATE)) {
-    ups_trace(("cannot combine UPS_OVERWRITE and UPS_DUPLICATE"));
+
+  EVENTLOG_APPEND((env->config().filename.c_str(),
+              "f.db_find_many", "%u, %u, %u, 0x%x", (uint32_t)db->name(),
+              txn ? (uint32_t)txn->get_id() : 0, count, flags));
+
+  if (count == 0)
+    return (0);
+  return (db->find_many(txn, keys, records, count, results, flags));
+}
+
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_erase_many(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *keys,
+                uint32_t count, ups_status_t *results, uint32_t flags)
+{
+  Database *db = (Database *)hdb;
+  Transaction *txn = (Transaction *)htxn;
+  Environment *env;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if ((flags & UPS_PARTIAL)
-      && (db->get_flags() & UPS_ENABLE_TRANSACTIONS)) {
-    ups_trace(("flag UPS_PARTIAL is not allowed in combination with "
-          "transactions"));
+  if (count && (!keys || !results)) {
+    ups_trace(("parameters 'keys' and 'results' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if ((flags & UPS_PARTIAL) && (record->size <= sizeof(uint64_t))) {
-    ups_trace(("flag UPS_PARTIAL is not allowed if record->size "
-          "<= 8"));
+  env = db->get_env();
+
+  ScopedExclusiveLock lock;
+  if (!(flags & UPS_DONT_LOCK))
+    lock = ScopedExclusiveLock(env->mutex());
+
+  for (uint32_t i = 0; i < count; i++) {
+    ups_status_t st = check_erase_parameters(db, &keys[i], flags);
+    if (st)
+      return (st);
+  }
+
+  EVENTLOG_APPEND((env->config().filename.c_str(),
+              "f.db_erase_many", "%u, %u, %u, 0x%x", (uint32_t)db->name(),
+              txn ? (uint32_t)txn->get_id() : 0, count, flags));
+
+  if (count == 0)
+    return (0);
+  return (db->erase_many(txn, keys, count, results, flags));
+}
+
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_insert_async(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
+                ups_record_t *record, uint32_t flags,
+                ups_async_callback_t callback, void *context)
+{
+  Database *db = (Database *)hdb;
+  Transaction *txn = (Transaction *)htxn;
+  Environment *env;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if ((flags & UPS_PARTIAL)
-      && (record->partial_size + record->partial_offset > record->size)) {
-    ups_trace(("partial offset+size is greater than the total "
-          "record size"));
+  if (!callback) {
+    ups_trace(("parameter 'callback' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if ((flags & UPS_DUPLICATE)
-      && !(db->get_flags() & UPS_ENABLE_DUPLICATE_KEYS)) {
-    ups_trace(("database does not support duplicate keys "
-          "(see UPS_ENABLE_DUPLICATE_KEYS)"));
+  env = db->get_env();
+
+  ScopedExclusiveLock lock(env->mutex());
+
+  ups_status_t st = check_insert_parameters(db, key, record, flags);
+  if (st)
+    return (st);
+
+  EVENTLOG_APPEND((env->config().filename.c_str(),
+              "f.db_insert_async", "%u, %u, %s, %u, 0x%x",
+              (uint32_t)db->name(), txn ? (uint32_t)txn->get_id() : 0,
+              EventLog::escape(key->data, key->size),
+              (uint32_t)record->size, flags));
+
+  return (db->insert_async(txn, key, record, flags, callback, context));
+}
+
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_find_async(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
+                uint32_t flags, ups_async_callback_t callback, void *context)
+{
+  Database *db = (Database *)hdb;
+  Transaction *txn = (Transaction *)htxn;
+  Environment *env;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if ((flags & UPS_DUPLICATE_INSERT_AFTER)
-      || (flags & UPS_DUPLICATE_INSERT_BEFORE)
-      || (flags & UPS_DUPLICATE_INSERT_LAST)
-      || (flags & UPS_DUPLICATE_INSERT_FIRST)) {
-    ups_trace(("function does not support flags UPS_DUPLICATE_INSERT_*; "
-          "see ups_cursor_insert"));
+  if (!callback) {
+    ups_trace(("parameter 'callback' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
+  env = db->get_env();
 
-  if (!__prepare_key(key) || !__prepare_record(record))
-    return (UPS_INV_PARAMETER);
+  ScopedExclusiveLock lock(env->mutex());
 
-  /* allocate temp. storage for a recno key */
-  if ((db->get_flags() & UPS_RECORD_NUMBER32)
-      || (db->get_flags() & UPS_RECORD_NUMBER64)) {
-    if (flags & UPS_OVERWRITE) {
-      if (!key->data) {
-        ups_trace(("key->data must not be NULL"));
-        return (UPS_INV_PARAMETER);
-      }
-    }
-    else {
-      if (key->flags & UPS_KEY_USER_ALLOC) {
-        if (!key->data) {
-          ups_trace(("key->data must not be NULL"));
-          return (UPS_INV_PARAMETER);
-        }
-      }
-      else {
-        if (key->data || key->size) {
-          ups_trace(("key->size must be 0, key->data must be NULL"));
-          return (UPS_INV_PARAMETER);
-        }
-      }
-    }
-  }
+  // the record is allocated by the library and passed to the callback
+  ups_record_t record = {0};
+  ups_status_t st = check_find_parameters(db, key, &record, flags);
+  if (st)
+    return (st);
 
   EVENTLOG_APPEND((env->config().filename.c_str(),
-              "f.db_insert", "%u, %u, %s, %u, 0x%x", (uint32_t)db->name(),
+              "f.db_find_async", "%u, %u, %s, 0x%x", (uint32_t)db->name(),
               txn ? (uint32_t)txn->get_id() : 0,
-              key ? EventLog::escape(key->data, key->size) : "",
-              (uint32_t)record->size, flags));
+              EventLog::escape(key->data, key->size), flags));
 
-  return (db->insert(0, txn, key, record, flags));
+  return (db->find_async(txn, key, flags, callback, context));
 }
 
 UPS_EXPORT ups_status_t UPS_CALLCONV
-ups_db_erase(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key, uint32_t flags)
+ups_db_erase_async(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
+                uint32_t flags, ups_async_callback_t callback, void *context)
 {
   Database *db = (Database *)hdb;
   Transaction *txn = (Transaction *)htxn;
@@ -1046,41 +1458,85 @@ ups_db_erase(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key, uint32_t flags)
     ups_trace(("parameter 'db' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
+  if (!callback) {
+    ups_trace(("parameter 'callback' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
   env = db->get_env();
 
-  ScopedLock lock;
-  if (!(flags & UPS_DONT_LOCK))
-    lock = ScopedLock(env->mutex());
+  ScopedExclusiveLock lock(env->mutex());
 
-  if (!key) {
-    ups_trace(("parameter 'key' must not be NULL"));
+  ups_status_t st = check_erase_parameters(db, key, flags);
+  if (st)
+    return (st);
+
+  EVENTLOG_APPEND((env->config().filename.c_str(),
+              "f.db_erase_async", "%u, %u, %s, 0x%x", (uint32_t)db->name(),
+              txn ? (uint32_t)txn->get_id() : 0,
+              EventLog::escape(key->data, key->size), flags));
+
+  return (db->erase_async(txn, key, flags, callback, context));
+}
+
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_bulk_begin(ups_db_t *hdb, uint32_t fill_factor, uint32_t flags)
+{
+  Database *db = (Database *)hdb;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if (flags & UPS_HINT_PREPEND) {
-    ups_trace(("flag UPS_HINT_PREPEND is only allowed in "
-          "ups_cursor_insert"));
+  if (fill_factor > 100) {
+    ups_trace(("parameter 'fill_factor' must be between 0 and 100"));
     return (UPS_INV_PARAMETER);
   }
-  if (flags & UPS_HINT_APPEND) {
-    ups_trace(("flag UPS_HINT_APPEND is only allowed in "
-          "ups_cursor_insert"));
+  if (fill_factor == 0)
+    fill_factor = 100;
+
+  ScopedExclusiveLock lock(db->get_env()->mutex());
+
+  return (db->bulk_begin(fill_factor, flags));
+}
+
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_bulk_insert(ups_db_t *hdb, ups_key_t *key, ups_record_t *record)
+{
+  Database *db = (Database *)hdb;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
     return (UPS_INV_PARAMETER);
   }
-  if (db->get_flags() & UPS_READ_ONLY) {
-    ups_trace(("cannot erase from a read-only database"));
-    return (UPS_WRITE_PROTECTED);
+  if (!key) {
+    ups_trace(("parameter 'key' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!record) {
+    ups_trace(("parameter 'record' must not be NULL"));
+    return (UPS_INV_PARAMETER);
   }
+  if (!__prepare_key(key) || !__prepare_record(record))
+    return (UPS_INV_PARAMETER);
 
-  if (!__prepare_key(key))
+  ScopedExclusiveLock lock(db->get_env()->mutex());
+
+  return (db->bulk_insert(key, record));
+}
+
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_bulk_end(ups_db_t *hdb)
+{
+  Database *db = (Database *)hdb;
+
+  if (!db) {
+    ups_trace(("parameter 'db' must not be NULL"));
     return (UPS_INV_PARAMETER);
+  }
 
-  EVENTLOG_APPEND((env->config().filename.c_str(),
-              "f.db_erase", "%u, %u, %s, 0x%x", (uint32_t)db->name(),
-              txn ? (uint32_t)txn->get_id() : 0,
-              key ? EventLog::escape(key->data, key->size) : "",
-              flags));
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
-  return (db->erase(0, txn, key, flags));
+  return (db->bulk_end());
 }
 
 UPS_EXPORT ups_status_t UPS_CALLCONV
@@ -1098,7 +1554,7 @@ ups_db_check_integrity(ups_db_t *hdb, uint32_t flags)
     return (UPS_INV_PARAMETER);
   }
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   return (db->check_integrity(flags));
 }
@@ -1158,9 +1614,9 @@ ups_cursor_create(ups_cursor_t **hcursor, ups_db_t *hdb, ups_txn_t *htxn,
               "f.cursor_create", "%u, %u, 0x%x", (uint32_t)db->name(),
               txn ? (uint32_t)txn->get_id() : 0, flags));
 
-  ScopedLock lock;
+  ScopedExclusiveLock lock;
   if (!(flags & UPS_DONT_LOCK))
-    lock = ScopedLock(env->mutex());
+    lock = ScopedExclusiveLock(env->mutex());
 
   return (db->cursor_create(cursor, txn, flags));
 }
@@ -1182,7 +1638,7 @@ ups_cursor_clone(ups_cursor_t *hsrc, ups_cursor_t **hdest)
   dest = (Cursor **)hdest;
 
   Database *db = src->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   EVENTLOG_APPEND((db->get_env()->config().filename.c_str(),
               "f.cursor_clone", ""));
@@ -1202,7 +1658,7 @@ ups_cursor_overwrite(ups_cursor_t *hcursor, ups_record_t *record,
   Cursor *cursor = (Cursor *)hcursor;
 
   Database *db = cursor->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   if (flags) {
     ups_trace(("function does not support a non-zero flags value; "
@@ -1238,7 +1694,8 @@ ups_cursor_move(ups_cursor_t *hcursor, ups_key_t *key,
 
   Cursor *cursor = (Cursor *)hcursor;
   Database *db = cursor->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
 
   if ((flags & UPS_ONLY_DUPLICATES) && (flags & UPS_SKIP_DUPLICATES)) {
     ups_trace(("combination of UPS_ONLY_DUPLICATES and "
@@ -1291,9 +1748,9 @@ ups_cursor_find(ups_cursor_t *hcursor, ups_key_t *key, ups_record_t *record,
   Database *db = cursor->db();
   Environment *env = db->get_env();
 
-  ScopedLock lock;
+  ScopedReadWriteLock lock;
   if (!(flags & UPS_DONT_LOCK))
-    lock = ScopedLock(env->mutex());
+    lock.lock(env->mutex(), db->supports_concurrent_reads());
 
   if (!key) {
     ups_trace(("parameter 'key' must not be NULL"));
@@ -1353,7 +1810,7 @@ ups_cursor_insert(ups_cursor_t *hcursor, ups_key_t *key, ups_record_t *record,
   Cursor *cursor = (Cursor *)hcursor;
 
   Database *db = cursor->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   if (!key) {
     ups_trace(("parameter 'key' must not be NULL"));
@@ -1456,7 +1913,7 @@ ups_cursor_erase(ups_cursor_t *hcursor, uint32_t flags)
 
   Cursor *cursor = (Cursor *)hcursor;
   Database *db = cursor->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   if (db->get_flags() & UPS_READ_ONLY) {
     ups_trace(("cannot erase from a read-only database"));
@@ -1488,7 +1945,7 @@ ups_cursor_get_duplicate_count(ups_cursor_t *hcursor, uint32_t *count,
 
   Cursor *cursor = (Cursor *)hcursor;
   Database *db = cursor->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   if (!count) {
     ups_trace(("parameter 'count' must not be NULL"));
@@ -1512,7 +1969,7 @@ ups_cursor_get_duplicate_position(ups_cursor_t *hcursor, uint32_t *position)
 
   Cursor *cursor = (Cursor *)hcursor;
   Database *db = cursor->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   if (!position) {
     ups_trace(("parameter 'position' must not be NULL"));
@@ -1536,7 +1993,7 @@ ups_cursor_get_record_size(ups_cursor_t *hcursor, uint64_t *size)
 
   Cursor *cursor = (Cursor *)hcursor;
   Database *db = cursor->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   if (!size) {
     ups_trace(("parameter 'size' must not be NULL"));
@@ -1559,7 +2016,7 @@ ups_cursor_close(ups_cursor_t *hcursor)
 
   Cursor *cursor = (Cursor *)hcursor;
   Database *db = cursor->db();
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
 
   EVENTLOG_APPEND((db->get_env()->config().filename.c_str(),
               "f.cursor_close", "%u", (uint32_t)db->name()));
@@ -1575,7 +2032,7 @@ ups_set_context_data(ups_db_t *hdb, void *data)
   if (!db)
     return;
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
   db->set_context_data(data);
 }
 
@@ -1589,7 +2046,7 @@ ups_get_context_data(ups_db_t *hdb, ups_bool_t dont_lock)
   if (dont_lock)
     return (db->get_context_data());
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedExclusiveLock lock(db->get_env()->mutex());
   return (db->get_context_data());
 }
 
@@ -1634,7 +2091,8 @@ ups_db_count(ups_db_t *hdb, ups_txn_t *htxn, uint32_t flags,
     return (UPS_INV_PARAMETER);
   }
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
 
   EVENTLOG_APPEND((db->get_env()->config().filename.c_str(),
               "f.db_count", "%u, 0x%x", (uint32_t)db->name(),
@@ -21,6 +21,8 @@
 
 // Always verify that a file of level N does not include headers > N!
 #include "1base/error.h"
+#include "1base/dynamic_array.h"
+#include "2simd/aggregate.h"
 #include "3btree/btree_visitor.h"
 #include "4db/db.h"
 #include "4db/db_local.h"
@@ -49,34 +51,112 @@ uqi_count(ups_db_t *hdb, ups_txn_t *htxn, uqi_result_t *result)
   result->type = UPS_TYPE_UINT64;
   result->u.result_u64 = 0;
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
   return (db->count(txn, false, &result->u.result_u64));
 }
 
+//
+// Applies a uqi_bool_predicate_t to each single key
+//
+struct KeyPredicate {
+  KeyPredicate(uqi_bool_predicate_t *pred)
+    : m_pred(pred) {
+  }
+
+  // Returns true if the key is selected
+  bool operator()(const void *key_data, uint16_t key_size) {
+    return (m_pred->predicate_func(key_data, key_size, m_pred->context) != 0);
+  }
+
+  // Sets |selected[i]| to a non-zero value if the i-th key is selected
+  void operator()(const void *key_array, size_t key_count, uint16_t key_size,
+                  uint8_t *selected) {
+    const uint8_t *p = (const uint8_t *)key_array;
+    for (size_t i = 0; i < key_count; i++, p += key_size)
+      selected[i] = (*this)(p, key_size) ? 1 : 0;
+  }
+
+  // The user's predicate
+  uqi_bool_predicate_t *m_pred;
+};
+
+//
+// Applies a uqi_batch_predicate_t to a whole array of keys
+//
+struct BatchPredicate {
+  BatchPredicate(uqi_batch_predicate_t *pred)
+    : m_pred(pred) {
+  }
+
+  // Returns true if the key is selected
+  bool operator()(const void *key_data, uint16_t key_size) {
+    uint8_t selected = 0;
+    m_pred->predicate_func(key_data, 1, key_size, &selected, m_pred->context);
+    return (selected != 0);
+  }
+
+  // Sets |selected[i]| to a non-zero value if the i-th key is selected
+  void operator()(const void *key_array, size_t key_count, uint16_t key_size,
+                  uint8_t *selected) {
+    m_pred->predicate_func(key_array, key_count, key_size, selected,
+                    m_pred->context);
+  }
+
+  // The user's predicate
+  uqi_batch_predicate_t *m_pred;
+};
+
+// Applies |pred| to an array of keys; returns an array with a flag for
+// each key
+template<typename Predicate>
+static uint8_t *
+select_keys(Predicate &pred, ByteArray *arena, const void *key_array,
+                size_t key_count, uint16_t key_size)
+{
+  uint8_t *selected = arena->resize(key_count);
+  pred(key_array, key_count, key_size, selected);
+  return (selected);
+}
+
+// Counts the selected keys
+static inline size_t
+count_selected(const uint8_t *selected, size_t key_count)
+{
+  return (simd_count_range<uint8_t>(selected, key_count, 1, 0xff));
+}
+
 //
 // A ScanVisitor for uqi_count_if
 //
-template<typename PodType>
+template<typename PodType, typename Predicate>
 struct CountIfScanVisitor : public ScanVisitor {
-  CountIfScanVisitor(uqi_bool_predicate_t *pred)
+  CountIfScanVisitor(Predicate pred)
     : m_count(0), m_pred(pred) {
   }
 
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new CountIfScanVisitor(m_pred));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    m_count += ((const CountIfScanVisitor *)other)->m_count;
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   size_t duplicate_count) {
-    if (m_pred->predicate_func(key_data, key_size, m_pred->context))
+    if (m_pred(key_data, key_size))
       m_count++;
   }
 
   // Operates on an array of keys
   virtual void operator()(const void *key_array, size_t key_count) {
-    const PodType *p = (const PodType *)key_array;
-    const PodType *end = &p[key_count];
-    for (; p < end; p++) {
-      if (m_pred->predicate_func(p, sizeof(PodType), m_pred->context))
-        m_count++;
-    }
+    uint8_t *selected = select_keys(m_pred, &m_selected, key_array,
+                    key_count, sizeof(PodType));
+    m_count += count_selected(selected, key_count);
   }
 
   // Assigns the result to |result|
@@ -88,33 +168,44 @@ struct CountIfScanVisitor : public ScanVisitor {
   uint64_t m_count;
 
   // The user's predicate
-  uqi_bool_predicate_t *m_pred;
+  Predicate m_pred;
+
+  // Stores the predicate's result for each key
+  ByteArray m_selected;
 };
 
 //
 // A ScanVisitor for uqi_count_if on binary keys
 //
+template<typename Predicate>
 struct CountIfScanVisitorBinary : public ScanVisitor {
-  CountIfScanVisitorBinary(size_t key_size, uqi_bool_predicate_t *pred)
+  CountIfScanVisitorBinary(size_t key_size, Predicate pred)
     : m_count(0), m_key_size(key_size), m_pred(pred) {
   }
 
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new CountIfScanVisitorBinary(m_key_size, m_pred));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    m_count += ((const CountIfScanVisitorBinary *)other)->m_count;
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   size_t duplicate_count) {
-    if (m_pred->predicate_func(key_data, key_size, m_pred->context))
+    if (m_pred(key_data, key_size))
       m_count++;
   }
 
   // Operates on an array of keys
   virtual void operator()(const void *key_array, size_t key_count) {
     assert(m_key_size != UPS_KEY_SIZE_UNLIMITED);
-    const uint8_t *p = (const uint8_t *)key_array;
-    const uint8_t *end = &p[key_count * m_key_size];
-    for (; p < end; p += m_key_size) {
-      if (m_pred->predicate_func(p, m_key_size, m_pred->context))
-        m_count++;
-    }
+    uint8_t *selected = select_keys(m_pred, &m_selected, key_array,
+                    key_count, m_key_size);
+    m_count += count_selected(selected, key_count);
   }
 
   // Assigns the result to |result|
@@ -129,26 +220,19 @@ struct CountIfScanVisitorBinary : public ScanVisitor {
   uint16_t m_key_size;
 
   // The user's predicate
-  uqi_bool_predicate_t *m_pred;
+  Predicate m_pred;
+
+  // Stores the predicate's result for each key
+  ByteArray m_selected;
 };
 
-ups_status_t UPS_CALLCONV
-uqi_count_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
-                uqi_result_t *result)
+// Implementation of uqi_count_if, uqi_count_distinct_if and their
+// batched counterparts
+template<typename Predicate>
+static ups_status_t
+count_if_impl(ups_db_t *hdb, ups_txn_t *txn, Predicate pred,
+                bool distinct, uqi_result_t *result)
 {
-  if (!hdb) {
-    ups_trace(("parameter 'db' must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-  if (!pred) {
-    ups_trace(("parameter 'pred' must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-  if (!result) {
-    ups_trace(("parameter 'result' must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-
   // Remote databases are not yet supported
   LocalDatabase *db = dynamic_cast<LocalDatabase *>((Database *)hdb);
   if (!db) {
@@ -162,39 +246,80 @@ uqi_count_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
 
   switch (db->config().key_type) {
     case UPS_TYPE_UINT8:
-      visitor.reset(new CountIfScanVisitor<uint8_t>(pred));
+      visitor.reset(new CountIfScanVisitor<uint8_t, Predicate>(pred));
       break;
     case UPS_TYPE_UINT16:
-      visitor.reset(new CountIfScanVisitor<uint16_t>(pred));
+      visitor.reset(new CountIfScanVisitor<uint16_t, Predicate>(pred));
       break;
     case UPS_TYPE_UINT32:
-      visitor.reset(new CountIfScanVisitor<uint32_t>(pred));
+      visitor.reset(new CountIfScanVisitor<uint32_t, Predicate>(pred));
       break;
     case UPS_TYPE_UINT64:
-      visitor.reset(new CountIfScanVisitor<uint64_t>(pred));
+      visitor.reset(new CountIfScanVisitor<uint64_t, Predicate>(pred));
       break;
     case UPS_TYPE_REAL32:
-      visitor.reset(new CountIfScanVisitor<float>(pred));
+      visitor.reset(new CountIfScanVisitor<float, Predicate>(pred));
       break;
     case UPS_TYPE_REAL64:
-      visitor.reset(new CountIfScanVisitor<double>(pred));
+      visitor.reset(new CountIfScanVisitor<double, Predicate>(pred));
       break;
     case UPS_TYPE_BINARY:
-      visitor.reset(new CountIfScanVisitorBinary(db->config().key_size,
-                              pred));
+      visitor.reset(new CountIfScanVisitorBinary<Predicate>(
+                              db->config().key_size, pred));
       break;
     default:
       ups_assert(!"shouldn't be here");
       return (UPS_INV_PARAMETER);
   }
 
-  ScopedLock lock(db->get_env()->mutex());
-  ups_status_t st = db->scan((Transaction *)txn, visitor.get(), false);
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
+  ups_status_t st = db->scan((Transaction *)txn, visitor.get(), distinct);
   if (st == 0)
     visitor->assign_result(result);
   return (st);
 }
 
+ups_status_t UPS_CALLCONV
+uqi_count_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
+                uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!pred) {
+    ups_trace(("parameter 'pred' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  return (count_if_impl(hdb, txn, KeyPredicate(pred), false, result));
+}
+
+ups_status_t UPS_CALLCONV
+uqi_count_if_batch(ups_db_t *hdb, ups_txn_t *txn, uqi_batch_predicate_t *pred,
+                uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!pred) {
+    ups_trace(("parameter 'pred' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  return (count_if_impl(hdb, txn, BatchPredicate(pred), false, result));
+}
+
 ups_status_t UPS_CALLCONV
 uqi_count_distinct(ups_db_t *hdb, ups_txn_t *htxn, uqi_result_t *result)
 {
@@ -213,7 +338,8 @@ uqi_count_distinct(ups_db_t *hdb, ups_txn_t *htxn, uqi_result_t *result)
   result->type = UPS_TYPE_UINT64;
   result->u.result_u64 = 0;
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
   return (db->count(txn, true, &result->u.result_u64));
 }
 
@@ -234,50 +360,7 @@ uqi_count_distinct_if(ups_db_t *hdb, ups_txn_t *txn,
     return (UPS_INV_PARAMETER);
   }
 
-  // Remote databases are not yet supported
-  LocalDatabase *db = dynamic_cast<LocalDatabase *>((Database *)hdb);
-  if (!db) {
-    ups_trace(("uqi_* functions are not yet supported for remote databases"));
-    return (UPS_INV_PARAMETER);
-  }
-
-  std::auto_ptr<ScanVisitor> visitor;
-  result->u.result_u64 = 0;
-  result->type = UPS_TYPE_UINT64;
-
-  switch (db->config().key_type) {
-    case UPS_TYPE_UINT8:
-      visitor.reset(new CountIfScanVisitor<uint8_t>(pred));
-      break;
-    case UPS_TYPE_UINT16:
-      visitor.reset(new CountIfScanVisitor<uint16_t>(pred));
-      break;
-    case UPS_TYPE_UINT32:
-      visitor.reset(new CountIfScanVisitor<uint32_t>(pred));
-      break;
-    case UPS_TYPE_UINT64:
-      visitor.reset(new CountIfScanVisitor<uint64_t>(pred));
-      break;
-    case UPS_TYPE_REAL32:
-      visitor.reset(new CountIfScanVisitor<float>(pred));
-      break;
-    case UPS_TYPE_REAL64:
-      visitor.reset(new CountIfScanVisitor<double>(pred));
-      break;
-    case UPS_TYPE_BINARY:
-      visitor.reset(new CountIfScanVisitorBinary(db->config().key_size,
-                              pred));
-      break;
-    default:
-      ups_assert(!"shouldn't be here");
-      return (UPS_INV_PARAMETER);
-  }
-
-  ScopedLock lock(db->get_env()->mutex());
-  ups_status_t st = db->scan((Transaction *)txn, visitor.get(), true);
-  if (st == 0)
-    visitor->assign_result(result);
-  return (st);
+  return (count_if_impl(hdb, txn, KeyPredicate(pred), true, result));
 }
 
 //
@@ -289,6 +372,17 @@ struct AverageScanVisitor : public ScanVisitor {
     : m_sum(0), m_count(0) {
   }
 
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new AverageScanVisitor());
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    m_sum += ((const AverageScanVisitor *)other)->m_sum;
+    m_count += ((const AverageScanVisitor *)other)->m_count;
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   size_t duplicate_count) {
@@ -300,10 +394,8 @@ struct AverageScanVisitor : public ScanVisitor {
 
   // Operates on an array of keys
   virtual void operator()(const void *key_array, size_t key_count) {
-    const PodType *p = (const PodType *)key_array;
-    const PodType *end = &p[key_count];
-    for (; p < end; p++)
-      m_sum += *p;
+    m_sum += simd_sum<PodType, ResultType>((const PodType *)key_array,
+                    key_count);
     m_count += key_count;
   }
 
@@ -372,7 +464,8 @@ uqi_average(ups_db_t *hdb, ups_txn_t *txn, uqi_result_t *result)
       return (UPS_INV_PARAMETER);
   }
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
   ups_status_t st = db->scan((Transaction *)txn, visitor.get(), false);
   if (st == 0)
     visitor->assign_result(result);
@@ -382,18 +475,29 @@ uqi_average(ups_db_t *hdb, ups_txn_t *txn, uqi_result_t *result)
 //
 // A ScanVisitor for uqi_average_if
 //
-template<typename PodType, typename ResultType>
+template<typename PodType, typename ResultType, typename Predicate>
 struct AverageIfScanVisitor : public ScanVisitor {
-  AverageIfScanVisitor(uqi_bool_predicate_t *pred)
+  AverageIfScanVisitor(Predicate pred)
     : m_sum(0), m_count(0), m_pred(pred) {
   }
 
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new AverageIfScanVisitor(m_pred));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    m_sum += ((const AverageIfScanVisitor *)other)->m_sum;
+    m_count += ((const AverageIfScanVisitor *)other)->m_count;
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   size_t duplicate_count) {
     ups_assert(key_size == sizeof(PodType));
 
-    if (m_pred->predicate_func(key_data, key_size, m_pred->context)) {
+    if (m_pred(key_data, key_size)) {
       m_sum += *(const PodType *)key_data * duplicate_count;
       m_count++;
     }
@@ -401,14 +505,11 @@ struct AverageIfScanVisitor : public ScanVisitor {
 
   // Operates on an array of keys
   virtual void operator()(const void *key_array, size_t key_count) {
-    const PodType *p = (const PodType *)key_array;
-    const PodType *end = &p[key_count];
-    for (; p < end; p++) {
-      if (m_pred->predicate_func(p, sizeof(PodType), m_pred->context)) {
-        m_sum += *p;
-        m_count++;
-      }
-    }
+    uint8_t *selected = select_keys(m_pred, &m_selected, key_array,
+                    key_count, sizeof(PodType));
+    m_sum += sum_selected<PodType, ResultType>((const PodType *)key_array,
+                    key_count, selected);
+    m_count += count_selected(selected, key_count);
   }
 
   // Assigns the result to |result|
@@ -424,26 +525,18 @@ struct AverageIfScanVisitor : public ScanVisitor {
   uint64_t m_count;
 
   // The user's predicate function
-  uqi_bool_predicate_t *m_pred;
+  Predicate m_pred;
+
+  // Stores the predicate's result for each key
+  ByteArray m_selected;
 };
 
-ups_status_t UPS_CALLCONV
-uqi_average_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
+// Implementation of uqi_average_if and uqi_average_if_batch
+template<typename Predicate>
+static ups_status_t
+average_if_impl(ups_db_t *hdb, ups_txn_t *txn, Predicate pred,
                 uqi_result_t *result)
 {
-  if (!hdb) {
-    ups_trace(("parameter 'db' must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-  if (!pred) {
-    ups_trace(("parameter 'pred' must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-  if (!result) {
-    ups_trace(("parameter 'result' must not be NULL"));
-    return (UPS_INV_PARAMETER);
-  }
-
   // Remote databases are not yet supported
   LocalDatabase *db = dynamic_cast<LocalDatabase *>((Database *)hdb);
   if (!db) {
@@ -457,40 +550,87 @@ uqi_average_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
   switch (db->config().key_type) {
     case UPS_TYPE_UINT8:
       result->type = UPS_TYPE_UINT64;
-      visitor.reset(new AverageIfScanVisitor<uint8_t, uint64_t>(pred));
+      visitor.reset(new AverageIfScanVisitor<uint8_t, uint64_t,
+                              Predicate>(pred));
       break;
     case UPS_TYPE_UINT16:
       result->type = UPS_TYPE_UINT64;
-      visitor.reset(new AverageIfScanVisitor<uint16_t, uint64_t>(pred));
+      visitor.reset(new AverageIfScanVisitor<uint16_t, uint64_t,
+                              Predicate>(pred));
       break;
     case UPS_TYPE_UINT32:
       result->type = UPS_TYPE_UINT64;
-      visitor.reset(new AverageIfScanVisitor<uint32_t, uint64_t>(pred));
+      visitor.reset(new AverageIfScanVisitor<uint32_t, uint64_t,
+                              Predicate>(pred));
       break;
     case UPS_TYPE_UINT64:
       result->type = UPS_TYPE_UINT64;
-      visitor.reset(new AverageIfScanVisitor<uint64_t, uint64_t>(pred));
+      visitor.reset(new AverageIfScanVisitor<uint64_t, uint64_t,
+                              Predicate>(pred));
       break;
     case UPS_TYPE_REAL32:
       result->type = UPS_TYPE_REAL64;
-      visitor.reset(new AverageIfScanVisitor<float, double>(pred));
+      visitor.reset(new AverageIfScanVisitor<float, double,
+                              Predicate>(pred));
       break;
     case UPS_TYPE_REAL64:
       result->type = UPS_TYPE_REAL64;
-      visitor.reset(new AverageIfScanVisitor<double, double>(pred));
+      visitor.reset(new AverageIfScanVisitor<double, double,
+                              Predicate>(pred));
       break;
     default:
       ups_trace(("uqi_avg* can only be applied to numerical data"));
       return (UPS_INV_PARAMETER);
   }
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
   ups_status_t st = db->scan((Transaction *)txn, visitor.get(), false);
   if (st == 0)
     visitor->assign_result(result);
   return (st);
 }
 
+ups_status_t UPS_CALLCONV
+uqi_average_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
+                uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!pred) {
+    ups_trace(("parameter 'pred' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  return (average_if_impl(hdb, txn, KeyPredicate(pred), result));
+}
+
+ups_status_t UPS_CALLCONV
+uqi_average_if_batch(ups_db_t *hdb, ups_txn_t *txn,
+                uqi_batch_predicate_t *pred, uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!pred) {
+    ups_trace(("parameter 'pred' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  return (average_if_impl(hdb, txn, BatchPredicate(pred), result));
+}
+
 //
 // A ScanVisitor for uqi_sum
 //
@@ -500,6 +640,16 @@ struct SumScanVisitor : public ScanVisitor {
     : m_sum(0) {
   }
 
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new SumScanVisitor());
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    m_sum += ((const SumScanVisitor *)other)->m_sum;
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   size_t duplicate_count) {
@@ -509,27 +659,8 @@ struct SumScanVisitor : public ScanVisitor {
 
   // Operates on an array of keys
   virtual void operator()(const void *key_array, size_t key_count) {
-    const PodType *p = (const PodType *)key_array;
-    const PodType *end = &p[key_count];
-    const int kMax = 8;
-    ResultType sums[kMax] = {0};
-    for (; p + kMax < end; p += kMax) {
-#if defined __GNUC__
-      __builtin_prefetch(((char *)p) + kMax * sizeof(PodType));
-#endif
-      sums[0] += p[0];
-      sums[1] += p[1];
-      sums[2] += p[2];
-      sums[3] += p[3];
-      sums[4] += p[4];
-      sums[5] += p[5];
-      sums[6] += p[6];
-      sums[7] += p[7];
-    }
-    for (; p < end; p++)
-      m_sum += *p;
-    for (int i = 0; i < kMax; i++)
-      m_sum += sums[i];
+    m_sum += simd_sum<PodType, ResultType>((const PodType *)key_array,
+                    key_count);
   }
 
   // Assigns the result to |result|
@@ -593,7 +724,8 @@ uqi_sum(ups_db_t *hdb, ups_txn_t *txn, uqi_result_t *result)
       return (UPS_INV_PARAMETER);
   }
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
   ups_status_t st = db->scan((Transaction *)txn, visitor.get(), false);
   if (st == 0)
     visitor->assign_result(result);
@@ -603,29 +735,37 @@ uqi_sum(ups_db_t *hdb, ups_txn_t *txn, uqi_result_t *result)
 //
 // A ScanVisitor for uqi_sum_if
 //
-template<typename PodType, typename ResultType>
+template<typename PodType, typename ResultType, typename Predicate>
 struct SumIfScanVisitor : public ScanVisitor {
-  SumIfScanVisitor(uqi_bool_predicate_t *pred)
+  SumIfScanVisitor(Predicate pred)
     : m_sum(0), m_pred(pred) {
   }
 
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new SumIfScanVisitor(m_pred));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    m_sum += ((const SumIfScanVisitor *)other)->m_sum;
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   size_t duplicate_count) {
     ups_assert(key_size == sizeof(PodType));
 
-    if (m_pred->predicate_func(key_data, key_size, m_pred->context))
+    if (m_pred(key_data, key_size))
       m_sum += *(const PodType *)key_data * duplicate_count;
   }
 
   // Operates on an array of keys
   virtual void operator()(const void *key_array, size_t key_count) {
-    const PodType *p = (const PodType *)key_array;
-    const PodType *end = &p[key_count];
-    for (; p < end; p++) {
-      if (m_pred->predicate_func(p, sizeof(PodType), m_pred->context))
-        m_sum += *p;
-    }
+    uint8_t *selected = select_keys(m_pred, &m_selected, key_array,
+                    key_count, sizeof(PodType));
+    m_sum += sum_selected<PodType, ResultType>((const PodType *)key_array,
+                    key_count, selected);
   }
 
   // Assigns the result to |result|
@@ -637,9 +777,66 @@ struct SumIfScanVisitor : public ScanVisitor {
   ResultType m_sum;
 
   // The user's predicate function
-  uqi_bool_predicate_t *m_pred;
+  Predicate m_pred;
+
+  // Stores the predicate's result for each key
+  ByteArray m_selected;
 };
 
+// Implementation of uqi_sum_if and uqi_sum_if_batch
+template<typename Predicate>
+static ups_status_t
+sum_if_impl(ups_db_t *hdb, ups_txn_t *txn, Predicate pred,
+                uqi_result_t *result)
+{
+  // Remote databases are not yet supported
+  LocalDatabase *db = dynamic_cast<LocalDatabase *>((Database *)hdb);
+  if (!db) {
+    ups_trace(("uqi_* functions are not yet supported for remote databases"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  std::auto_ptr<ScanVisitor> visitor;
+  result->u.result_u64 = 0;
+
+  switch (db->config().key_type) {
+    case UPS_TYPE_UINT8:
+      result->type = UPS_TYPE_UINT64;
+      visitor.reset(new SumIfScanVisitor<uint8_t, uint64_t, Predicate>(pred));
+      break;
+    case UPS_TYPE_UINT16:
+      result->type = UPS_TYPE_UINT64;
+      visitor.reset(new SumIfScanVisitor<uint16_t, uint64_t, Predicate>(pred));
+      break;
+    case UPS_TYPE_UINT32:
+      result->type = UPS_TYPE_UINT64;
+      visitor.reset(new SumIfScanVisitor<uint32_t, uint64_t, Predicate>(pred));
+      break;
+    case UPS_TYPE_UINT64:
+      result->type = UPS_TYPE_UINT64;
+      visitor.reset(new SumIfScanVisitor<uint64_t, uint64_t, Predicate>(pred));
+      break;
+    case UPS_TYPE_REAL32:
+      result->type = UPS_TYPE_REAL64;
+      visitor.reset(new SumIfScanVisitor<float, double, Predicate>(pred));
+      break;
+    case UPS_TYPE_REAL64:
+      result->type = UPS_TYPE_REAL64;
+      visitor.reset(new SumIfScanVisitor<double, double, Predicate>(pred));
+      break;
+    default:
+      ups_trace(("uqi_sum* can only be applied to numerical data"));
+      return (UPS_INV_PARAMETER);
+  }
+
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
+  ups_status_t st = db->scan((Transaction *)txn, visitor.get(), false);
+  if (st == 0)
+    visitor->assign_result(result);
+  return (st);
+}
+
 ups_status_t UPS_CALLCONV
 uqi_sum_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
                 uqi_result_t *result)
@@ -657,6 +854,100 @@ uqi_sum_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
     return (UPS_INV_PARAMETER);
   }
 
+  return (sum_if_impl(hdb, txn, KeyPredicate(pred), result));
+}
+
+ups_status_t UPS_CALLCONV
+uqi_sum_if_batch(ups_db_t *hdb, ups_txn_t *txn, uqi_batch_predicate_t *pred,
+                uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!pred) {
+    ups_trace(("parameter 'pred' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  return (sum_if_impl(hdb, txn, BatchPredicate(pred), result));
+}
+
+//
+// A ScanVisitor for uqi_min and uqi_max
+//
+template<typename PodType, typename ResultType, bool IsMax>
+struct MinMaxScanVisitor : public ScanVisitor {
+  MinMaxScanVisitor()
+    : m_value(0), m_is_set(false) {
+  }
+
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new MinMaxScanVisitor());
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    const MinMaxScanVisitor *mmsv = (const MinMaxScanVisitor *)other;
+    if (mmsv->m_is_set)
+      update(mmsv->m_value);
+  }
+
+  // Operates on a single key
+  virtual void operator()(const void *key_data, uint16_t key_size, 
+                  size_t duplicate_count) {
+    ups_assert(key_size == sizeof(PodType));
+    update(*(const PodType *)key_data);
+  }
+
+  // Operates on an array of keys
+  virtual void operator()(const void *key_array, size_t key_count) {
+    if (key_count == 0)
+      return;
+    const PodType *p = (const PodType *)key_array;
+    update(IsMax ? simd_max(p, key_count) : simd_min(p, key_count));
+  }
+
+  // Assigns the result to |result|
+  virtual void assign_result(uqi_result_t *result) {
+    ResultType res = m_value;
+    memcpy(&result->u.result_u64, &res, sizeof(uint64_t));
+  }
+
+  // Stores |value| if it is the new minimum (or maximum)
+  void update(PodType value) {
+    if (!m_is_set || (IsMax ? value > m_value : value < m_value)) {
+      m_value = value;
+      m_is_set = true;
+    }
+  }
+
+  // The current minimum (or maximum)
+  PodType m_value;
+
+  // True if |m_value| was assigned
+  bool m_is_set;
+};
+
+// Implementation of uqi_min and uqi_max
+template<bool IsMax>
+static ups_status_t
+min_max_impl(ups_db_t *hdb, ups_txn_t *txn, uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
   // Remote databases are not yet supported
   LocalDatabase *db = dynamic_cast<LocalDatabase *>((Database *)hdb);
   if (!db) {
@@ -670,34 +961,173 @@ uqi_sum_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
   switch (db->config().key_type) {
     case UPS_TYPE_UINT8:
       result->type = UPS_TYPE_UINT64;
-      visitor.reset(new SumIfScanVisitor<uint8_t, uint64_t>(pred));
+      visitor.reset(new MinMaxScanVisitor<uint8_t, uint64_t, IsMax>());
       break;
     case UPS_TYPE_UINT16:
       result->type = UPS_TYPE_UINT64;
-      visitor.reset(new SumIfScanVisitor<uint16_t, uint64_t>(pred));
+      visitor.reset(new MinMaxScanVisitor<uint16_t, uint64_t, IsMax>());
       break;
     case UPS_TYPE_UINT32:
       result->type = UPS_TYPE_UINT64;
-      visitor.reset(new SumIfScanVisitor<uint32_t, uint64_t>(pred));
+      visitor.reset(new MinMaxScanVisitor<uint32_t, uint64_t, IsMax>());
       break;
     case UPS_TYPE_UINT64:
       result->type = UPS_TYPE_UINT64;
-      visitor.reset(new SumIfScanVisitor<uint64_t, uint64_t>(pred));
+      visitor.reset(new MinMaxScanVisitor<uint64_t, uint64_t, IsMax>());
       break;
     case UPS_TYPE_REAL32:
       result->type = UPS_TYPE_REAL64;
-      visitor.reset(new SumIfScanVisitor<float, double>(pred));
+      visitor.reset(new MinMaxScanVisitor<float, double, IsMax>());
       break;
     case UPS_TYPE_REAL64:
       result->type = UPS_TYPE_REAL64;
-      visitor.reset(new SumIfScanVisitor<double, double>(pred));
+      visitor.reset(new MinMaxScanVisitor<double, double, IsMax>());
       break;
     default:
-      ups_trace(("uqi_sum* can only be applied to numerical data"));
+      ups_trace(("uqi_min/uqi_max can only be applied to numerical data"));
+      return (UPS_INV_PARAMETER);
+  }
+
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
+  ups_status_t st = db->scan((Transaction *)txn, visitor.get(), true);
+  if (st == 0)
+    visitor->assign_result(result);
+  return (st);
+}
+
+ups_status_t UPS_CALLCONV
+uqi_min(ups_db_t *hdb, ups_txn_t *txn, uqi_result_t *result)
+{
+  return (min_max_impl<false>(hdb, txn, result));
+}
+
+ups_status_t UPS_CALLCONV
+uqi_max(ups_db_t *hdb, ups_txn_t *txn, uqi_result_t *result)
+{
+  return (min_max_impl<true>(hdb, txn, result));
+}
+
+//
+// A ScanVisitor for uqi_count_range
+//
+template<typename PodType>
+struct CountRangeScanVisitor : public ScanVisitor {
+  CountRangeScanVisitor(const void *low, const void *high)
+    : m_count(0), m_low(*(const PodType *)low),
+      m_high(*(const PodType *)high) {
+  }
+
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new CountRangeScanVisitor(&m_low, &m_high));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    m_count += ((const CountRangeScanVisitor *)other)->m_count;
+  }
+
+  // Operates on a single key
+  virtual void operator()(const void *key_data, uint16_t key_size, 
+                  size_t duplicate_count) {
+    ups_assert(key_size == sizeof(PodType));
+    PodType key = *(const PodType *)key_data;
+    if (key >= m_low && key <= m_high)
+      m_count += duplicate_count;
+  }
+
+  // Operates on an array of keys
+  virtual void operator()(const void *key_array, size_t key_count) {
+    m_count += simd_count_range((const PodType *)key_array, key_count,
+                    m_low, m_high);
+  }
+
+  // Assigns the result to |result|
+  virtual void assign_result(uqi_result_t *result) {
+    memcpy(&result->u.result_u64, &m_count, sizeof(uint64_t));
+  }
+
+  // The counter
+  uint64_t m_count;
+
+  // The lower bound of the range
+  PodType m_low;
+
+  // The upper bound of the range
+  PodType m_high;
+};
+
+ups_status_t UPS_CALLCONV
+uqi_count_range(ups_db_t *hdb, ups_txn_t *txn, ups_key_t *low,
+                ups_key_t *high, uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!low || !low->data) {
+    ups_trace(("parameter 'low' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!high || !high->data) {
+    ups_trace(("parameter 'high' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  // Remote databases are not yet supported
+  LocalDatabase *db = dynamic_cast<LocalDatabase *>((Database *)hdb);
+  if (!db) {
+    ups_trace(("uqi_* functions are not yet supported for remote databases"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  std::auto_ptr<ScanVisitor> visitor;
+  result->u.result_u64 = 0;
+  result->type = UPS_TYPE_UINT64;
+
+  if (low->size != db->config().key_size
+      || high->size != db->config().key_size) {
+    ups_trace(("size of 'low' and 'high' must match the key size"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  switch (db->config().key_type) {
+    case UPS_TYPE_UINT8:
+      visitor.reset(new CountRangeScanVisitor<uint8_t>(low->data,
+                              high->data));
+      break;
+    case UPS_TYPE_UINT16:
+      visitor.reset(new CountRangeScanVisitor<uint16_t>(low->data,
+                              high->data));
+      break;
+    case UPS_TYPE_UINT32:
+      visitor.reset(new CountRangeScanVisitor<uint32_t>(low->data,
+                              high->data));
+      break;
+    case UPS_TYPE_UINT64:
+      visitor.reset(new CountRangeScanVisitor<uint64_t>(low->data,
+                              high->data));
+      break;
+    case UPS_TYPE_REAL32:
+      visitor.reset(new CountRangeScanVisitor<float>(low->data,
+                              high->data));
+      break;
+    case UPS_TYPE_REAL64:
+      visitor.reset(new CountRangeScanVisitor<double>(low->data,
+                              high->data));
+      break;
+    default:
+      ups_trace(("uqi_count_range can only be applied to numerical data"));
       return (UPS_INV_PARAMETER);
   }
 
-  ScopedLock lock(db->get_env()->mutex());
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
   ups_status_t st = db->scan((Transaction *)txn, visitor.get(), false);
   if (st == 0)
     visitor->assign_result(result);
@@ -0,0 +1,1030 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * UQI functions which aggregate the records (and not the keys)
+ */
+
+#include "0root/root.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "ups/upscaledb_uqi.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "2simd/aggregate.h"
+#include "3btree/btree_index.h"
+#include "3btree/btree_visitor.h"
+#include "4db/db.h"
+#include "4db/db_local.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+using namespace upscaledb;
+
+// Returns the LocalDatabase of |hdb|, or NULL if it is a remote database
+static LocalDatabase *
+get_local_db(ups_db_t *hdb)
+{
+  LocalDatabase *db = dynamic_cast<LocalDatabase *>((Database *)hdb);
+  if (!db)
+    ups_trace(("uqi_* functions are not yet supported for remote databases"));
+  return (db);
+}
+
+// Returns the size of a numeric type, or 0 if |type| is not numeric
+static size_t
+get_type_size(int type)
+{
+  switch (type) {
+    case UPS_TYPE_UINT8:
+      return (1);
+    case UPS_TYPE_UINT16:
+      return (2);
+    case UPS_TYPE_UINT32:
+    case UPS_TYPE_REAL32:
+      return (4);
+    case UPS_TYPE_UINT64:
+    case UPS_TYPE_REAL64:
+      return (8);
+    default:
+      return (0);
+  }
+}
+
+// Verifies that |field| describes a numeric value in the fixed-length
+// records of |db|
+static bool
+check_field(LocalDatabase *db, const uqi_record_field_t *field)
+{
+  size_t record_size = db->config().record_size;
+  if (record_size == UPS_RECORD_SIZE_UNLIMITED) {
+    ups_trace(("uqi_record_* functions require a fixed record size"));
+    return (false);
+  }
+  size_t type_size = get_type_size(field->type);
+  if (type_size == 0) {
+    ups_trace(("uqi_record_* functions can only be applied to numerical "
+                "data"));
+    return (false);
+  }
+  if (field->offset + type_size > record_size) {
+    ups_trace(("field exceeds the record size"));
+    return (false);
+  }
+  return (true);
+}
+
+// Reads a (possibly unaligned) value from a record
+template<typename PodType>
+static inline PodType
+read_field(const void *record_data, uint32_t offset)
+{
+  PodType value;
+  memcpy(&value, (const uint8_t *)record_data + offset, sizeof(PodType));
+  return (value);
+}
+
+//
+// Base class for visitors which operate on the records; the keys without
+// records are ignored
+//
+struct RecordScanVisitor : public ScanVisitor {
+  // Requests the records from the scan
+  virtual bool requires_records() const {
+    return (true);
+  }
+
+  // Not used
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  size_t duplicate_count) {
+  }
+
+  // Not used
+  virtual void operator()(const void *key_array, size_t key_count) {
+  }
+};
+
+//
+// A ScanVisitor for uqi_record_sum and uqi_record_average
+//
+template<typename PodType, typename ResultType, bool IsAverage>
+struct RecordSumScanVisitor : public RecordScanVisitor {
+  RecordSumScanVisitor(uint32_t offset, uint32_t record_size)
+    : m_offset(offset), m_record_size(record_size), m_sum(0), m_count(0) {
+  }
+
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new RecordSumScanVisitor(m_offset, m_record_size));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    const RecordSumScanVisitor *rssv = (const RecordSumScanVisitor *)other;
+    m_sum += rssv->m_sum;
+    m_count += rssv->m_count;
+  }
+
+  // Operates on a single record
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  const void *record_data, uint32_t record_size) {
+    m_sum += read_field<PodType>(record_data, m_offset);
+    m_count++;
+  }
+
+  // Operates on an array of records
+  virtual void operator()(const void *key_array, const void *record_array,
+                  size_t count) {
+    // records which consist of nothing but the value are summed up with SIMD
+    if (m_offset == 0 && m_record_size == sizeof(PodType)) {
+      m_sum += simd_sum<PodType, ResultType>((const PodType *)record_array,
+                      count);
+    }
+    else {
+      const uint8_t *p = (const uint8_t *)record_array;
+      for (size_t i = 0; i < count; i++, p += m_record_size)
+        m_sum += read_field<PodType>(p, m_offset);
+    }
+    m_count += count;
+  }
+
+  // Assigns the result to |result|
+  virtual void assign_result(uqi_result_t *result) {
+    ResultType res = m_sum;
+    if (IsAverage)
+      res = m_count > 0 ? (ResultType)(m_sum / m_count) : 0;
+    memcpy(&result->u.result_u64, &res, sizeof(uint64_t));
+  }
+
+  // The offset of the value in the record
+  uint32_t m_offset;
+
+  // The fixed size of the records
+  uint32_t m_record_size;
+
+  // The sum of all values
+  ResultType m_sum;
+
+  // The number of records
+  uint64_t m_count;
+};
+
+//
+// A ScanVisitor for uqi_record_min and uqi_record_max
+//
+template<typename PodType, typename ResultType, bool IsMax>
+struct RecordMinMaxScanVisitor : public RecordScanVisitor {
+  RecordMinMaxScanVisitor(uint32_t offset, uint32_t record_size)
+    : m_offset(offset), m_record_size(record_size), m_value(0),
+      m_is_set(false) {
+  }
+
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new RecordMinMaxScanVisitor(m_offset, m_record_size));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    const RecordMinMaxScanVisitor *rmmsv
+            = (const RecordMinMaxScanVisitor *)other;
+    if (rmmsv->m_is_set)
+      update(rmmsv->m_value);
+  }
+
+  // Operates on a single record
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  const void *record_data, uint32_t record_size) {
+    update(read_field<PodType>(record_data, m_offset));
+  }
+
+  // Operates on an array of records
+  virtual void operator()(const void *key_array, const void *record_array,
+                  size_t count) {
+    if (count == 0)
+      return;
+    if (m_offset == 0 && m_record_size == sizeof(PodType)) {
+      const PodType *p = (const PodType *)record_array;
+      update(IsMax ? simd_max(p, count) : simd_min(p, count));
+    }
+    else {
+      const uint8_t *p = (const uint8_t *)record_array;
+      for (size_t i = 0; i < count; i++, p += m_record_size)
+        update(read_field<PodType>(p, m_offset));
+    }
+  }
+
+  // Assigns the result to |result|
+  virtual void assign_result(uqi_result_t *result) {
+    ResultType res = m_value;
+    memcpy(&result->u.result_u64, &res, sizeof(uint64_t));
+  }
+
+  // Stores |value| if it is the new minimum (or maximum)
+  void update(PodType value) {
+    if (!m_is_set || (IsMax ? value > m_value : value < m_value)) {
+      m_value = value;
+      m_is_set = true;
+    }
+  }
+
+  // The offset of the value in the record
+  uint32_t m_offset;
+
+  // The fixed size of the records
+  uint32_t m_record_size;
+
+  // The current minimum (or maximum)
+  PodType m_value;
+
+  // True if |m_value| was assigned
+  bool m_is_set;
+};
+
+// Creates a visitor for the aggregate functions on records
+template<template<typename, typename, bool> class Visitor, bool Flag>
+static ScanVisitor *
+create_field_visitor(const uqi_record_field_t *field, uint32_t record_size,
+                uqi_result_t *result)
+{
+  switch (field->type) {
+    case UPS_TYPE_UINT8:
+      result->type = UPS_TYPE_UINT64;
+      return (new Visitor<uint8_t, uint64_t, Flag>(field->offset,
+                              record_size));
+    case UPS_TYPE_UINT16:
+      result->type = UPS_TYPE_UINT64;
+      return (new Visitor<uint16_t, uint64_t, Flag>(field->offset,
+                              record_size));
+    case UPS_TYPE_UINT32:
+      result->type = UPS_TYPE_UINT64;
+      return (new Visitor<uint32_t, uint64_t, Flag>(field->offset,
+                              record_size));
+    case UPS_TYPE_UINT64:
+      result->type = UPS_TYPE_UINT64;
+      return (new Visitor<uint64_t, uint64_t, Flag>(field->offset,
+                              record_size));
+    case UPS_TYPE_REAL32:
+      result->type = UPS_TYPE_REAL64;
+      return (new Visitor<float, double, Flag>(field->offset, record_size));
+    case UPS_TYPE_REAL64:
+      result->type = UPS_TYPE_REAL64;
+      return (new Visitor<double, double, Flag>(field->offset, record_size));
+    default:
+      ups_assert(!"shouldn't be here");
+      return (0);
+  }
+}
+
+// Implementation of uqi_record_sum, uqi_record_average, uqi_record_min
+// and uqi_record_max
+template<template<typename, typename, bool> class Visitor, bool Flag>
+static ups_status_t
+record_field_impl(ups_db_t *hdb, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!field) {
+    ups_trace(("parameter 'field' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  LocalDatabase *db = get_local_db(hdb);
+  if (!db)
+    return (UPS_INV_PARAMETER);
+  if (!check_field(db, field))
+    return (UPS_INV_PARAMETER);
+
+  result->u.result_u64 = 0;
+  std::auto_ptr<ScanVisitor> visitor(create_field_visitor<Visitor, Flag>(
+                          field, (uint32_t)db->config().record_size, result));
+
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
+  ups_status_t st = db->scan((Transaction *)txn, visitor.get(), false);
+  if (st == 0)
+    visitor->assign_result(result);
+  return (st);
+}
+
+ups_status_t UPS_CALLCONV
+uqi_record_sum(ups_db_t *hdb, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result)
+{
+  return (record_field_impl<RecordSumScanVisitor, false>(hdb, txn, field,
+                          result));
+}
+
+ups_status_t UPS_CALLCONV
+uqi_record_average(ups_db_t *hdb, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result)
+{
+  return (record_field_impl<RecordSumScanVisitor, true>(hdb, txn, field,
+                          result));
+}
+
+ups_status_t UPS_CALLCONV
+uqi_record_min(ups_db_t *hdb, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result)
+{
+  return (record_field_impl<RecordMinMaxScanVisitor, false>(hdb, txn, field,
+                          result));
+}
+
+ups_status_t UPS_CALLCONV
+uqi_record_max(ups_db_t *hdb, ups_txn_t *txn, uqi_record_field_t *field,
+                uqi_result_t *result)
+{
+  return (record_field_impl<RecordMinMaxScanVisitor, true>(hdb, txn, field,
+                          result));
+}
+
+//
+// A ScanVisitor for uqi_record_count_if
+//
+struct RecordCountIfScanVisitor : public RecordScanVisitor {
+  RecordCountIfScanVisitor(uqi_bool_predicate_t *pred, uint32_t record_size)
+    : m_pred(pred), m_record_size(record_size), m_count(0) {
+  }
+
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new RecordCountIfScanVisitor(m_pred, m_record_size));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    m_count += ((const RecordCountIfScanVisitor *)other)->m_count;
+  }
+
+  // Operates on a single record
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  const void *record_data, uint32_t record_size) {
+    if (m_pred->predicate_func(record_data, (uint16_t)record_size,
+                            m_pred->context))
+      m_count++;
+  }
+
+  // Operates on an array of records
+  virtual void operator()(const void *key_array, const void *record_array,
+                  size_t count) {
+    const uint8_t *p = (const uint8_t *)record_array;
+    for (size_t i = 0; i < count; i++, p += m_record_size) {
+      if (m_pred->predicate_func(p, (uint16_t)m_record_size, m_pred->context))
+        m_count++;
+    }
+  }
+
+  // Assigns the result to |result|
+  virtual void assign_result(uqi_result_t *result) {
+    memcpy(&result->u.result_u64, &m_count, sizeof(uint64_t));
+  }
+
+  // The user's predicate
+  uqi_bool_predicate_t *m_pred;
+
+  // The size of the records, if they are passed in an array
+  uint32_t m_record_size;
+
+  // The counter
+  uint64_t m_count;
+};
+
+ups_status_t UPS_CALLCONV
+uqi_record_count_if(ups_db_t *hdb, ups_txn_t *txn, uqi_bool_predicate_t *pred,
+                uqi_result_t *result)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!pred) {
+    ups_trace(("parameter 'pred' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!result) {
+    ups_trace(("parameter 'result' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  LocalDatabase *db = get_local_db(hdb);
+  if (!db)
+    return (UPS_INV_PARAMETER);
+
+  result->type = UPS_TYPE_UINT64;
+  result->u.result_u64 = 0;
+  RecordCountIfScanVisitor visitor(pred, (uint32_t)db->config().record_size);
+
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
+  ups_status_t st = db->scan((Transaction *)txn, &visitor, false);
+  if (st == 0)
+    visitor.assign_result(result);
+  return (st);
+}
+
+//
+// A ScanVisitor for uqi_top_keys. The keys are collected in a bounded
+// min-heap; its top element is the smallest of the k largest keys
+//
+template<typename PodType>
+struct TopKeysScanVisitor : public ScanVisitor {
+  TopKeysScanVisitor(size_t k)
+    : m_k(k), m_last(0), m_has_last(false) {
+  }
+
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new TopKeysScanVisitor(m_k));
+  }
+
+  // Adds the result of another visitor
+  virtual void combine(const ScanVisitor *other) {
+    const TopKeysScanVisitor *tksv = (const TopKeysScanVisitor *)other;
+    for (size_t i = 0; i < tksv->m_heap.size(); i++)
+      push(tksv->m_heap[i]);
+  }
+
+  // Operates on a single key
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  size_t duplicate_count) {
+    ups_assert(key_size == sizeof(PodType));
+    PodType key;
+    memcpy(&key, key_data, sizeof(PodType));
+    // the keys are sorted; skip the duplicates
+    if (m_has_last && key == m_last)
+      return;
+    m_last = key;
+    m_has_last = true;
+    push(key);
+  }
+
+  // Operates on an array of keys
+  virtual void operator()(const void *key_array, size_t key_count) {
+    const PodType *p = (const PodType *)key_array;
+    // the array is sorted; only the last k keys are relevant
+    size_t start = key_count > m_k ? key_count - m_k : 0;
+    for (size_t i = start; i < key_count; i++)
+      push(p[i]);
+  }
+
+  // Not required; use copy_keys() instead
+  virtual void assign_result(uqi_result_t *result) {
+  }
+
+  // Copies the keys to |keys|, starting with the largest one
+  uint32_t copy_keys(void *keys) {
+    std::sort_heap(m_heap.begin(), m_heap.end(), std::greater<PodType>());
+    memcpy(keys, m_heap.empty() ? 0 : &m_heap[0],
+                    m_heap.size() * sizeof(PodType));
+    return ((uint32_t)m_heap.size());
+  }
+
+  // Adds |key| to the heap if it's one of the k largest keys
+  void push(PodType key) {
+    if (m_heap.size() == m_k) {
+      if (!(key > m_heap.front()))
+        return;
+      std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<PodType>());
+      m_heap.pop_back();
+    }
+    m_heap.push_back(key);
+    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<PodType>());
+  }
+
+  // The number of keys which are returned
+  size_t m_k;
+
+  // The k largest keys
+  std::vector<PodType> m_heap;
+
+  // The previous key, to skip duplicates
+  PodType m_last;
+
+  // True if |m_last| was assigned
+  bool m_has_last;
+};
+
+// Runs a TopKeysScanVisitor
+template<typename PodType>
+static ups_status_t
+top_keys_impl(LocalDatabase *db, ups_txn_t *txn, uint32_t k, void *keys,
+                uint32_t *count)
+{
+  TopKeysScanVisitor<PodType> visitor(k);
+  ups_status_t st = db->scan((Transaction *)txn, &visitor, false);
+  if (st == 0)
+    *count = visitor.copy_keys(keys);
+  return (st);
+}
+
+ups_status_t UPS_CALLCONV
+uqi_top_keys(ups_db_t *hdb, ups_txn_t *txn, uint32_t k, void *keys,
+                uint32_t *count)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!keys) {
+    ups_trace(("parameter 'keys' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!count) {
+    ups_trace(("parameter 'count' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  LocalDatabase *db = get_local_db(hdb);
+  if (!db)
+    return (UPS_INV_PARAMETER);
+
+  *count = 0;
+  if (get_type_size(db->config().key_type) == 0) {
+    ups_trace(("uqi_top_keys can only be applied to numerical data"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (k == 0)
+    return (0);
+
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
+
+  switch (db->config().key_type) {
+    case UPS_TYPE_UINT8:
+      return (top_keys_impl<uint8_t>(db, txn, k, keys, count));
+    case UPS_TYPE_UINT16:
+      return (top_keys_impl<uint16_t>(db, txn, k, keys, count));
+    case UPS_TYPE_UINT32:
+      return (top_keys_impl<uint32_t>(db, txn, k, keys, count));
+    case UPS_TYPE_UINT64:
+      return (top_keys_impl<uint64_t>(db, txn, k, keys, count));
+    case UPS_TYPE_REAL32:
+      return (top_keys_impl<float>(db, txn, k, keys, count));
+    case UPS_TYPE_REAL64:
+    default:
+      return (top_keys_impl<double>(db, txn, k, keys, count));
+  }
+}
+
+//
+// A candidate of uqi_top_records
+//
+template<typename PodType>
+struct TopRecordEntry {
+  // The value of the record field
+  PodType value;
+
+  // The position in the scan; orders the duplicates of a key
+  uint64_t sequence;
+
+  // The key and the record
+  std::vector<uint8_t> key;
+  std::vector<uint8_t> record;
+};
+
+//
+// Returns true if |lhs| is better than |rhs|: it has the larger value,
+// or the smaller key, or it was visited earlier. Used as the comparator of
+// the heap, therefore the top of the heap is the worst candidate
+//
+template<typename PodType>
+struct TopRecordCompare {
+  TopRecordCompare(BtreeIndex *btree)
+    : m_btree(btree) {
+  }
+
+  bool operator()(const TopRecordEntry<PodType> &lhs,
+                  const TopRecordEntry<PodType> &rhs) const {
+    return (is_better(lhs.value, &lhs.key[0], lhs.sequence,
+                            rhs.value, &rhs.key[0], rhs.sequence));
+  }
+
+  bool is_better(PodType lvalue, const uint8_t *lkey, uint64_t lsequence,
+                  PodType rvalue, const uint8_t *rkey, uint64_t rsequence)
+                  const {
+    if (lvalue != rvalue)
+      return (lvalue > rvalue);
+    ups_key_t k1 = ups_make_key((void *)lkey, m_btree->key_size());
+    ups_key_t k2 = ups_make_key((void *)rkey, m_btree->key_size());
+    int cmp = m_btree->compare_keys(&k1, &k2);
+    if (cmp != 0)
+      return (cmp < 0);
+    return (lsequence < rsequence);
+  }
+
+  BtreeIndex *m_btree;
+};
+
+//
+// A ScanVisitor for uqi_top_records
+//
+template<typename PodType>
+struct TopRecordsScanVisitor : public RecordScanVisitor {
+  typedef TopRecordEntry<PodType> Entry;
+
+  TopRecordsScanVisitor(BtreeIndex *btree, size_t k, uint32_t offset,
+                  uint16_t key_size, uint32_t record_size)
+    : m_btree(btree), m_compare(btree), m_k(k), m_offset(offset),
+      m_key_size(key_size), m_record_size(record_size), m_sequence(0) {
+  }
+
+  // Returns a new visitor for a parallel scan
+  virtual ScanVisitor *clone() const {
+    return (new TopRecordsScanVisitor(m_btree, m_k, m_offset, m_key_size,
+                            m_record_size));
+  }
+
+  // Adds the result of another visitor; its keys are visited after those
+  // of this visitor
+  virtual void combine(const ScanVisitor *other) {
+    const TopRecordsScanVisitor *trsv = (const TopRecordsScanVisitor *)other;
+    for (size_t i = 0; i < trsv->m_heap.size(); i++) {
+      const Entry &e = trsv->m_heap[i];
+      push(e.value, &e.key[0], &e.record[0], m_sequence + e.sequence);
+    }
+    m_sequence += trsv->m_sequence;
+  }
+
+  // Operates on a single record
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  const void *record_data, uint32_t record_size) {
+    ups_assert(key_size == m_key_size);
+    ups_assert(record_size == m_record_size);
+    push(read_field<PodType>(record_data, m_offset),
+                    (const uint8_t *)key_data, (const uint8_t *)record_data,
+                    m_sequence++);
+  }
+
+  // Operates on an array of records
+  virtual void operator()(const void *key_array, const void *record_array,
+                  size_t count) {
+    const uint8_t *k = (const uint8_t *)key_array;
+    const uint8_t *r = (const uint8_t *)record_array;
+    for (size_t i = 0; i < count; i++, k += m_key_size, r += m_record_size)
+      push(read_field<PodType>(r, m_offset), k, r, m_sequence++);
+  }
+
+  // Not required; use copy_results() instead
+  virtual void assign_result(uqi_result_t *result) {
+  }
+
+  // Copies the keys and records to |keys| and |records|, starting with
+  // the best one
+  uint32_t copy_results(void *keys, void *records) {
+    std::sort_heap(m_heap.begin(), m_heap.end(), m_compare);
+    uint8_t *k = (uint8_t *)keys;
+    uint8_t *r = (uint8_t *)records;
+    for (size_t i = 0; i < m_heap.size(); i++) {
+      if (k) {
+        memcpy(k, &m_heap[i].key[0], m_key_size);
+        k += m_key_size;
+      }
+      if (r) {
+        memcpy(r, &m_heap[i].record[0], m_record_size);
+        r += m_record_size;
+      }
+    }
+    return ((uint32_t)m_heap.size());
+  }
+
+  // Adds a candidate to the heap if it's one of the k best ones
+  void push(PodType value, const uint8_t *key, const uint8_t *record,
+                  uint64_t sequence) {
+    if (m_heap.size() == m_k) {
+      const Entry &worst = m_heap.front();
+      if (!m_compare.is_better(value, key, sequence,
+                              worst.value, &worst.key[0], worst.sequence))
+        return;
+      std::pop_heap(m_heap.begin(), m_heap.end(), m_compare);
+      m_heap.pop_back();
+    }
+
+    m_heap.push_back(Entry());
+    Entry &e = m_heap.back();
+    e.value = value;
+    e.sequence = sequence;
+    e.key.assign(key, key + m_key_size);
+    e.record.assign(record, record + m_record_size);
+    std::push_heap(m_heap.begin(), m_heap.end(), m_compare);
+  }
+
+  // The btree, for comparing keys
+  BtreeIndex *m_btree;
+
+  // The heap's comparator
+  TopRecordCompare<PodType> m_compare;
+
+  // The number of results
+  size_t m_k;
+
+  // The offset of the value in the record
+  uint32_t m_offset;
+
+  // The fixed key size
+  uint16_t m_key_size;
+
+  // The fixed record size
+  uint32_t m_record_size;
+
+  // The number of visited records
+  uint64_t m_sequence;
+
+  // The k best candidates
+  std::vector<Entry> m_heap;
+};
+
+// Runs a TopRecordsScanVisitor
+template<typename PodType>
+static ups_status_t
+top_records_impl(LocalDatabase *db, ups_txn_t *txn,
+                const uqi_record_field_t *field, uint32_t k, void *keys,
+                void *records, uint32_t *count)
+{
+  TopRecordsScanVisitor<PodType> visitor(db->btree_index(), k, field->offset,
+                  (uint16_t)db->config().key_size,
+                  (uint32_t)db->config().record_size);
+  ups_status_t st = db->scan((Transaction *)txn, &visitor, false);
+  if (st == 0)
+    *count = visitor.copy_results(keys, records);
+  return (st);
+}
+
+ups_status_t UPS_CALLCONV
+uqi_top_records(ups_db_t *hdb, ups_txn_t *txn, uqi_record_field_t *field,
+                uint32_t k, void *keys, void *records, uint32_t *count)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!field) {
+    ups_trace(("parameter 'field' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!count) {
+    ups_trace(("parameter 'count' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+
+  LocalDatabase *db = get_local_db(hdb);
+  if (!db)
+    return (UPS_INV_PARAMETER);
+
+  *count = 0;
+  if (!check_field(db, field))
+    return (UPS_INV_PARAMETER);
+  if (db->config().key_size == UPS_KEY_SIZE_UNLIMITED) {
+    ups_trace(("uqi_top_records requires a fixed key size"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (k == 0)
+    return (0);
+
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
+
+  switch (field->type) {
+    case UPS_TYPE_UINT8:
+      return (top_records_impl<uint8_t>(db, txn, field, k, keys, records,
+                              count));
+    case UPS_TYPE_UINT16:
+      return (top_records_impl<uint16_t>(db, txn, field, k, keys, records,
+                              count));
+    case UPS_TYPE_UINT32:
+      return (top_records_impl<uint32_t>(db, txn, field, k, keys, records,
+                              count));
+    case UPS_TYPE_UINT64:
+      return (top_records_impl<uint64_t>(db, txn, field, k, keys, records,
+                              count));
+    case UPS_TYPE_REAL32:
+      return (top_records_impl<float>(db, txn, field, k, keys, records,
+                              count));
+    case UPS_TYPE_REAL64:
+    default:
+      return (top_records_impl<double>(db, txn, field, k, keys, records,
+                              count));
+  }
+}
+
+//
+// A ScanVisitor for uqi_record_group_by. The keys arrive in sorted order,
+// therefore a group ends as soon as the key changes. Does not support
+// parallel scans, because the groups would be split at the chunk
+// boundaries
+//
+template<typename PodType, typename ResultType>
+struct GroupByScanVisitor : public RecordScanVisitor {
+  GroupByScanVisitor(int aggregate, int result_type, uint32_t offset,
+                  uint16_t key_size, uint32_t record_size,
+                  uqi_group_func_t func, void *context)
+    : m_aggregate(aggregate), m_result_type(result_type), m_offset(offset),
+      m_key_size(key_size),
+      m_record_size(record_size), m_func(func), m_context(context),
+      m_is_set(false), m_count(0), m_sum(0), m_value(0) {
+  }
+
+  // Operates on a single record
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  const void *record_data, uint32_t record_size) {
+    const uint8_t *key = (const uint8_t *)key_data;
+    if (!m_is_set || key_size != m_key.size()
+          || (key_size > 0 && ::memcmp(key, &m_key[0], key_size) != 0)) {
+      flush();
+      m_key.assign(key, key + key_size);
+      m_is_set = true;
+    }
+
+    m_count++;
+    if (m_aggregate == UQI_AGGREGATE_COUNT)
+      return;
+
+    PodType value = read_field<PodType>(record_data, m_offset);
+    m_sum += value;
+    if (m_count == 1
+          || (m_aggregate == UQI_AGGREGATE_MIN && value < m_value)
+          || (m_aggregate == UQI_AGGREGATE_MAX && value > m_value))
+      m_value = value;
+  }
+
+  // Operates on an array of records; the keys are unique
+  virtual void operator()(const void *key_array, const void *record_array,
+                  size_t count) {
+    const uint8_t *k = (const uint8_t *)key_array;
+    const uint8_t *r = (const uint8_t *)record_array;
+    for (size_t i = 0; i < count; i++, k += m_key_size, r += m_record_size)
+      (*this)(k, m_key_size, r, m_record_size);
+  }
+
+  // Reports the last group
+  virtual void assign_result(uqi_result_t *result) {
+    flush();
+  }
+
+  // Reports the current group to the user's callback
+  void flush() {
+    if (!m_is_set)
+      return;
+
+    uqi_result_t result;
+    result.u.result_u64 = 0;
+    result.type = UPS_TYPE_UINT64;
+    if (m_aggregate == UQI_AGGREGATE_COUNT)
+      result.u.result_u64 = m_count;
+    else {
+      ResultType res;
+      if (m_aggregate == UQI_AGGREGATE_SUM)
+        res = m_sum;
+      else if (m_aggregate == UQI_AGGREGATE_AVERAGE)
+        res = (ResultType)(m_sum / m_count);
+      else
+        res = m_value;
+      memcpy(&result.u.result_u64, &res, sizeof(uint64_t));
+      result.type = m_result_type;
+    }
+
+    m_func(m_key.empty() ? 0 : &m_key[0], (uint16_t)m_key.size(), &result,
+                    m_context);
+
+    m_is_set = false;
+    m_count = 0;
+    m_sum = 0;
+    m_value = 0;
+  }
+
+  // The aggregate function
+  int m_aggregate;
+
+  // The type of the result (if it is not a counter)
+  int m_result_type;
+
+  // The offset of the value in the record
+  uint32_t m_offset;
+
+  // The fixed key size, if the keys are passed in an array
+  uint16_t m_key_size;
+
+  // The fixed record size
+  uint32_t m_record_size;
+
+  // The user's callback and its context
+  uqi_group_func_t m_func;
+  void *m_context;
+
+  // The key of the current group
+  std::vector<uint8_t> m_key;
+
+  // True if a group is active
+  bool m_is_set;
+
+  // The number of records in the current group
+  uint64_t m_count;
+
+  // The sum of the values in the current group
+  ResultType m_sum;
+
+  // The minimum (or maximum) of the current group
+  PodType m_value;
+};
+
+// Runs a GroupByScanVisitor
+template<typename PodType, typename ResultType>
+static ups_status_t
+group_by_impl(LocalDatabase *db, ups_txn_t *txn, int aggregate,
+                int result_type, uint32_t offset, uqi_group_func_t func,
+                void *context)
+{
+  GroupByScanVisitor<PodType, ResultType> visitor(aggregate, result_type,
+                  offset,
+                  (uint16_t)db->config().key_size,
+                  (uint32_t)db->config().record_size, func, context);
+  ups_status_t st = db->scan((Transaction *)txn, &visitor, false);
+  if (st == 0)
+    visitor.assign_result(0);
+  return (st);
+}
+
+ups_status_t UPS_CALLCONV
+uqi_record_group_by(ups_db_t *hdb, ups_txn_t *txn, uqi_record_field_t *field,
+                int aggregate, uqi_group_func_t func, void *context)
+{
+  if (!hdb) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!func) {
+    ups_trace(("parameter 'func' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (aggregate < UQI_AGGREGATE_COUNT || aggregate > UQI_AGGREGATE_MAX) {
+    ups_trace(("unknown aggregate function %d", aggregate));
+    return (UPS_INV_PARAMETER);
+  }
+
+  LocalDatabase *db = get_local_db(hdb);
+  if (!db)
+    return (UPS_INV_PARAMETER);
+
+  ScopedReadWriteLock lock(db->get_env()->mutex(),
+                  db->supports_concurrent_reads());
+
+  if (aggregate == UQI_AGGREGATE_COUNT)
+    return (group_by_impl<uint8_t, uint64_t>(db, txn, aggregate,
+                            UPS_TYPE_UINT64, 0,
+                            func, context));
+
+  if (!field) {
+    ups_trace(("parameter 'field' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (!check_field(db, field))
+    return (UPS_INV_PARAMETER);
+
+  switch (field->type) {
+    case UPS_TYPE_UINT8:
+      return (group_by_impl<uint8_t, uint64_t>(db, txn, aggregate,
+                              UPS_TYPE_UINT64, field->offset, func, context));
+    case UPS_TYPE_UINT16:
+      return (group_by_impl<uint16_t, uint64_t>(db, txn, aggregate,
+                              UPS_TYPE_UINT64, field->offset, func, context));
+    case UPS_TYPE_UINT32:
+      return (group_by_impl<uint32_t, uint64_t>(db, txn, aggregate,
+                              UPS_TYPE_UINT64, field->offset, func, context));
+    case UPS_TYPE_UINT64:
+      return (group_by_impl<uint64_t, uint64_t>(db, txn, aggregate,
+                              UPS_TYPE_UINT64, field->offset, func, context));
+    case UPS_TYPE_REAL32:
+      return (group_by_impl<float, double>(db, txn, aggregate,
+                              UPS_TYPE_REAL64, field->offset, func, context));
+    case UPS_TYPE_REAL64:
+    default:
+      return (group_by_impl<double, double>(db, txn, aggregate,
+                              UPS_TYPE_REAL64, field->offset, func, context));
+  }
+}
@@ -73,6 +73,10 @@ __parser_cb(void *ctx, int type, const struct JSON_value_struct *value) {
           p->globals.port = value->vu.integer_value;
           break;
         }
+        if (!strcmp("threads", p->key)) {
+          p->globals.threads = value->vu.integer_value;
+          break;
+        }
       }
       if (type == JSON_T_STRING) {
         if (!strcmp("error-log", p->key)) {
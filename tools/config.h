@@ -33,6 +33,7 @@ typedef struct config_table_t
 
   struct config_global_t {
     unsigned int port;
+    unsigned int threads;
     unsigned int enable_error_log;
     char *error_log;
     unsigned int enable_access_log;
@@ -92,7 +92,10 @@ struct Configuration
       journal_compression(0), record_compression(0), key_compression(0),
       read_only(false), enable_crc32(false), record_number32(false),
       record_number64(false), posix_fadvice(UPS_POSIX_FADVICE_NORMAL),
-      simulate_crashes(false) {
+      simulate_crashes(false), cache_policy(UPS_CACHE_POLICY_LRU),
+      flush_threads(1), use_io_uring(false), direct_io(false),
+      prefetch_pages(0), group_commit_window(0), group_commit_bytes(0),
+      janitor_interval(0) {
   }
 
   void print() const {
@@ -194,6 +197,22 @@ struct Configuration
                 << " ";
     if (simulate_crashes)
       std::cout << "--simulate-crashes ";
+    if (cache_policy == UPS_CACHE_POLICY_2Q)
+      std::cout << "--cache-policy=2q ";
+    if (flush_threads > 1)
+      std::cout << "--flush-threads=" << flush_threads << " ";
+    if (prefetch_pages)
+      std::cout << "--prefetch-pages=" << prefetch_pages << " ";
+    if (group_commit_window)
+      std::cout << "--group-commit-window=" << group_commit_window << " ";
+    if (group_commit_bytes)
+      std::cout << "--group-commit-bytes=" << group_commit_bytes << " ";
+    if (janitor_interval)
+      std::cout << "--janitor-interval=" << janitor_interval << " ";
+    if (direct_io)
+      std::cout << "--direct-io ";
+    else if (use_io_uring)
+      std::cout << "--use-io-uring ";
     if (!filename.empty())
       std::cout << filename;
     else {
@@ -303,6 +322,14 @@ struct Configuration
   bool record_number64;
   int posix_fadvice;
   bool simulate_crashes;
+  int cache_policy;
+  int flush_threads;
+  bool use_io_uring;
+  bool direct_io;
+  int prefetch_pages;
+  uint64_t group_commit_window;
+  uint64_t group_commit_bytes;
+  uint32_t janitor_interval;
 };
 
 #endif /* UPS_BENCH_CONFIGURATION_H */
@@ -99,6 +99,14 @@
 #define ARG_RECORD_NUMBER64                     70
 #define ARG_POSIX_FADVICE                       71
 #define ARG_SIMULATE_CRASHES                    72
+#define ARG_CACHE_POLICY                        73
+#define ARG_FLUSH_THREADS                       74
+#define ARG_USE_IO_URING                        75
+#define ARG_DIRECT_IO                           76
+#define ARG_PREFETCH_PAGES                      77
+#define ARG_GROUP_COMMIT_WINDOW                 78
+#define ARG_GROUP_COMMIT_BYTES                  79
+#define ARG_JANITOR_INTERVAL                    80
 
 /*
  * command line parameters
@@ -448,6 +456,58 @@ static option_t opts[] = {
     "simulate-crashes",
     "Simulates a crash after every operation, then performs a fullcheck",
     0 },
+  {
+    ARG_CACHE_POLICY,
+    0,
+    "cache-policy",
+    "Sets the cache replacement policy: 'lru' (default), '2q'",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_FLUSH_THREADS,
+    0,
+    "flush-threads",
+    "Sets the number of threads which flush dirty pages (default: 1)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_PREFETCH_PAGES,
+    0,
+    "prefetch-pages",
+    "Sets the number of leaf pages which are read ahead during scans "
+            "(default: 0)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_GROUP_COMMIT_WINDOW,
+    0,
+    "group-commit-window",
+    "Time (in usec) a commit waits for others to share the fsync "
+            "(default: 0)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_GROUP_COMMIT_BYTES,
+    0,
+    "group-commit-bytes",
+    "Syncs the journal as soon as this many bytes were written "
+            "(default: 0)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_JANITOR_INTERVAL,
+    0,
+    "janitor-interval",
+    "Merges underfull btree leaves in the background, every N msec "
+            "(default: 0)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_USE_IO_URING,
+    0,
+    "use-io-uring",
+    "Performs the file I/O with io_uring (if available)",
+    0 },
+  {
+    ARG_DIRECT_IO,
+    0,
+    "direct-io",
+    "Uses O_DIRECT (implies --use-io-uring and --no-mmap)",
+    0 },
   {0, 0}
 };
 
@@ -818,6 +878,42 @@ parse_config(int argc, char **argv, Configuration *c)
         exit(-1);
       }
     }
+    else if (opt == ARG_CACHE_POLICY) {
+      if (!strcmp(param, "lru"))
+        c->cache_policy = UPS_CACHE_POLICY_LRU;
+      else if (!strcmp(param, "2q"))
+        c->cache_policy = UPS_CACHE_POLICY_2Q;
+      else {
+        printf("[FAIL] invalid parameter for 'cache-policy'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_USE_IO_URING) {
+      c->use_io_uring = true;
+    }
+    else if (opt == ARG_DIRECT_IO) {
+      c->use_io_uring = true;
+      c->direct_io = true;
+    }
+    else if (opt == ARG_FLUSH_THREADS) {
+      c->flush_threads = strtoul(param, 0, 0);
+      if (!c->flush_threads) {
+        printf("[FAIL] invalid parameter for 'flush-threads'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_PREFETCH_PAGES) {
+      c->prefetch_pages = strtoul(param, 0, 0);
+    }
+    else if (opt == ARG_GROUP_COMMIT_WINDOW) {
+      c->group_commit_window = strtoul(param, 0, 0);
+    }
+    else if (opt == ARG_GROUP_COMMIT_BYTES) {
+      c->group_commit_bytes = strtoul(param, 0, 0);
+    }
+    else if (opt == ARG_JANITOR_INTERVAL) {
+      c->janitor_interval = strtoul(param, 0, 0);
+    }
     else if (opt == ARG_ENABLE_CRC32) {
       c->enable_crc32 = true;
     }
@@ -985,6 +1081,16 @@ print_metrics(Metrics *metrics, Configuration *conf)
           (long unsigned int)metrics->upscaledb_metrics.cache_hits);
   printf("\tupscaledb cache_misses                %lu\n",
           (long unsigned int)metrics->upscaledb_metrics.cache_misses);
+  for (int i = 0; i < UPS_CACHE_SHARDS; i++) {
+    printf("\tupscaledb cache_shard_hits[%d]         %lu\n", i,
+          (long unsigned int)metrics->upscaledb_metrics.cache_shard_hits[i]);
+    printf("\tupscaledb cache_shard_misses[%d]       %lu\n", i,
+          (long unsigned int)metrics->upscaledb_metrics.cache_shard_misses[i]);
+  }
+  printf("\tupscaledb page_count_prefetched       %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_count_prefetched);
+  printf("\tupscaledb prefetch_hits                %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.prefetch_hits);
   printf("\tupscaledb blob_total_allocated        %lu\n",
           (long unsigned int)metrics->upscaledb_metrics.blob_total_allocated);
   printf("\tupscaledb blob_total_read             %lu\n",
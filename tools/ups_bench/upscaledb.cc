@@ -72,7 +72,7 @@ UpscaleDatabase::do_create_env()
 {
   ups_status_t st = 0;
   uint32_t flags = 0;
-  ups_parameter_t params[6] = {{0, 0}};
+  ups_parameter_t params[12] = {{0, 0}};
 
   ScopedLock lock(ms_mutex);
 
@@ -92,6 +92,24 @@ UpscaleDatabase::do_create_env()
     params[p].name = UPS_PARAM_POSIX_FADVISE;
     params[p].value = m_config->posix_fadvice;
     p++;
+    params[p].name = UPS_PARAM_CACHE_POLICY;
+    params[p].value = m_config->cache_policy;
+    p++;
+    params[p].name = UPS_PARAM_FLUSH_THREADS;
+    params[p].value = m_config->flush_threads;
+    p++;
+    params[p].name = UPS_PARAM_PREFETCH_PAGES;
+    params[p].value = m_config->prefetch_pages;
+    p++;
+    params[p].name = UPS_PARAM_GROUP_COMMIT_WINDOW;
+    params[p].value = m_config->group_commit_window;
+    p++;
+    params[p].name = UPS_PARAM_GROUP_COMMIT_BYTES;
+    params[p].value = m_config->group_commit_bytes;
+    p++;
+    params[p].name = UPS_PARAM_JANITOR_INTERVAL;
+    params[p].value = m_config->janitor_interval;
+    p++;
     if (m_config->use_encryption) {
       params[p].name = UPS_PARAM_ENCRYPTION_KEY;
       params[p].value = (uint64_t)"1234567890123456";
@@ -105,6 +123,8 @@ UpscaleDatabase::do_create_env()
 
     flags |= m_config->inmemory ? UPS_IN_MEMORY : 0; 
     flags |= m_config->no_mmap ? UPS_DISABLE_MMAP : 0; 
+    flags |= m_config->use_io_uring ? UPS_ENABLE_IO_URING : 0;
+    flags |= m_config->direct_io ? UPS_ENABLE_DIRECT_IO : 0;
     flags |= m_config->cacheunlimited ? UPS_CACHE_UNLIMITED : 0;
     flags |= m_config->use_transactions ? UPS_ENABLE_TRANSACTIONS : 0;
     flags |= m_config->use_fsync ? UPS_ENABLE_FSYNC : 0;
@@ -155,7 +175,7 @@ UpscaleDatabase::do_open_env()
 {
   ups_status_t st = 0;
   uint32_t flags = 0;
-  ups_parameter_t params[6] = {{0, 0}};
+  ups_parameter_t params[11] = {{0, 0}};
 
   ScopedLock lock(ms_mutex);
 
@@ -173,6 +193,24 @@ UpscaleDatabase::do_open_env()
     params[p].name = UPS_PARAM_POSIX_FADVISE;
     params[p].value = m_config->posix_fadvice;
     p++;
+    params[p].name = UPS_PARAM_CACHE_POLICY;
+    params[p].value = m_config->cache_policy;
+    p++;
+    params[p].name = UPS_PARAM_FLUSH_THREADS;
+    params[p].value = m_config->flush_threads;
+    p++;
+    params[p].name = UPS_PARAM_PREFETCH_PAGES;
+    params[p].value = m_config->prefetch_pages;
+    p++;
+    params[p].name = UPS_PARAM_GROUP_COMMIT_WINDOW;
+    params[p].value = m_config->group_commit_window;
+    p++;
+    params[p].name = UPS_PARAM_GROUP_COMMIT_BYTES;
+    params[p].value = m_config->group_commit_bytes;
+    p++;
+    params[p].name = UPS_PARAM_JANITOR_INTERVAL;
+    params[p].value = m_config->janitor_interval;
+    p++;
     if (m_config->use_encryption) {
       params[p].name = UPS_PARAM_ENCRYPTION_KEY;
       params[p].value = (uint64_t)"1234567890123456";
@@ -180,6 +218,8 @@ UpscaleDatabase::do_open_env()
     }
 
     flags |= m_config->no_mmap ? UPS_DISABLE_MMAP : 0; 
+    flags |= m_config->use_io_uring ? UPS_ENABLE_IO_URING : 0;
+    flags |= m_config->direct_io ? UPS_ENABLE_DIRECT_IO : 0;
     flags |= m_config->cacheunlimited ? UPS_CACHE_UNLIMITED : 0;
     flags |= m_config->use_transactions
                 ? (UPS_ENABLE_TRANSACTIONS | UPS_AUTO_RECOVERY)
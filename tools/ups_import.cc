@@ -29,6 +29,8 @@
 #define ARG_HELP          1
 #define ARG_STDIN         2
 #define ARG_MERGE         3
+#define ARG_BULK          4
+#define ARG_FILL_FACTOR   5
 
 
 /*
@@ -53,6 +55,18 @@ static option_t opts[] = {
     "merge",
     "merge database dump into existing file",
     0 },
+  {
+    ARG_BULK,
+    "bulk",
+    "bulk",
+    "build the btree bottom-up from the (sorted) dump",
+    0 },
+  {
+    ARG_FILL_FACTOR,
+    "ff",
+    "fill-factor",
+    "percentage of the btree leaves which is filled (--bulk)",
+    GETOPTS_NEED_ARGUMENT },
   { 0, 0, 0, 0, 0 } /* terminating element */
 };
 
@@ -80,14 +94,17 @@ class Importer {
 
 class BinaryImporter : public Importer {
   public:
-    BinaryImporter(FILE *f, ups_env_t *env, const char *outfilename)
+    BinaryImporter(FILE *f, ups_env_t *env, const char *outfilename,
+                    bool bulk, uint32_t fill_factor)
       : Importer(f, env, outfilename), m_db(0), m_insert_flags(0),
+        m_bulk(bulk), m_fill_factor(fill_factor), m_bulk_active(false),
         m_db_counter(0), m_item_counter(0) {
       m_buffer = (char *)malloc(1024 * 1024);
     }
 
     ~BinaryImporter() {
       free(m_buffer);
+      end_bulk_load();
       if (m_env)
         ups_env_close(m_env, UPS_AUTO_CLEANUP);
       printf("Imported %u databases with %u items.\n",
@@ -169,29 +186,52 @@ class BinaryImporter : public Importer {
       };
 
       if (m_db) {
+        end_bulk_load();
         ups_db_close(m_db, 0);
         m_db = 0;
       }
 
       if (db.flags() & UPS_ENABLE_DUPLICATE_KEYS)
-        m_insert_flags |= UPS_DUPLICATE;
-      else {
-        m_insert_flags &= ~UPS_DUPLICATE;
-        m_insert_flags |= UPS_OVERWRITE;
-      }
+        m_insert_flags = UPS_DUPLICATE;
+      else
+        m_insert_flags = UPS_OVERWRITE;
 
       uint32_t open_flags = db.flags();
       open_flags &= ~UPS_ENABLE_DUPLICATE_KEYS;
 
       ups_status_t st = ups_env_open_db(m_env, &m_db, db.name(), open_flags, 0);
-      if (st == 0)
+      if (st == 0) {
+        begin_bulk_load();
         return;
+      }
       if (st != UPS_DATABASE_NOT_FOUND)
         error("ups_env_open_db", st);
 
       st = ups_env_create_db(m_env, &m_db, db.name(), db.flags(), &params[0]);
       if (st)
         error("ups_env_create_db", st);
+      begin_bulk_load();
+    }
+
+    // Starts a bulk load if --bulk was specified. Databases which are
+    // not empty (--merge) are filled with regular inserts.
+    void begin_bulk_load() {
+      if (!m_bulk)
+        return;
+      ups_status_t st = ups_db_bulk_begin(m_db, m_fill_factor, 0);
+      if (st == 0)
+        m_bulk_active = true;
+      else if (st != UPS_INV_PARAMETER)
+        error("ups_db_bulk_begin", st);
+    }
+
+    void end_bulk_load() {
+      if (!m_bulk_active)
+        return;
+      m_bulk_active = false;
+      ups_status_t st = ups_db_bulk_end(m_db);
+      if (st)
+        error("ups_db_bulk_end", st);
     }
 
     void read_item(HamsterTool::Datum &datum) {
@@ -207,6 +247,18 @@ class BinaryImporter : public Importer {
       r.data = (void *)srec.data();
       r.size = srec.size();
 
+      if (m_bulk_active) {
+        ups_status_t st = ups_db_bulk_insert(m_db, &k, &r);
+        if (st == UPS_INV_PARAMETER) {
+          fprintf(stderr, "The dump is not sorted; import it without "
+                  "--bulk.\n");
+          exit(-1);
+        }
+        if (st)
+          error("ups_db_bulk_insert", st);
+        return;
+      }
+
       ups_status_t st = ups_db_insert(m_db, 0, &k, &r, m_insert_flags);
       if (st)
         error("ups_db_insert", st);
@@ -229,6 +281,9 @@ class BinaryImporter : public Importer {
     char *m_buffer;
     ups_db_t *m_db;
     uint32_t m_insert_flags;
+    bool m_bulk;
+    uint32_t m_fill_factor;
+    bool m_bulk_active;
     size_t m_db_counter;
     size_t m_item_counter;
 };
@@ -236,9 +291,11 @@ class BinaryImporter : public Importer {
 int
 main(int argc, char **argv) {
   unsigned opt;
-  char *param, *dumpfilename = 0, *envfilename = 0;
+  char *param, *endptr = 0, *dumpfilename = 0, *envfilename = 0;
   bool merge = false;
   bool use_stdin = false;
+  bool bulk = false;
+  uint32_t fill_factor = 100;
 
   getopts_init(argc, argv, "ups_import");
 
@@ -250,6 +307,21 @@ main(int argc, char **argv) {
       case ARG_MERGE:
         merge = true;
         break;
+      case ARG_BULK:
+        bulk = true;
+        break;
+      case ARG_FILL_FACTOR:
+        if (!param) {
+          printf("Parameter `fill-factor' is missing.\n");
+          return (-1);
+        }
+        fill_factor = (uint32_t)strtoul(param, &endptr, 0);
+        if ((endptr && *endptr) || fill_factor == 0 || fill_factor > 100) {
+          printf("Invalid parameter `fill-factor'; numerical value "
+             "between 1 and 100 expected.\n");
+          return (-1);
+        }
+        break;
       case GETOPTS_PARAMETER:
         if (!dumpfilename && !use_stdin)
           dumpfilename = param;
@@ -265,11 +337,15 @@ main(int argc, char **argv) {
       case ARG_HELP:
         print_banner("ups_import");
 
-        printf("usage: ups_import [--stdin] [--merge] <data> <environ>\n");
+        printf("usage: ups_import [--stdin] [--merge] [--bulk [--fill-factor=<n>]] <data> <environ>\n");
         printf("usage: ups_import --help\n");
         printf("       --help:       this help screen\n");
         printf("       --stdin:      read dump data from stdin\n");
         printf("       --merge:      merge data into existing environment\n");
+        printf("       --bulk:       build the btree bottom-up; faster, but the dump\n"
+               "                     must be sorted and the databases empty\n");
+        printf("       --fill-factor=<n>: fill btree leaves to <n> percent (--bulk;\n"
+               "                     default 100)\n");
         printf("       <data>:       filename with exported data\n");
         printf("       <environ>:    upscaledb environment which will be created (or filled)\n");
         return (0);
@@ -332,7 +408,8 @@ main(int argc, char **argv) {
   }
 
   // now run the import; the importer will create the environment
-  Importer *importer = new BinaryImporter(f, env, envfilename);
+  Importer *importer = new BinaryImporter(f, env, envfilename, bulk,
+                  fill_factor);
   importer->run();
   delete importer;
   fclose(f);
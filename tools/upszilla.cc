@@ -835,6 +835,8 @@ main(int argc, char **argv) {
   if (params) {
     cfg.port = params->globals.port;
     hlog(LOG_DBG, "Config: port is %u\n", cfg.port);
+    cfg.num_threads = params->globals.threads;
+    hlog(LOG_DBG, "Config: threads is %u\n", cfg.num_threads);
     if (params->globals.enable_access_log) {
       cfg.access_log_path = params->globals.access_log;
       hlog(LOG_DBG, "Config: http access hlog is %s\n",
@@ -321,3 +321,18 @@ TEST_CASE("APIv110/spinlockTest", "")
   lock.unlock();
 }
 
+TEST_CASE("APIv110/readWriteSpinlockTest", "")
+{
+  upscaledb::ReadWriteSpinlock lock;
+  lock.lock();
+  REQUIRE(false == lock.try_lock());
+  REQUIRE(false == lock.try_lock_shared());
+  lock.unlock();
+  REQUIRE(true == lock.try_lock_shared());
+  REQUIRE(true == lock.try_lock_shared());
+  REQUIRE(false == lock.try_lock());
+  lock.unlock_shared();
+  lock.unlock_shared();
+  REQUIRE(true == lock.try_lock());
+  lock.unlock();
+}
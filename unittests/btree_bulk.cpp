@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+#include "3rdparty/catch/catch.hpp"
+
+#include "utils.h"
+#include "os.hpp"
+
+#include <vector>
+#include <string>
+
+#include "1os/file.h"
+
+using namespace upscaledb;
+
+struct BtreeBulkFixture {
+  ups_db_t *m_db;
+  ups_env_t *m_env;
+  uint32_t m_env_flags;
+  uint32_t m_page_size;
+
+  BtreeBulkFixture(uint32_t env_flags = 0, uint32_t page_size = 1024 * 4)
+    : m_db(0), m_env(0), m_env_flags(env_flags), m_page_size(page_size) {
+    os::unlink(Utils::opath(".test"));
+  }
+
+  ~BtreeBulkFixture() {
+    close();
+  }
+
+  void create(uint32_t db_flags, ups_parameter_t *params) {
+    ups_parameter_t p[] = {
+      { UPS_PARAM_PAGESIZE, m_page_size },
+      { 0, 0 }
+    };
+    REQUIRE(0 == ups_env_create(&m_env, Utils::opath(".test"), m_env_flags,
+                            0644, &p[0]));
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1, db_flags, params));
+  }
+
+  void close() {
+    if (m_env) {
+      REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+      m_env = 0;
+      m_db = 0;
+    }
+  }
+
+  void reopen() {
+    close();
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"), m_env_flags, 0));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+  }
+
+  // Returns the |i|th key of a binary database
+  static std::string make_key(uint32_t i, size_t size) {
+    char buffer[32];
+    ::sprintf(buffer, "%010u", i);
+    std::string s(buffer);
+    if (s.size() < size)
+      s.append(size - s.size(), 'x');
+    return (s);
+  }
+
+  // Loads |count| uint32 keys (with a gap of 3)
+  void loadUint32(uint32_t count, uint32_t fill_factor) {
+    REQUIRE(0 == ups_db_bulk_begin(m_db, fill_factor, 0));
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t k = i * 3;
+      ups_key_t key = ups_make_key(&k, sizeof(k));
+      ups_record_t rec = ups_make_record(&k, sizeof(k));
+      REQUIRE(0 == ups_db_bulk_insert(m_db, &key, &rec));
+    }
+    REQUIRE(0 == ups_db_bulk_end(m_db));
+  }
+
+  // Verifies the keys which were loaded with loadUint32()
+  void verifyUint32(uint32_t count) {
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+
+    uint64_t keycount;
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &keycount));
+    REQUIRE(keycount == count);
+
+    ups_cursor_t *cursor;
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+    for (uint32_t i = 0; i < count; i++) {
+      REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT));
+      REQUIRE(*(uint32_t *)key.data == i * 3);
+      REQUIRE(*(uint32_t *)rec.data == i * 3);
+    }
+    REQUIRE(UPS_KEY_NOT_FOUND == ups_cursor_move(cursor, 0, 0,
+                            UPS_CURSOR_NEXT));
+    REQUIRE(0 == ups_cursor_close(cursor));
+
+    for (uint32_t i = 0; i < count; i += 7) {
+      uint32_t k = i * 3;
+      key = ups_make_key(&k, sizeof(k));
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(*(uint32_t *)rec.data == k);
+      k++;
+      REQUIRE(UPS_KEY_NOT_FOUND == ups_db_find(m_db, 0, &key, &rec, 0));
+    }
+  }
+
+  void uint32Test(uint64_t compressor, uint32_t count) {
+    ups_parameter_t p[] = {
+      { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32 },
+      { UPS_PARAM_RECORD_SIZE, 4 },
+      { UPS_PARAM_KEY_COMPRESSION, compressor },
+      { 0, 0 }
+    };
+    if (compressor == 0)
+      p[2].name = 0;
+    create(0, &p[0]);
+
+    loadUint32(count, 100);
+    verifyUint32(count);
+    reopen();
+    verifyUint32(count);
+
+    // the database can be modified after the bulk load
+    for (uint32_t i = 0; i < count; i += 11) {
+      uint32_t k = i * 3 + 1;
+      ups_key_t key = ups_make_key(&k, sizeof(k));
+      ups_record_t rec = ups_make_record(&k, sizeof(k));
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+      k--;
+      REQUIRE(0 == ups_db_erase(m_db, 0, &key, 0));
+    }
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+  }
+
+  void binaryTest(uint32_t key_size, uint32_t record_size) {
+    ups_parameter_t p[] = {
+      { UPS_PARAM_KEY_SIZE, key_size },
+      { 0, 0 }
+    };
+    create(0, key_size == UPS_KEY_SIZE_UNLIMITED ? 0 : &p[0]);
+
+    const uint32_t count = 20000;
+    std::vector<uint8_t> buffer(record_size);
+    REQUIRE(0 == ups_db_bulk_begin(m_db, 0, 0));
+    for (uint32_t i = 0; i < count; i++) {
+      // every 100th key is an extended key
+      std::string s = make_key(i, key_size == UPS_KEY_SIZE_UNLIMITED
+                            ? (i % 100 == 0 ? 500 : 10 + i % 20)
+                            : key_size);
+      ups_key_t key = ups_make_key((void *)s.data(), (uint16_t)s.size());
+      if (record_size)
+        *(uint32_t *)&buffer[0] = i;
+      ups_record_t rec = ups_make_record(buffer.empty() ? 0 : &buffer[0],
+                            record_size);
+      REQUIRE(0 == ups_db_bulk_insert(m_db, &key, &rec));
+    }
+    REQUIRE(0 == ups_db_bulk_end(m_db));
+
+    for (int pass = 0; pass < 2; pass++) {
+      REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+      for (uint32_t i = 0; i < count; i += 13) {
+        std::string s = make_key(i, key_size == UPS_KEY_SIZE_UNLIMITED
+                            ? (i % 100 == 0 ? 500 : 10 + i % 20)
+                            : key_size);
+        ups_key_t key = ups_make_key((void *)s.data(), (uint16_t)s.size());
+        ups_record_t rec = {0};
+        REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+        REQUIRE(rec.size == record_size);
+        if (record_size)
+          REQUIRE(*(uint32_t *)rec.data == i);
+      }
+      uint64_t keycount;
+      REQUIRE(0 == ups_db_count(m_db, 0, 0, &keycount));
+      REQUIRE(keycount == count);
+      reopen();
+    }
+  }
+
+  void duplicateTest() {
+    create(UPS_ENABLE_DUPLICATE_KEYS, 0);
+
+    // key i has (i % 7) + 1 duplicates; key 500 has many more
+    REQUIRE(0 == ups_db_bulk_begin(m_db, 0, 0));
+    for (uint32_t i = 0; i < 3000; i++) {
+      std::string s = make_key(i, 12);
+      ups_key_t key = ups_make_key((void *)s.data(), (uint16_t)s.size());
+      uint32_t dupes = i == 500 ? 1000 : i % 7 + 1;
+      for (uint32_t j = 0; j < dupes; j++) {
+        ups_record_t rec = ups_make_record(&j, sizeof(j));
+        REQUIRE(0 == ups_db_bulk_insert(m_db, &key, &rec));
+      }
+    }
+    REQUIRE(0 == ups_db_bulk_end(m_db));
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+
+    ups_cursor_t *cursor;
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+    for (uint32_t i = 0; i < 3000; i++) {
+      std::string s = make_key(i, 12);
+      ups_key_t key = ups_make_key((void *)s.data(), (uint16_t)s.size());
+      ups_record_t rec = {0};
+      REQUIRE(0 == ups_cursor_find(cursor, &key, &rec, 0));
+      uint32_t dupes;
+      REQUIRE(0 == ups_cursor_get_duplicate_count(cursor, &dupes, 0));
+      REQUIRE(dupes == (i == 500 ? 1000 : i % 7 + 1));
+      for (uint32_t j = 0; j < dupes; j++) {
+        if (j > 0)
+          REQUIRE(0 == ups_cursor_move(cursor, 0, &rec,
+                                  UPS_CURSOR_NEXT | UPS_ONLY_DUPLICATES));
+        REQUIRE(*(uint32_t *)rec.data == j);
+      }
+    }
+    REQUIRE(0 == ups_cursor_close(cursor));
+  }
+
+  void fillFactorTest() {
+    ups_parameter_t p[] = {
+      { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32 },
+      { UPS_PARAM_RECORD_SIZE, 4 },
+      { 0, 0 }
+    };
+
+    // a lower fill factor creates more pages, therefore a bigger file
+    uint64_t file_size[3];
+    uint32_t fill_factors[3] = {100, 70, 30};
+    for (int i = 0; i < 3; i++) {
+      create(0, &p[0]);
+      loadUint32(100000, fill_factors[i]);
+      verifyUint32(100000);
+      close();
+
+      File f;
+      f.open(Utils::opath(".test"), true);
+      file_size[i] = f.get_file_size();
+      f.close();
+      os::unlink(Utils::opath(".test"));
+    }
+    REQUIRE(file_size[0] < file_size[1]);
+    REQUIRE(file_size[1] < file_size[2]);
+
+    // the packed btree is smaller than a btree filled with random inserts
+    create(0, &p[0]);
+    for (uint32_t i = 0; i < 100000; i++) {
+      uint32_t k = ((i * 7919) % 100000) * 3;
+      ups_key_t key = ups_make_key(&k, sizeof(k));
+      ups_record_t rec = ups_make_record(&k, sizeof(k));
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    close();
+    File f;
+    f.open(Utils::opath(".test"), true);
+    REQUIRE(file_size[0] < f.get_file_size());
+    f.close();
+  }
+
+  void recnoTest(uint32_t db_flags) {
+    create(db_flags, 0);
+
+    REQUIRE(0 == ups_db_bulk_begin(m_db, 0, 0));
+    for (uint32_t i = 0; i < 10000; i++) {
+      ups_key_t key = {0};
+      ups_record_t rec = ups_make_record(&i, sizeof(i));
+      REQUIRE(0 == ups_db_bulk_insert(m_db, &key, &rec));
+    }
+    REQUIRE(0 == ups_db_bulk_end(m_db));
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+
+    // regular inserts continue with the next record number
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    if (db_flags & UPS_RECORD_NUMBER32)
+      REQUIRE(*(uint32_t *)key.data == 10001);
+    else
+      REQUIRE(*(uint64_t *)key.data == 10001);
+
+    uint64_t keycount;
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &keycount));
+    REQUIRE(keycount == 10001);
+  }
+
+  void errorTest() {
+    ups_parameter_t p[] = {
+      { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32 },
+      { 0, 0 }
+    };
+    create(0, &p[0]);
+
+    uint32_t k = 10;
+    ups_key_t key = ups_make_key(&k, sizeof(k));
+    ups_record_t rec = {0};
+
+    REQUIRE(UPS_INV_PARAMETER == ups_db_bulk_begin(0, 0, 0));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_bulk_begin(m_db, 101, 0));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_bulk_insert(m_db, &key, &rec));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_bulk_end(m_db));
+
+    ups_cursor_t *cursor;
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+    REQUIRE(UPS_CURSOR_STILL_OPEN == ups_db_bulk_begin(m_db, 0, 0));
+    REQUIRE(0 == ups_cursor_close(cursor));
+
+    REQUIRE(0 == ups_db_bulk_begin(m_db, 0, 0));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_bulk_begin(m_db, 0, 0));
+    REQUIRE(0 == ups_db_bulk_insert(m_db, &key, &rec));
+    // duplicate keys are not enabled
+    REQUIRE(UPS_DUPLICATE_KEY == ups_db_bulk_insert(m_db, &key, &rec));
+    // keys must be sorted
+    k = 5;
+    REQUIRE(UPS_INV_PARAMETER == ups_db_bulk_insert(m_db, &key, &rec));
+    // regular updates are not allowed
+    REQUIRE(UPS_INV_PARAMETER == ups_db_insert(m_db, 0, &key, &rec, 0));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_erase(m_db, 0, &key, 0));
+    k = 20;
+    REQUIRE(0 == ups_db_bulk_insert(m_db, &key, &rec));
+    REQUIRE(0 == ups_db_bulk_end(m_db));
+
+    // the database is no longer empty
+    REQUIRE(UPS_INV_PARAMETER == ups_db_bulk_begin(m_db, 0, 0));
+
+    uint64_t keycount;
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &keycount));
+    REQUIRE(keycount == 2);
+  }
+};
+
+TEST_CASE("BtreeBulk/uint32Test", "")
+{
+  BtreeBulkFixture f;
+  f.uint32Test(0, 50000);
+}
+
+TEST_CASE("BtreeBulk/uint32InMemoryTest", "")
+{
+  BtreeBulkFixture f(UPS_IN_MEMORY);
+  ups_parameter_t p[] = {
+    { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32 },
+    { UPS_PARAM_RECORD_SIZE, 4 },
+    { 0, 0 }
+  };
+  f.create(0, &p[0]);
+  f.loadUint32(50000, 80);
+  f.verifyUint32(50000);
+}
+
+TEST_CASE("BtreeBulk/uint32TxnTest", "")
+{
+  BtreeBulkFixture f(UPS_ENABLE_TRANSACTIONS);
+  f.uint32Test(0, 50000);
+}
+
+TEST_CASE("BtreeBulk/varbyteTest", "")
+{
+  // uint32 compression requires 16k pages
+  BtreeBulkFixture f(0, 1024 * 16);
+  f.uint32Test(UPS_COMPRESSOR_UINT32_VARBYTE, 500000);
+}
+
+TEST_CASE("BtreeBulk/forTest", "")
+{
+  // uint32 compression requires 16k pages
+  BtreeBulkFixture f(0, 1024 * 16);
+  f.uint32Test(UPS_COMPRESSOR_UINT32_FOR, 500000);
+}
+
+#ifdef HAVE_SSE2
+TEST_CASE("BtreeBulk/simdcompTest", "")
+{
+  // uint32 compression requires 16k pages
+  BtreeBulkFixture f(0, 1024 * 16);
+  f.uint32Test(UPS_COMPRESSOR_UINT32_SIMDCOMP, 500000);
+}
+
+TEST_CASE("BtreeBulk/groupVarintTest", "")
+{
+  // uint32 compression requires 16k pages
+  BtreeBulkFixture f(0, 1024 * 16);
+  f.uint32Test(UPS_COMPRESSOR_UINT32_GROUPVARINT, 500000);
+}
+
+TEST_CASE("BtreeBulk/streamVbyteTest", "")
+{
+  // uint32 compression requires 16k pages
+  BtreeBulkFixture f(0, 1024 * 16);
+  f.uint32Test(UPS_COMPRESSOR_UINT32_STREAMVBYTE, 500000);
+}
+#endif
+
+TEST_CASE("BtreeBulk/fixedBinaryTest", "")
+{
+  BtreeBulkFixture f;
+  f.binaryTest(16, 8);
+}
+
+TEST_CASE("BtreeBulk/variableBinaryTest", "")
+{
+  BtreeBulkFixture f;
+  f.binaryTest(UPS_KEY_SIZE_UNLIMITED, 0);
+}
+
+TEST_CASE("BtreeBulk/blobRecordTest", "")
+{
+  BtreeBulkFixture f;
+  f.binaryTest(UPS_KEY_SIZE_UNLIMITED, 200);
+}
+
+TEST_CASE("BtreeBulk/duplicateTest", "")
+{
+  BtreeBulkFixture f;
+  f.duplicateTest();
+}
+
+TEST_CASE("BtreeBulk/fillFactorTest", "")
+{
+  BtreeBulkFixture f;
+  f.fillFactorTest();
+}
+
+TEST_CASE("BtreeBulk/recno32Test", "")
+{
+  BtreeBulkFixture f;
+  f.recnoTest(UPS_RECORD_NUMBER32);
+}
+
+TEST_CASE("BtreeBulk/recno64Test", "")
+{
+  BtreeBulkFixture f;
+  f.recnoTest(UPS_RECORD_NUMBER64);
+}
+
+TEST_CASE("BtreeBulk/errorTest", "")
+{
+  BtreeBulkFixture f;
+  f.errorTest();
+}
@@ -20,7 +20,12 @@
 #include "utils.h"
 #include "os.hpp"
 
+#include "1base/mutex.h"
+#include "2device/device.h"
 #include "4db/db.h"
+#include "4env/env_local.h"
+
+using namespace upscaledb;
 
 struct BtreeEraseFixture {
   ups_db_t *m_db;
@@ -152,6 +157,85 @@ struct BtreeEraseFixture {
       REQUIRE(0 == ups_db_erase(m_db, 0, &key, 0));
     }
   }
+
+  uint64_t get_leaf_count() {
+    ups_env_metrics_t metrics;
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    return (metrics.btree_leaf_metrics.number_of_pages);
+  }
+
+  uint64_t get_file_size() {
+    return (((LocalEnvironment *)m_env)->device()->file_size());
+  }
+
+  void janitorTest() {
+    ups_parameter_t p1[] = {
+      { UPS_PARAM_PAGESIZE, 1024 },
+      { UPS_PARAM_JANITOR_INTERVAL, 1 },
+      { 0, 0 }
+    };
+    ups_parameter_t p2[] = {
+      { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32 },
+      { 0, 0 }
+    };
+
+    teardown();
+    REQUIRE(0 ==
+        ups_env_create(&m_env, Utils::opath(".test"), m_flags, 0644,
+            &p1[0]));
+    REQUIRE(0 ==
+        ups_env_create_db(m_env, &m_db, 1, 0, &p2[0]));
+
+    ups_parameter_t query[] = {
+      { UPS_PARAM_JANITOR_INTERVAL, 0 },
+      { 0, 0 }
+    };
+    REQUIRE(0 == ups_env_get_parameters(m_env, &query[0]));
+    REQUIRE(1u == query[0].value);
+
+    const uint32_t kMax = 20000;
+    for (uint32_t i = 0; i < kMax; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = {0};
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    uint64_t leaf_count = get_leaf_count();
+    uint64_t file_size = get_file_size();
+
+    // erase 99% of the keys; only a single key remains in most leaves
+    for (uint32_t i = 0; i < kMax; i++) {
+      if (i % 100 == 0)
+        continue;
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      REQUIRE(0 == ups_db_erase(m_db, 0, &key, 0));
+    }
+
+    // the janitor merges the leaves in the background
+    for (int i = 0; i < 1000 && (get_leaf_count() > leaf_count / 3
+                || get_file_size() >= file_size); i++)
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    REQUIRE(get_leaf_count() <= leaf_count / 3);
+    REQUIRE(get_file_size() < file_size);
+
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+    uint64_t count;
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &count));
+    REQUIRE(count == kMax / 100);
+
+    for (uint32_t i = 0; i < kMax; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = {0};
+      REQUIRE((i % 100 == 0 ? 0 : UPS_KEY_NOT_FOUND)
+                      == ups_db_find(m_db, 0, &key, &rec, 0));
+    }
+
+    // the remaining keys can be erased while the janitor is running
+    for (uint32_t i = 0; i < kMax; i += 100) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      REQUIRE(0 == ups_db_erase(m_db, 0, &key, 0));
+    }
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+  }
 };
 
 TEST_CASE("BtreeErase/collapseRootTest", "")
@@ -179,6 +263,18 @@ TEST_CASE("BtreeErase/mergeWithLeftTest", "")
 }
 
 
+TEST_CASE("BtreeErase/janitorTest", "")
+{
+  BtreeEraseFixture f;
+  f.janitorTest();
+}
+
+TEST_CASE("BtreeErase/janitorTxnTest", "")
+{
+  BtreeEraseFixture f(UPS_ENABLE_TRANSACTIONS);
+  f.janitorTest();
+}
+
 TEST_CASE("BtreeErase-inmem/collapseRootTest", "")
 {
   BtreeEraseFixture f(UPS_IN_MEMORY);
@@ -252,6 +252,48 @@ TEST_CASE("Device/readWritePage", "")
   f. readWritePageTest();
 }
 
+TEST_CASE("Device/ioUring", "")
+{
+  ups_env_t *env;
+  ups_db_t *db;
+  uint32_t flags[] = {
+    UPS_ENABLE_IO_URING,
+    UPS_ENABLE_IO_URING | UPS_ENABLE_DIRECT_IO,
+    UPS_ENABLE_IO_URING | UPS_ENABLE_TRANSACTIONS
+  };
+
+  // without liburing (or kernel support) the regular file I/O is used
+  for (int f = 0; f < 3; f++) {
+    REQUIRE(0 ==
+        ups_env_create(&env, Utils::opath(".test"), flags[f], 0644, 0));
+    REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, 0));
+    char buffer[1000] = {0};
+    for (int i = 0; i < 2000; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = ups_make_record(buffer, sizeof(buffer));
+      *(int *)buffer = i;
+      REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+
+    REQUIRE(0 == ups_env_open(&env, Utils::opath(".test"), flags[f], 0));
+    REQUIRE(0 == ups_env_open_db(env, &db, 1, 0, 0));
+    for (int i = 0; i < 2000; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = {0};
+      REQUIRE(0 == ups_db_find(db, 0, &key, &rec, 0));
+      REQUIRE(sizeof(buffer) == rec.size);
+      REQUIRE(i == *(int *)rec.data);
+    }
+    REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+  }
+
+  // O_DIRECT requires io_uring
+  REQUIRE(UPS_INV_PARAMETER ==
+      ups_env_create(&env, Utils::opath(".test"), UPS_ENABLE_DIRECT_IO,
+              0644, 0));
+}
+
 
 TEST_CASE("Device-inmem/newDelete", "")
 {
@@ -15,10 +15,15 @@
  * See the file COPYING for License information.
  */
 
+#include <vector>
+#include <limits>
+#include <algorithm>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "ups/upscaledb_uqi.h"
 
+#include "2simd/aggregate.h"
 #include "3btree/btree_index.h"
 #include "4context/context.h"
 #include "4db/db_local.h"
@@ -45,6 +50,28 @@ average_if_predicate(const void *key_data, uint16_t key_size, void *context)
   return (*p < 10.f);
 }
 
+// only select records which start with an odd byte
+static ups_bool_t
+record_count_if_predicate(const void *record_data, uint16_t record_size,
+                void *context)
+{
+  const uint8_t *p = (const uint8_t *)record_data;
+  return (record_size > 0 && (*p & 1));
+}
+
+// collects the results of uqi_record_group_by
+static void
+group_by_callback(const void *key_data, uint16_t key_size,
+                const uqi_result_t *result, void *context)
+{
+  std::vector<std::pair<uint32_t, uint64_t> > *groups
+        = (std::vector<std::pair<uint32_t, uint64_t> > *)context;
+  REQUIRE(key_size == sizeof(uint32_t));
+  REQUIRE(result->type == UPS_TYPE_UINT64);
+  groups->push_back(std::make_pair(*(const uint32_t *)key_data,
+                          result->u.result_u64));
+}
+
 static ups_bool_t
 count_if_predicate(const void *key_data, uint16_t key_size, void *context)
 {
@@ -52,23 +79,96 @@ count_if_predicate(const void *key_data, uint16_t key_size, void *context)
   return (*p & 1);
 }
 
+// only select even numbers; batched version of sum_if_predicate
+static void
+sum_if_batch_predicate(const void *key_array, size_t key_count,
+                uint16_t key_size, uint8_t *selected, void *context)
+{
+  const uint32_t *p = (const uint32_t *)key_array;
+  for (size_t i = 0; i < key_count; i++)
+    selected[i] = (p[i] & 1) == 0;
+}
+
+// only select numbers < 10; batched version of average_if_predicate
+static void
+average_if_batch_predicate(const void *key_array, size_t key_count,
+                uint16_t key_size, uint8_t *selected, void *context)
+{
+  const float *p = (const float *)key_array;
+  for (size_t i = 0; i < key_count; i++)
+    selected[i] = p[i] < 10.f ? 0xff : 0;
+}
+
+// batched version of count_if_predicate
+static void
+count_if_batch_predicate(const void *key_array, size_t key_count,
+                uint16_t key_size, uint8_t *selected, void *context)
+{
+  const uint8_t *p = (const uint8_t *)key_array;
+  for (size_t i = 0; i < key_count; i++, p += key_size)
+    selected[i] = *p & 1;
+}
+
+// Compares the SIMD kernels with the portable implementations
+template<typename T, typename R>
+static void
+simdKernelTest(T scale)
+{
+  std::vector<T> data(300);
+  srand(0);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = (T)(rand() % 1000) * scale;
+  data[123] = std::numeric_limits<T>::max();
+  data[7] = 0;
+
+  T low = data[10];
+  T high = data[20];
+  if (high < low)
+    std::swap(low, high);
+
+  // different lengths and misaligned start offsets
+  for (size_t offset = 0; offset < 3; offset++) {
+    for (size_t count = 0; count + offset <= data.size(); count++) {
+      const T *p = &data[offset];
+      R sum1 = simd_sum<T, R>(p, count);
+      R sum2 = sum_portable<T, R>(p, count);
+      REQUIRE(sum1 == sum2);
+      REQUIRE(simd_count_range(p, count, low, high)
+                      == count_range_portable(p, count, low, high));
+      if (count > 0) {
+        REQUIRE(simd_min(p, count) == min_portable(p, count));
+        REQUIRE(simd_max(p, count) == max_portable(p, count));
+      }
+    }
+  }
+
+  REQUIRE(simd_count_range(&data[0], data.size(), high, low) == 0u);
+}
+
 struct HolaFixture {
   ups_db_t *m_db;
   ups_env_t *m_env;
   bool m_use_transactions;
 
-  HolaFixture(bool use_transactions, int type, bool use_duplicates = false)
+  HolaFixture(bool use_transactions, int type, bool use_duplicates = false,
+                  int scan_threads = 1,
+                  uint32_t record_size = UPS_RECORD_SIZE_UNLIMITED)
     : m_use_transactions(use_transactions) {
     os::unlink(Utils::opath(".test"));
     ups_parameter_t params[] = {
         {UPS_PARAM_KEY_TYPE, (uint64_t)type},
+        {UPS_PARAM_RECORD_SIZE, (uint64_t)record_size},
+        {0, 0}
+    };
+    ups_parameter_t env_params[] = {
+        {UPS_PARAM_SCAN_THREADS, (uint64_t)scan_threads},
         {0, 0}
     };
     REQUIRE(0 == ups_env_create(&m_env, ".test",
                             use_transactions
                                 ? UPS_ENABLE_TRANSACTIONS
                                 : 0,
-                            0, 0));
+                            0, &env_params[0]));
     REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1,
                             use_duplicates
                                 ? UPS_ENABLE_DUPLICATES
@@ -382,6 +482,490 @@ struct HolaFixture {
     REQUIRE(result.type == UPS_TYPE_UINT64);
     REQUIRE(result.u.result_u64 == c);
   }
+
+  void sumIfBatchTest(int count) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+    uint64_t sum = 0;
+
+    // insert a few keys
+    for (int i = 0; i < count; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+      if ((i & 1) == 0)
+        sum += i;
+    }
+
+    uqi_batch_predicate_t predicate;
+    predicate.context = 0;
+    predicate.predicate_func = sum_if_batch_predicate;
+
+    uqi_result_t result;
+    REQUIRE(0 == uqi_sum_if_batch(m_db, 0, &predicate, &result));
+    REQUIRE(result.type == UPS_TYPE_UINT64);
+    REQUIRE(result.u.result_u64 == sum);
+  }
+
+  void averageIfBatchTest(int count) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+    float sum = 0;
+    int c = 0;
+
+    // insert a few keys
+    for (int i = 0; i < count; i++) {
+      float f = (float)i;
+      key.data = &f;
+      key.size = sizeof(f);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+      if (f < 10.f) {
+        sum += f;
+        c++;
+      }
+    }
+
+    uqi_batch_predicate_t predicate;
+    predicate.context = 0;
+    predicate.predicate_func = average_if_batch_predicate;
+
+    uqi_result_t result;
+    REQUIRE(0 == uqi_average_if_batch(m_db, 0, &predicate, &result));
+    REQUIRE(result.type == UPS_TYPE_REAL64);
+    REQUIRE(result.u.result_double == sum / c);
+  }
+
+  void countIfBatchTest(int count) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+    char buffer[200] = {0};
+    uint64_t c = 0;
+
+    // insert a few keys
+    for (int i = 0; i < count; i++) {
+      buffer[0] = (char)i;
+      key.size = i + 1;
+      key.data = &buffer[0];
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+      if ((i & 1) == 0)
+        c++;
+    }
+
+    uqi_batch_predicate_t predicate;
+    predicate.context = 0;
+    predicate.predicate_func = count_if_batch_predicate;
+
+    uqi_result_t result;
+    REQUIRE(0 == uqi_count_if_batch(m_db, 0, &predicate, &result));
+    REQUIRE(result.type == UPS_TYPE_UINT64);
+    REQUIRE(result.u.result_u64 == c);
+  }
+
+  void minMaxTest(int count) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+    uqi_result_t result;
+
+    // an empty database returns 0
+    REQUIRE(0 == uqi_min(m_db, 0, &result));
+    REQUIRE(result.type == UPS_TYPE_UINT64);
+    REQUIRE(result.u.result_u64 == 0u);
+
+    // insert keys in random order
+    srand(1);
+    uint32_t min = 0xffffffffu, max = 0;
+    for (int i = 0; i < count; i++) {
+      uint32_t k = (uint32_t)rand() + 1;
+      key.data = &k;
+      key.size = sizeof(k);
+      ups_status_t st = ups_db_insert(m_db, 0, &key, &record, 0);
+      REQUIRE((st == 0 || st == UPS_DUPLICATE_KEY));
+      min = std::min(min, k);
+      max = std::max(max, k);
+    }
+
+    REQUIRE(0 == uqi_min(m_db, 0, &result));
+    REQUIRE(result.type == UPS_TYPE_UINT64);
+    REQUIRE(result.u.result_u64 == min);
+    REQUIRE(0 == uqi_max(m_db, 0, &result));
+    REQUIRE(result.type == UPS_TYPE_UINT64);
+    REQUIRE(result.u.result_u64 == max);
+  }
+
+  void minMaxRealTest(int count) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+
+    // insert keys in descending order
+    for (int i = count; i > 0; i--) {
+      double d = i * 1.5;
+      key.data = &d;
+      key.size = sizeof(d);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+    }
+
+    uqi_result_t result;
+    REQUIRE(0 == uqi_min(m_db, 0, &result));
+    REQUIRE(result.type == UPS_TYPE_REAL64);
+    REQUIRE(result.u.result_double == 1.5);
+    REQUIRE(0 == uqi_max(m_db, 0, &result));
+    REQUIRE(result.type == UPS_TYPE_REAL64);
+    REQUIRE(result.u.result_double == count * 1.5);
+  }
+
+  void countRangeTest(int count) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+
+    ups_txn_t *txn = 0;
+    if (m_use_transactions)
+      REQUIRE(0 == ups_txn_begin(&txn, m_env, 0, 0, 0));
+
+    for (uint64_t i = 0; i < (uint64_t)count; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ups_db_insert(m_db, txn, &key, &record, 0));
+    }
+
+    uint64_t low = count / 4;
+    uint64_t high = count / 2;
+    ups_key_t lkey = ups_make_key(&low, sizeof(low));
+    ups_key_t hkey = ups_make_key(&high, sizeof(high));
+
+    uqi_result_t result;
+    REQUIRE(0 == uqi_count_range(m_db, txn, &lkey, &hkey, &result));
+    REQUIRE(result.type == UPS_TYPE_UINT64);
+    REQUIRE(result.u.result_u64 == high - low + 1);
+
+    // an empty range
+    REQUIRE(0 == uqi_count_range(m_db, txn, &hkey, &lkey, &result));
+    REQUIRE(result.u.result_u64 == 0u);
+
+    // the key size must match
+    uint32_t small = 0;
+    ups_key_t skey = ups_make_key(&small, sizeof(small));
+    REQUIRE(UPS_INV_PARAMETER
+                    == uqi_count_range(m_db, txn, &skey, &hkey, &result));
+    REQUIRE(UPS_INV_PARAMETER
+                    == uqi_count_range(m_db, txn, 0, &hkey, &result));
+
+    if (txn)
+      REQUIRE(0 == ups_txn_commit(txn, 0));
+  }
+
+  // Returns the number of chunks of a parallel scan
+  size_t partitionChunks() {
+    Context context((LocalEnvironment *)m_env, 0, (LocalDatabase *)m_db);
+    std::vector<BtreeScanChunk> chunks;
+    BtreeIndex *be = ((LocalDatabase *)m_db)->btree_index();
+    if (!be->partition(&context, 16, &chunks))
+      return (0);
+    return (chunks.size());
+  }
+
+  // Compares the results of the (parallel) scans with |keys|
+  void verifyScans(ups_txn_t *txn, const std::vector<uint32_t> &keys) {
+    uint64_t sum = 0, even_sum = 0;
+    uint32_t min = 0xffffffffu, max = 0;
+    uint64_t in_range = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+      sum += keys[i];
+      if ((keys[i] & 1) == 0)
+        even_sum += keys[i];
+      if (keys[i] >= 1000 && keys[i] <= 50000)
+        in_range++;
+      min = std::min(min, keys[i]);
+      max = std::max(max, keys[i]);
+    }
+
+    uqi_result_t result;
+    REQUIRE(0 == uqi_sum(m_db, txn, &result));
+    REQUIRE(result.u.result_u64 == sum);
+
+    uqi_bool_predicate_t predicate;
+    predicate.context = 0;
+    predicate.predicate_func = sum_if_predicate;
+    REQUIRE(0 == uqi_sum_if(m_db, txn, &predicate, &result));
+    REQUIRE(result.u.result_u64 == even_sum);
+
+    uqi_batch_predicate_t batch;
+    batch.context = 0;
+    batch.predicate_func = sum_if_batch_predicate;
+    REQUIRE(0 == uqi_sum_if_batch(m_db, txn, &batch, &result));
+    REQUIRE(result.u.result_u64 == even_sum);
+
+    // the average of integer keys is an integer as well
+    REQUIRE(0 == uqi_average(m_db, txn, &result));
+    REQUIRE(result.u.result_u64 == sum / keys.size());
+
+    REQUIRE(0 == uqi_min(m_db, txn, &result));
+    REQUIRE(result.u.result_u64 == min);
+    REQUIRE(0 == uqi_max(m_db, txn, &result));
+    REQUIRE(result.u.result_u64 == max);
+
+    uint32_t low = 1000, high = 50000;
+    ups_key_t lkey = ups_make_key(&low, sizeof(low));
+    ups_key_t hkey = ups_make_key(&high, sizeof(high));
+    REQUIRE(0 == uqi_count_range(m_db, txn, &lkey, &hkey, &result));
+    REQUIRE(result.u.result_u64 == in_range);
+  }
+
+  void parallelScanTest(int count) {
+    std::vector<uint32_t> keys;
+    for (int i = 0; i < count; i++)
+      keys.push_back(i * 3);
+
+    // insert in random order; then the leaves are not completely filled
+    srand(0);
+    std::random_shuffle(keys.begin(), keys.end());
+    for (size_t i = 0; i < keys.size(); i++)
+      REQUIRE(0 == insertTxn(0, keys[i]));
+
+    REQUIRE(partitionChunks() > 1);
+    verifyScans(0, keys);
+  }
+
+  void parallelScanTxnTest(int count, int step) {
+    std::vector<uint32_t> keys;
+    for (int i = 0; i < count; i++) {
+      keys.push_back(i * 3);
+      REQUIRE(0 == insertBtree(i * 3));
+    }
+    REQUIRE(partitionChunks() > 1);
+
+    // now modify a few leaves in a pending Transaction: insert new keys,
+    // erase btree keys and overwrite others
+    ups_txn_t *txn;
+    REQUIRE(0 == ups_txn_begin(&txn, m_env, 0, 0, 0));
+    for (int i = 0; i < count; i += step) {
+      uint32_t k = i * 3 + 1;
+      REQUIRE(0 == insertTxn(txn, k));
+      keys.push_back(k);
+    }
+    for (int i = 500; i < count; i += 2 * step) {
+      uint32_t k = i * 3;
+      ups_key_t key = ups_make_key(&k, sizeof(k));
+      REQUIRE(0 == ups_db_erase(m_db, txn, &key, 0));
+      keys.erase(std::find(keys.begin(), keys.end(), k));
+    }
+    for (int i = 1000; i < count; i += 3 * step) {
+      uint32_t k = i * 3;
+      ups_key_t key = ups_make_key(&k, sizeof(k));
+      ups_record_t record = {0};
+      REQUIRE(0 == ups_db_insert(m_db, txn, &key, &record, UPS_OVERWRITE));
+    }
+
+    verifyScans(txn, keys);
+    REQUIRE(0 == ups_txn_abort(txn, 0));
+  }
+
+  // Inserts |key| with a record of |record_size| bytes; |value| is stored
+  // at |offset|
+  ups_status_t insertRecord(ups_txn_t *txn, uint32_t key, uint32_t value,
+                  uint32_t record_size, uint32_t offset,
+                  uint32_t flags = 0) {
+    std::vector<uint8_t> buffer(record_size, 0xff);
+    memcpy(&buffer[offset], &value, sizeof(value));
+    ups_key_t k = ups_make_key(&key, sizeof(key));
+    ups_record_t r = ups_make_record(&buffer[0], record_size);
+    return (ups_db_insert(m_db, txn, &k, &r, flags));
+  }
+
+  void recordAggregateTest(int count, uint32_t record_size, uint32_t offset) {
+    std::vector<uint32_t> keys;
+    for (int i = 0; i < count; i++)
+      keys.push_back(i);
+    srand(0);
+    std::random_shuffle(keys.begin(), keys.end());
+
+    // half of the keys are inserted in a pending Transaction
+    ups_txn_t *txn = 0;
+    uint64_t sum = 0;
+    uint32_t min = 0xffffffffu, max = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (m_use_transactions && i == keys.size() / 2)
+        REQUIRE(0 == ups_txn_begin(&txn, m_env, 0, 0, 0));
+      uint32_t value = (keys[i] * 7) % 100000;
+      REQUIRE(0 == insertRecord(txn, keys[i], value, record_size, offset));
+      sum += value;
+      min = std::min(min, value);
+      max = std::max(max, value);
+    }
+
+    uqi_record_field_t field = {UPS_TYPE_UINT32, offset};
+    uqi_result_t result;
+    REQUIRE(0 == uqi_record_sum(m_db, txn, &field, &result));
+    REQUIRE(result.type == UPS_TYPE_UINT64);
+    REQUIRE(result.u.result_u64 == sum);
+    REQUIRE(0 == uqi_record_average(m_db, txn, &field, &result));
+    REQUIRE(result.u.result_u64 == sum / count);
+    REQUIRE(0 == uqi_record_min(m_db, txn, &field, &result));
+    REQUIRE(result.u.result_u64 == min);
+    REQUIRE(0 == uqi_record_max(m_db, txn, &field, &result));
+    REQUIRE(result.u.result_u64 == max);
+
+    // the field must be inside the record
+    field.offset = record_size - 3;
+    REQUIRE(UPS_INV_PARAMETER == uqi_record_sum(m_db, txn, &field, &result));
+    field.offset = 0;
+    field.type = UPS_TYPE_BINARY;
+    REQUIRE(UPS_INV_PARAMETER == uqi_record_max(m_db, txn, &field, &result));
+    REQUIRE(UPS_INV_PARAMETER == uqi_record_sum(m_db, txn, 0, &result));
+
+    if (txn)
+      REQUIRE(0 == ups_txn_commit(txn, 0));
+  }
+
+  void recordCountIfTest(int count) {
+    uint64_t expected = 0;
+    for (int i = 0; i < count; i++) {
+      // records with different sizes; some of them are stored in blobs
+      uint32_t size = (i % 3 == 0) ? 100 : (i % 8) + 1;
+      std::vector<uint8_t> buffer(size, (uint8_t)i);
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t record = ups_make_record(&buffer[0], size);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+      if (i & 1)
+        expected++;
+    }
+
+    uqi_bool_predicate_t predicate;
+    predicate.context = 0;
+    predicate.predicate_func = record_count_if_predicate;
+    uqi_result_t result;
+    REQUIRE(0 == uqi_record_count_if(m_db, 0, &predicate, &result));
+    REQUIRE(result.u.result_u64 == expected);
+
+    // uqi_record_sum requires a fixed record size
+    uqi_record_field_t field = {UPS_TYPE_UINT8, 0};
+    REQUIRE(UPS_INV_PARAMETER == uqi_record_sum(m_db, 0, &field, &result));
+  }
+
+  void topKeysTest(int count) {
+    for (int i = 0; i < count; i++) {
+      REQUIRE(0 == insertTxn(0, i));
+      // a few duplicates, which are returned only once
+      if (i % 5 == 0)
+        REQUIRE(0 == insertRecord(0, i, 0, 4, 0, UPS_DUPLICATE));
+    }
+
+    uint32_t keys[20];
+    uint32_t n = 0;
+    REQUIRE(0 == uqi_top_keys(m_db, 0, 10, &keys[0], &n));
+    REQUIRE(n == 10u);
+    for (uint32_t i = 0; i < n; i++)
+      REQUIRE(keys[i] == count - 1 - i);
+
+    REQUIRE(0 == uqi_top_keys(m_db, 0, 0, &keys[0], &n));
+    REQUIRE(n == 0u);
+    REQUIRE(UPS_INV_PARAMETER == uqi_top_keys(m_db, 0, 10, 0, &n));
+  }
+
+  void topKeysSmallTest() {
+    for (int i = 0; i < 5; i++)
+      REQUIRE(0 == insertTxn(0, i * 10));
+
+    uint32_t keys[20];
+    uint32_t n = 0;
+    REQUIRE(0 == uqi_top_keys(m_db, 0, 20, &keys[0], &n));
+    REQUIRE(n == 5u);
+    for (uint32_t i = 0; i < n; i++)
+      REQUIRE(keys[i] == 40 - 10 * i);
+  }
+
+  void topRecordsTest(int count) {
+    const uint32_t record_size = 16;
+    const uint32_t offset = 4;
+    for (int i = 0; i < count; i++)
+      REQUIRE(0 == insertRecord(0, i, i % 100, record_size, offset));
+
+    // |count / 100| keys have the value 99; then the smallest keys with
+    // value 98
+    uint32_t per_value = count / 100;
+    uint32_t keys[15];
+    uint8_t records[15 * record_size];
+    uint32_t n = 0;
+    uqi_record_field_t field = {UPS_TYPE_UINT32, offset};
+    REQUIRE(0 == uqi_top_records(m_db, 0, &field, 15, &keys[0], &records[0],
+                            &n));
+    REQUIRE(n == 15u);
+    for (uint32_t i = 0; i < n; i++) {
+      uint32_t expected = i < per_value
+                            ? 99 + i * 100
+                            : 98 + (i - per_value) * 100;
+      REQUIRE(keys[i] == expected);
+      uint32_t value;
+      memcpy(&value, &records[i * record_size + offset], sizeof(value));
+      REQUIRE(value == expected % 100);
+    }
+
+    // only the keys
+    REQUIRE(0 == uqi_top_records(m_db, 0, &field, 3, &keys[0], 0, &n));
+    REQUIRE(n == 3u);
+    REQUIRE(keys[0] == 99u);
+    REQUIRE(keys[2] == 299u);
+  }
+
+  void groupByTest(int count) {
+    // key i has (i % 5) + 1 duplicates; the records are i * 10 + d.
+    // Some of them are inserted in a pending Transaction
+    ups_txn_t *txn = 0;
+    if (m_use_transactions)
+      REQUIRE(0 == ups_txn_begin(&txn, m_env, 0, 0, 0));
+    for (int i = 0; i < count; i++) {
+      for (int d = 0; d < (i % 5) + 1; d++)
+        REQUIRE(0 == insertRecord(i % 3 == 0 ? txn : 0, i, i * 10 + d,
+                                sizeof(uint32_t), 0, UPS_DUPLICATE));
+    }
+
+    const int aggregates[] = {UQI_AGGREGATE_COUNT, UQI_AGGREGATE_SUM,
+                              UQI_AGGREGATE_AVERAGE, UQI_AGGREGATE_MIN,
+                              UQI_AGGREGATE_MAX};
+    uqi_record_field_t field = {UPS_TYPE_UINT32, 0};
+    for (int a = 0; a < 5; a++) {
+      std::vector<std::pair<uint32_t, uint64_t> > groups;
+      REQUIRE(0 == uqi_record_group_by(m_db, txn, &field, aggregates[a],
+                              group_by_callback, &groups));
+      REQUIRE(groups.size() == (size_t)count);
+      for (int i = 0; i < count; i++) {
+        uint64_t n = (i % 5) + 1;
+        uint64_t first = i * 10;
+        uint64_t expected = 0;
+        switch (aggregates[a]) {
+          case UQI_AGGREGATE_COUNT:
+            expected = n;
+            break;
+          case UQI_AGGREGATE_SUM:
+            expected = n * first + n * (n - 1) / 2;
+            break;
+          case UQI_AGGREGATE_AVERAGE:
+            expected = (n * first + n * (n - 1) / 2) / n;
+            break;
+          case UQI_AGGREGATE_MIN:
+            expected = first;
+            break;
+          case UQI_AGGREGATE_MAX:
+            expected = first + n - 1;
+            break;
+        }
+        REQUIRE(groups[i].first == (uint32_t)i);
+        REQUIRE(groups[i].second == expected);
+      }
+    }
+
+    // COUNT does not need a field
+    std::vector<std::pair<uint32_t, uint64_t> > groups;
+    REQUIRE(0 == uqi_record_group_by(m_db, txn, 0, UQI_AGGREGATE_COUNT,
+                            group_by_callback, &groups));
+    REQUIRE(groups.size() == (size_t)count);
+    REQUIRE(UPS_INV_PARAMETER == uqi_record_group_by(m_db, txn, 0,
+                            UQI_AGGREGATE_SUM, group_by_callback, &groups));
+    REQUIRE(UPS_INV_PARAMETER == uqi_record_group_by(m_db, txn, &field, 99,
+                            group_by_callback, &groups));
+
+    if (txn)
+      REQUIRE(0 == ups_txn_commit(txn, 0));
+  }
 };
 
 TEST_CASE("Hola/sumTest", "")
@@ -450,4 +1034,146 @@ TEST_CASE("Hola/countDistinctIfTest", "")
   f.countIfTest(20);
 }
 
+TEST_CASE("Hola/sumIfBatchTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32);
+  f.sumIfBatchTest(10000);
+}
+
+TEST_CASE("Hola/averageIfBatchTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_REAL32);
+  f.averageIfBatchTest(20);
+}
+
+TEST_CASE("Hola/countIfBatchTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_BINARY);
+  f.countIfBatchTest(20);
+}
+
+TEST_CASE("Hola/minMaxTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32);
+  f.minMaxTest(10000);
+}
+
+TEST_CASE("Hola/minMaxRealTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_REAL64);
+  f.minMaxRealTest(5000);
+}
+
+TEST_CASE("Hola/countRangeTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT64);
+  f.countRangeTest(10000);
+}
+
+TEST_CASE("Hola/countRangeTxnTest", "")
+{
+  HolaFixture f(true, UPS_TYPE_UINT64);
+  f.countRangeTest(1000);
+}
+
+TEST_CASE("Hola/parallelScanTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, false, 4);
+  f.parallelScanTest(200000);
+}
+
+TEST_CASE("Hola/parallelScanTxnTest", "")
+{
+  HolaFixture f(true, UPS_TYPE_UINT32, false, 4);
+  f.parallelScanTxnTest(100000, 7919);
+}
+
+TEST_CASE("Hola/parallelScanTxnDenseTest", "")
+{
+  HolaFixture f(true, UPS_TYPE_UINT32, false, 4);
+  f.parallelScanTxnTest(100000, 997);
+}
+
+TEST_CASE("Hola/recordAggregateTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, false, 1, 16);
+  f.recordAggregateTest(20000, 16, 5);
+}
+
+TEST_CASE("Hola/recordAggregateSimdTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, false, 1, 4);
+  f.recordAggregateTest(20000, 4, 0);
+}
+
+TEST_CASE("Hola/recordAggregateTxnTest", "")
+{
+  HolaFixture f(true, UPS_TYPE_UINT32, false, 1, 16);
+  f.recordAggregateTest(20000, 16, 5);
+}
+
+TEST_CASE("Hola/recordAggregateParallelTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, false, 4, 16);
+  f.recordAggregateTest(200000, 16, 5);
+}
+
+TEST_CASE("Hola/recordAggregateDuplicateTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, true, 1, 16);
+  f.recordAggregateTest(20000, 16, 5);
+}
+
+TEST_CASE("Hola/recordCountIfTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32);
+  f.recordCountIfTest(10000);
+}
+
+TEST_CASE("Hola/topKeysTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, true);
+  f.topKeysTest(10000);
+}
+
+TEST_CASE("Hola/topKeysSmallTest", "")
+{
+  HolaFixture f(true, UPS_TYPE_UINT32);
+  f.topKeysSmallTest();
+}
+
+TEST_CASE("Hola/topRecordsTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, false, 1, 16);
+  f.topRecordsTest(1000);
+}
+
+TEST_CASE("Hola/topRecordsParallelTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, false, 4, 16);
+  f.topRecordsTest(100000);
+}
+
+TEST_CASE("Hola/groupByTest", "")
+{
+  HolaFixture f(false, UPS_TYPE_UINT32, true, 1, 4);
+  f.groupByTest(5000);
+}
+
+TEST_CASE("Hola/groupByTxnTest", "")
+{
+  HolaFixture f(true, UPS_TYPE_UINT32, true, 1, 4);
+  f.groupByTest(2000);
+}
+
+TEST_CASE("Hola/simdKernelTest", "")
+{
+  simdKernelTest<uint8_t, uint64_t>(1);
+  simdKernelTest<uint16_t, uint64_t>(1);
+  simdKernelTest<uint32_t, uint64_t>(1000);
+  simdKernelTest<uint64_t, uint64_t>(1000000);
+  simdKernelTest<float, double>(0.5f);
+  simdKernelTest<double, double>(0.25);
+}
+
 } // namespace upscaledb
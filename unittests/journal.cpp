@@ -15,8 +15,13 @@
  * See the file COPYING for License information.
  */
 
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+
 #include "3rdparty/catch/catch.hpp"
 
+#include "1base/mutex.h"
 #include "2lsn_manager/lsn_manager.h"
 #include "2lsn_manager/lsn_manager_test.h"
 #include "3journal/journal.h"
@@ -31,6 +36,24 @@ using namespace upscaledb;
 
 namespace upscaledb {
 
+static void
+group_committer(ups_env_t *env, ups_db_t *db, uint32_t first, uint32_t count,
+                boost::atomic<int> *errors)
+{
+  for (uint32_t i = first; i < first + count; i++) {
+    ups_txn_t *txn;
+    ups_key_t key = ups_make_key(&i, sizeof(i));
+    ups_record_t rec = ups_make_record(&i, sizeof(i));
+    if (0 != ups_txn_begin(&txn, env, 0, 0, 0)) {
+      (*errors)++;
+      continue;
+    }
+    if (0 != ups_db_insert(db, txn, &key, &rec, 0)
+        || 0 != ups_txn_commit(txn, 0))
+      (*errors)++;
+  }
+}
+
 struct LogEntry {
   LogEntry()
     : lsn(0), txn_id(0), type(0), dbname(0) {
@@ -1504,6 +1527,70 @@ struct JournalFixture {
 
     m_env = 0; // do not close again when tearing down
   }
+
+  void groupCommitTest() {
+    teardown();
+
+    ups_parameter_t bad_params[] = {
+        {UPS_PARAM_GROUP_COMMIT_WINDOW, 1000001},
+        {0, 0}
+    };
+    REQUIRE(UPS_INV_PARAMETER == ups_env_create(&m_env, Utils::opath(".test"),
+                UPS_ENABLE_TRANSACTIONS | UPS_ENABLE_FSYNC, 0644,
+                &bad_params[0]));
+
+    ups_parameter_t params[] = {
+        {UPS_PARAM_GROUP_COMMIT_WINDOW, 500},
+        {UPS_PARAM_GROUP_COMMIT_BYTES, 64 * 1024},
+        {0, 0}
+    };
+    REQUIRE(0 == ups_env_create(&m_env, Utils::opath(".test"),
+                UPS_ENABLE_TRANSACTIONS | UPS_ENABLE_FSYNC, 0644,
+                &params[0]));
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1, 0, 0));
+    m_lenv = (LocalEnvironment *)m_env;
+
+    ups_parameter_t query[] = {
+        {UPS_PARAM_GROUP_COMMIT_WINDOW, 0},
+        {UPS_PARAM_GROUP_COMMIT_BYTES, 0},
+        {0, 0}
+    };
+    REQUIRE(0 == ups_env_get_parameters(m_env, &query[0]));
+    REQUIRE(500u == query[0].value);
+    REQUIRE((uint64_t)(64 * 1024) == query[1].value);
+
+    const int num_threads = 4;
+    const uint32_t per_thread = 200;
+    boost::atomic<int> errors(0);
+    std::vector<Thread *> threads;
+    for (int i = 0; i < num_threads; i++)
+      threads.push_back(new Thread(boost::bind(&group_committer, m_env, m_db,
+                              i * per_thread, per_thread, &errors)));
+    for (int i = 0; i < num_threads; i++) {
+      threads[i]->join();
+      delete threads[i];
+    }
+    REQUIRE(0 == errors.load());
+
+    // all commits were synced
+    JournalState &state = m_lenv->journal()->m_state;
+    REQUIRE(state.write_seqnum > 0);
+    REQUIRE(state.durable_seqnum == state.write_seqnum);
+    REQUIRE(0 == m_lenv->journal()->unsynced_seqnum());
+
+    // reopen and verify the data
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"),
+                UPS_ENABLE_TRANSACTIONS | UPS_AUTO_RECOVERY, 0));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    for (uint32_t i = 0; i < num_threads * per_thread; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = {0};
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(rec.size == sizeof(i));
+      REQUIRE(*(uint32_t *)rec.data == i);
+    }
+  }
 };
 
 TEST_CASE("Journal/createCloseTest", "")
@@ -1686,5 +1773,11 @@ TEST_CASE("Journal/issue71Test", "")
   f.issue71Test();
 }
 
+TEST_CASE("Journal/groupCommitTest", "")
+{
+  JournalFixture f;
+  f.groupCommitTest();
+}
+
 } // namespace upscaledb
 
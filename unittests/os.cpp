@@ -120,6 +120,33 @@ TEST_CASE("OsTest/readWriteTest",
   }
 }
 
+TEST_CASE("OsTest/pwritevTest",
+           "Tests the operating system functions in os*")
+{
+  File f;
+  char data[100][128];
+  void *buffers[100];
+  size_t lengths[100];
+  char buffer[128], orig[128];
+
+  // more buffers than a single call to pwritev() accepts
+  for (int i = 0; i < 100; i++) {
+    memset(data[i], i, sizeof(data[i]));
+    buffers[i] = data[i];
+    lengths[i] = sizeof(data[i]);
+  }
+
+  f.create(Utils::opath(".test"), 0664);
+  f.pwritev(sizeof(buffer), buffers, lengths, 100);
+  REQUIRE((uint64_t)(101 * sizeof(buffer)) == f.get_file_size());
+  for (int i = 0; i < 100; i++) {
+    memset(orig, i, sizeof(orig));
+    memset(buffer, 0xff, sizeof(buffer));
+    f.pread((i + 1) * sizeof(buffer), buffer, sizeof(buffer));
+    REQUIRE(0 == memcmp(buffer, orig, sizeof(buffer)));
+  }
+}
+
 TEST_CASE("OsTest/mmapTest",
            "Tests the operating system functions in os*")
 {
@@ -15,8 +15,12 @@
  * See the file COPYING for License information.
  */
 
+#include <algorithm>
+
 #include "3rdparty/catch/catch.hpp"
 
+#include "ups/upscaledb_uqi.h"
+
 #include "utils.h"
 
 #include "1base/pickle.h"
@@ -25,7 +29,10 @@
 #include "3page_manager/freelist.h"
 #include "3page_manager/page_manager.h"
 #include "3page_manager/page_manager_test.h"
+#include "3btree/btree_node.h"
+#include "3cache/cache.h"
 #include "4context/context.h"
+#include "4cursor/cursor_local.h"
 #include "4env/env_local.h"
 #include "4txn/txn.h"
 
@@ -256,6 +263,270 @@ struct PageManagerFixture {
     REQUIRE(false == test.is_cache_full());
   }
 
+  void cachePolicyParameterTest() {
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    ups_parameter_t param[] = {
+      { UPS_PARAM_CACHE_POLICY, UPS_CACHE_POLICY_2Q },
+      { 0, 0 }
+    };
+    ups_parameter_t query[] = {
+      { UPS_PARAM_CACHE_POLICY, 0 },
+      { 0, 0 }
+    };
+
+    REQUIRE(0 ==
+        ups_env_create(&m_env, Utils::opath(".test"), 0, 0644, &param[0]));
+    REQUIRE(0 == ups_env_get_parameters(m_env, &query[0]));
+    REQUIRE(UPS_CACHE_POLICY_2Q == query[0].value);
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    // the policy is not persisted
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"), 0, 0));
+    REQUIRE(0 == ups_env_get_parameters(m_env, &query[0]));
+    REQUIRE(UPS_CACHE_POLICY_LRU == query[0].value);
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    param[0].value = 99;
+    REQUIRE(UPS_INV_PARAMETER ==
+        ups_env_open(&m_env, Utils::opath(".test"), 0, &param[0]));
+    REQUIRE(UPS_INV_PARAMETER ==
+        ups_env_create(&m_env, Utils::opath(".test"), 0, 0644, &param[0]));
+    m_env = 0;
+  }
+
+  // Fills a cache with a "hot" page per shard, then with a scan of
+  // new pages, and returns the number of hot pages selected for purging
+  int scanResistance(int policy) {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    EnvironmentConfiguration config;
+    config.page_size_bytes = 16 * 1024;
+    config.cache_size_bytes = 64 * config.page_size_bytes;
+    config.cache_policy = policy;
+    Cache cache(config);
+
+    PPageData pers;
+    memset(&pers, 0, sizeof(pers));
+    std::vector<Page *> hot;
+    std::vector<Page *> scan;
+
+    // 8 pages, one in each shard. Purging (and re-loading) them
+    // makes them "hot" with 2Q
+    for (int i = 1; i <= UPS_CACHE_SHARDS; i++) {
+      Page *p = new Page(lenv->device());
+      p->set_address(i * config.page_size_bytes);
+      p->set_data(&pers);
+      cache.put(p);
+      cache.del(p);
+      cache.put(p);
+      REQUIRE(p->get_cache_queue() == Page::kCacheQueueHot);
+      hot.push_back(p);
+    }
+
+    // now scan 200 new pages
+    for (int i = 1000; i < 1200; i++) {
+      Page *p = new Page(lenv->device());
+      p->set_address(i * config.page_size_bytes);
+      p->set_data(&pers);
+      cache.put(p);
+      scan.push_back(p);
+    }
+    REQUIRE(cache.is_cache_full());
+
+    std::vector<uint64_t> candidates;
+    std::vector<Page *> garbage;
+    cache.purge_candidates(candidates, garbage, 0);
+    REQUIRE(candidates.empty());
+    REQUIRE(!garbage.empty());
+
+    int purged_hot = 0;
+    for (size_t i = 0; i < garbage.size(); i++) {
+      if (std::find(hot.begin(), hot.end(), garbage[i]) != hot.end())
+        purged_hot++;
+    }
+
+    for (size_t i = 0; i < hot.size(); i++) {
+      cache.del(hot[i]);
+      hot[i]->set_data(0);
+      delete hot[i];
+    }
+    for (size_t i = 0; i < scan.size(); i++) {
+      cache.del(scan[i]);
+      scan[i]->set_data(0);
+      delete scan[i];
+    }
+    REQUIRE(0u == cache.current_elements());
+    return (purged_hot);
+  }
+
+  void cacheScanResistanceTest() {
+    // LRU purges the (older) hot pages, 2Q purges only the scanned pages
+    REQUIRE(UPS_CACHE_SHARDS == scanResistance(UPS_CACHE_POLICY_LRU));
+    REQUIRE(0 == scanResistance(UPS_CACHE_POLICY_2Q));
+  }
+
+  void cacheShardMetricsTest() {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    EnvironmentConfiguration config;
+    config.page_size_bytes = 16 * 1024;
+    Cache cache(config);
+
+    PPageData pers;
+    memset(&pers, 0, sizeof(pers));
+    Page *p = new Page(lenv->device());
+    p->set_address(3 * config.page_size_bytes);
+    p->set_data(&pers);
+    cache.put(p);
+
+    REQUIRE(p == cache.get(3 * config.page_size_bytes));
+    REQUIRE(p == cache.get(3 * config.page_size_bytes));
+    REQUIRE((Page *)0 == cache.get(5 * config.page_size_bytes));
+
+    ups_env_metrics_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    cache.fill_metrics(&metrics);
+    REQUIRE(2u == metrics.cache_hits);
+    REQUIRE(1u == metrics.cache_misses);
+    REQUIRE(2u == metrics.cache_shard_hits[3]);
+    REQUIRE(1u == metrics.cache_shard_misses[5]);
+    REQUIRE(0u == metrics.cache_shard_hits[5]);
+
+    cache.del(p);
+    p->set_data(0);
+    delete p;
+  }
+
+  void parallelFlushTest() {
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    ups_parameter_t param[] = {
+      { UPS_PARAM_FLUSH_THREADS, 4 },
+      { UPS_PARAM_CACHE_SIZE, 64 * UPS_DEFAULT_PAGE_SIZE },
+      { 0, 0 }
+    };
+    ups_parameter_t query[] = {
+      { UPS_PARAM_FLUSH_THREADS, 0 },
+      { 0, 0 }
+    };
+
+    REQUIRE(0 ==
+        ups_env_create(&m_env, Utils::opath(".test"),
+                UPS_ENABLE_TRANSACTIONS, 0644, &param[0]));
+    REQUIRE(0 == ups_env_get_parameters(m_env, &query[0]));
+    REQUIRE(4u == query[0].value);
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1, 0, 0));
+
+    // many inserts, big records: the changesets and the purged pages
+    // are flushed by multiple threads
+    char buffer[512] = {0};
+    for (int i = 0; i < 5000; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = ups_make_record(buffer, sizeof(buffer));
+      *(int *)buffer = i;
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    REQUIRE(0 ==
+        ups_env_open(&m_env, Utils::opath(".test"), 0, &param[0]));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    for (int i = 0; i < 5000; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = {0};
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(sizeof(buffer) == rec.size);
+      REQUIRE(i == *(int *)rec.data);
+    }
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    param[0].value = 0;
+    REQUIRE(UPS_INV_PARAMETER ==
+        ups_env_open(&m_env, Utils::opath(".test"), 0, &param[0]));
+    m_env = 0;
+  }
+
+  void readAheadTest() {
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    ups_parameter_t param[] = {
+      { UPS_PARAM_PAGE_SIZE, 1024 },
+      { UPS_PARAM_PREFETCH_PAGES, 8 },
+      { 0, 0 }
+    };
+    ups_parameter_t query[] = {
+      { UPS_PARAM_PREFETCH_PAGES, 0 },
+      { 0, 0 }
+    };
+
+    REQUIRE(0 ==
+        ups_env_create(&m_env, Utils::opath(".test"), 0, 0644, &param[0]));
+    REQUIRE(0 == ups_env_get_parameters(m_env, &query[0]));
+    REQUIRE(8u == query[0].value);
+    ups_parameter_t db_param[] = {
+      { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32 },
+      { 0, 0 }
+    };
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1, 0, &db_param[0]));
+    const int kMax = 20000;
+    for (int i = 0; i < kMax; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = ups_make_record(&i, sizeof(i));
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    // the cache is empty after re-opening; read ahead the leaves which
+    // follow the first leaf, then scan all keys with a cursor
+    REQUIRE(0 ==
+        ups_env_open(&m_env, Utils::opath(".test"), 0, &param[1]));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    ups_cursor_t *cursor;
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_FIRST));
+    Page *page;
+    ((LocalCursor *)cursor)->get_btree_cursor()->get_coupled_key(&page);
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    lenv->page_manager()->read_ahead((LocalDatabase *)m_db,
+                    PBtreeNode::from_page(page)->get_right());
+
+    ups_env_metrics_t metrics;
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE(8u == metrics.page_count_prefetched);
+    REQUIRE(0u == metrics.prefetch_hits);
+
+    for (int i = 1; i < kMax; i++) {
+      REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT));
+      REQUIRE(i == *(int *)key.data);
+      REQUIRE(i == *(int *)rec.data);
+    }
+    REQUIRE(UPS_KEY_NOT_FOUND ==
+        ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT));
+    REQUIRE(0 == ups_cursor_close(cursor));
+
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.prefetch_hits >= 8u);
+    REQUIRE(metrics.prefetch_hits <= metrics.page_count_prefetched);
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    // same for a full scan of a UQI query; the database is closed
+    // while pages are still read ahead
+    REQUIRE(0 ==
+        ups_env_open(&m_env, Utils::opath(".test"), 0, &param[1]));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    uqi_result_t result;
+    REQUIRE(0 == uqi_count(m_db, 0, &result));
+    REQUIRE((uint64_t)kMax == result.u.result_u64);
+    REQUIRE(0 == ups_db_close(m_db, 0));
+    REQUIRE(0 == ups_env_close(m_env, 0));
+
+    param[1].value = 2000;
+    REQUIRE(UPS_INV_PARAMETER ==
+        ups_env_open(&m_env, Utils::opath(".test"), 0, &param[1]));
+    m_env = 0;
+  }
+
   void storeStateTest() {
     LocalEnvironment *lenv = (LocalEnvironment *)m_env;
     PageManagerTest test = lenv->page_manager()->test();
@@ -513,6 +784,36 @@ TEST_CASE("PageManager/cacheFullTest", "")
   f.cacheFullTest();
 }
 
+TEST_CASE("PageManager/cachePolicyParameterTest", "")
+{
+  PageManagerFixture f;
+  f.cachePolicyParameterTest();
+}
+
+TEST_CASE("PageManager/cacheScanResistanceTest", "")
+{
+  PageManagerFixture f;
+  f.cacheScanResistanceTest();
+}
+
+TEST_CASE("PageManager/cacheShardMetricsTest", "")
+{
+  PageManagerFixture f;
+  f.cacheShardMetricsTest();
+}
+
+TEST_CASE("PageManager/parallelFlushTest", "")
+{
+  PageManagerFixture f;
+  f.parallelFlushTest();
+}
+
+TEST_CASE("PageManager/readAheadTest", "")
+{
+  PageManagerFixture f;
+  f.readAheadTest();
+}
+
 TEST_CASE("PageManager/storeStateTest", "")
 {
   PageManagerFixture f(false, 16 * UPS_DEFAULT_PAGE_SIZE);
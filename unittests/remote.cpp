@@ -17,6 +17,9 @@
 
 #ifdef UPS_ENABLE_REMOTE
 
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include <ups/upscaledb_srv.h>
@@ -30,16 +33,38 @@ using namespace upscaledb;
 
 #define SERVER_URL "ups://localhost:8989/test.db"
 
+// collects the results of the asynchronous operations
+struct AsyncResults {
+  std::vector<ups_status_t> status;
+  std::vector<uint32_t> keys;
+  std::vector<uint32_t> records;
+};
+
+static void UPS_CALLCONV
+async_callback(ups_db_t *db, ups_status_t status, ups_key_t *key,
+      ups_record_t *record, void *context)
+{
+  AsyncResults *results = (AsyncResults *)context;
+  results->status.push_back(status);
+  results->keys.push_back(key->size == sizeof(uint32_t)
+                              ? *(uint32_t *)key->data
+                              : 0xffffffff);
+  results->records.push_back(record && record->size == sizeof(uint32_t)
+                              ? *(uint32_t *)record->data
+                              : 0xffffffff);
+}
+
 struct RemoteFixture {
   ups_env_t *m_env;
   ups_db_t *m_db;
   ups_srv_t *m_srv;
 
-  RemoteFixture()
+  RemoteFixture(uint32_t num_threads = 0)
     : m_env(0), m_db(0), m_srv(0) {
     ups_srv_config_t cfg;
     memset(&cfg, 0, sizeof(cfg));
     cfg.port = 8989;
+    cfg.num_threads = num_threads;
 
     REQUIRE(0 == ups_env_create(&m_env, "test.db",
             UPS_ENABLE_TRANSACTIONS, 0644, 0));
@@ -1198,6 +1223,229 @@ struct RemoteFixture {
     REQUIRE(UPS_IO_ERROR == ups_env_create(&env,
                 SERVER_URL, 0, 0664, &params[0]));
   }
+
+  // Connects to the server, then inserts, looks up and erases keys which
+  // are unique for |id|. Catch is not thread-safe; failures are counted
+  // in |errors|.
+  static void clientThread(int id, boost::atomic<int> *errors) {
+    ups_env_t *env;
+    ups_db_t *db;
+    ups_txn_t *txn;
+
+    if (ups_env_open(&env, SERVER_URL, 0, 0)) {
+      (*errors)++;
+      return;
+    }
+    if (ups_env_open_db(env, &db, 55, 0, 0)) {
+      (*errors)++;
+      ups_env_close(env, 0);
+      return;
+    }
+
+    for (uint32_t i = 0; i < 200; i++) {
+      uint32_t k = id * 1000 + i;
+      ups_key_t key = ups_make_key(&k, sizeof(k));
+      ups_record_t rec = ups_make_record(&k, sizeof(k));
+      ups_record_t rec2 = {0};
+
+      // each request is answered before the next one is sent; a reply
+      // which belongs to another request would not match
+      if (ups_txn_begin(&txn, env, 0, 0, 0)) {
+        (*errors)++;
+        continue;
+      }
+      if (ups_db_insert(db, txn, &key, &rec, 0))
+        (*errors)++;
+      if (ups_db_find(db, txn, &key, &rec2, 0)
+          || rec2.size != sizeof(k)
+          || *(uint32_t *)rec2.data != k)
+        (*errors)++;
+      if (ups_db_erase(db, txn, &key, 0))
+        (*errors)++;
+      if (ups_txn_commit(txn, 0))
+        (*errors)++;
+    }
+
+    if (ups_env_close(env, UPS_AUTO_CLEANUP))
+      (*errors)++;
+  }
+
+  void asyncTest() {
+    ups_env_t *env;
+    ups_db_t *db;
+    ups_db_t *recnodb;
+
+    REQUIRE(0 == ups_env_open(&env, SERVER_URL, 0, 0));
+    REQUIRE(0 == ups_env_open_db(env, &db, 55, 0, 0));
+    REQUIRE(0 == ups_env_open_db(env, &recnodb, 34, 0, 0));
+
+    // more requests than fit into the window
+    const uint32_t kCount = 3000;
+    AsyncResults results;
+    for (uint32_t i = 0; i < kCount; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = ups_make_record(&i, sizeof(i));
+      REQUIRE(0 == ups_db_insert_async(db, 0, &key, &rec, 0,
+                              async_callback, &results));
+    }
+    REQUIRE(0 == ups_env_wait_async(env));
+    REQUIRE(results.status.size() == kCount);
+    for (uint32_t i = 0; i < kCount; i++) {
+      REQUIRE(results.status[i] == 0);
+      REQUIRE(results.keys[i] == i);
+    }
+
+    // synchronous requests first complete the pending ones
+    results = AsyncResults();
+    for (uint32_t i = 0; i < kCount; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      REQUIRE(0 == ups_db_find_async(db, 0, &key, 0,
+                              async_callback, &results));
+    }
+    uint32_t value = kCount;
+    ups_key_t key = ups_make_key(&value, sizeof(value));
+    ups_record_t rec = {0};
+    REQUIRE(UPS_KEY_NOT_FOUND == ups_db_find(db, 0, &key, &rec, 0));
+    REQUIRE(results.status.size() == kCount);
+    for (uint32_t i = 0; i < kCount; i++) {
+      REQUIRE(results.status[i] == 0);
+      REQUIRE(results.keys[i] == i);
+      REQUIRE(results.records[i] == i);
+    }
+
+    // erase all keys; the second erase fails
+    results = AsyncResults();
+    for (uint32_t i = 0; i < kCount; i++) {
+      key = ups_make_key(&i, sizeof(i));
+      REQUIRE(0 == ups_db_erase_async(db, 0, &key, 0,
+                              async_callback, &results));
+    }
+    key = ups_make_key(&value, sizeof(value));
+    REQUIRE(0 == ups_db_erase_async(db, 0, &key, 0,
+                            async_callback, &results));
+    REQUIRE(0 == ups_env_wait_async(env));
+    REQUIRE(results.status.size() == kCount + 1);
+    for (uint32_t i = 0; i < kCount; i++)
+      REQUIRE(results.status[i] == 0);
+    REQUIRE(results.status[kCount] == UPS_KEY_NOT_FOUND);
+
+    // record number databases return the generated key
+    results = AsyncResults();
+    for (uint32_t i = 0; i < 10; i++) {
+      key = ups_make_key(0, 0);
+      rec = ups_make_record(&i, sizeof(i));
+      REQUIRE(0 == ups_db_insert_async(recnodb, 0, &key, &rec, 0,
+                              async_callback, &results));
+    }
+    REQUIRE(0 == ups_db_close(recnodb, 0));
+    REQUIRE(results.status.size() == 10u);
+    for (uint32_t i = 0; i < 10; i++) {
+      REQUIRE(results.status[i] == 0);
+      REQUIRE(results.keys[i] == i + 1);
+    }
+
+    REQUIRE(0 == ups_db_close(db, 0));
+    REQUIRE(0 == ups_env_close(env, 0));
+  }
+
+  void cursorBatchTest() {
+    ups_env_t *env;
+    ups_db_t *db;
+    ups_cursor_t *cursor;
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    char buffer[16];
+
+    REQUIRE(0 == ups_env_open(&env, SERVER_URL, 0, 0));
+    REQUIRE(0 == ups_env_open_db(env, &db, 55, 0, 0));
+
+    const int kCount = 5000;
+    for (int i = 0; i < kCount; i++) {
+      ::sprintf(buffer, "%08d", i);
+      key = ups_make_key(buffer, 9);
+      rec = ups_make_record(&i, sizeof(i));
+      REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+    }
+
+    // scan forward and backward
+    REQUIRE(0 == ups_cursor_create(&cursor, db, 0, 0));
+    int i = 0;
+    while (0 == ups_cursor_move(cursor, &key, &rec,
+                i == 0 ? UPS_CURSOR_FIRST : UPS_CURSOR_NEXT)) {
+      ::sprintf(buffer, "%08d", i);
+      REQUIRE(0 == ::strcmp(buffer, (char *)key.data));
+      REQUIRE(i == *(int *)rec.data);
+      i++;
+    }
+    REQUIRE(i == kCount);
+    // the cursor still points to the last key
+    REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, 0));
+    REQUIRE(*(int *)rec.data == kCount - 1);
+
+    i = kCount - 1;
+    REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_LAST));
+    while (0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_PREVIOUS)) {
+      i--;
+      REQUIRE(i == *(int *)rec.data);
+    }
+    REQUIRE(i == 0);
+
+    // other operations see the position which was returned most recently
+    for (i = 0; i < 100; i++)
+      REQUIRE(0 == ups_cursor_move(cursor, &key, &rec,
+                  i == 0 ? UPS_CURSOR_FIRST : UPS_CURSOR_NEXT));
+    REQUIRE(99 == *(int *)rec.data);
+    uint64_t size;
+    REQUIRE(0 == ups_cursor_get_record_size(cursor, &size));
+    REQUIRE((uint64_t)sizeof(int) == size);
+    int value = -1;
+    rec = ups_make_record(&value, sizeof(value));
+    REQUIRE(0 == ups_cursor_overwrite(cursor, &rec, 0));
+    REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, 0));
+    REQUIRE(0 == ::strcmp("00000099", (char *)key.data));
+    REQUIRE(-1 == *(int *)rec.data);
+    REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_PREVIOUS));
+    REQUIRE(98 == *(int *)rec.data);
+
+    // changes of the Database are visible to a running scan
+    for (i = 0; i < 100; i++)
+      REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT));
+    REQUIRE(0 == ::strcmp("00000198", (char *)key.data));
+    ::sprintf(buffer, "%08d", 199);
+    key = ups_make_key(buffer, 9);
+    REQUIRE(0 == ups_db_erase(db, 0, &key, 0));
+    REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT));
+    REQUIRE(0 == ::strcmp("00000200", (char *)key.data));
+
+    // cursor erase removes the current key
+    REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT));
+    REQUIRE(0 == ups_cursor_erase(cursor, 0));
+    ::sprintf(buffer, "%08d", 201);
+    key = ups_make_key(buffer, 9);
+    REQUIRE(UPS_KEY_NOT_FOUND == ups_db_find(db, 0, &key, &rec, 0));
+
+    REQUIRE(0 == ups_cursor_close(cursor));
+    REQUIRE(0 == ups_db_close(db, 0));
+    REQUIRE(0 == ups_env_close(env, 0));
+  }
+
+  void multiThreadedServerTest() {
+    boost::atomic<int> errors(0);
+    std::vector<boost::thread *> threads;
+    for (int i = 0; i < 8; i++)
+      threads.push_back(new boost::thread(clientThread, i, &errors));
+    for (int i = 0; i < 8; i++) {
+      threads[i]->join();
+      delete threads[i];
+    }
+    REQUIRE(0 == errors.load());
+
+    uint64_t count;
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 55, 0, 0));
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &count));
+    REQUIRE(0ull == count);
+    REQUIRE(0 == ups_db_close(m_db, 0));
+  }
 };
 
 TEST_CASE("Remote/invalidUrlTest", "")
@@ -1476,4 +1724,22 @@ TEST_CASE("Remote/cursorApproxMatchTest", "")
   f.cursorApproxMatchTest();
 }
 
+TEST_CASE("Remote/asyncTest", "")
+{
+  RemoteFixture f;
+  f.asyncTest();
+}
+
+TEST_CASE("Remote/cursorBatchTest", "")
+{
+  RemoteFixture f;
+  f.cursorBatchTest();
+}
+
+TEST_CASE("Remote/multiThreadedServerTest", "")
+{
+  RemoteFixture f(4);
+  f.multiThreadedServerTest();
+}
+
 #endif // UPS_ENABLE_REMOTE
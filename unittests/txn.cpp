@@ -17,6 +17,9 @@
 
 #include "3rdparty/catch/catch.hpp"
 
+#include <vector>
+#include <algorithm>
+
 #include <ups/upscaledb.h>
 
 #include "1base/error.h"
@@ -205,6 +208,88 @@ struct TxnFixture {
     REQUIRE(0 == ups_txn_commit(txn, 0));
   }
 
+  void txnIndexOrderTest() {
+    const int kCount = 1000;
+    char data[kCount][8];
+    ups_key_t keys[kCount];
+    TransactionNode *nodes[kCount];
+    TransactionIndex *index = m_dbp->txn_index();
+
+    // store the even keys in random order
+    for (int i = 0; i < kCount; i++) {
+      ::sprintf(data[i], "%06d", i * 2);
+      ::memset(&keys[i], 0, sizeof(keys[i]));
+      keys[i].data = &data[i][0];
+      keys[i].size = 7;
+    }
+    std::vector<int> order;
+    for (int i = 0; i < kCount; i++)
+      order.push_back(i);
+    std::random_shuffle(order.begin(), order.end());
+    for (int i = 0; i < kCount; i++) {
+      bool created = false;
+      nodes[order[i]] = index->get_or_create(&keys[order[i]], &created);
+      REQUIRE(created == true);
+    }
+    bool created = true;
+    REQUIRE(nodes[5] == index->get_or_create(&keys[5], &created));
+    REQUIRE(created == false);
+
+    // the nodes are sorted
+    TransactionNode *node = index->get_first();
+    for (int i = 0; i < kCount; i++) {
+      REQUIRE(node == nodes[i]);
+      REQUIRE(node->get_previous_sibling() == (i > 0 ? nodes[i - 1] : 0));
+      node = node->get_next_sibling();
+    }
+    REQUIRE(node == (TransactionNode *)0);
+    REQUIRE(index->get_last() == nodes[kCount - 1]);
+
+    // approximate matching
+    char buf[8];
+    ups_key_t key = {0};
+    key.data = &buf[0];
+    key.size = 7;
+    ::sprintf(buf, "%06d", 11);
+    REQUIRE(index->get(&key, 0) == (TransactionNode *)0);
+    REQUIRE(index->get(&key, UPS_FIND_LT_MATCH) == nodes[5]);
+    REQUIRE(index->get(&key, UPS_FIND_GT_MATCH) == nodes[6]);
+    REQUIRE(index->get(&key, UPS_FIND_LEQ_MATCH) == nodes[5]);
+    REQUIRE(index->get(&key, UPS_FIND_GEQ_MATCH) == nodes[6]);
+    ::sprintf(buf, "%06d", 12);
+    REQUIRE(index->get(&key, 0) == nodes[6]);
+    REQUIRE(index->get(&key, UPS_FIND_LT_MATCH) == nodes[5]);
+    REQUIRE(index->get(&key, UPS_FIND_GT_MATCH) == nodes[7]);
+    REQUIRE(index->get(&key, UPS_FIND_LEQ_MATCH) == nodes[6]);
+    REQUIRE(index->get(&key, UPS_FIND_GEQ_MATCH) == nodes[6]);
+    ::sprintf(buf, "%06d", kCount * 2);
+    REQUIRE(index->get(&key, UPS_FIND_LT_MATCH) == nodes[kCount - 1]);
+    REQUIRE(index->get(&key, UPS_FIND_GT_MATCH) == (TransactionNode *)0);
+    ::sprintf(buf, "%06d", 0);
+    REQUIRE(index->get(&key, UPS_FIND_LT_MATCH) == (TransactionNode *)0);
+
+    // remove every other node, then all remaining ones
+    for (int i = 0; i < kCount; i += 2) {
+      index->remove(nodes[i]);
+      delete nodes[i];
+    }
+    node = index->get_first();
+    for (int i = 1; i < kCount; i += 2) {
+      REQUIRE(node == nodes[i]);
+      REQUIRE(index->get(&keys[i], 0) == nodes[i]);
+      REQUIRE(index->get(&keys[i - 1], 0) == (TransactionNode *)0);
+      node = node->get_next_sibling();
+    }
+    REQUIRE(node == (TransactionNode *)0);
+    for (int i = kCount - 1; i > 0; i -= 2) {
+      REQUIRE(index->get_last() == nodes[i]);
+      index->remove(nodes[i]);
+      delete nodes[i];
+    }
+    REQUIRE(index->get_first() == (TransactionNode *)0);
+    REQUIRE(index->get_last() == (TransactionNode *)0);
+  }
+
   void txnMultipleOpsTest() {
     ups_txn_t *txn;
     TransactionNode *node;
@@ -622,6 +707,12 @@ TEST_CASE("Txn/txnMultipleNodesTest", "")
   f.txnMultipleNodesTest();
 }
 
+TEST_CASE("Txn/txnIndexOrderTest", "")
+{
+  TxnFixture f;
+  f.txnIndexOrderTest();
+}
+
 TEST_CASE("Txn/txnMultipleOpsTest", "")
 {
   TxnFixture f;
@@ -1175,6 +1266,126 @@ struct HighLevelTxnFixture {
     REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
     m_env = 0;
   }
+
+  void readOnlySnapshotTest() {
+    ups_txn_t *writer, *reader;
+    uint64_t count;
+
+    REQUIRE(0 ==
+        ups_env_create(&m_env, Utils::opath(".test"),
+          UPS_ENABLE_TRANSACTIONS, 0644, 0));
+    REQUIRE(0 ==
+        ups_env_create_db(m_env, &m_db, 1, 0, 0));
+
+    REQUIRE(0 == insert(0, "key1", "rec1", 0));
+
+    /* an active txn does not conflict with the snapshot */
+    REQUIRE(0 == ups_txn_begin(&writer, m_env, 0, 0, 0));
+    REQUIRE(0 == insert(writer, "key2", "rec2", 0));
+    REQUIRE(0 == ups_txn_begin(&reader, m_env, 0, 0, UPS_TXN_READ_ONLY));
+    REQUIRE(UPS_TXN_CONFLICT == find(0, "key2", "rec2"));
+    REQUIRE(UPS_KEY_NOT_FOUND == find(reader, "key2", "rec2"));
+
+    /* changes which are committed later are invisible */
+    REQUIRE(0 == ups_txn_commit(writer, 0));
+    REQUIRE(0 == insert(0, "key1", "rec3", UPS_OVERWRITE));
+    REQUIRE(0 == insert(0, "key3", "rec3", 0));
+    REQUIRE(0 == find(0, "key2", "rec2"));
+    REQUIRE(0 == find(0, "key1", "rec3"));
+    REQUIRE(UPS_KEY_NOT_FOUND == find(reader, "key2", "rec2"));
+    REQUIRE(UPS_KEY_NOT_FOUND == find(reader, "key3", "rec3"));
+    REQUIRE(0 == find(reader, "key1", "rec1"));
+    REQUIRE(0 == ups_db_count(m_db, reader, 0, &count));
+    REQUIRE(1ull == count);
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &count));
+    REQUIRE(3ull == count);
+
+    ups_key_t key = {0};
+    key.data = (void *)"key1";
+    key.size = 5;
+    REQUIRE(0 == ups_db_erase(m_db, 0, &key, 0));
+    REQUIRE(0 == find(reader, "key1", "rec1"));
+
+    /* a read-only txn cannot modify the database */
+    REQUIRE(UPS_WRITE_PROTECTED == insert(reader, "key4", "rec4", 0));
+    REQUIRE(UPS_WRITE_PROTECTED == ups_db_erase(m_db, reader, &key, 0));
+    REQUIRE(0 == ups_txn_commit(reader, 0));
+
+    /* the deferred transactions are flushed when the snapshot is gone */
+    REQUIRE(0 == insert(0, "key5", "rec5", 0));
+    REQUIRE((Transaction *)0 ==
+          ((LocalEnvironment *)m_env)->txn_manager()->get_oldest_txn());
+
+    teardown();
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"),
+                    UPS_ENABLE_TRANSACTIONS, 0));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    REQUIRE(UPS_KEY_NOT_FOUND == find(0, "key1", "rec1"));
+    REQUIRE(0 == find(0, "key2", "rec2"));
+    REQUIRE(0 == find(0, "key3", "rec3"));
+    REQUIRE(0 == find(0, "key5", "rec5"));
+  }
+
+  void readOnlyCursorTest() {
+    ups_txn_t *writer, *reader;
+    ups_cursor_t *cursor;
+    ups_parameter_t params[] = {
+        {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+        {0, 0}
+    };
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    uint64_t count;
+
+    REQUIRE(0 ==
+        ups_env_create(&m_env, Utils::opath(".test"),
+          UPS_ENABLE_TRANSACTIONS, 0644, 0));
+    REQUIRE(0 ==
+        ups_env_create_db(m_env, &m_db, 1, 0, &params[0]));
+
+    for (uint32_t i = 0; i < 20; i += 2) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+
+    REQUIRE(0 == ups_txn_begin(&writer, m_env, 0, 0, 0));
+    REQUIRE(0 == ups_txn_begin(&reader, m_env, 0, 0, UPS_TXN_READ_ONLY));
+
+    /* modify the database in an active and in committed transactions */
+    for (uint32_t i = 1; i < 20; i += 2) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ups_db_insert(m_db, i < 10 ? writer : 0, &key, &rec, 0));
+    }
+    uint32_t erased = 4;
+    key.data = &erased;
+    key.size = sizeof(erased);
+    REQUIRE(0 == ups_db_erase(m_db, 0, &key, 0));
+
+    /* the reader still sees the even keys, without conflicts */
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, reader, 0));
+    uint32_t expected = 0;
+    while (0 == ups_cursor_move(cursor, &key, 0, UPS_CURSOR_NEXT)) {
+      REQUIRE(expected == *(uint32_t *)key.data);
+      expected += 2;
+    }
+    REQUIRE(20u == expected);
+    REQUIRE(0 == ups_cursor_move(cursor, &key, 0, UPS_CURSOR_LAST));
+    do {
+      expected -= 2;
+      REQUIRE(expected == *(uint32_t *)key.data);
+    } while (0 == ups_cursor_move(cursor, &key, 0, UPS_CURSOR_PREVIOUS));
+    REQUIRE(0u == expected);
+    REQUIRE(0 == ups_cursor_close(cursor));
+    REQUIRE(0 == ups_db_count(m_db, reader, 0, &count));
+    REQUIRE(10ull == count);
+
+    REQUIRE(0 == ups_txn_commit(writer, 0));
+    REQUIRE(0 == ups_txn_commit(reader, 0));
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &count));
+    REQUIRE(19ull == count);
+  }
 };
 
 TEST_CASE("Txn-high/noPersistentDatabaseFlagTest", "")
@@ -1268,6 +1479,18 @@ TEST_CASE("Txn-high/insertTransactionsWithDelay", "")
     f.insertTransactionsWithDelay(i);
 }
 
+TEST_CASE("Txn-high/readOnlySnapshotTest", "")
+{
+  HighLevelTxnFixture f;
+  f.readOnlySnapshotTest();
+}
+
+TEST_CASE("Txn-high/readOnlyCursorTest", "")
+{
+  HighLevelTxnFixture f;
+  f.readOnlyCursorTest();
+}
+
 
 struct InMemoryTxnFixture {
   ups_db_t *m_db;
@@ -15,8 +15,12 @@
  * See the file COPYING for License information.
  */
 
+#include <vector>
+#include <boost/bind.hpp>
+
 #include "3rdparty/catch/catch.hpp"
 
+#include "1base/mutex.h"
 #include "1os/file.h"
 #include "1errorinducer/errorinducer.h"
 #include "2page/page.h"
@@ -62,6 +66,57 @@ struct my_rec_t {
   uint32_t val2[15];
 };
 
+static void
+concurrent_reader(ups_db_t *db, int max_keys, boost::atomic<int> *errors)
+{
+  for (uint32_t i = 0; i < (uint32_t)max_keys; i++) {
+    ups_key_t key = ups_make_key(&i, sizeof(i));
+    ups_record_t rec = {0};
+    if (0 != ups_db_find(db, 0, &key, &rec, 0)
+        || rec.size != sizeof(i) || *(uint32_t *)rec.data != i)
+      (*errors)++;
+  }
+
+  ups_cursor_t *cursor;
+  if (0 != ups_cursor_create(&cursor, db, 0, 0)) {
+    (*errors)++;
+    return;
+  }
+  ups_key_t key = {0};
+  ups_record_t rec = {0};
+  int count = 0;
+  while (0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT)) {
+    if (*(uint32_t *)key.data != (uint32_t)count
+        || *(uint32_t *)rec.data != (uint32_t)count)
+      (*errors)++;
+    count++;
+  }
+  if (count != max_keys)
+    (*errors)++;
+  ups_cursor_close(cursor);
+}
+
+// collects the results of the asynchronous operations
+struct AsyncResults {
+  std::vector<ups_status_t> status;
+  std::vector<uint32_t> keys;
+  std::vector<uint32_t> records;
+};
+
+static void UPS_CALLCONV
+async_callback(ups_db_t *db, ups_status_t status, ups_key_t *key,
+      ups_record_t *record, void *context)
+{
+  AsyncResults *results = (AsyncResults *)context;
+  results->status.push_back(status);
+  results->keys.push_back(key->size == sizeof(uint32_t)
+                              ? *(uint32_t *)key->data
+                              : 0xffffffff);
+  results->records.push_back(record && record->size == sizeof(uint32_t)
+                              ? *(uint32_t *)record->data
+                              : 0xffffffff);
+}
+
 struct UpscaledbFixture {
   ups_db_t *m_db;
   ups_env_t *m_env;
@@ -2233,6 +2288,53 @@ struct UpscaledbFixture {
     REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP | UPS_TXN_AUTO_ABORT));
   }
 
+  void concurrentReadsTest() {
+    ups_env_t *env;
+    ups_db_t *db;
+    ups_parameter_t env_params[] = {
+        {UPS_PARAM_CACHE_SIZE, 64 * 1024},
+        {0, 0}
+    };
+    ups_parameter_t db_params[] = {
+        {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+        {UPS_PARAM_RECORD_SIZE, sizeof(uint32_t)},
+        {0, 0}
+    };
+    const int max_keys = 20000;
+
+    REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"),
+                        UPS_ENABLE_CONCURRENT_READS, 0, &env_params[0]));
+    REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &db_params[0]));
+    REQUIRE(true == ((Database *)db)->supports_concurrent_reads());
+
+    for (uint32_t i = 0; i < (uint32_t)max_keys; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = ups_make_record(&i, sizeof(i));
+      REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+    }
+
+    boost::atomic<int> errors(0);
+    std::vector<Thread *> threads;
+    for (int i = 0; i < 4; i++)
+      threads.push_back(new Thread(boost::bind(&concurrent_reader,
+                              db, max_keys, &errors)));
+    for (int i = 0; i < 4; i++) {
+      threads[i]->join();
+      delete threads[i];
+    }
+    REQUIRE(0 == errors.load());
+
+    REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+
+    // Transactions disable the concurrent read path
+    REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"),
+                        UPS_ENABLE_CONCURRENT_READS | UPS_ENABLE_TRANSACTIONS,
+                        0, 0));
+    REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &db_params[0]));
+    REQUIRE(false == ((Database *)db)->supports_concurrent_reads());
+    REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+  }
+
   void issue47Test() {
     ups_env_t *env;
     ups_db_t *db;
@@ -2262,6 +2364,187 @@ struct UpscaledbFixture {
 
     REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP | UPS_TXN_AUTO_ABORT));
   }
+
+  void batchTest(uint32_t env_flags) {
+    ups_env_t *env;
+    ups_db_t *db;
+    ups_parameter_t params[] = {
+        {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+        {0, 0}
+    };
+
+    REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"),
+                        env_flags, 0, 0));
+    REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+    const uint32_t kCount = 10000;
+    std::vector<uint32_t> values(kCount);
+    std::vector<ups_key_t> keys(kCount);
+    std::vector<ups_record_t> records(kCount);
+    std::vector<ups_status_t> results(kCount);
+
+    // insert sorted keys; every 10th key is inserted twice
+    for (uint32_t i = 0; i < kCount; i++) {
+      values[i] = (i % 10 == 9) ? i - 1 : i;
+      keys[i] = ups_make_key(&values[i], sizeof(values[i]));
+      records[i] = ups_make_record(&values[i], sizeof(values[i]));
+    }
+    REQUIRE(0 == ups_db_insert_many(db, 0, &keys[0], &records[0], kCount,
+                            &results[0], 0));
+    for (uint32_t i = 0; i < kCount; i++)
+      REQUIRE(results[i] == (i % 10 == 9 ? UPS_DUPLICATE_KEY : 0));
+
+    uint64_t count;
+    REQUIRE(0 == ups_db_count(db, 0, 0, &count));
+    REQUIRE(count == (uint64_t)(kCount - kCount / 10));
+
+    // look up the keys in reverse order; every 10th key is missing
+    for (uint32_t i = 0; i < kCount; i++) {
+      values[i] = kCount - i - 1;
+      keys[i] = ups_make_key(&values[i], sizeof(values[i]));
+      ::memset(&records[i], 0, sizeof(records[i]));
+    }
+    REQUIRE(0 == ups_db_find_many(db, 0, &keys[0], &records[0], kCount,
+                            &results[0], 0));
+    for (uint32_t i = 0; i < kCount; i++) {
+      if (values[i] % 10 == 9) {
+        REQUIRE(results[i] == UPS_KEY_NOT_FOUND);
+        continue;
+      }
+      REQUIRE(results[i] == 0);
+      REQUIRE(records[i].size == sizeof(uint32_t));
+      REQUIRE(*(uint32_t *)records[i].data == values[i]);
+    }
+
+    // erase the even keys
+    for (uint32_t i = 0; i < kCount; i++)
+      values[i] = i * 2;
+    REQUIRE(0 == ups_db_erase_many(db, 0, &keys[0], kCount, &results[0], 0));
+    for (uint32_t i = 0; i < kCount; i++)
+      REQUIRE(results[i] == (i * 2 < kCount && (i * 2) % 10 != 9
+                                ? 0
+                                : UPS_KEY_NOT_FOUND));
+
+    for (uint32_t i = 0; i < kCount; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = {0};
+      REQUIRE(ups_db_find(db, 0, &key, &rec, 0)
+                      == (i % 2 == 1 && i % 10 != 9 ? 0 : UPS_KEY_NOT_FOUND));
+    }
+
+    // invalid parameters are rejected for the whole batch
+    REQUIRE(UPS_INV_PARAMETER == ups_db_insert_many(db, 0, &keys[0],
+                            &records[0], kCount, 0, 0));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_find_many(db, 0, &keys[0],
+                            &records[0], kCount, &results[0],
+                            UPS_FIND_LT_MATCH));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_erase_many(db, 0, 0, kCount,
+                            &results[0], 0));
+    REQUIRE(0 == ups_db_find_many(db, 0, 0, 0, 0, &results[0], 0));
+
+    REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+  }
+
+  void asyncTest() {
+    ups_parameter_t params[] = {
+        {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+        {0, 0}
+    };
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 3, 0, &params[0]));
+
+    const uint32_t kCount = 100;
+    AsyncResults results;
+
+    for (uint32_t i = 0; i < kCount; i++) {
+      uint32_t value = i;
+      ups_key_t key = ups_make_key(&value, sizeof(value));
+      ups_record_t rec = ups_make_record(&value, sizeof(value));
+      REQUIRE(0 == ups_db_insert_async(m_db, 0, &key, &rec, 0,
+                              async_callback, &results));
+    }
+    // the second insert of the same key fails
+    uint32_t value = 0;
+    ups_key_t key = ups_make_key(&value, sizeof(value));
+    ups_record_t rec = ups_make_record(&value, sizeof(value));
+    REQUIRE(0 == ups_db_insert_async(m_db, 0, &key, &rec, 0,
+                            async_callback, &results));
+    REQUIRE(0 == ups_env_wait_async(m_env));
+    REQUIRE(results.status.size() == kCount + 1);
+    for (uint32_t i = 0; i < kCount; i++) {
+      REQUIRE(results.status[i] == 0);
+      REQUIRE(results.keys[i] == i);
+      REQUIRE(results.records[i] == 0xffffffff);
+    }
+    REQUIRE(results.status[kCount] == UPS_DUPLICATE_KEY);
+
+    // look up the keys; odd keys are erased first
+    results = AsyncResults();
+    for (uint32_t i = 1; i < kCount; i += 2) {
+      key = ups_make_key(&i, sizeof(i));
+      REQUIRE(0 == ups_db_erase_async(m_db, 0, &key, 0,
+                              async_callback, &results));
+    }
+    for (uint32_t i = 0; i < kCount; i++) {
+      key = ups_make_key(&i, sizeof(i));
+      REQUIRE(0 == ups_db_find_async(m_db, 0, &key, 0,
+                              async_callback, &results));
+    }
+    REQUIRE(0 == ups_env_wait_async(m_env));
+    REQUIRE(results.status.size() == kCount / 2 + kCount);
+    for (uint32_t i = 0; i < kCount / 2; i++)
+      REQUIRE(results.status[i] == 0);
+    for (uint32_t i = 0; i < kCount; i++) {
+      size_t j = kCount / 2 + i;
+      REQUIRE(results.keys[j] == i);
+      if (i % 2) {
+        REQUIRE(results.status[j] == UPS_KEY_NOT_FOUND);
+      }
+      else {
+        REQUIRE(results.status[j] == 0);
+        REQUIRE(results.records[j] == i);
+      }
+    }
+
+    REQUIRE(UPS_INV_PARAMETER == ups_db_insert_async(m_db, 0, &key, &rec,
+                            0, 0, 0));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_find_async(m_db, 0, 0, 0,
+                            async_callback, &results));
+    REQUIRE(UPS_INV_PARAMETER == ups_db_erase_async(0, 0, &key, 0,
+                            async_callback, &results));
+    REQUIRE(UPS_INV_PARAMETER == ups_env_wait_async(0));
+  }
+
+  void batchRecnoTest() {
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 2, UPS_RECORD_NUMBER64, 0));
+
+    const uint32_t kCount = 100;
+    std::vector<uint32_t> values(kCount);
+    std::vector<ups_key_t> keys(kCount);
+    std::vector<ups_record_t> records(kCount);
+    std::vector<ups_status_t> results(kCount);
+
+    for (uint32_t i = 0; i < kCount; i++) {
+      values[i] = i;
+      ::memset(&keys[i], 0, sizeof(keys[i]));
+      records[i] = ups_make_record(&values[i], sizeof(values[i]));
+    }
+    REQUIRE(0 == ups_db_insert_many(m_db, 0, &keys[0], &records[0], kCount,
+                            &results[0], 0));
+    for (uint32_t i = 0; i < kCount; i++) {
+      REQUIRE(results[i] == 0);
+      REQUIRE(keys[i].size == sizeof(uint64_t));
+      REQUIRE(*(uint64_t *)keys[i].data == (uint64_t)i + 1);
+    }
+
+    for (uint32_t i = 0; i < kCount; i++)
+      ::memset(&records[i], 0, sizeof(records[i]));
+    REQUIRE(0 == ups_db_find_many(m_db, 0, &keys[0], &records[0], kCount,
+                            &results[0], 0));
+    for (uint32_t i = 0; i < kCount; i++) {
+      REQUIRE(results[i] == 0);
+      REQUIRE(*(uint32_t *)records[i].data == i);
+    }
+  }
 };
 
 TEST_CASE("Upscaledb/versionTest", "")
@@ -2660,4 +2943,34 @@ TEST_CASE("Upscaledb/issue47Test", "")
   f.issue47Test();
 }
 
+TEST_CASE("Upscaledb/concurrentReadsTest", "")
+{
+  UpscaledbFixture f;
+  f.concurrentReadsTest();
+}
+
+TEST_CASE("Upscaledb/batchTest", "")
+{
+  UpscaledbFixture f;
+  f.batchTest(0);
+}
+
+TEST_CASE("Upscaledb/batchTxnTest", "")
+{
+  UpscaledbFixture f;
+  f.batchTest(UPS_ENABLE_TRANSACTIONS);
+}
+
+TEST_CASE("Upscaledb/batchRecnoTest", "")
+{
+  UpscaledbFixture f;
+  f.batchRecnoTest();
+}
+
+TEST_CASE("Upscaledb/asyncTest", "")
+{
+  UpscaledbFixture f;
+  f.asyncTest();
+}
+
 } // namespace upscaledb